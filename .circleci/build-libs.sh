@@ -6,7 +6,7 @@
 SRC=../../indi-3rdparty/
 FLAGS="-DCMAKE_INSTALL_PREFIX=/usr -DFIX_WARNINGS=ON -DCMAKE_BUILD_TYPE=$1"
 
-LIBS="libapogee libfishcamp libfli libqhy libqsi libsbig libinovasdk libahp-xc libahp-gt"
+LIBS="libpixelconvert libapogee libfishcamp libfli libqhy libqsi libsbig libinovasdk libahp-xc libahp-gt"
 
 if [ .${CIRCLE_BRANCH%_*} == '.drv' -a `lsb_release -si` == 'Ubuntu' ] ; then
     DRV=lib"${CIRCLE_BRANCH#drv_}"
@@ -0,0 +1,52 @@
+# - Try to find INDI pixel layout conversion library
+# Once done this will define
+#
+#  PIXELCONVERT_FOUND - system has PIXELCONVERT
+#  PIXELCONVERT_INCLUDE_DIR - the PIXELCONVERT include directory
+#  PIXELCONVERT_LIBRARIES - Link these to use PIXELCONVERT
+
+# Copyright (c) 2026, INDI Developers
+# Based on FindLibfacile by Carsten Niehaus, <cniehaus@gmx.de>
+#
+# Redistribution and use is allowed according to the terms of the BSD license.
+# For details see the accompanying COPYING-CMAKE-SCRIPTS file.
+
+if (PIXELCONVERT_INCLUDE_DIR AND PIXELCONVERT_LIBRARIES)
+
+  # in cache already
+  set(PIXELCONVERT_FOUND TRUE)
+  message(STATUS "Found libpixelconvert: ${PIXELCONVERT_LIBRARIES}")
+
+else (PIXELCONVERT_INCLUDE_DIR AND PIXELCONVERT_LIBRARIES)
+
+  find_path(PIXELCONVERT_INCLUDE_DIR pixelconvert.h
+    ${_obIncDir}
+    ${GNUWIN32_DIR}/include
+  )
+
+  find_library(PIXELCONVERT_LIBRARIES NAMES pixelconvert
+    PATHS
+    ${_obLinkDir}
+    ${GNUWIN32_DIR}/lib
+  )
+
+  if(PIXELCONVERT_INCLUDE_DIR AND PIXELCONVERT_LIBRARIES)
+    set(PIXELCONVERT_FOUND TRUE)
+  else (PIXELCONVERT_INCLUDE_DIR AND PIXELCONVERT_LIBRARIES)
+    set(PIXELCONVERT_FOUND FALSE)
+  endif(PIXELCONVERT_INCLUDE_DIR AND PIXELCONVERT_LIBRARIES)
+
+
+  if (PIXELCONVERT_FOUND)
+    if (NOT PIXELCONVERT_FIND_QUIETLY)
+      message(STATUS "Found PIXELCONVERT: ${PIXELCONVERT_LIBRARIES}")
+    endif (NOT PIXELCONVERT_FIND_QUIETLY)
+  else (PIXELCONVERT_FOUND)
+    if (PIXELCONVERT_FIND_REQUIRED)
+      message(FATAL_ERROR "PIXELCONVERT not found. Please install libpixelconvert-dev. http://www.indilib.org")
+    endif (PIXELCONVERT_FIND_REQUIRED)
+  endif (PIXELCONVERT_FOUND)
+
+  mark_as_advanced(PIXELCONVERT_INCLUDE_DIR PIXELCONVERT_LIBRARIES)
+  
+endif (PIXELCONVERT_INCLUDE_DIR AND PIXELCONVERT_LIBRARIES)
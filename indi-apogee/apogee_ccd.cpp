@@ -42,6 +42,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
 #include <netdb.h>
 #include <zlib.h>
 
+#include <chrono>
 #include <memory>
 
 #ifdef OSX_EMBEDED_MODE
@@ -134,6 +135,11 @@ bool ApogeeCCD::initProperties()
     IUFillSwitchVector(&FanStatusSP, FanStatusS, 4, getDeviceName(), "CCD_FAN", "Fan", OPTIONS_TAB, IP_RW, ISR_1OFMANY,
                        0, IPS_IDLE);
 
+    IUFillNumber(&DownloadTimeN[TIME_DOWNLOAD], "DOWNLOAD_MS", "Download (ms)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumber(&DownloadTimeN[TIME_DELIVERY], "DELIVERY_MS", "Delivery (ms)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&DownloadTimeNP, DownloadTimeN, 2, getDeviceName(), "CCD_DOWNLOAD_TIME", "Frame Timing", INFO_TAB,
+                       IP_RO, 0, IPS_IDLE);
+
     // Filter Type
     IUFillSwitch(&FilterTypeS[TYPE_UNKNOWN], "TYPE_UNKNOWN", "No CFW", ISS_ON);
     IUFillSwitch(&FilterTypeS[TYPE_FW50_9R], "TYPE_FW50_9R", "FW50 9R", ISS_OFF);
@@ -177,6 +183,7 @@ bool ApogeeCCD::updateProperties()
         defineProperty(&CoolerNP);
         defineProperty(&ReadOutSP);
         defineProperty(&FanStatusSP);
+        defineProperty(&DownloadTimeNP);
         getCameraParams();
 
         if (cfwFound)
@@ -194,6 +201,7 @@ bool ApogeeCCD::updateProperties()
         deleteProperty(ReadOutSP.name);
         deleteProperty(CamInfoTP.name);
         deleteProperty(FanStatusSP.name);
+        deleteProperty(DownloadTimeNP.name);
 
         if (cfwFound)
         {
@@ -684,8 +692,8 @@ bool ApogeeCCD::UpdateCCDBin(int binx, int biny)
 
 int ApogeeCCD::grabImage()
 {
-    std::vector<uint16_t> pImageData;
     uint16_t *image = reinterpret_cast<uint16_t*>(PrimaryCCD.getFrameBuffer());
+    auto downloadStart = std::chrono::steady_clock::now();
 
     try
     {
@@ -698,10 +706,10 @@ int ApogeeCCD::grabImage()
         }
         else
         {
-            ApgCam->GetImage(pImageData);
+            // The library writes the ROI straight into the frame buffer, one row per GetRoiNumCols() pixels.
             imageWidth  = ApgCam->GetRoiNumCols();
             imageHeight = ApgCam->GetRoiNumRows();
-            copy(pImageData.begin(), pImageData.end(), image);
+            ApgCam->GetImage(image, PrimaryCCD.getFrameBufferSize() / sizeof(uint16_t), imageWidth);
         }
         guard.unlock();
     }
@@ -711,9 +719,19 @@ int ApogeeCCD::grabImage()
         return -1;
     }
 
+    auto deliveryStart = std::chrono::steady_clock::now();
+
     ExposureComplete(&PrimaryCCD);
 
-    LOG_INFO("Download complete.");
+    auto deliveryEnd = std::chrono::steady_clock::now();
+
+    DownloadTimeN[TIME_DOWNLOAD].value = std::chrono::duration<double, std::milli>(deliveryStart - downloadStart).count();
+    DownloadTimeN[TIME_DELIVERY].value = std::chrono::duration<double, std::milli>(deliveryEnd - deliveryStart).count();
+    DownloadTimeNP.s = IPS_OK;
+    IDSetNumber(&DownloadTimeNP, nullptr);
+
+    LOGF_INFO("Download complete (download %.1f ms, delivery %.1f ms).", DownloadTimeN[TIME_DOWNLOAD].value,
+              DownloadTimeN[TIME_DELIVERY].value);
 
     return 0;
 }
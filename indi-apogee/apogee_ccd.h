@@ -128,6 +128,15 @@ class ApogeeCCD : public INDI::CCD, public INDI::FilterInterface
             INFO_FIRMWARE,
         };
 
+        // Per-frame timings
+        INumber DownloadTimeN[2];
+        INumberVectorProperty DownloadTimeNP;
+        enum
+        {
+            TIME_DOWNLOAD,
+            TIME_DELIVERY,
+        };
+
         double minDuration;
         double ExposureRequest;
         int imageWidth, imageHeight;
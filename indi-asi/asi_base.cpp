@@ -23,15 +23,18 @@
 #include "asi_base.h"
 #include "asi_helpers.h"
 
+#include <pixelconvert.h>
+
 #include "config.h"
 
 #include <stream/streammanager.h>
-#include <indielapsedtimer.h>
 
 #include <algorithm>
 #include <cmath>
 #include <vector>
 #include <map>
+#include <new>
+#include <thread>
 #include <unistd.h>
 
 #define MAX_EXP_RETRIES         3
@@ -40,6 +43,10 @@
 #define TEMP_THRESHOLD          .25  /* Differential temperature threshold (C)*/
 
 #define CONTROL_TAB "Controls"
+#define STREAMING_TAB "Streaming"
+
+#define STREAM_RING_DEPTH       4    /* Default number of video frames buffered between reader and encoder */
+#define STREAM_STATS_INTERVAL   1000 /* Video counters update interval (ms) */
 
 static bool warn_roi_height = true;
 static bool warn_roi_width = true;
@@ -67,11 +74,31 @@ void ASIBase::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
         LOGF_ERROR("Failed to start video capture (%s).", Helpers::toString(ret));
     }
 
+    uint32_t totalBytes = PrimaryCCD.getFrameBufferSize();
+    int waitMS          = static_cast<int>((ExposureRequest * 2000.0) + 500);
+
+    // Frames are read into the ring here and converted/encoded on the delivery thread,
+    // so a stall in the recorder or encoder never holds up ASIGetVideoData.
+    mFrameRing.allocate(static_cast<size_t>(StreamRingNP[0].getValue()), totalBytes);
+    std::vector<uint8_t> discardFrame;
+
+    mStreamCaptured = mStreamDelivered = mStreamDropped = mStreamLate = 0;
+
+    std::thread delivery(&ASIBase::workerDeliverVideo, this, ExposureRequest);
+
     while (!isAboutToQuit)
     {
-        uint8_t *targetFrame = PrimaryCCD.getFrameBuffer();
-        uint32_t totalBytes  = PrimaryCCD.getFrameBufferSize();
-        int waitMS           = static_cast<int>((ExposureRequest * 2000.0) + 500);
+        FrameRing::Slot *slot = mFrameRing.beginWrite();
+        uint8_t *targetFrame;
+
+        if (slot != nullptr)
+            targetFrame = slot->data.data();
+        else
+        {
+            // Ring is full, keep draining the camera so the SDK does not fall behind.
+            discardFrame.resize(totalBytes);
+            targetFrame = discardFrame.data();
+        }
 
         ret = ASIGetVideoData(mCameraInfo.CameraID, targetFrame, totalBytes, waitMS);
         if (ret != ASI_SUCCESS)
@@ -87,14 +114,86 @@ void ASIBase::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
             continue;
         }
 
-        if (mCurrentVideoFormat == ASI_IMG_RGB24)
-            for (uint32_t i = 0; i < totalBytes; i += 3)
-                std::swap(targetFrame[i], targetFrame[i + 2]);
+        mStreamCaptured++;
 
-        Streamer->newFrame(targetFrame, totalBytes);
+        if (slot == nullptr)
+        {
+            mStreamDropped++;
+            continue;
+        }
+
+        slot->size = totalBytes;
+        slot->timestamp = std::chrono::steady_clock::now();
+        mFrameRing.endWrite();
     }
 
     ASIStopVideoCapture(mCameraInfo.CameraID);
+
+    // Stopping drops what the encoder has not caught up with yet
+    mFrameRing.close(true);
+    delivery.join();
+}
+
+void ASIBase::workerDeliverVideo(double framePeriod)
+{
+    const auto latency = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double>(framePeriod));
+    const auto statsInterval = std::chrono::milliseconds(STREAM_STATS_INTERVAL);
+    auto lastStats = std::chrono::steady_clock::now();
+
+    // Only this thread publishes the stats, the reader just bumps the atomic counters
+    StreamStatsNP.setState(IPS_BUSY);
+    updateStreamStats();
+
+    while (true)
+    {
+        FrameRing::Slot *slot = mFrameRing.beginRead(statsInterval);
+        auto now = std::chrono::steady_clock::now();
+
+        if (slot != nullptr)
+        {
+            uint8_t *frame = slot->data.data();
+            size_t size    = slot->size;
+
+            if (mCurrentVideoFormat == ASI_IMG_RGB24)
+                pixelconvert_swap_rb24(frame, size / 3);
+
+            Streamer->newFrame(frame, size);
+
+            // Late: the frame waited in the ring longer than one frame period.
+            if (now - slot->timestamp > latency)
+                mStreamLate++;
+            mStreamDelivered++;
+
+            mFrameRing.endRead();
+        }
+        else if (mFrameRing.isClosed())
+            break;
+
+        if (now - lastStats >= statsInterval)
+        {
+            updateStreamStats();
+            lastStats = now;
+        }
+    }
+
+    // The reader stops capturing before closing the ring, so these are the final counts
+    StreamStatsNP.setState(IPS_OK);
+    updateStreamStats();
+}
+
+void ASIBase::updateStreamStats()
+{
+    int sdkDropped = 0;
+    if (ASIGetDroppedFrames(mCameraInfo.CameraID, &sdkDropped) != ASI_SUCCESS)
+        sdkDropped = 0;
+
+    StreamStatsNP[STREAM_CAPTURED].setValue(mStreamCaptured);
+    StreamStatsNP[STREAM_DELIVERED].setValue(mStreamDelivered);
+    StreamStatsNP[STREAM_DROPPED].setValue(mStreamDropped);
+    StreamStatsNP[STREAM_SDK_DROPPED].setValue(sdkDropped);
+    StreamStatsNP[STREAM_LATE].setValue(mStreamLate);
+    StreamStatsNP.apply();
 }
 
 void ASIBase::workerBlinkExposure(const std::atomic_bool &isAboutToQuit, int blinks, float duration)
@@ -167,64 +266,48 @@ void ASIBase::workerExposure(const std::atomic_bool &isAboutToQuit, float durati
         LOGF_ERROR("Failed to set exposure duration (%s).", Helpers::toString(ret));
     }
 
-    // Try exposure for 3 times
     ASI_BOOL isDark = (PrimaryCCD.getFrameType() == INDI::CCDChip::DARK_FRAME) ? ASI_TRUE : ASI_FALSE;
+    ReadoutModel::Mode mode = getReadoutMode();
+    ASI_EXPOSURE_STATUS status = ASI_EXP_IDLE;
+    std::chrono::steady_clock::time_point exposureStart;
 
-    for (int i = 0; i < 3; i++)
-    {
-        ret = ASIStartExposure(mCameraInfo.CameraID, isDark);
-        if (ret == ASI_SUCCESS)
-            break;
-
-        LOGF_ERROR("Failed to start exposure (%d)", Helpers::toString(ret));
-        // Wait 100ms before trying again
-        usleep(100 * 1000);
-    }
-
-    if (ret != ASI_SUCCESS)
+    // Restart the exposure up to MAX_EXP_RETRIES times if the camera reports a failure
+    while (true)
     {
-        LOG_WARN(
-            "ASI firmware might require an update to *compatible mode."
-            "Check http://www.indilib.org/devices/ccds/zwo-optics-asi-cameras.html for details."
-        );
-        return;
-    }
-
-    INDI::ElapsedTimer exposureTimer;
+        // Try exposure for 3 times
+        for (int i = 0; i < 3; i++)
+        {
+            ret = ASIStartExposure(mCameraInfo.CameraID, isDark);
+            if (ret == ASI_SUCCESS)
+                break;
 
-    if (duration > VERBOSE_EXPOSURE)
-        LOGF_INFO("Taking a %g seconds frame...", duration);
+            LOGF_ERROR("Failed to start exposure (%d)", Helpers::toString(ret));
+            // Wait 100ms before trying again
+            usleep(100 * 1000);
+        }
 
-    int statRetry = 0;
-    ASI_EXPOSURE_STATUS status = ASI_EXP_IDLE;
-    do
-    {
-        float delay = 0.1;
-        float timeLeft = std::max(duration - exposureTimer.elapsed() / 1000.0, 0.0);
-
-        /*
-         * Check the status every second until the time left is
-         * about one second, after which decrease the poll interval
-         *
-         * For expsoures with more than a second left try
-         * to keep the displayed "exposure left" value at
-         * a full second boundary, which keeps the
-         * count down neat
-         */
-        if (timeLeft > 1.1)
+        if (ret != ASI_SUCCESS)
         {
-            delay = std::max(timeLeft - std::trunc(timeLeft), 0.005f);
-            timeLeft = std::round(timeLeft);
+            LOG_WARN(
+                "ASI firmware might require an update to *compatible mode."
+                "Check http://www.indilib.org/devices/ccds/zwo-optics-asi-cameras.html for details."
+            );
+            return;
         }
 
-        if (timeLeft > 0)
+        exposureStart = std::chrono::steady_clock::now();
+
+        if (duration > VERBOSE_EXPOSURE && mExposureRetry == 0)
+            LOGF_INFO("Taking a %g seconds frame...", duration);
+
+        // Sleep until just before the learned readout completes, then poll closely.
+        double overhead = 0;
+        ret = waitForExposure(mCameraInfo.CameraID, exposureStart, duration, mReadoutModel.predict(mode), isAboutToQuit,
+                              [this](double timeLeft)
         {
             PrimaryCCD.setExposureLeft(timeLeft);
-        }
-
-        usleep(delay * 1000 * 1000);
+        }, status, overhead);
 
-        ASI_ERROR_CODE ret = ASIGetExpStatus(mCameraInfo.CameraID, &status);
         // 2021-09-11 <sterne-jaeger@openfuture.de>: Fix for
         // https://www.indilib.org/forum/development/10346-asi-driver-sends-image-after-abort.html
         // Aborting an exposure also returns ASI_SUCCESS here, therefore
@@ -234,35 +317,27 @@ void ASIBase::workerExposure(const std::atomic_bool &isAboutToQuit, float durati
 
         if (ret != ASI_SUCCESS)
         {
-            LOGF_DEBUG("Failed to get exposure status (%s)", Helpers::toString(ret));
-            if (++statRetry < 10)
-            {
-                usleep(100);
-                continue;
-            }
-
             LOGF_ERROR("Exposure status timed out (%s)", Helpers::toString(ret));
             PrimaryCCD.setExposureFailed();
             return;
         }
 
-        if (status == ASI_EXP_FAILED)
+        if (status == ASI_EXP_SUCCESS)
         {
-            if (++mExposureRetry < MAX_EXP_RETRIES)
-            {
-                LOG_DEBUG("ASIGetExpStatus failed. Restarting exposure...");
-                ASIStopExposure(mCameraInfo.CameraID);
-                workerExposure(isAboutToQuit, duration);
-                return;
-            }
+            mReadoutModel.addSample(mode, overhead);
+            break;
+        }
 
+        ASIStopExposure(mCameraInfo.CameraID);
+        if (++mExposureRetry >= MAX_EXP_RETRIES)
+        {
             LOGF_ERROR("Exposure failed after %d attempts.", mExposureRetry);
-            ASIStopExposure(mCameraInfo.CameraID);
             PrimaryCCD.setExposureFailed();
             return;
         }
+
+        LOG_DEBUG("ASIGetExpStatus failed. Restarting exposure...");
     }
-    while (status != ASI_EXP_SUCCESS);
 
     // Reset exposure retry
     mExposureRetry = 0;
@@ -270,7 +345,37 @@ void ASIBase::workerExposure(const std::atomic_bool &isAboutToQuit, float durati
     if (PrimaryCCD.getExposureDuration() > VERBOSE_EXPOSURE)
         LOG_INFO("Exposure done, downloading image...");
 
-    grabImage(duration);
+    if (grabImage(duration) == 0)
+        updateExposureLatency(exposureStart, duration, mReadoutModel.predict(mode));
+}
+
+ReadoutModel::Mode ASIBase::getReadoutMode()
+{
+    ReadoutModel::Mode mode;
+    mode.width     = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    mode.height    = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    mode.bin       = PrimaryCCD.getBinX();
+    mode.imageType = getImageType();
+    return mode;
+}
+
+void ASIBase::updateExposureLatency(std::chrono::steady_clock::time_point start, double duration, double predicted)
+{
+    double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    mLatencyCount++;
+    mLatencySum += latency;
+    mLatencyMin = (mLatencyCount == 1) ? latency : std::min(mLatencyMin, latency);
+    mLatencyMax = (mLatencyCount == 1) ? latency : std::max(mLatencyMax, latency);
+
+    ExposureLatencyNP[LATENCY_LAST].setValue(latency);
+    ExposureLatencyNP[LATENCY_MEAN].setValue(mLatencySum / mLatencyCount);
+    ExposureLatencyNP[LATENCY_MIN].setValue(mLatencyMin);
+    ExposureLatencyNP[LATENCY_MAX].setValue(mLatencyMax);
+    ExposureLatencyNP[LATENCY_OVERHEAD].setValue(latency - duration * 1000);
+    ExposureLatencyNP[LATENCY_PREDICTED].setValue(predicted * 1000);
+    ExposureLatencyNP.setState(IPS_OK);
+    ExposureLatencyNP.apply();
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -328,6 +433,29 @@ bool ASIBase::initProperties()
     BlinkNP[BLINK_DURATION].fill("BLINK_DURATION", "Blink duration",         "%2.3f", 0,  60, 0.001, 0);
     BlinkNP.fill(getDeviceName(), "BLINK", "Blink", CONTROL_TAB, IP_RW, 60, IPS_IDLE);
 
+    ExposureLatencyNP[LATENCY_LAST     ].fill("LATENCY_LAST",      "Last (ms)",              "%.1f", 0, 1e9, 0, 0);
+    ExposureLatencyNP[LATENCY_MEAN     ].fill("LATENCY_MEAN",      "Mean (ms)",              "%.1f", 0, 1e9, 0, 0);
+    ExposureLatencyNP[LATENCY_MIN      ].fill("LATENCY_MIN",       "Min (ms)",               "%.1f", 0, 1e9, 0, 0);
+    ExposureLatencyNP[LATENCY_MAX      ].fill("LATENCY_MAX",       "Max (ms)",               "%.1f", 0, 1e9, 0, 0);
+    ExposureLatencyNP[LATENCY_OVERHEAD ].fill("LATENCY_OVERHEAD",  "Last overhead (ms)",     "%.1f", -1e9, 1e9, 0, 0);
+    ExposureLatencyNP[LATENCY_PREDICTED].fill("LATENCY_PREDICTED", "Predicted readout (ms)", "%.1f", 0, 1e9, 0, 0);
+    ExposureLatencyNP.fill(getDeviceName(), "CCD_EXPOSURE_LATENCY", "Exposure Latency", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
+    StreamRingNP[0].fill("STREAM_RING_DEPTH", "Buffers", "%.f", 2, 64, 1, STREAM_RING_DEPTH);
+    StreamRingNP.fill(getDeviceName(), "CCD_STREAM_BUFFERS", "Stream Buffers", STREAMING_TAB, IP_RW, 60, IPS_IDLE);
+
+    StreamStatsNP[STREAM_CAPTURED   ].fill("STREAM_CAPTURED",    "Captured",         "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_DELIVERED  ].fill("STREAM_DELIVERED",   "Delivered",        "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_DROPPED    ].fill("STREAM_DROPPED",     "Dropped (ring)",   "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_SDK_DROPPED].fill("STREAM_SDK_DROPPED", "Dropped (camera)", "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_LATE       ].fill("STREAM_LATE",        "Late",             "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP.fill(getDeviceName(), "CCD_STREAM_STATS", "Stream Stats", STREAMING_TAB, IP_RO, 60, IPS_IDLE);
+
+    ScratchArenaNP[SCRATCH_HITS  ].fill("SCRATCH_HITS",   "Reused",     "%.f", 0, 1e12, 0, 0);
+    ScratchArenaNP[SCRATCH_MISSES].fill("SCRATCH_MISSES", "Allocated",  "%.f", 0, 1e12, 0, 0);
+    ScratchArenaNP[SCRATCH_SIZE  ].fill("SCRATCH_SIZE",   "Size (MB)",  "%.2f", 0, 1e6, 0, 0);
+    ScratchArenaNP.fill(getDeviceName(), "CCD_SCRATCH_ARENA", "RGB Buffer", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
     IUSaveText(&BayerT[2], getBayerString());
 
     ADCDepthNP[0].fill("BITS", "Bits", "%2.0f", 0, 32, 1, mCameraInfo.BitDepth);
@@ -467,7 +595,13 @@ bool ASIBase::updateProperties()
         }
 
         defineProperty(BlinkNP);
+        defineProperty(StreamRingNP);
+        loadConfig(true, StreamRingNP.getName());
+        defineProperty(StreamStatsNP);
+        defineProperty(ExposureLatencyNP);
         defineProperty(ADCDepthNP);
+        if (mCameraInfo.IsColorCam)
+            defineProperty(ScratchArenaNP);
         defineProperty(SDKVersionSP);
         if (!mSerialNumber.empty())
         {
@@ -500,6 +634,9 @@ bool ASIBase::updateProperties()
             deleteProperty(VideoFormatSP.getName());
 
         deleteProperty(BlinkNP.getName());
+        deleteProperty(StreamRingNP.getName());
+        deleteProperty(StreamStatsNP.getName());
+        deleteProperty(ExposureLatencyNP.getName());
         deleteProperty(SDKVersionSP.getName());
         if (!mSerialNumber.empty())
         {
@@ -507,6 +644,8 @@ bool ASIBase::updateProperties()
             deleteProperty(NicknameTP.getName());
         }
         deleteProperty(ADCDepthNP.getName());
+        if (mCameraInfo.IsColorCam)
+            deleteProperty(ScratchArenaNP.getName());
     }
 
     return true;
@@ -571,6 +710,12 @@ bool ASIBase::Disconnect()
         ASICloseCamera(mCameraInfo.CameraID);
     }
 
+    releaseScratchBuffer();
+    mFrameRing.release();
+    mReadoutModel.clear();
+    mLatencyCount = 0;
+    mLatencySum = mLatencyMin = mLatencyMax = 0;
+
     LOG_INFO("Camera is offline.");
 
 
@@ -783,6 +928,21 @@ bool ASIBase::ISNewNumber(const char *dev, const char *name, double values[], ch
             BlinkNP.apply();
             return true;
         }
+
+        if (StreamRingNP.isNameMatch(name))
+        {
+            if (Streamer->isBusy())
+            {
+                LOG_WARN("Cannot change stream buffers while streaming or recording.");
+                StreamRingNP.setState(IPS_ALERT);
+                StreamRingNP.apply();
+                return true;
+            }
+
+            StreamRingNP.setState(StreamRingNP.update(values, names, n) ? IPS_OK : IPS_ALERT);
+            StreamRingNP.apply();
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -1162,10 +1322,10 @@ int ASIBase::grabImage(float duration)
 
     if (type == ASI_IMG_RGB24)
     {
-        buffer = static_cast<uint8_t *>(malloc(nTotalBytes));
+        buffer = getScratchBuffer(nTotalBytes);
         if (buffer == nullptr)
         {
-            LOGF_ERROR("%s: %d malloc failed (RGB 24).", getDeviceName());
+            LOGF_ERROR("Failed to allocate %zu bytes for RGB 24 buffer.", nTotalBytes);
             return -1;
         }
     }
@@ -1177,31 +1337,19 @@ int ASIBase::grabImage(float duration)
             "Failed to get data after exposure (%dx%d #%d channels) (%s).",
             subW, subH, nChannels, Helpers::toString(ret)
         );
-        if (type == ASI_IMG_RGB24)
-            free(buffer);
         return -1;
     }
 
     if (type == ASI_IMG_RGB24)
     {
-        uint8_t *dstR = image;
-        uint8_t *dstG = image + subW * subH;
-        uint8_t *dstB = image + subW * subH * 2;
-
-        const uint8_t *src = buffer;
-        const uint8_t *end = buffer + subW * subH * 3;
-
-        while (src != end)
-        {
-            *dstB++ = *src++;
-            *dstG++ = *src++;
-            *dstR++ = *src++;
-        }
-
-        free(buffer);
+        size_t nPixels = subW * subH;
+        pixelconvert_deinterleave_rgb24(buffer, image, image + nPixels, image + nPixels * 2, nPixels, PIXELCONVERT_ORDER_BGR);
     }
     guard.unlock();
 
+    if (type == ASI_IMG_RGB24)
+        ScratchArenaNP.apply();
+
     PrimaryCCD.setNAxis(type == ASI_IMG_RGB24 ? 3 : 2);
 
     // If mono camera or we're sending Luma or RGB, turn off bayering
@@ -1217,6 +1365,45 @@ int ASIBase::grabImage(float duration)
     return 0;
 }
 
+uint8_t *ASIBase::getScratchBuffer(size_t size)
+{
+    if (mScratchBuffer && size <= mScratchCapacity)
+    {
+        ScratchArenaNP[SCRATCH_HITS].setValue(ScratchArenaNP[SCRATCH_HITS].getValue() + 1);
+        return mScratchBuffer.get();
+    }
+
+    // Contents need not be preserved, so drop the old block before allocating the larger one.
+    mScratchBuffer.reset();
+    mScratchCapacity = 0;
+    mScratchBuffer.reset(new (std::nothrow) uint8_t[size]);
+    if (!mScratchBuffer)
+    {
+        ScratchArenaNP.setState(IPS_ALERT);
+        return nullptr;
+    }
+
+    mScratchCapacity = size;
+    LOGF_DEBUG("RGB buffer grown to %zu bytes.", size);
+
+    ScratchArenaNP[SCRATCH_MISSES].setValue(ScratchArenaNP[SCRATCH_MISSES].getValue() + 1);
+    ScratchArenaNP[SCRATCH_SIZE].setValue(size / 1048576.0);
+    ScratchArenaNP.setState(IPS_OK);
+    return mScratchBuffer.get();
+}
+
+void ASIBase::releaseScratchBuffer()
+{
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
+    mScratchBuffer.reset();
+    mScratchCapacity = 0;
+
+    ScratchArenaNP[SCRATCH_HITS].setValue(0);
+    ScratchArenaNP[SCRATCH_MISSES].setValue(0);
+    ScratchArenaNP[SCRATCH_SIZE].setValue(0);
+    ScratchArenaNP.setState(IPS_IDLE);
+}
+
 bool ASIBase::isMonoBinActive()
 {
     long monoBin = 0;
@@ -1562,6 +1749,7 @@ bool ASIBase::saveConfigItems(FILE *fp)
         VideoFormatSP.save(fp);
 
     BlinkNP.save(fp);
+    StreamRingNP.save(fp);
 
     return true;
 }
@@ -23,12 +23,16 @@
 #pragma once
 
 #include <ASICamera2.h>
+#include <pixelconvert_framering.h>
 
 #include "indipropertyswitch.h"
 #include "indipropertynumber.h"
 #include "indipropertytext.h"
 #include "indisinglethreadpool.h"
+#include "asi_readout_model.h"
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include <indiccd.h>
@@ -86,12 +90,33 @@ class ASIBase : public INDI::CCD
     protected:
         INDI::SingleThreadPool mWorker;
         void workerStreamVideo(const std::atomic_bool &isAboutToQuit);
+        void workerDeliverVideo(double framePeriod);
         void workerBlinkExposure(const std::atomic_bool &isAboutToQuit, int blinks, float duration);
         void workerExposure(const std::atomic_bool &isAboutToQuit, float duration);
 
         /** Get image from CCD and send it to client */
         int grabImage(float duration);
 
+        /** Readout mode of the current frame settings, used as key for the readout model */
+        ReadoutModel::Mode getReadoutMode();
+
+        /** Publish exposure start to ExposureComplete latency statistics */
+        void updateExposureLatency(std::chrono::steady_clock::time_point start, double duration, double predicted);
+
+        /**
+         * @brief Get the persistent scratch buffer used for RGB24 downloads.
+         * The buffer is kept across exposures and only grows when a larger frame is requested.
+         * @param size Required size in bytes.
+         * @return Pointer to at least size bytes, or nullptr if the allocation failed.
+         */
+        uint8_t *getScratchBuffer(size_t size);
+
+        /** Release the scratch buffer and reset its statistics */
+        void releaseScratchBuffer();
+
+        /** Publish video ring counters, called from the delivery thread only */
+        void updateStreamStats();
+
     protected:
         double mTargetTemperature;
         double mCurrentTemperature;
@@ -159,9 +184,56 @@ class ASIBase : public INDI::CCD
             FLIP_VERTICAL
         };
 
+        INDI::PropertyNumber  ExposureLatencyNP {6};
+        enum
+        {
+            LATENCY_LAST,
+            LATENCY_MEAN,
+            LATENCY_MIN,
+            LATENCY_MAX,
+            LATENCY_OVERHEAD,
+            LATENCY_PREDICTED
+        };
+
+        INDI::PropertyNumber  StreamRingNP {1};
+
+        INDI::PropertyNumber  StreamStatsNP {5};
+        enum
+        {
+            STREAM_CAPTURED,
+            STREAM_DELIVERED,
+            STREAM_DROPPED,
+            STREAM_SDK_DROPPED,
+            STREAM_LATE
+        };
+
+        INDI::PropertyNumber  ScratchArenaNP {3};
+        enum
+        {
+            SCRATCH_HITS,
+            SCRATCH_MISSES,
+            SCRATCH_SIZE
+        };
+
         std::string mCameraName, mCameraID, mSerialNumber, mNickname;
         ASI_CAMERA_INFO mCameraInfo;
         uint8_t mExposureRetry {0};
         ASI_IMG_TYPE mCurrentVideoFormat;
         std::vector<ASI_CONTROL_CAPS> mControlCaps;
+
+        /** Scratch arena for interleaved RGB24 downloads, guarded by ccdBufferLock */
+        std::unique_ptr<uint8_t[]> mScratchBuffer;
+        size_t mScratchCapacity {0};
+
+        /** Video frames travel from the SDK reader (mWorker) to the delivery thread through this ring */
+        FrameRing mFrameRing;
+        std::atomic<uint64_t> mStreamCaptured {0};
+        std::atomic<uint64_t> mStreamDelivered {0};
+        std::atomic<uint64_t> mStreamDropped {0};
+        std::atomic<uint64_t> mStreamLate {0};
+
+        /** Readout time learned from the last exposures of each mode */
+        ReadoutModel mReadoutModel;
+        uint32_t mLatencyCount {0};
+        double mLatencySum {0}, mLatencyMin {0}, mLatencyMax {0};
 };
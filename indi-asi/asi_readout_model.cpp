@@ -0,0 +1,160 @@
+/*
+    ASI Camera Readout Model
+
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "asi_readout_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#define POLL_GUARD_MS           2    /* Wake up this long before the predicted completion */
+#define SPIN_INTERVAL_US        200  /* Status poll interval around the predicted completion */
+#define SPIN_WINDOW_MS          20   /* Fall back to slow polling after spinning this long */
+#define SLOW_POLL_US            5000 /* Status poll interval once the spin window has passed */
+#define MAX_STATUS_RETRIES      10   /* Consecutive ASIGetExpStatus errors before giving up */
+
+void ReadoutModel::addSample(const Mode &mode, double overhead)
+{
+    auto &samples = mSamples[mode];
+    samples.push_back(std::max(overhead, 0.0));
+    while (samples.size() > mWindow)
+        samples.pop_front();
+}
+
+double ReadoutModel::predict(const Mode &mode) const
+{
+    auto it = mSamples.find(mode);
+    if (it == mSamples.end() || it->second.empty())
+        return 0;
+
+    return *std::min_element(it->second.begin(), it->second.end());
+}
+
+size_t ReadoutModel::samples(const Mode &mode) const
+{
+    auto it = mSamples.find(mode);
+    return it == mSamples.end() ? 0 : it->second.size();
+}
+
+void ReadoutModel::clear()
+{
+    mSamples.clear();
+}
+
+ASI_ERROR_CODE waitForExposure(int cameraID, std::chrono::steady_clock::time_point start, double duration,
+                               double predictedOverhead, const std::atomic_bool &isAboutToQuit,
+                               const std::function<void(double)> &onTimeLeft, ASI_EXPOSURE_STATUS &status,
+                               double &overhead)
+{
+    using Clock = std::chrono::steady_clock;
+    auto toDuration = [](double seconds)
+    {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    };
+
+    const auto exposureEnd = start + toDuration(duration);
+    const auto guard       = std::chrono::milliseconds(POLL_GUARD_MS);
+    const auto wakeUp      = exposureEnd + toDuration(predictedOverhead) - guard;
+
+    int retries = 0;
+    status = ASI_EXP_WORKING;
+    overhead = 0;
+
+    ASI_ERROR_CODE ret = ASI_SUCCESS;
+
+    // Returns true when polling should stop, either because the exposure finished or ASIGetExpStatus keeps failing.
+    auto poll = [&]()
+    {
+        ret = ASIGetExpStatus(cameraID, &status);
+        if (ret != ASI_SUCCESS)
+        {
+            if (++retries < MAX_STATUS_RETRIES)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                return false;
+            }
+            return true;
+        }
+        retries = 0;
+        return status == ASI_EXP_SUCCESS || status == ASI_EXP_FAILED;
+    };
+
+    // Coarse phase: sleep until just before the predicted completion, waking at every
+    // full second of the countdown for long exposures.
+    while (Clock::now() < wakeUp)
+    {
+        auto now = Clock::now();
+        double timeLeft = std::chrono::duration<double>(exposureEnd - now).count();
+        auto next = wakeUp;
+
+        if (timeLeft > 1.1)
+        {
+            next = std::min(wakeUp, now + toDuration(std::max(timeLeft - std::trunc(timeLeft), 0.005)));
+            timeLeft = std::round(timeLeft);
+        }
+
+        if (timeLeft > 0 && onTimeLeft)
+            onTimeLeft(timeLeft);
+
+        std::this_thread::sleep_until(next);
+
+        if (isAboutToQuit)
+            return ASI_SUCCESS;
+
+        if (next == wakeUp)
+            break;
+
+        if (poll())
+        {
+            overhead = std::chrono::duration<double>(Clock::now() - exposureEnd).count();
+            return ret;
+        }
+    }
+
+    // Fine phase: poll at a short interval around the predicted completion.
+    const auto spinStart = Clock::now();
+    bool firstPoll = true;
+    while (true)
+    {
+        bool done = poll();
+
+        if (isAboutToQuit)
+            return ASI_SUCCESS;
+
+        if (done)
+        {
+            if (firstPoll && predictedOverhead > 0)
+            {
+                // Completion happened before we woke up, so the measurement is only an upper bound.
+                // Report a slightly shorter overhead so the model converges back down.
+                overhead = std::max(predictedOverhead - 2 * std::chrono::duration<double>(guard).count(), 0.0);
+            }
+            else
+                overhead = std::chrono::duration<double>(Clock::now() - exposureEnd).count();
+            return ret;
+        }
+
+        if (ret == ASI_SUCCESS)
+            firstPoll = false;
+
+        bool spinning = Clock::now() - spinStart < std::chrono::milliseconds(SPIN_WINDOW_MS);
+        std::this_thread::sleep_for(std::chrono::microseconds(spinning ? SPIN_INTERVAL_US : SLOW_POLL_US));
+    }
+}
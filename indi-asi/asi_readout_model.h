@@ -0,0 +1,95 @@
+/*
+    ASI Camera Readout Model
+
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <ASICamera2.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <tuple>
+
+/**
+ * @brief Learns how long the camera needs after the end of an exposure until
+ * ASIGetExpStatus reports ASI_EXP_SUCCESS, separately for every readout mode.
+ */
+class ReadoutModel
+{
+    public:
+        struct Mode
+        {
+            int width;
+            int height;
+            int bin;
+            int imageType;
+
+            bool operator<(const Mode &other) const
+            {
+                return std::tie(width, height, bin, imageType) < std::tie(other.width, other.height, other.bin, other.imageType);
+            }
+        };
+
+    public:
+        explicit ReadoutModel(size_t window = 16) : mWindow(window) {}
+
+        /** Record the measured readout overhead (seconds) of one exposure */
+        void addSample(const Mode &mode, double overhead);
+
+        /**
+         * @brief Predicted readout overhead in seconds, 0 when the mode has no history.
+         * The shortest overhead of the last exposures is used so the waiter wakes up early rather than late.
+         */
+        double predict(const Mode &mode) const;
+
+        /** Number of samples currently held for the mode */
+        size_t samples(const Mode &mode) const;
+
+        void clear();
+
+    private:
+        size_t mWindow;
+        std::map<Mode, std::deque<double>> mSamples;
+};
+
+/**
+ * @brief Wait until an exposure started at start has finished or failed.
+ *
+ * Sleeps until just before the predicted completion time (duration + predicted overhead),
+ * then polls ASIGetExpStatus at a short interval. Exposures longer than a second keep the
+ * once-per-second countdown so the client display stays neat.
+ *
+ * @param cameraID camera to poll.
+ * @param start time the exposure was started.
+ * @param duration exposure duration in seconds.
+ * @param predictedOverhead expected readout overhead in seconds (see ReadoutModel::predict).
+ * @param isAboutToQuit set when the exposure is aborted.
+ * @param onTimeLeft called with the remaining exposure time while waiting, may be empty.
+ * @param status receives the last exposure status.
+ * @param overhead receives the measured readout overhead in seconds, to be fed back into ReadoutModel.
+ * @return ASI_SUCCESS once the status is ASI_EXP_SUCCESS or ASI_EXP_FAILED or the wait was aborted,
+ * otherwise the error repeatedly returned by ASIGetExpStatus.
+ */
+ASI_ERROR_CODE waitForExposure(int cameraID, std::chrono::steady_clock::time_point start, double duration,
+                               double predictedOverhead, const std::atomic_bool &isAboutToQuit,
+                               const std::function<void(double)> &onTimeLeft, ASI_EXPOSURE_STATUS &status,
+                               double &overhead);
@@ -0,0 +1,217 @@
+/*
+    ASI Camera Readout Model Tests
+
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "asi_readout_model.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+// Mocked camera: the exposure reports ASI_EXP_WORKING until readyAt, then finalStatus.
+static struct
+{
+    Clock::time_point readyAt;
+    ASI_EXPOSURE_STATUS finalStatus { ASI_EXP_SUCCESS };
+    int errors { 0 };
+    int polls { 0 };
+} mock;
+
+ASI_ERROR_CODE ASIGetExpStatus(int, ASI_EXPOSURE_STATUS *pExpStatus)
+{
+    mock.polls++;
+    if (mock.errors > 0)
+    {
+        mock.errors--;
+        return ASI_ERROR_TIMEOUT;
+    }
+
+    *pExpStatus = Clock::now() >= mock.readyAt ? mock.finalStatus : ASI_EXP_WORKING;
+    return ASI_SUCCESS;
+}
+
+static void startMockExposure(Clock::time_point start, double duration, double readout,
+                              ASI_EXPOSURE_STATUS finalStatus = ASI_EXP_SUCCESS)
+{
+    mock.readyAt = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(duration + readout));
+    mock.finalStatus = finalStatus;
+    mock.errors = 0;
+    mock.polls = 0;
+}
+
+static double msSince(Clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+TEST(ReadoutModel, PredictsShortestRecentOverheadPerMode)
+{
+    ReadoutModel model(3);
+    ReadoutModel::Mode full { 4144, 2822, 1, ASI_IMG_RAW16 };
+    ReadoutModel::Mode roi { 640, 480, 1, ASI_IMG_RAW8 };
+
+    EXPECT_EQ(model.predict(full), 0);
+
+    model.addSample(full, 0.120);
+    model.addSample(full, 0.100);
+    model.addSample(full, 0.110);
+    model.addSample(roi, 0.004);
+
+    EXPECT_DOUBLE_EQ(model.predict(full), 0.100);
+    EXPECT_DOUBLE_EQ(model.predict(roi), 0.004);
+
+    // Oldest samples fall out of the window
+    model.addSample(full, 0.130);
+    model.addSample(full, 0.140);
+    EXPECT_EQ(model.samples(full), 3u);
+    EXPECT_DOUBLE_EQ(model.predict(full), 0.110);
+
+    model.clear();
+    EXPECT_EQ(model.samples(roi), 0u);
+}
+
+TEST(WaitForExposure, CompletesShortExposureWithoutModel)
+{
+    std::atomic_bool quit { false };
+    ASI_EXPOSURE_STATUS status;
+    double overhead = 0;
+
+    auto start = Clock::now();
+    startMockExposure(start, 0.010, 0.015);
+
+    ASI_ERROR_CODE ret = waitForExposure(0, start, 0.010, 0, quit, nullptr, status, overhead);
+
+    EXPECT_EQ(ret, ASI_SUCCESS);
+    EXPECT_EQ(status, ASI_EXP_SUCCESS);
+    EXPECT_GE(Clock::now(), mock.readyAt);
+    EXPECT_LT(msSince(mock.readyAt), 5.0);
+    EXPECT_NEAR(overhead, 0.015, 0.005);
+}
+
+TEST(WaitForExposure, SleepsThroughPredictedReadout)
+{
+    std::atomic_bool quit { false };
+    ASI_EXPOSURE_STATUS status;
+    double overhead = 0;
+
+    auto start = Clock::now();
+    startMockExposure(start, 0.020, 0.030);
+
+    ASI_ERROR_CODE ret = waitForExposure(0, start, 0.020, 0.030, quit, nullptr, status, overhead);
+
+    EXPECT_EQ(ret, ASI_SUCCESS);
+    EXPECT_EQ(status, ASI_EXP_SUCCESS);
+    EXPECT_LT(msSince(mock.readyAt), 3.0);
+    // Only the short window before the predicted completion is polled
+    EXPECT_LT(mock.polls, 25);
+}
+
+TEST(WaitForExposure, ShrinksOverestimatedReadout)
+{
+    std::atomic_bool quit { false };
+    ASI_EXPOSURE_STATUS status;
+    double overhead = 0;
+
+    auto start = Clock::now();
+    startMockExposure(start, 0.010, 0.005);
+
+    waitForExposure(0, start, 0.010, 0.050, quit, nullptr, status, overhead);
+
+    EXPECT_EQ(status, ASI_EXP_SUCCESS);
+    EXPECT_LT(overhead, 0.050);
+}
+
+TEST(WaitForExposure, ReportsCountdownForLongExposures)
+{
+    std::atomic_bool quit { false };
+    ASI_EXPOSURE_STATUS status;
+    double overhead = 0;
+    std::vector<double> countdown;
+
+    auto start = Clock::now();
+    startMockExposure(start, 2.0, 0.010);
+
+    waitForExposure(0, start, 2.0, 0, quit, [&](double left)
+    {
+        countdown.push_back(left);
+    }, status, overhead);
+
+    EXPECT_EQ(status, ASI_EXP_SUCCESS);
+    ASSERT_FALSE(countdown.empty());
+    EXPECT_DOUBLE_EQ(countdown.front(), 2.0);
+}
+
+TEST(WaitForExposure, ReturnsFailedStatus)
+{
+    std::atomic_bool quit { false };
+    ASI_EXPOSURE_STATUS status;
+    double overhead = 0;
+
+    auto start = Clock::now();
+    startMockExposure(start, 0.005, 0.001, ASI_EXP_FAILED);
+
+    ASI_ERROR_CODE ret = waitForExposure(0, start, 0.005, 0, quit, nullptr, status, overhead);
+
+    EXPECT_EQ(ret, ASI_SUCCESS);
+    EXPECT_EQ(status, ASI_EXP_FAILED);
+}
+
+TEST(WaitForExposure, RetriesTransientErrors)
+{
+    std::atomic_bool quit { false };
+    ASI_EXPOSURE_STATUS status;
+    double overhead = 0;
+
+    auto start = Clock::now();
+    startMockExposure(start, 0.005, 0.001);
+    mock.errors = 3;
+
+    EXPECT_EQ(waitForExposure(0, start, 0.005, 0, quit, nullptr, status, overhead), ASI_SUCCESS);
+    EXPECT_EQ(status, ASI_EXP_SUCCESS);
+
+    start = Clock::now();
+    startMockExposure(start, 0.005, 0.001);
+    mock.errors = 100;
+
+    EXPECT_EQ(waitForExposure(0, start, 0.005, 0, quit, nullptr, status, overhead), ASI_ERROR_TIMEOUT);
+}
+
+TEST(WaitForExposure, StopsWhenAborted)
+{
+    std::atomic_bool quit { false };
+    ASI_EXPOSURE_STATUS status;
+    double overhead = 0;
+
+    auto start = Clock::now();
+    startMockExposure(start, 10.0, 0);
+
+    std::thread abort([&quit]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        quit = true;
+    });
+
+    EXPECT_EQ(waitForExposure(0, start, 10.0, 0, quit, nullptr, status, overhead), ASI_SUCCESS);
+    abort.join();
+
+    EXPECT_LT(msSince(start), 2000.0);
+    EXPECT_EQ(status, ASI_EXP_WORKING);
+}
@@ -13,6 +13,7 @@
 #include "DsiException.h"
 #include "Util.h"
 
+#include <chrono>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
@@ -29,6 +30,13 @@
 #define MILLISEC 2
 #endif
 
+/* Bulk transfers kept queued during image readout and the bytes each one reads. */
+#define FIELD_TRANSFERS  4
+#define FIELD_CHUNK_SIZE 0x20000
+
+/* Timeout of libusb_handle_events while waiting for image data, in ms. */
+#define FIELD_EVENT_TIMEOUT 100
+
 static unsigned int last_time;
 
 static unsigned int get_sysclock_ms()
@@ -94,6 +102,128 @@ static void log_command_info(bool iswrite, const char *prefix, unsigned int leng
     }
 }
 
+namespace
+{
+/* Rows of one field read by a single bulk transfer. */
+struct FieldChunk
+{
+    bool odd;
+    unsigned int first;
+    unsigned int rows;
+};
+
+/* State of one readout, owned by readFields.  Only the transfers of this
+ * readout carry a pointer to it, and readFields reaps all of them before
+ * returning, so it is touched by nothing but their callbacks.  Those run inside
+ * readFields' own libusb_handle_events calls; other devices' callbacks may run
+ * there as well on the default context, but never see this state.
+ */
+struct FieldRead
+{
+    const DSI::FieldLayout *layout;
+    unsigned char *field[2];
+    uint16_t *frame;
+    std::vector<FieldChunk> chunks;
+    size_t submitted;
+    size_t received[2];
+    int inFlight;
+    int rc;
+};
+
+struct FieldSlot
+{
+    FieldRead *read;
+    size_t chunk;
+};
+}
+
+/* Splits a field into chunks of whole rows.  Every chunk but the last of a
+ * field must be a multiple of the bulk packet size, otherwise the device
+ * overruns the transfer.
+ */
+static void split_field(std::vector<FieldChunk> &chunks, bool odd, unsigned int rows, unsigned int row_bytes)
+{
+    /* smallest number of rows filling whole packets */
+    unsigned int unit = 512;
+    while (unit > 1 && row_bytes * (unit / 2) % 512 == 0)
+        unit /= 2;
+
+    unsigned int step = FIELD_CHUNK_SIZE / row_bytes / unit * unit;
+    if (step == 0)
+        step = unit;
+
+    for (unsigned int first = 0; first < rows; first += step)
+        chunks.push_back({ odd, first, rows - first < step ? rows - first : step });
+}
+
+static int submit_chunk(struct libusb_transfer *transfer, FieldSlot *slot, size_t index)
+{
+    FieldRead *read         = slot->read;
+    const FieldChunk &chunk = read->chunks[index];
+    unsigned int row_bytes  = read->layout->rowBytes();
+
+    transfer->buffer = read->field[chunk.odd] + (size_t)chunk.first * row_bytes;
+    transfer->length = chunk.rows * row_bytes;
+    slot->chunk      = index;
+
+    int rc = libusb_submit_transfer(transfer);
+    if (rc == 0)
+    {
+        read->submitted++;
+        read->inFlight++;
+    }
+    return rc;
+}
+
+static void LIBUSB_CALL field_read_callback(struct libusb_transfer *transfer)
+{
+    FieldSlot *slot = (FieldSlot *)transfer->user_data;
+    FieldRead *read = slot->read;
+    read->inFlight--;
+
+    if (transfer->status == LIBUSB_TRANSFER_CANCELLED)
+        return;
+
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED)
+    {
+        if (read->rc == 0)
+            read->rc = transfer->status == LIBUSB_TRANSFER_NO_DEVICE ? LIBUSB_ERROR_NO_DEVICE : LIBUSB_ERROR_IO;
+        return;
+    }
+
+    FieldChunk chunk = read->chunks[slot->chunk];
+    bool last        = slot->chunk + 1 == read->chunks.size() || read->chunks[slot->chunk + 1].odd != chunk.odd;
+    read->received[chunk.odd] += transfer->actual_length;
+
+    // Chunks are queued at fixed offsets, only the end of a field may come up short
+    if (transfer->actual_length < transfer->length)
+    {
+        if (!last)
+        {
+            if (read->rc == 0)
+                read->rc = LIBUSB_ERROR_OVERFLOW;
+            return;
+        }
+        chunk.rows = transfer->actual_length / read->layout->rowBytes();
+    }
+
+    if (read->rc != 0)
+        return;
+
+    // Keep the queue full before spending time on the conversion
+    if (read->submitted < read->chunks.size())
+    {
+        int rc = submit_chunk(transfer, slot, read->submitted);
+        if (rc < 0)
+        {
+            read->rc = rc;
+            return;
+        }
+    }
+
+    DSI::mergeFieldRows(*read->layout, chunk.odd, read->field[chunk.odd], chunk.first, chunk.rows, read->frame);
+}
+
 /**
  * Initialize a generic (base class) DSI device.
  *
@@ -111,7 +241,7 @@ DSI::Device::Device(const char *devname) : readout_mode(ReadoutMode::DUAL), usb_
 {
     command_sequence_number = 0;
     eeprom_length           = -1;
-    log_commands            = true;
+    log_commands            = false;
     test_pattern            = true;
     vdd_on                  = false; /* DSI III default due to amp glow issue (gs)   */
     exposure_time           = 10;
@@ -125,8 +255,6 @@ DSI::Device::Device(const char *devname) : readout_mode(ReadoutMode::DUAL), usb_
     image_offset_x          = 0;
     image_offset_y          = 0;
 
-    framebuffer = (unsigned char *)0;
-
     binning2x2 = false;
     ccd_temp   = -128.5;
 
@@ -135,12 +263,14 @@ DSI::Device::Device(const char *devname) : readout_mode(ReadoutMode::DUAL), usb_
 
 DSI::Device::~Device()
 {
-    std::cerr << "in DSI::Device::~Device" << std::endl;
+    if (log_commands)
+        std::cerr << "in DSI::Device::~Device" << std::endl;
     int result;
     if (handle != 0)
     {
         result = libusb_release_interface(handle, 0);
-        std::cerr << "usb_release_interface(handle, 0) -> " << result << std::endl;
+        if (log_commands)
+            std::cerr << "usb_release_interface(handle, 0) -> " << result << std::endl;
         libusb_close(handle);
     }
     handle                  = 0;
@@ -742,7 +872,8 @@ int DSI::Device::startExposure(int howlong, int gain, int offs)
     }
     else // This is what the DSI III monkey found while sniffing USB (gs)
     {
-        std::cerr << "Epsosure time: " << exposure_time << ", Gain: " << gain << ", Offset: " << offs << std::endl;
+        if (log_commands)
+            std::cerr << "Epsosure time: " << exposure_time << ", Gain: " << gain << ", Offset: " << offs << std::endl;
 
         // first, set gain and offset
         command(DeviceCommand::SET_GAIN, gain);
@@ -810,8 +941,6 @@ int DSI::Device::startExposure(int howlong, int gain, int offs)
 
 unsigned char *DSI::Device::downloadImage()
 {
-    int status = 0;
-    int transferred = 0;
     int interlaced = 0;
     int rawtemp = 0;
     unsigned int t_read_width = 0;
@@ -855,83 +984,28 @@ unsigned char *DSI::Device::downloadImage()
     t_read_height = t_read_height_even + t_read_height_odd;
     t_read_bpp    = read_bpp;
 
-    unsigned int odd_size  = t_read_bpp * t_read_width * t_read_height_odd;
-    unsigned int even_size = t_read_bpp * t_read_width * t_read_height_even;
-    unsigned int all_size  = t_read_bpp * t_read_width * t_read_height;
-    unsigned char *odd_data = new unsigned char[odd_size];
-    unsigned char *even_data = nullptr;
-
-    if (interlaced)
-        even_data = new unsigned char[even_size];
-
-    framebuffer = new unsigned char[all_size];
-
-    if (interlaced)
-    {
-        /* XXX: There has to be  a way to calculate a more optimal readout
-               time here. */
-        status = libusb_bulk_transfer(handle, 0x86, even_data, even_size, &transferred, 60000 * MILLISEC);
-        if (log_commands)
-        {
-            log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)even_data, 0);
-
-            std::cerr << std::dec << "read even data, status = (" << status << ") " << (status > 0 ? "" : strerror(-status))
-                      << std::endl
-                      << "    requested " << even_size << " bytes " << t_read_width << " x " << t_read_height_even
-                      << " (even pixels)" << std::endl
-                      << "Transferred: " << transferred << " bytes" << std::endl;
-        }
-
-        if (status != 0)
-        {
-            std::stringstream ss;
-            ss << std::dec << "read even data, status = (" << status << ") " << strerror(-status);
-            throw device_read_error(ss.str());
-        }
+    FieldLayout layout = { t_read_width,     interlaced ? t_read_height_even : 0,
+                           t_read_height_odd, t_image_width,
+                           t_image_height,   t_image_offset_x,
+                           t_image_offset_y, interlaced != 0 };
 
-        status = libusb_bulk_transfer(handle, 0x86, odd_data, odd_size, &transferred, 60000 * MILLISEC);
-        if (log_commands)
-        {
-            log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)odd_data, 0);
-
-            std::cerr << std::dec << "read odd data, status = (" << status << ") " << (status > 0 ? "" : strerror(-status))
-                      << std::endl
-                      << "    requested " << odd_size << " bytes " << t_read_width << " x " << t_read_height_odd
-                      << " (odd pixels)" << std::endl
-                      << "Transferred: " << transferred << " bytes" << std::endl;
-        }
+    if (log_commands)
+        std::cerr << "t_image_height  =" << t_image_height << std::endl
+                  << "t_image_width   =" << t_image_width << std::endl
+                  << "t_image_offset_x=" << t_image_offset_x << std::endl
+                  << "t_image_offset_y=" << t_image_offset_y << std::endl
+                  << "t_read_width    =" << t_read_width << std::endl
+                  << "t_read_height   =" << t_read_height << std::endl
+                  << "t_read_bpp      =" << t_read_bpp << std::endl;
 
-        if (status != 0)
-        {
-            std::stringstream ss;
-            ss << std::dec << "read odd data, status = (" << status << ") " << strerror(-status);
-            throw device_read_error(ss.str());
-        }
-    }
-    else // progressive mode for DSI III (gs)
+    if (!interlaced) // progressive mode for DSI III (gs)
     {
         if ((!vdd_on) && (exposure_time >= VDD_TRH))
             command(DeviceCommand::SET_VDD_MODE, VddMode::ON.value());
-
-        status = libusb_bulk_transfer(handle, 0x86, odd_data, odd_size, &transferred, 60000 * MILLISEC);
-        if (log_commands)
-        {
-            log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)odd_data, 0);
-
-            std::cerr << std::dec << "read progressive data, status = (" << status << ") " << std::endl
-                      << "    requested " << odd_size << " bytes " << t_read_width << " x " << t_read_height_odd
-                      << " (pixels)" << std::endl
-                      << "Transferred: " << transferred << " bytes" << std::endl;
-        }
-
-        if (status != 0)
-        {
-            std::stringstream ss;
-            ss << std::dec << "read progressive data, status = (" << status << ") ";
-            throw device_read_error(ss.str());
-        }
     }
 
+    readFields(layout);
+
     /* Update temperature for devices with sensor (gs) */
 
     if (has_tempsensor)
@@ -945,85 +1019,123 @@ unsigned char *DSI::Device::downloadImage()
     /* disable 2x2 binning after downloading image (gs) */
     disable2x2Binning();
 
-    unsigned char msb = 0, lsb = 0, is_odd = 0;
-    unsigned int x_ptr = 0, line_start = 0, y_ptr = 0, read_ptr = 0, write_ptr = 0;
-    char *even = (char *)even_data;
-    char *odd  = (char *)odd_data;
-
-    if (log_commands)
-        std::cerr << "t_image_height  =" << t_image_height << std::endl
-                  << "t_image_width   =" << t_image_width << std::endl
-                  << "t_image_offset_x=" << t_image_offset_x << std::endl
-                  << "t_image_offset_y=" << t_image_offset_y << std::endl
-                  << "t_read_width    =" << t_read_width << std::endl
-                  << "t_read_height   =" << t_read_height << std::endl
-                  << "t_read_bpp      =" << t_read_bpp << std::endl;
+    return (unsigned char *)framebuffer.data();
+}
 
-    if (interlaced)
+void DSI::Device::readFields(const FieldLayout &layout)
+{
+    unsigned int row_bytes = layout.rowBytes();
+    size_t even_size       = (size_t)row_bytes * layout.rows_even;
+    size_t odd_size        = (size_t)row_bytes * layout.rows_odd;
+
+    even_data.resize(even_size);
+    odd_data.resize(odd_size);
+    framebuffer.resize((size_t)layout.image_width * layout.image_height);
+
+    FieldRead read;
+    read.layout      = &layout;
+    read.field[0]    = even_data.data();
+    read.field[1]    = odd_data.data();
+    read.frame       = framebuffer.data();
+    read.submitted   = 0;
+    read.received[0] = 0;
+    read.received[1] = 0;
+    read.inFlight    = 0;
+    read.rc          = 0;
+
+    // Both fields are queued at once, the camera sends the odd one right after the even one
+    if (layout.interlaced)
+        split_field(read.chunks, false, layout.rows_even, row_bytes);
+    split_field(read.chunks, true, layout.rows_odd, row_bytes);
+
+    FieldSlot slots[FIELD_TRANSFERS];
+    struct libusb_transfer *transfers[FIELD_TRANSFERS] = {};
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < FIELD_TRANSFERS && read.submitted < read.chunks.size(); i++)
     {
-        for (write_ptr = y_ptr = 0; y_ptr < t_image_height; y_ptr++)
+        transfers[i] = libusb_alloc_transfer(0);
+        if (transfers[i] == nullptr)
         {
-            line_start = t_read_width * ((y_ptr + t_image_offset_y) / 2);
-            is_odd     = (y_ptr + t_image_offset_y) % 2;
-
-            std::cerr << "starting image row " << y_ptr << ", write_ptr=" << write_ptr << ", line_start=" << line_start
-                      << ", is_odd=" << (is_odd == 0 ? 0 : 1) << ", read_ptr=" << (line_start + t_image_offset_x) * 2
-                      << std::endl;
+            read.rc = LIBUSB_ERROR_NO_MEM;
+            break;
+        }
 
-            for (x_ptr = 0; x_ptr < t_image_width; x_ptr++)
-            {
-                read_ptr = (line_start + x_ptr + t_image_offset_x) * 2;
-                if (is_odd == 1) // odd line
-                {
-                    msb = odd[read_ptr];
-                    lsb = odd[read_ptr + 1];
-                }
-                else
-                {
-                    // even line
-                    msb = even[read_ptr];
-                    lsb = even[read_ptr + 1];
-                }
-                framebuffer[write_ptr++] = msb;
-                framebuffer[write_ptr++] = lsb;
-            }
+        slots[i] = { &read, 0 };
+        // No per-transfer timeout, queued transfers may wait for the whole CCD readout before data arrives
+        libusb_fill_bulk_transfer(transfers[i], handle, 0x86, nullptr, 0, field_read_callback, &slots[i], 0);
+        int rc = submit_chunk(transfers[i], &slots[i], read.submitted);
+        if (rc < 0)
+        {
+            read.rc = rc;
+            break;
         }
     }
-    else
+
+    bool cancelling = false;
+    size_t last     = 0;
+    auto progress   = start;
+    while (read.inFlight > 0)
     {
-        for (write_ptr = y_ptr = 0; y_ptr < t_image_height; y_ptr++)
+        size_t received = read.received[0] + read.received[1];
+        if (received != last)
         {
-            line_start = t_read_width * (y_ptr + t_image_offset_y);
-
-            // std::cerr << "starting image row " << y_ptr
-            //      << ", write_ptr=" << write_ptr
-            //      << ", line_start=" << line_start
-            //      << ", read_ptr=" << (line_start+t_image_offset_x)*2
-            //      << std::endl;
-            for (x_ptr = 0; x_ptr < t_image_width; x_ptr++)
-            {
-                read_ptr = (line_start + x_ptr + t_image_offset_x) * 2;
-
-                msb = odd[read_ptr];
-                lsb = odd[read_ptr + 1];
+            last     = received;
+            progress = std::chrono::steady_clock::now();
+        }
 
-                framebuffer[write_ptr++] = msb;
-                framebuffer[write_ptr++] = lsb;
+        if (!cancelling)
+        {
+            if (read.rc == 0 &&
+                std::chrono::steady_clock::now() - progress > std::chrono::milliseconds(60000 * MILLISEC))
+                read.rc = LIBUSB_ERROR_TIMEOUT;
+            if (read.rc != 0)
+            {
+                // Only transfers still owned by libusb are cancelled, the others return NOT_FOUND
+                for (int i = 0; i < FIELD_TRANSFERS; i++)
+                    if (transfers[i] != nullptr)
+                        libusb_cancel_transfer(transfers[i]);
+                cancelling = true;
             }
         }
+
+        struct timeval tv = { 0, FIELD_EVENT_TIMEOUT * 1000 };
+        libusb_handle_events_timeout_completed(nullptr, &tv, nullptr);
     }
 
+    for (int i = 0; i < FIELD_TRANSFERS; i++)
+        if (transfers[i] != nullptr)
+            libusb_free_transfer(transfers[i]);
+
     if (log_commands)
-        std::cerr << "write_ptr=" << write_ptr << std::endl;
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
 
-    delete[] odd_data;
+        if (layout.interlaced)
+        {
+            log_command_info(false, "r 86", read.received[0], (char *)even_data.data(), 0);
+            std::cerr << std::dec << "read even data, requested " << even_size << " bytes " << layout.read_width
+                      << " x " << layout.rows_even << " (even pixels)" << std::endl
+                      << "Transferred: " << read.received[0] << " bytes" << std::endl;
+        }
 
-    if (interlaced)
-        delete[] even_data;
+        log_command_info(false, "r 86", read.received[1], (char *)odd_data.data(), 0);
+        std::cerr << std::dec << "read " << (layout.interlaced ? "odd" : "progressive") << " data, requested "
+                  << odd_size << " bytes " << layout.read_width << " x " << layout.rows_odd << " ("
+                  << (layout.interlaced ? "odd pixels" : "pixels") << ")" << std::endl
+                  << "Transferred: " << read.received[1] << " bytes" << std::endl
+                  << read.chunks.size() << " transfers in " << elapsed.count() << " ms, status = (" << read.rc
+                  << ") " << (read.rc < 0 ? libusb_error_name(read.rc) : "OK") << std::endl;
+    }
 
-    return framebuffer;
+    if (read.rc != 0)
+    {
+        std::stringstream ss;
+        ss << std::dec << "read image data, status = (" << read.rc << ") " << libusb_error_name(read.rc);
+        throw device_read_error(ss.str());
+    }
 
-    throw dsi_exception("unsupported image command");
+    checkFieldsRead(layout, read.received[0], read.received[1]);
 }
 
 /* ask camera for remaining exposure time for long exposures (gs) */
@@ -1053,7 +1165,7 @@ int DSI::Device::ExposureInProgress()
 
 unsigned char *DSI::Device::ccdFramebuffer()
 {
-    return (framebuffer);
+    return framebuffer.empty() ? nullptr : (unsigned char *)framebuffer.data();
 }
 
 void DSI::Device::set1x1Binning()
@@ -1092,14 +1204,11 @@ void DSI::Device::disable2x2Binning()
 
 unsigned char *DSI::Device::getImage(DeviceCommand __command, int howlong)
 {
-    int transferred = 0;
-
     if (((__command == DeviceCommand::TRIGGER)) || (__command == DeviceCommand::TEST_PATTERN))
     {
         // Monkey code.  Monkey see (SniffUSB), monkey do).  Some part of this
         // is required because w/o it, I get segfaults on the second attempt
         // to run the code.
-        int status = 0;
         int interlaced = 0;
         int rawtemp = 0;
 
@@ -1303,16 +1412,10 @@ unsigned char *DSI::Device::getImage(DeviceCommand __command, int howlong)
             t_image_offset_y = 0;
         }
 
-        unsigned int odd_size  = t_read_bpp * t_read_width * t_read_height_odd;
-        unsigned int even_size = t_read_bpp * t_read_width * t_read_height_even;
-        unsigned int all_size  = t_read_bpp * t_read_width * t_read_height;
-        unsigned char *odd_data = new unsigned char[odd_size];
-        unsigned char *even_data = nullptr;
-
-        if (interlaced)
-            even_data = new unsigned char[even_size];
-
-        framebuffer = new unsigned char[all_size];
+        FieldLayout layout = { t_read_width,     interlaced ? t_read_height_even : 0,
+                               t_read_height_odd, t_image_width,
+                               t_image_height,   t_image_offset_x,
+                               t_image_offset_y, interlaced != 0 };
 
         /* The Meade driver seems to only issue a GET_EXP_TIME_COUNT command
          * when the exposure is over about 2 seconds (count = 20,000).  From
@@ -1332,62 +1435,6 @@ unsigned char *DSI::Device::getImage(DeviceCommand __command, int howlong)
         if (last_time == 0)
             last_time = get_sysclock_ms();
 
-        if (interlaced)
-        {
-            /* XXX: There has to be  a way to calculate a more optimal readout
-               time here. */
-            status = libusb_bulk_transfer(handle, 0x86, even_data, even_size, &transferred, 60000 * MILLISEC);
-            if (log_commands)
-            {
-                log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)even_data, 0);
-
-                std::cerr << std::dec << "read even data, status = (" << status << ") " << (status > 0 ? "" : strerror(-status))
-                          << std::endl
-                          << "    requested " << even_size << " bytes " << t_read_width << " x " << t_read_height_even
-                          << " (even pixels)" << std::endl;
-            }
-
-            if (status < 0)
-            {
-                std::stringstream ss;
-                ss << std::dec << "read even data, status = (" << status << ") " << strerror(-status);
-                throw device_read_error(ss.str());
-            }
-        }
-
-        status = libusb_bulk_transfer(handle, 0x86, odd_data, odd_size, &transferred, 60000 * MILLISEC);
-        if (log_commands)
-        {
-            log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)even_data, 0);
-
-            std::cerr << std::dec << "read odd data, status = (" << status << ") " << (status > 0 ? "" : strerror(-status))
-                      << std::endl
-                      << "    requested " << odd_size << " bytes " << t_read_width << " x " << t_read_height_odd
-                      << " (odd pixels)" << std::endl;
-        }
-
-        if (status < 0)
-        {
-            std::stringstream ss;
-            ss << std::dec << "read odd data, status = (" << status << ") " << strerror(-status);
-            throw device_read_error(ss.str());
-        }
-
-        if (has_tempsensor)
-        {
-            rawtemp  = command(DeviceCommand::GET_TEMP);
-            ccd_temp = floor((float)rawtemp / 25.6) / 10.0;
-        }
-
-        command(DeviceCommand::GET_EXP_MODE);
-
-        disable2x2Binning();
-
-        unsigned char msb = 0, lsb = 0, is_odd = 0;
-        unsigned int x_ptr = 0, line_start = 0, y_ptr = 0, read_ptr = 0, write_ptr = 0;
-        char *even = (char *)even_data;
-        char *odd  = (char *)odd_data;
-
         if (log_commands)
             std::cerr << "t_image_height  =" << t_image_height << std::endl
                       << "t_image_width   =" << t_image_width << std::endl
@@ -1397,67 +1444,19 @@ unsigned char *DSI::Device::getImage(DeviceCommand __command, int howlong)
                       << "t_read_height   =" << t_read_height << std::endl
                       << "t_read_bpp      =" << t_read_bpp << std::endl;
 
-        if (interlaced)
-        {
-            for (write_ptr = y_ptr = 0; y_ptr < t_image_height; y_ptr++)
-            {
-                line_start = t_read_width * ((y_ptr + t_image_offset_y) / 2);
-                is_odd     = (y_ptr + t_image_offset_y) % 2;
+        readFields(layout);
 
-                std::cerr << "starting image row " << y_ptr << ", write_ptr=" << write_ptr << ", line_start=" << line_start
-                          << ", is_odd=" << (is_odd == 0 ? 0 : 1) << ", read_ptr=" << (line_start + t_image_offset_x) * 2
-                          << std::endl;
-                for (x_ptr = 0; x_ptr < t_image_width; x_ptr++)
-                {
-                    read_ptr = (line_start + x_ptr + t_image_offset_x) * 2;
-                    if (is_odd == 1) // odd line
-                    {
-                        msb = odd[read_ptr];
-                        lsb = odd[read_ptr + 1];
-                    }
-                    else
-                    {
-                        // even line
-                        msb = even[read_ptr];
-                        lsb = even[read_ptr + 1];
-                    }
-                    framebuffer[write_ptr++] = msb;
-                    framebuffer[write_ptr++] = lsb;
-                }
-            }
-        }
-        else
+        if (has_tempsensor)
         {
-            for (write_ptr = y_ptr = 0; y_ptr < t_image_height; y_ptr++)
-            {
-                line_start = t_read_width * (y_ptr + t_image_offset_y);
-
-                //std::cerr << "starting image row " << y_ptr
-                //     << ", write_ptr=" << write_ptr
-                //     << ", line_start=" << line_start
-                //     << ", read_ptr=" << (line_start+t_image_offset_x)*2 << std::endl;
-                for (x_ptr = 0; x_ptr < t_image_width; x_ptr++)
-                {
-                    read_ptr = (line_start + x_ptr + t_image_offset_x) * 2;
-
-                    msb = odd[read_ptr];
-                    lsb = odd[read_ptr + 1];
-
-                    framebuffer[write_ptr++] = msb;
-                    framebuffer[write_ptr++] = lsb;
-                }
-            }
+            rawtemp  = command(DeviceCommand::GET_TEMP);
+            ccd_temp = floor((float)rawtemp / 25.6) / 10.0;
         }
 
-        if (log_commands)
-            std::cerr << "write_ptr=" << write_ptr << std::endl;
-
-        delete[] odd_data;
+        command(DeviceCommand::GET_EXP_MODE);
 
-        if (interlaced)
-            delete[] even_data;
+        disable2x2Binning();
 
-        return framebuffer;
+        return (unsigned char *)framebuffer.data();
     }
 
     throw dsi_exception("unsupported image command");
@@ -6,11 +6,13 @@
 
 #pragma once
 
+#include "DsiField.h"
 #include "DsiTypes.h"
 
 #include <libusb-1.0/libusb.h>
 
 #include <string>
+#include <vector>
 
 #ifndef LONGEXP
 #define LONGEXP 20000
@@ -30,8 +32,12 @@ class Device
     std::string camera_name;
 
   protected:
-    /* image frame buffer (gs) */
-    unsigned char *framebuffer;
+    /* image frame buffer, host order pixels of the last image (gs) */
+    std::vector<uint16_t> framebuffer;
+
+    /* Landing buffers of the even and odd field, kept between images. */
+    std::vector<unsigned char> even_data;
+    std::vector<unsigned char> odd_data;
 
     /* These are chip-specific sizes required to parameterize the image
          * retrieval.
@@ -177,6 +183,11 @@ class Device
 
     void sendRegister(AdRegister adr, unsigned int arg);
 
+    /* Reads the fields of an image with bulk transfers queued back to back
+     * and merges each piece into framebuffer as soon as it has arrived.
+     */
+    void readFields(const FieldLayout &layout);
+
   public:
     Device(const char *devname = 0);
     virtual ~Device();
@@ -212,6 +223,7 @@ class Device
     virtual unsigned char *downloadImage();
     virtual int startExposure(int howlong, int gain = 0, int offs = 0x0ff);
     virtual int ExposureInProgress();
+    /* Host order 16 bit pixels of the last image, owned by the device. */
     virtual unsigned char *ccdFramebuffer();
 
     virtual void set1x1Binning();
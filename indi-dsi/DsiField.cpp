@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2026, INDI Developers
+ *
+ */
+
+#include "DsiField.h"
+#include "DsiException.h"
+
+#include <sstream>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* Big endian pixels to host order. */
+static void swapRow(uint16_t *dst, const unsigned char *src, unsigned int width)
+{
+    unsigned int x = 0;
+
+#if defined(__SSE2__)
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + 2 * x));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + 2 * x + 16));
+        a         = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+        b         = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128((__m128i *)(dst + x), a);
+        _mm_storeu_si128((__m128i *)(dst + x + 8), b);
+    }
+#elif defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16_t a = vrev16q_u8(vld1q_u8(src + 2 * x));
+        uint8x16_t b = vrev16q_u8(vld1q_u8(src + 2 * x + 16));
+        vst1q_u16(dst + x, vreinterpretq_u16_u8(a));
+        vst1q_u16(dst + x + 8, vreinterpretq_u16_u8(b));
+    }
+#endif
+
+    for (; x < width; x++)
+        dst[x] = (uint16_t)((src[2 * x] << 8) | src[2 * x + 1]);
+}
+
+void DSI::mergeFieldRows(const FieldLayout &layout, bool odd, const unsigned char *field, unsigned int first,
+                         unsigned int count, uint16_t *frame)
+{
+    const unsigned int pitch = layout.rowBytes();
+    const unsigned char *src = field + 2 * layout.offset_x;
+
+    for (unsigned int r = first; r < first + count; r++)
+    {
+        /* Position of the raw row among all rows read out. */
+        unsigned int row = layout.interlaced ? 2 * r + (odd ? 1 : 0) : r;
+        if (row < layout.offset_y)
+            continue;
+
+        unsigned int y = row - layout.offset_y;
+        if (y >= layout.image_height)
+            continue;
+
+        swapRow(frame + (unsigned long)y * layout.image_width, src + (unsigned long)r * pitch, layout.image_width);
+    }
+}
+
+void DSI::mergeFields(const FieldLayout &layout, const unsigned char *even, const unsigned char *odd, uint16_t *frame)
+{
+    if (layout.interlaced && even != nullptr)
+        mergeFieldRows(layout, false, even, 0, layout.rows_even, frame);
+    mergeFieldRows(layout, true, odd, 0, layout.rows_odd, frame);
+}
+
+void DSI::checkFieldsRead(const FieldLayout &layout, size_t even, size_t odd)
+{
+    size_t even_size = layout.interlaced ? (size_t)layout.rowBytes() * layout.rows_even : 0;
+    size_t odd_size  = (size_t)layout.rowBytes() * layout.rows_odd;
+
+    if ((layout.interlaced && even < even_size) || odd < odd_size)
+    {
+        std::stringstream ss;
+        ss << std::dec << "short image read, received " << even + odd << " of " << even_size + odd_size << " bytes";
+        throw device_read_error(ss.str());
+    }
+}
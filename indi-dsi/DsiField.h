@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2026, INDI Developers
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace DSI
+{
+/* Geometry of one readout.  The camera sends the even field (absent in
+ * progressive mode) followed by the odd field, each raw row is read_width
+ * big endian 16 bit pixels.  The image is the image_width x image_height
+ * window at (offset_x, offset_y) of the interleaved rows.
+ */
+struct FieldLayout
+{
+    unsigned int read_width;
+    unsigned int rows_even;
+    unsigned int rows_odd;
+    unsigned int image_width;
+    unsigned int image_height;
+    unsigned int offset_x;
+    unsigned int offset_y;
+    bool interlaced;
+
+    /* Bytes of one raw row. */
+    unsigned int rowBytes() const { return 2 * read_width; }
+};
+
+/* Converts raw rows [first, first + count) of a field into host order pixels
+ * of the image window in frame.  field points at row 0 of the field, rows
+ * falling outside the window are skipped.  In progressive mode all rows are
+ * in the odd field.  Rows may be converted in any order, so a field can be
+ * merged piecewise while the rest of it is still being read.
+ */
+void mergeFieldRows(const FieldLayout &layout, bool odd, const unsigned char *field, unsigned int first,
+                    unsigned int count, uint16_t *frame);
+
+/* Converts both fields of a readout, even may be null in progressive mode. */
+void mergeFields(const FieldLayout &layout, const unsigned char *even, const unsigned char *odd, uint16_t *frame);
+
+/* Throws device_read_error when a field came up short: a truncated readout
+ * would otherwise leave rows of the previous frame in the reused buffers.
+ * The even field is not read in progressive mode and is not checked then.
+ */
+void checkFieldsRead(const FieldLayout &layout, size_t even, size_t odd);
+};
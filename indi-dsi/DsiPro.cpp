@@ -30,8 +30,7 @@ void DsiPro::initImager(const char *devname)
      */
     for (int i = 0; i < 1; i++)
     {
-        unsigned char *foo = getImage(1);
-        delete[] foo;
+        getImage(1);
     }
 }
 
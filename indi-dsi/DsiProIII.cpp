@@ -32,8 +32,7 @@ void DsiProIII::initImager(const char *devname)
      */
     for (int i = 0; i < 1; i++)
     {
-        unsigned char *foo = getImage(1);
-        delete[] foo;
+        getImage(1);
     }
 }
 
@@ -23,9 +23,9 @@
 #include "config.h"
 #include "DsiDeviceFactory.h"
 
+#include <cstring>
 #include <iostream>
 #include <math.h>
-#include <arpa/inet.h>
 #include <unistd.h>
 
 std::unique_ptr<DSICCD> dsiCCD(new DSICCD());
@@ -65,6 +65,8 @@ bool DSICCD::Connect()
         return false;
     }
 
+    dsi->setDebug(isDebug());
+
     ccd = dsi->getCcdChipName();
     if (ccd == "ICX254AL")
     {
@@ -468,18 +470,23 @@ bool DSICCD::saveConfigItems(FILE *fp)
     return true;
 }
 
+/*******************************************************************************
+ * Forward the debug level to the device so its USB diagnostics follow it
+*******************************************************************************/
+
+void DSICCD::debugTriggered(bool enable)
+{
+    if (dsi)
+        dsi->setDebug(enable);
+}
+
 /*******************************************************************************
  * Download image from DSI
 *******************************************************************************/
 
 void DSICCD::grabImage()
 {
-    uint16_t *buf = nullptr;
-    int x = 0, y = 0;
-
-    std::unique_lock<std::mutex> guard(ccdBufferLock);
-    // Let's get a pointer to the frame buffer
-    uint8_t *image = PrimaryCCD.getFrameBuffer();
+    const uint8_t *buf = nullptr;
 
     // Get width and height
     int width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
@@ -487,24 +494,24 @@ void DSICCD::grabImage()
 
     try
     {
-        buf = (uint16_t *)dsi->ccdFramebuffer();
+        buf = dsi->ccdFramebuffer();
     }
     catch (...)
     {
         LOG_INFO("Image download failed!");
         return;
     }
-    guard.unlock();
 
-    for (y = 0; y < height; ++y)
+    if (buf == nullptr)
     {
-        for (x = 0; x < width; ++x)
-        {
-            ((uint16_t *)image)[x + width * y] = ntohs(buf[x + width * y]);
-        }
+        LOG_INFO("Image download failed!");
+        return;
     }
 
-    delete buf;
+    // The fields were already merged into host order pixels during the download
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
+    memcpy(PrimaryCCD.getFrameBuffer(), buf, width * height * sizeof(uint16_t));
+    guard.unlock();
 
     // Let INDI::CCD know we're done filling the image buffer
     ExposureComplete(&PrimaryCCD);
@@ -0,0 +1,207 @@
+/*
+ * Copyright © 2026, INDI Developers
+ *
+ * Feeds synthetic field data through the reassembly of the DSI driver and
+ * compares it with the byte by byte merge followed by ntohs it replaced.
+ */
+
+#include "DsiField.h"
+#include "DsiException.h"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+struct Camera
+{
+    const char *name;
+    DSI::FieldLayout layout;
+};
+
+/* Geometry as computed by DSI::Device::downloadImage, the test pattern is
+ * the only one whose rows are not a multiple of the packet size. */
+const Camera cameras[] = {
+    { "Pro", { 768, 253, 252, 508, 488, 23, 13, true } },
+    { "ProBinned", { 384, 126, 126, 254, 244, 11, 6, true } },
+    { "ProII", { 1024, 299, 298, 748, 577, 30, 13, true } },
+    { "ProIII", { 1536, 0, 1050, 1360, 1024, 30, 13, false } },
+    { "ProIIIBinned", { 768, 0, 525, 680, 512, 15, 6, false } },
+    { "TestPattern", { 540, 253, 252, 540, 505, 0, 0, true } },
+    { "OddWidth", { 256, 40, 39, 37, 75, 3, 1, true } },
+};
+
+std::vector<unsigned char> makeField(const DSI::FieldLayout &layout, unsigned int rows, unsigned int seed)
+{
+    std::vector<unsigned char> field(layout.rowBytes() * rows);
+    for (size_t i = 0; i < field.size(); i++)
+        field[i] = (unsigned char)((i + seed) * 2654435761u >> 17);
+    return field;
+}
+
+/* The reassembly of downloadImage before the fields were merged in place,
+ * followed by the conversion DSICCD::grabImage did. */
+std::vector<uint16_t> legacyMerge(const DSI::FieldLayout &l, const unsigned char *even_data,
+                                  const unsigned char *odd_data)
+{
+    std::vector<unsigned char> framebuffer(2 * l.read_width * (l.rows_even + l.rows_odd));
+    const char *even = (const char *)even_data;
+    const char *odd  = (const char *)odd_data;
+    unsigned char msb = 0, lsb = 0, is_odd = 0;
+    unsigned int x_ptr = 0, line_start = 0, y_ptr = 0, read_ptr = 0, write_ptr = 0;
+
+    if (l.interlaced)
+    {
+        for (write_ptr = y_ptr = 0; y_ptr < l.image_height; y_ptr++)
+        {
+            line_start = l.read_width * ((y_ptr + l.offset_y) / 2);
+            is_odd     = (y_ptr + l.offset_y) % 2;
+
+            for (x_ptr = 0; x_ptr < l.image_width; x_ptr++)
+            {
+                read_ptr = (line_start + x_ptr + l.offset_x) * 2;
+                if (is_odd == 1)
+                {
+                    msb = odd[read_ptr];
+                    lsb = odd[read_ptr + 1];
+                }
+                else
+                {
+                    msb = even[read_ptr];
+                    lsb = even[read_ptr + 1];
+                }
+                framebuffer[write_ptr++] = msb;
+                framebuffer[write_ptr++] = lsb;
+            }
+        }
+    }
+    else
+    {
+        for (write_ptr = y_ptr = 0; y_ptr < l.image_height; y_ptr++)
+        {
+            line_start = l.read_width * (y_ptr + l.offset_y);
+            for (x_ptr = 0; x_ptr < l.image_width; x_ptr++)
+            {
+                read_ptr = (line_start + x_ptr + l.offset_x) * 2;
+
+                msb = odd[read_ptr];
+                lsb = odd[read_ptr + 1];
+
+                framebuffer[write_ptr++] = msb;
+                framebuffer[write_ptr++] = lsb;
+            }
+        }
+    }
+
+    const uint16_t *buf = (const uint16_t *)framebuffer.data();
+    std::vector<uint16_t> image(l.image_width * l.image_height);
+    for (size_t i = 0; i < image.size(); i++)
+        image[i] = ntohs(buf[i]);
+    return image;
+}
+}
+
+class DsiFieldTest : public ::testing::TestWithParam<Camera> {};
+
+TEST_P(DsiFieldTest, MatchesLegacyMerge)
+{
+    const DSI::FieldLayout &layout = GetParam().layout;
+    std::vector<unsigned char> even = makeField(layout, layout.rows_even, 1);
+    std::vector<unsigned char> odd  = makeField(layout, layout.rows_odd, 2);
+
+    std::vector<uint16_t> expected = legacyMerge(layout, even.data(), odd.data());
+
+    // Guard words after the image catch rows written past its end
+    std::vector<uint16_t> frame(expected.size() + 64, 0xdead);
+    DSI::mergeFields(layout, layout.interlaced ? even.data() : nullptr, odd.data(), frame.data());
+
+    for (size_t i = 0; i < expected.size(); i++)
+        ASSERT_EQ(expected[i], frame[i]) << "pixel " << i % layout.image_width << "," << i / layout.image_width;
+    for (size_t i = expected.size(); i < frame.size(); i++)
+        ASSERT_EQ(0xdead, frame[i]);
+}
+
+TEST_P(DsiFieldTest, PiecewiseMergeInAnyOrder)
+{
+    const DSI::FieldLayout &layout = GetParam().layout;
+    std::vector<unsigned char> even = makeField(layout, layout.rows_even, 3);
+    std::vector<unsigned char> odd  = makeField(layout, layout.rows_odd, 4);
+
+    std::vector<uint16_t> expected = legacyMerge(layout, even.data(), odd.data());
+
+    // Pieces of a few rows, as the bulk transfers deliver them, completed out of order
+    struct Piece
+    {
+        bool odd;
+        unsigned int first, rows;
+    };
+    std::vector<Piece> pieces;
+    for (unsigned int first = 0; first < layout.rows_even; first += 7)
+        pieces.push_back({ false, first, std::min(7u, layout.rows_even - first) });
+    for (unsigned int first = 0; first < layout.rows_odd; first += 5)
+        pieces.push_back({ true, first, std::min(5u, layout.rows_odd - first) });
+    std::reverse(pieces.begin(), pieces.end());
+
+    std::vector<uint16_t> frame(expected.size());
+    for (const Piece &p : pieces)
+        DSI::mergeFieldRows(layout, p.odd, p.odd ? odd.data() : even.data(), p.first, p.rows, frame.data());
+
+    EXPECT_EQ(expected, frame);
+}
+
+TEST_P(DsiFieldTest, ShortReadIsAnError)
+{
+    const DSI::FieldLayout &layout = GetParam().layout;
+    size_t even = layout.interlaced ? (size_t)layout.rowBytes() * layout.rows_even : 0;
+    size_t odd  = (size_t)layout.rowBytes() * layout.rows_odd;
+
+    EXPECT_NO_THROW(DSI::checkFieldsRead(layout, even, odd));
+    EXPECT_THROW(DSI::checkFieldsRead(layout, even, odd - layout.rowBytes()), DSI::device_read_error);
+    EXPECT_THROW(DSI::checkFieldsRead(layout, even, odd - 1), DSI::device_read_error);
+    if (layout.interlaced)
+    {
+        // A short even field is not made up for by the odd one
+        EXPECT_THROW(DSI::checkFieldsRead(layout, even - 1, odd + 1), DSI::device_read_error);
+        EXPECT_THROW(DSI::checkFieldsRead(layout, 0, odd), DSI::device_read_error);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Cameras, DsiFieldTest, ::testing::ValuesIn(cameras),
+                        [](const ::testing::TestParamInfo<Camera> &info) { return std::string(info.param.name); });
+
+TEST(DsiField, Benchmark)
+{
+    using Clock            = std::chrono::steady_clock;
+    const int frames       = 20;
+    const Camera *benched[] = { &cameras[0], &cameras[2], &cameras[3] };
+
+    for (const Camera *camera : benched)
+    {
+        const DSI::FieldLayout &layout = camera->layout;
+        std::vector<unsigned char> even = makeField(layout, layout.rows_even, 5);
+        std::vector<unsigned char> odd  = makeField(layout, layout.rows_odd, 6);
+        std::vector<uint16_t> frame(layout.image_width * layout.image_height);
+        std::vector<uint16_t> legacy;
+
+        auto start = Clock::now();
+        for (int i = 0; i < frames; i++)
+            legacy = legacyMerge(layout, even.data(), odd.data());
+        auto middle = Clock::now();
+        for (int i = 0; i < frames; i++)
+            DSI::mergeFields(layout, even.data(), odd.data(), frame.data());
+        auto end = Clock::now();
+
+        EXPECT_EQ(legacy, frame);
+
+        double legacyMs = std::chrono::duration<double, std::milli>(middle - start).count() / frames;
+        double mergeMs  = std::chrono::duration<double, std::milli>(end - middle).count() / frames;
+        printf("%-8s %4ux%-4u legacy %7.3f ms  merge %7.3f ms  x%.1f\n", camera->name, layout.image_width,
+               layout.image_height, legacyMs, mergeMs, legacyMs / mergeMs);
+    }
+}
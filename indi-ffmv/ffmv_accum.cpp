@@ -0,0 +1,104 @@
+/**
+ * Sub-exposure accumulation for the FireFly MV driver.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ffmv_accum.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+static inline uint16_t bigEndian16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+#if defined(__SSE2__)
+static inline __m128i loadSwapped(const uint8_t *p)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+#endif
+
+void ffmvAccumulate16(uint16_t *acc, const uint8_t *frame, size_t n)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(acc + i + 8));
+        _mm_storeu_si128((__m128i *)(acc + i), _mm_adds_epu16(a, loadSwapped(frame + 2 * i)));
+        _mm_storeu_si128((__m128i *)(acc + i + 8), _mm_adds_epu16(b, loadSwapped(frame + 2 * i + 16)));
+    }
+#elif defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+    for (; i + 16 <= n; i += 16)
+    {
+        uint16x8_t a = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(frame + 2 * i)));
+        uint16x8_t b = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(frame + 2 * i + 16)));
+        vst1q_u16(acc + i, vqaddq_u16(vld1q_u16(acc + i), a));
+        vst1q_u16(acc + i + 8, vqaddq_u16(vld1q_u16(acc + i + 8), b));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        uint32_t sum = (uint32_t)acc[i] + bigEndian16(frame + 2 * i);
+        acc[i]       = sum > 0xFFFF ? 0xFFFF : (uint16_t)sum;
+    }
+}
+
+void ffmvAccumulate32(uint32_t *acc, const uint8_t *frame, size_t n)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = loadSwapped(frame + 2 * i);
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(acc + i + 4));
+        _mm_storeu_si128((__m128i *)(acc + i), _mm_add_epi32(a, _mm_unpacklo_epi16(v, zero)));
+        _mm_storeu_si128((__m128i *)(acc + i + 4), _mm_add_epi32(b, _mm_unpackhi_epi16(v, zero)));
+    }
+#elif defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+    for (; i + 8 <= n; i += 8)
+    {
+        uint16x8_t v = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(frame + 2 * i)));
+        vst1q_u32(acc + i, vaddw_u16(vld1q_u32(acc + i), vget_low_u16(v)));
+        vst1q_u32(acc + i + 4, vaddw_u16(vld1q_u32(acc + i + 4), vget_high_u16(v)));
+    }
+#endif
+
+    for (; i < n; i++)
+        acc[i] += bigEndian16(frame + 2 * i);
+}
+
+void ffmvAverage32(uint16_t *image, const uint32_t *acc, size_t n, unsigned int count)
+{
+    if (count == 0)
+        count = 1;
+
+    // Once per exposure, so a plain division is good enough
+    for (size_t i = 0; i < n; i++)
+        image[i] = (uint16_t)(((uint64_t)acc[i] + count / 2) / count);
+}
@@ -0,0 +1,40 @@
+/**
+ * Sub-exposure accumulation for the FireFly MV driver.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+#ifndef FFMV_ACCUM_H
+#define FFMV_ACCUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Adds n big endian 16 bit pixels of frame to acc, saturating at 0xFFFF.
+ */
+void ffmvAccumulate16(uint16_t *acc, const uint8_t *frame, size_t n);
+
+/**
+ * Adds n big endian 16 bit pixels of frame to the 32 bit sums in acc.
+ * 65537 subs fit before a sum can wrap.
+ */
+void ffmvAccumulate32(uint32_t *acc, const uint8_t *frame, size_t n);
+
+/**
+ * Writes the rounded mean of count subs from the sums in acc to image.
+ */
+void ffmvAverage32(uint16_t *image, const uint32_t *acc, size_t n, unsigned int count);
+
+#endif // FFMV_ACCUM_H
@@ -17,6 +17,7 @@
  */
 
 #include <sys/time.h>
+#include <algorithm>
 #include <memory>
 #include <stdint.h>
 #include <arpa/inet.h>
@@ -27,6 +28,7 @@
 #include <iostream>
 
 #include "ffmv_ccd.h"
+#include "ffmv_accum.h"
 #include "config.h"
 
 std::unique_ptr<FFMVCCD> ffmvCCD(new FFMVCCD());
@@ -259,6 +261,8 @@ bool FFMVCCD::Connect()
 ***************************************************************************************/
 bool FFMVCCD::Disconnect()
 {
+    stopCapture();
+
     if (dcam)
     {
         dc1394_capture_stop(dcam);
@@ -297,6 +301,12 @@ bool FFMVCCD::initProperties()
     IUFillSwitchVector(&GainSP, GainS, 2, getDeviceName(), "GAIN", "Gain", IMAGE_SETTINGS_TAB, IP_WO, ISR_NOFMANY, 0,
                        IPS_IDLE);
 
+    /* Sum subs with saturation, or average them in 32 bits for long stacks */
+    IUFillSwitch(&StackS[STACK_SUM], "STACK_SUM", "Sum", ISS_ON);
+    IUFillSwitch(&StackS[STACK_AVERAGE], "STACK_AVERAGE", "Average", ISS_OFF);
+    IUFillSwitchVector(&StackSP, StackS, 2, getDeviceName(), "STACK_MODE", "Subs", IMAGE_SETTINGS_TAB, IP_RW,
+                       ISR_1OFMANY, 0, IPS_IDLE);
+
     setDefaultPollingPeriod(250);
 
     return true;
@@ -319,10 +329,12 @@ bool FFMVCCD::updateProperties()
         // Start the timer
         SetTimer(getCurrentPollingPeriod());
         defineProperty(&GainSP);
+        defineProperty(&StackSP);
     }
     else
     {
         deleteProperty(GainSP.name);
+        deleteProperty(StackSP.name);
     }
 
     return true;
@@ -437,6 +449,17 @@ bool FFMVCCD::StartExposure(float duration)
         return false;
     }
 
+    /* Accumulate the subs as they arrive */
+    stopCapture();
+    stackAverage = StackS[STACK_AVERAGE].s == ISS_ON;
+    stackPixels  = (PrimaryCCD.getSubW() / PrimaryCCD.getBinX()) * (PrimaryCCD.getSubH() / PrimaryCCD.getBinY());
+    stackedSubs  = 0;
+    if (stackAverage)
+        stack32.assign(stackPixels, 0);
+    else
+        stack16.assign(stackPixels, 0);
+    captureThread = std::thread(&FFMVCCD::captureSubs, this);
+
     // We're done
     return true;
 }
@@ -447,6 +470,8 @@ bool FFMVCCD::StartExposure(float duration)
 bool FFMVCCD::AbortExposure()
 {
     InExposure = false;
+    stopCapture();
+    dc1394_video_set_transmission(dcam, DC1394_OFF);
     return true;
 }
 
@@ -558,6 +583,17 @@ bool FFMVCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, ch
             setDigitalGain(GainS[1].s);
             return true;
         }
+
+        if (!strcmp(name, StackSP.name))
+        {
+            if (IUUpdateSwitch(&StackSP, states, names, n) < 0)
+            {
+                return false;
+            }
+            StackSP.s = IPS_OK;
+            IDSetSwitch(&StackSP, nullptr);
+            return true;
+        }
     }
 
     //  Nobody has claimed this, so, ignore it
@@ -604,71 +640,83 @@ void FFMVCCD::TimerHit()
 }
 
 /**
- * Download image from FireFly
+ * Accumulate sub_count frames from the DMA ring, started with the exposure.
+ * Each frame is handed back to the ring as soon as it has been added.
  */
-void FFMVCCD::grabImage()
+void FFMVCCD::captureSubs()
 {
     dc1394error_t err;
     dc1394video_frame_t *frame;
-    uint32_t uheight, uwidth;
-    int sub;
-    uint16_t val;
-    struct timeval start, end;
 
-    std::unique_lock<std::mutex> guard(ccdBufferLock);
-    // Let's get a pointer to the frame buffer
-    uint8_t *image = PrimaryCCD.getFrameBuffer();
-
-    // Get width and height
-    int width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
-    int height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
-
-    memset(image, 0, PrimaryCCD.getFrameBufferSize());
-
-    /*-----------------------------------------------------------------------
-    *  stop data transmission
-    *-----------------------------------------------------------------------*/
-
-    gettimeofday(&start, nullptr);
-    for (sub = 0; sub < sub_count; ++sub)
+    for (int sub = 0; sub < sub_count && !abortCapture; ++sub)
     {
         LOGF_DEBUG("Getting sub %d of %d", sub, sub_count);
         err = dc1394_capture_dequeue(dcam, DC1394_CAPTURE_POLICY_WAIT, &frame);
-        if (err != DC1394_SUCCESS)
+        if (err != DC1394_SUCCESS || !frame)
         {
             LOG_ERROR("Could not capture frame");
+            break;
         }
-        dc1394_get_image_size_from_video_mode(dcam, DC1394_VIDEO_MODE_640x480_MONO16, &uwidth, &uheight);
 
         if (DC1394_TRUE == dc1394_capture_is_frame_corrupt(dcam, frame))
         {
             LOG_ERROR("Corrupt frame!");
+            dc1394_capture_enqueue(dcam, frame);
             continue;
         }
-        // Fill buffer with random pattern
-        for (int i = 0; i < height; i++)
-        {
-            for (int j = 0; j < width; j++)
-            {
-                /* Detect unsigned overflow */
-                val = ((uint16_t *)image)[i * width + j] + ntohs(((uint16_t *)(frame->image))[i * width + j]);
-                if (val > ((uint16_t *)image)[i * width + j])
-                {
-                    ((uint16_t *)image)[i * width + j] = val;
-                }
-                else
-                {
-                    ((uint16_t *)image)[i * width + j] = 0xFFFF;
-                }
-            }
-        }
+
+        size_t n = std::min<size_t>(stackPixels, frame->image_bytes / 2);
+        if (stackAverage)
+            ffmvAccumulate32(stack32.data(), frame->image, n);
+        else
+            ffmvAccumulate16(stack16.data(), frame->image, n);
+        ++stackedSubs;
 
         dc1394_capture_enqueue(dcam, frame);
     }
+}
+
+void FFMVCCD::stopCapture()
+{
+    if (!captureThread.joinable())
+        return;
+
+    abortCapture = true;
+    captureThread.join();
+    abortCapture = false;
+}
+
+/**
+ * Download image from FireFly
+ */
+void FFMVCCD::grabImage()
+{
+    dc1394error_t err;
+    struct timeval start, end;
+
+    /* Wait for the remaining subs */
+    gettimeofday(&start, nullptr);
+    if (captureThread.joinable())
+        captureThread.join();
+
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
+    // Let's get a pointer to the frame buffer
+    uint16_t *image = reinterpret_cast<uint16_t *>(PrimaryCCD.getFrameBuffer());
+
+    if (stackAverage)
+        ffmvAverage32(image, stack32.data(), stackPixels, stackedSubs);
+    else
+        memcpy(image, stack16.data(), stackPixels * sizeof(uint16_t));
+
     guard.unlock();
     err = dc1394_video_set_transmission(dcam, DC1394_OFF);
+    if (err != DC1394_SUCCESS)
+    {
+        LOG_ERROR("Unable to stop transmission");
+    }
     gettimeofday(&end, nullptr);
-    LOGF_DEBUG("Download took %d uS", (int)((end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec)));
+    LOGF_DEBUG("Stacked %d of %d subs, download took %d uS", stackedSubs, sub_count,
+               (int)((end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec)));
 
     // Let INDI::CCD know we're done filling the image buffer
     ExposureComplete(&PrimaryCCD);
@@ -23,6 +23,10 @@
 #include <indiccd.h>
 #include <dc1394/dc1394.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 using namespace std;
 
 class FFMVCCD : public INDI::CCD
@@ -50,6 +54,8 @@ class FFMVCCD : public INDI::CCD
     float CalcTimeLeft();
     void setupParams();
     void grabImage();
+    void captureSubs();
+    void stopCapture();
     dc1394error_t writeMicronReg(unsigned int offset, unsigned int val);
     dc1394error_t readMicronReg(unsigned int offset, unsigned int *val);
 
@@ -70,6 +76,24 @@ class FFMVCCD : public INDI::CCD
     ISwitch GainS[2];
     ISwitchVectorProperty GainSP;
 
+    enum
+    {
+        STACK_SUM,
+        STACK_AVERAGE
+    };
+    ISwitch StackS[2];
+    ISwitchVectorProperty StackSP;
+
+    // Subs are accumulated on this thread while the exposure runs, the DMA
+    // ring keeps receiving the next frames in the meantime
+    std::thread captureThread;
+    std::atomic<bool> abortCapture { false };
+    bool stackAverage { false };
+    size_t stackPixels { 0 };
+    int stackedSubs { 0 };
+    std::vector<uint16_t> stack16;
+    std::vector<uint32_t> stack32;
+
     dc1394_t *dc1394;
     dc1394camera_t *dcam;
 
@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2026, INDI Developers
+ *
+ * Runs synthetic big endian frames through the sub accumulation of the
+ * FireFly MV driver and compares it with plain per pixel references.
+ */
+
+#include "ffmv_accum.h"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+std::vector<uint8_t> makeFrame(size_t pixels, unsigned int seed, uint16_t max = 0xFFFF)
+{
+    std::vector<uint8_t> frame(2 * pixels);
+    for (size_t i = 0; i < pixels; i++)
+    {
+        uint16_t v       = (uint16_t)(((i + seed) * 2654435761u >> 13) % (max + 1u));
+        frame[2 * i]     = v >> 8;
+        frame[2 * i + 1] = v & 0xFF;
+    }
+    return frame;
+}
+
+/* The loop FFMVCCD::grabImage ran for every sub, including its overflow test. */
+void legacyAccumulate(uint16_t *image, const uint8_t *frame, int width, int height)
+{
+    uint16_t val;
+    for (int i = 0; i < height; i++)
+    {
+        for (int j = 0; j < width; j++)
+        {
+            /* Detect unsigned overflow */
+            val = image[i * width + j] + ntohs(((const uint16_t *)frame)[i * width + j]);
+            if (val > image[i * width + j])
+                image[i * width + j] = val;
+            else
+                image[i * width + j] = 0xFFFF;
+        }
+    }
+}
+}
+
+TEST(FfmvAccum, SaturatingSum)
+{
+    // Odd size to cover the scalar tail
+    const size_t pixels = 640 * 3 + 13;
+    std::vector<uint16_t> acc(pixels, 0), expected(pixels, 0);
+
+    for (unsigned int sub = 0; sub < 6; sub++)
+    {
+        std::vector<uint8_t> frame = makeFrame(pixels, sub * 7919, 0x7FFF);
+        ffmvAccumulate16(acc.data(), frame.data(), pixels);
+        for (size_t i = 0; i < pixels; i++)
+        {
+            uint32_t sum = expected[i] + ((frame[2 * i] << 8) | frame[2 * i + 1]);
+            expected[i]  = sum > 0xFFFF ? 0xFFFF : sum;
+        }
+        ASSERT_EQ(expected, acc) << "sub " << sub;
+    }
+}
+
+TEST(FfmvAccum, ZeroPixelsDoNotSaturate)
+{
+    // The former overflow test also saturated when a sub pixel was 0
+    std::vector<uint8_t> frame(2 * 32, 0);
+    std::vector<uint16_t> acc(32, 100);
+    ffmvAccumulate16(acc.data(), frame.data(), acc.size());
+    EXPECT_EQ(std::vector<uint16_t>(32, 100), acc);
+}
+
+TEST(FfmvAccum, LongStackAverage)
+{
+    const size_t pixels = 1192 + 5;
+    const unsigned int subs = 500;
+    std::vector<uint32_t> acc(pixels, 0);
+    std::vector<uint64_t> expected(pixels, 0);
+
+    for (unsigned int sub = 0; sub < subs; sub++)
+    {
+        // Bright enough that a 16 bit sum clips after two subs
+        std::vector<uint8_t> frame = makeFrame(pixels, sub, 0xFFFF);
+        for (size_t i = 0; i < pixels; i++)
+            frame[2 * i] |= 0x80;
+        ffmvAccumulate32(acc.data(), frame.data(), pixels);
+        for (size_t i = 0; i < pixels; i++)
+            expected[i] += (frame[2 * i] << 8) | frame[2 * i + 1];
+    }
+
+    std::vector<uint16_t> image(pixels);
+    ffmvAverage32(image.data(), acc.data(), pixels, subs);
+    for (size_t i = 0; i < pixels; i++)
+    {
+        ASSERT_EQ(expected[i], acc[i]) << "pixel " << i;
+        ASSERT_EQ((expected[i] + subs / 2) / subs, image[i]) << "pixel " << i;
+        ASSERT_GE(image[i], 0x8000) << "pixel " << i;
+    }
+}
+
+TEST(FfmvAccum, Benchmark)
+{
+    using Clock    = std::chrono::steady_clock;
+    const int subs = 100;
+    const struct
+    {
+        const char *name;
+        int width, height;
+    } sensors[] = { { "FireFly MV", 640, 480 }, { "Atik GP", 1192, 964 } };
+
+    for (const auto &sensor : sensors)
+    {
+        const size_t pixels = sensor.width * sensor.height;
+        // Dim subs without zero pixels, so the former overflow test agrees
+        std::vector<uint8_t> frame = makeFrame(pixels, 11, 0x00FF);
+        for (size_t i = 0; i < pixels; i++)
+            frame[2 * i + 1] |= 1;
+        std::vector<uint16_t> legacy(pixels, 0), acc16(pixels, 0), image(pixels);
+        std::vector<uint32_t> acc32(pixels, 0);
+
+        auto t0 = Clock::now();
+        for (int i = 0; i < subs; i++)
+            legacyAccumulate(legacy.data(), frame.data(), sensor.width, sensor.height);
+        auto t1 = Clock::now();
+        for (int i = 0; i < subs; i++)
+            ffmvAccumulate16(acc16.data(), frame.data(), pixels);
+        auto t2 = Clock::now();
+        for (int i = 0; i < subs; i++)
+            ffmvAccumulate32(acc32.data(), frame.data(), pixels);
+        ffmvAverage32(image.data(), acc32.data(), pixels, subs);
+        auto t3 = Clock::now();
+
+        for (size_t i = 0; i < pixels; i++)
+        {
+            ASSERT_EQ(legacy[i], acc16[i]) << "pixel " << i;
+            ASSERT_EQ(acc16[i], acc32[i]) << "pixel " << i;
+        }
+
+        double legacyMs = std::chrono::duration<double, std::milli>(t1 - t0).count() / subs;
+        double sum16Ms  = std::chrono::duration<double, std::milli>(t2 - t1).count() / subs;
+        double sum32Ms  = std::chrono::duration<double, std::milli>(t3 - t2).count() / subs;
+        printf("%-10s %4dx%-4d per sub: legacy %6.3f ms  sum16 %6.3f ms x%.1f  sum32 %6.3f ms x%.1f\n", sensor.name,
+               sensor.width, sensor.height, legacyMs, sum16Ms, legacyMs / sum16Ms, sum32Ms, legacyMs / sum32Ms);
+    }
+}
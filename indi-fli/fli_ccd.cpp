@@ -662,7 +662,22 @@ bool FLICCD::grabImage()
     else
     {
         bool success = true;
-        for (int i = 0; i < height; i++)
+        size_t grabbed = 0;
+        int i = 0;
+
+        // Grab the whole frame at once where libfli supports it, older libfli
+        // and parallel port cameras reject the call without grabbing anything.
+        err = FLIGrabFrame(fli_dev, image, static_cast<size_t>(row_size) * height, &grabbed);
+        if (err && grabbed == 0)
+            LOGF_DEBUG("FLIGrabFrame() unavailable (%s), grabbing row by row.", strerror(-err));
+        else if (err)
+        {
+            LOGF_ERROR("FLIGrabFrame() failed after %zu bytes. %s.", grabbed, strerror(-err));
+            success = false;
+        }
+
+        // Whatever FLIGrabFrame() left is read row by row, also to flush the array after a failure
+        for (i = grabbed / row_size; i < height; i++)
         {
             if ((err = FLIGrabRow(fli_dev, image + (i * row_size), width)))
             {
@@ -167,6 +167,8 @@ bool NightscapeCCD::Connect()
     }
     dn->setFrameYBinning(1);
     dn->setFrameXBinning(1);
+    // download buffers for a full frame, kept until disconnect
+    dn->setMaxImgSize(m->getRawImgSize(0, 0, 1));
 
     dn->setIncrement(1);
     dn->setFbase("");
@@ -375,6 +377,7 @@ bool NightscapeCCD::StartExposure(float duration)
     dn->setImgSize(m->getRawImgSize(zonestart, zonelen, framediv));
     dn->setFrameYBinning(framediv);
     dn->setFrameXBinning(PrimaryCCD.getBinX());
+    dn->setFrameX(PrimaryCCD.getSubX(), PrimaryCCD.getSubW());
     m->sendzone(zonestart, zonelen, framediv);
     INDI::CCDChip::CCD_FRAME ft = PrimaryCCD.getFrameType();
     if (ft == INDI::CCDChip::DARK_FRAME || ft == INDI::CCDChip::BIAS_FRAME) dark = true;
@@ -0,0 +1,252 @@
+#include "nsbin.h"
+#include "kaf_constants.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define RAW_LINE (KAF8300_MAX_X*2)
+
+static inline uint16_t meanPixel(const uint16_t * p, int n) {
+	uint32_t sum = 0;
+	for (int a = 0; a < n; a++) sum += p[a];
+	return n == 4 ? sum >> 2 : sum / n;
+}
+
+static inline uint16_t rmsPixel(const uint16_t * p, int n) {
+	uint64_t sq = 0;
+	for (int a = 0; a < n; a++) sq += (uint32_t)p[a] * p[a];
+	return (uint16_t)(sqrt((double)(sq / n)) + 0.5);
+}
+
+#if defined(__SSE2__)
+// u32 lanes of a and b, all below 0x10000, to u16
+static inline __m128i pack32(__m128i a, __m128i b) {
+	const __m128i bias32 = _mm_set1_epi32(0x8000);
+	const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+	return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32)), bias16);
+}
+
+// sums of adjacent u16 pairs as u32
+static inline __m128i pairs16(__m128i v) {
+	return _mm_add_epi32(_mm_and_si128(v, _mm_set1_epi32(0xffff)), _mm_srli_epi32(v, 16));
+}
+
+// sums of adjacent pairs of the squares of 4 u16 as u64
+static inline __m128i pairsq(__m128i sq) {
+	return _mm_add_epi64(_mm_and_si128(sq, _mm_set_epi32(0, -1, 0, -1)), _mm_srli_epi64(sq, 32));
+}
+
+// rounded roots of two u64 mean squares, to i32 lanes 0 and 1
+static inline __m128i root2(__m128i msq) {
+	// mean squares are below 2^32, exact as doubles
+	const __m128i exp52 = _mm_set_epi32(0x43300000, 0, 0x43300000, 0);
+	__m128d d = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(msq, exp52)), _mm_set1_pd(4503599627370496.0));
+	return _mm_cvttpd_epi32(_mm_add_pd(_mm_sqrt_pd(d), _mm_set1_pd(0.5)));
+}
+
+// 8 rms pixels of 16 (xbin 2) or 32 (xbin 4) source pixels
+static inline __m128i rms8(const uint16_t * src, int xbin) {
+	__m128i r[4];
+	for (int i = 0; i < 4; i++) {
+		__m128i v, lo, hi, p0, p1, msq;
+		if (xbin == 2) {
+			// two pairs in each half of 4 pixels
+			v = _mm_loadl_epi64((const __m128i *)(src + 4*i));
+			lo = _mm_mullo_epi16(v, v);
+			hi = _mm_mulhi_epu16(v, v);
+			msq = _mm_srli_epi64(pairsq(_mm_unpacklo_epi16(lo, hi)), 1);
+		} else {
+			v = _mm_loadu_si128((const __m128i *)(src + 8*i));
+			lo = _mm_mullo_epi16(v, v);
+			hi = _mm_mulhi_epu16(v, v);
+			p0 = pairsq(_mm_unpacklo_epi16(lo, hi));
+			p1 = pairsq(_mm_unpackhi_epi16(lo, hi));
+			p0 = _mm_add_epi64(p0, _mm_srli_si128(p0, 8));
+			p1 = _mm_add_epi64(p1, _mm_srli_si128(p1, 8));
+			msq = _mm_srli_epi64(_mm_unpacklo_epi64(p0, p1), 2);
+		}
+		r[i] = root2(msq);
+	}
+	return pack32(_mm_unpacklo_epi64(r[0], r[1]), _mm_unpacklo_epi64(r[2], r[3]));
+}
+#endif
+
+void nsBinLine(uint16_t * dst, const uint16_t * src, int outlen, int xbin, bool rms)
+{
+	int x = 0;
+
+	if (xbin <= 1) {
+		memcpy(dst, src, outlen * 2);
+		return;
+	}
+
+#if defined(__SSE2__)
+	if (rms && (xbin == 2 || xbin == 4)) {
+		for (; x + 8 <= outlen; x += 8)
+			_mm_storeu_si128((__m128i *)(dst + x), rms8(src + x*xbin, xbin));
+	} else if (!rms && xbin == 2) {
+		for (; x + 8 <= outlen; x += 8) {
+			__m128i a = pairs16(_mm_loadu_si128((const __m128i *)(src + 2*x)));
+			__m128i b = pairs16(_mm_loadu_si128((const __m128i *)(src + 2*x + 8)));
+			_mm_storeu_si128((__m128i *)(dst + x), pack32(_mm_srli_epi32(a, 1), _mm_srli_epi32(b, 1)));
+		}
+	} else if (!rms && xbin == 4) {
+		for (; x + 8 <= outlen; x += 8) {
+			__m128i q[4];
+			for (int i = 0; i < 4; i++) {
+				__m128i p = pairs16(_mm_loadu_si128((const __m128i *)(src + 4*x + 8*i)));
+				// quad sums in lanes 0 and 2, moved to 0 and 1
+				q[i] = _mm_shuffle_epi32(_mm_add_epi32(p, _mm_srli_epi64(p, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+			}
+			__m128i a = _mm_srli_epi32(_mm_unpacklo_epi64(q[0], q[1]), 2);
+			__m128i b = _mm_srli_epi32(_mm_unpacklo_epi64(q[2], q[3]), 2);
+			_mm_storeu_si128((__m128i *)(dst + x), pack32(a, b));
+		}
+	}
+#elif defined(__ARM_NEON)
+	if (!rms && xbin == 2) {
+		for (; x + 8 <= outlen; x += 8) {
+			uint16x8x2_t v = vld2q_u16(src + 2*x);
+			uint32x4_t lo = vaddl_u16(vget_low_u16(v.val[0]), vget_low_u16(v.val[1]));
+			uint32x4_t hi = vaddl_u16(vget_high_u16(v.val[0]), vget_high_u16(v.val[1]));
+			vst1q_u16(dst + x, vcombine_u16(vshrn_n_u32(lo, 1), vshrn_n_u32(hi, 1)));
+		}
+	} else if (!rms && xbin == 4) {
+		for (; x + 8 <= outlen; x += 8) {
+			uint16x8x4_t v = vld4q_u16(src + 4*x);
+			uint32x4_t lo = vaddq_u32(vaddl_u16(vget_low_u16(v.val[0]), vget_low_u16(v.val[1])),
+			                          vaddl_u16(vget_low_u16(v.val[2]), vget_low_u16(v.val[3])));
+			uint32x4_t hi = vaddq_u32(vaddl_u16(vget_high_u16(v.val[0]), vget_high_u16(v.val[1])),
+			                          vaddl_u16(vget_high_u16(v.val[2]), vget_high_u16(v.val[3])));
+			vst1q_u16(dst + x, vcombine_u16(vshrn_n_u32(lo, 2), vshrn_n_u32(hi, 2)));
+		}
+	}
+#endif
+
+	// tail, and 3x binning where groups do not line up with vectors
+	if (rms) {
+		for (; x < outlen; x++) dst[x] = rmsPixel(src + x*xbin, xbin);
+	} else if (xbin == 2) {
+		for (; x < outlen; x++) dst[x] = ((uint32_t)src[2*x] + src[2*x + 1]) >> 1;
+	} else if (xbin == 3) {
+		for (; x < outlen; x++) dst[x] = ((uint32_t)src[3*x] + src[3*x + 1] + src[3*x + 2]) / 3;
+	} else {
+		for (; x < outlen; x++) dst[x] = meanPixel(src + x*xbin, xbin);
+	}
+}
+
+int nsBinLines(unsigned char * dst, const unsigned char * buf, int nbytes, int xstart, int xlen, int xbin, bool rms)
+{
+	int outlen = xlen / xbin;
+	int lines = 0;
+	const unsigned char * bufp = buf + (KAF8300_POSTAMBLE*2) + xstart*2;
+
+	while (nbytes >= RAW_LINE) {
+		nsBinLine((uint16_t *)dst, (const uint16_t *)bufp, outlen, xbin, rms);
+		dst += outlen * 2;
+		bufp += RAW_LINE;
+		nbytes -= RAW_LINE;
+		lines++;
+	}
+	return lines;
+}
+
+NsBinner::~NsBinner() {
+	if (binthread) {
+		{
+			std::unique_lock<std::mutex> ulock(mutx);
+			interrupted = true;
+			go_bin.notify_all();
+		}
+		binthread->join();
+		delete binthread;
+	}
+	free(binbuf);
+}
+
+void NsBinner::reserve(size_t size) {
+	if (size <= binbufsiz) return;
+	free(binbuf);
+	binbuf = (unsigned char *)malloc(size);
+	binbufsiz = binbuf ? size : 0;
+}
+
+void NsBinner::start(const unsigned char * rawbuf, int rawsiz, int xs, int xl, int xb, bool r) {
+	std::unique_lock<std::mutex> ulock(mutx);
+	while (busy) bin_done.wait(ulock);
+
+	if (xb < 1) xb = 1;
+	reserve((size_t)(rawsiz / RAW_LINE) * (xl / xb) * 2);
+	raw = binbuf ? rawbuf : NULL;
+	xstart = xs;
+	xlen = xl;
+	xbin = xb;
+	rms = r;
+	avail = 0;
+	done = 0;
+	finished = false;
+	complete = false;
+
+	if (!binthread) binthread = new std::thread(&NsBinner::trun, this);
+}
+
+void NsBinner::feed(int nread) {
+	std::unique_lock<std::mutex> ulock(mutx);
+	if (!raw) return;
+	avail = nread;
+	go_bin.notify_all();
+}
+
+void NsBinner::finish(int nread) {
+	std::unique_lock<std::mutex> ulock(mutx);
+	if (!raw) return;
+	avail = nread;
+	finished = true;
+	go_bin.notify_all();
+	while (raw && !complete) bin_done.wait(ulock);
+}
+
+void NsBinner::cancel() {
+	std::unique_lock<std::mutex> ulock(mutx);
+	while (busy) bin_done.wait(ulock);
+	raw = NULL;
+	complete = false;
+}
+
+int NsBinner::result(unsigned char * dst, const unsigned char * rawbuf, int xs, int xl, int xb, bool r) {
+	std::unique_lock<std::mutex> ulock(mutx);
+	if (!complete || raw != rawbuf || xstart != xs || xlen != xl || xbin != xb || rms != r) return -1;
+	memcpy(dst, binbuf, (size_t)done * (xlen / xbin) * 2);
+	return done;
+}
+
+void NsBinner::trun() {
+	std::unique_lock<std::mutex> ulock(mutx);
+	while (!interrupted) {
+		int lines = avail / RAW_LINE;
+		if (raw && !complete && done < lines) {
+			// lines below avail are no longer written by the download, bin them unlocked
+			int first = done;
+			busy = true;
+			ulock.unlock();
+			nsBinLines(binbuf + (size_t)first * (xlen / xbin) * 2, raw + (size_t)first * RAW_LINE,
+			           (lines - first) * RAW_LINE, xstart, xlen, xbin, rms);
+			ulock.lock();
+			busy = false;
+			done = lines;
+			bin_done.notify_all();
+			continue;
+		}
+		if (raw && finished && !complete) {
+			complete = true;
+			bin_done.notify_all();
+		}
+		go_bin.wait(ulock);
+	}
+}
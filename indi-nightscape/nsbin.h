@@ -0,0 +1,65 @@
+#ifndef __NS_BIN_H__
+#define __NS_BIN_H__
+#include <stdint.h>
+#include <stddef.h>
+#include <thread>         // std::thread
+#include <condition_variable>
+
+/*
+ x binning of KAF8300 lines.
+ src holds outlen * xbin host order pixels, each group of xbin becomes
+ one pixel of dst: the truncated mean, or with rms the rounded root of
+ the truncated mean square. xbin is 1 to 4.
+*/
+void nsBinLine(uint16_t * dst, const uint16_t * src, int outlen, int xbin, bool rms);
+
+/*
+ Bins the active window of every complete raw line of buf into dst,
+ returns the number of lines. dst holds xlen / xbin pixels per line.
+*/
+int nsBinLines(unsigned char * dst, const unsigned char * buf, int nbytes, int xstart, int xlen, int xbin, bool rms);
+
+/*
+ Bins a frame on a worker thread while it is being downloaded.
+ The download thread announces each chunk with feed(), the worker bins
+ the lines completed so far while the next chunk is in flight, so only the
+ lines of the last chunk are left when the download ends.
+*/
+class NsBinner {
+	public:
+		NsBinner() {}
+		~NsBinner();
+		void start(const unsigned char * raw, int rawsiz, int xstart, int xlen, int xbin, bool rms);
+		void feed(int nread);
+		void finish(int nread);
+		void cancel();
+		// copies the binned lines of raw to dst and returns their number, -1 unless raw
+		// was binned completely with this geometry. The copy is taken under the lock,
+		// so a start() for the next frame cannot overwrite it halfway.
+		int result(unsigned char * dst, const unsigned char * raw, int xstart, int xlen, int xbin, bool rms);
+	private:
+		void trun();
+		void reserve(size_t size);
+
+		const unsigned char * raw { NULL };
+		int xstart { 0 };
+		int xlen { 0 };
+		int xbin { 1 };
+		bool rms { false };
+		int avail { 0 };
+		int done { 0 };
+		bool finished { false };
+		bool complete { false };
+		bool busy { false };
+		bool interrupted { false };
+
+		unsigned char * binbuf { NULL };
+		size_t binbufsiz { 0 };
+
+		std::thread * binthread { NULL };
+		std::condition_variable go_bin;
+		std::condition_variable bin_done;
+		std::mutex mutx;
+};
+
+#endif
@@ -17,6 +17,41 @@ void NsDownload::setFrameXBinning(int binning) {
 			ctx->imgp->xbinning = binning;	
 
 }
+void NsDownload::setFrameX(int start, int len) {
+			xstart = start;
+			xlen = len;
+}
+
+NsDownload::~NsDownload() {
+	free(slots[0]);
+	free(slots[1]);
+}
+
+void NsDownload::setMaxImgSize(int siz) {
+	size_t size = (size_t)siz + DEFAULT_CHUNK_SIZE;
+	if (size <= slotsiz) return;
+	for (int i = 0; i < 2; i++) {
+		free(slots[i]);
+		slots[i] = (unsigned char *)malloc(size);
+		// fault the pages in once instead of on every exposure
+		if (slots[i]) memset(slots[i], 0, size);
+	}
+	if (!slots[0] || !slots[1]) {
+		DO_ERR("cannot allocate download buffers of %zu\n", size);
+		free(slots[0]);
+		free(slots[1]);
+		slots[0] = slots[1] = NULL;
+		size = 0;
+	}
+	slotsiz = size;
+	rd->buffer = NULL;
+	retrBuf = NULL;
+}
+
+void NsDownload::setBinRms(bool r) {
+			rms = r;
+}
+
 void NsDownload::setImgSize(int siz) {
 	rd->imgsz = siz;
 }
@@ -91,9 +126,7 @@ void NsDownload::setImgWrite(bool w) {
 }
 
 void NsDownload::freeBuf() {
-	if (!retrBuf) return;
-	if (retrBuf->buffer) free(retrBuf->buffer);
-	retrBuf->buffer = NULL;
+	// the slot is reused by the download after next
 	retrBuf = NULL;
 }
 
@@ -157,10 +190,7 @@ int NsDownload::downloader()
 			if (readdone) {
 			  download=0;
 				lastread = rc2;
-			
-				rb = rdd;
-				retrBuf = &rb;
-				rd->buffer = NULL;
+				handoff();
 			}	
 			return download;		
 }
@@ -304,12 +334,8 @@ void NsDownload::writedownload(int pad, int cooked)
 
 void NsDownload::copydownload(unsigned char *buf, int xstart, int xlen, int xbin, int pad, int cooked)
 {
-	unsigned char linebuf[KAF8300_MAX_X*2];
-	bool forwards = true;
-	bool rms = false;
 	int binning = xbin;
 	uint8_t * dbufp = buf;
-	uint8_t * bufp;
 	int nwrite = 0;
 	
 	if (retrBuf == NULL) {
@@ -326,62 +352,12 @@ void NsDownload::copydownload(unsigned char *buf, int xstart, int xlen, int xbin
 		}
 		memcpy (dbufp, retrBuf->buffer, nwrite);
 	} else {
-		//int actlines = nwrite / (KAF8300_MAX_X*2);
-	  //int rem = nwrite % (KAF8300_MAX_X*2);
 	  nwrite = retrBuf->nread;
-		int nwriteleft = nwrite;
-		if (forwards) {
-			bufp = retrBuf->buffer;
-			//dbufp =  (dbufp +(KAF8300_ACTIVE_X*2*IMG_Y)) - (KAF8300_ACTIVE_X*2);
-		} else {
-			bufp = (retrBuf->buffer + nwrite) - (KAF8300_MAX_X*2);
-			dbufp =  (dbufp +(KAF8300_ACTIVE_X*2*IMG_MAX_Y)) - (KAF8300_ACTIVE_X*2);
-		}
-		writelines = 0;
-	  while (nwriteleft >= (KAF8300_MAX_X*2)) {
-	  //swab (bufp + (KAF8300_POSTAMBLE*2),  linebuf, KAF8300_ACTIVE_X*2 );
-	   //memcpy (dbufp, linebuf, KAF8300_ACTIVE_X*2);
-	    if (binning > 1) {
-	    	uint8_t * lbufp = bufp + (KAF8300_POSTAMBLE*2) + xstart*2;
-	    	int len = xlen * 2;
-	    	int linelen = 0;
-	    	while (len > 0) {
-	    		short px[4];
-	    		long long pxsq =0;
-	    		long pxav =0;
-	    		short pxa;
-	    		memcpy(px, lbufp,binning * 2);
-	    		for (int a = 0; a < binning; a++) {
-	    			pxav += px[a];
-	    			pxsq	+= px[a]*px[a];
-	    		}
-	    		pxav /= binning;
-	    		pxsq /= binning;
-	    		if(rms) {
-	    			pxa = round(sqrt((double)	pxsq));
-	    			
-	    		} else {
-	    			pxa = pxav;	
-	    		}
-	    		memcpy (linebuf + linelen, &pxa, 2);
-	    		linelen += 2;
-	    		lbufp += 2*binning;
-	    		len -= 2* binning;
-				}
-				memcpy (dbufp, linebuf, (xlen*2)/binning);
-
-	    } else {
-	  		memcpy (dbufp, bufp + (KAF8300_POSTAMBLE*2) + xstart*2, xlen * 2 ); //KAF8300_ACTIVE_X*2 );
-	  	}
-			if (forwards) { 
-				bufp +=  KAF8300_MAX_X*2;
-				dbufp +=(xlen*2)/binning;
-			} else {
-				bufp -=  KAF8300_MAX_X*2;
-				dbufp-=(xlen*2)/binning;
-			}
-			nwriteleft -= KAF8300_MAX_X*2;
-			writelines++;
+	  if (binning < 1) binning = 1;
+	  // normally the lines were binned while the frame was downloading
+	  writelines = binner.result(dbufp, retrBuf->buffer, xstart, xlen, binning, rms);
+	  if (writelines < 0) {
+	  	writelines = nsBinLines(dbufp, retrBuf->buffer, nwrite, xstart, xlen, binning, rms);
 	  }
 	 DO_INFO( "wrote %d lines\n", writelines);
 	}	 
@@ -429,18 +405,29 @@ int NsDownload::fulldownload()
 
 void NsDownload::initdownload()
 {
-	  long imgszmax = KAF8300_MAX_X*0x9ca*2 + DEFAULT_CHUNK_SIZE;
+		if (!slotsiz) setMaxImgSize(KAF8300_MAX_X*IMG_MAX_Y*2);
 		readdone = 0;
 		rd->nread = 0;
 		if(!rd->buffer) {
-			rd->buffer = (unsigned char *)malloc(imgszmax);
+			// the slot not holding the last frame
+			rd->buffer = (retrBuf && retrBuf->buffer == slots[0]) ? slots[1] : slots[0];
 		}
-		memset(rd->buffer, 0, imgszmax);
-
-		rd->bufsiz = imgszmax;
+		rd->bufsiz = slotsiz;
 		rd->nblks = 0;	
 }
 
+// hands the downloaded frame to getBuf, the next download takes the other slot
+void NsDownload::handoff()
+{
+		// a short frame is padded to imgsz, clear what the last use of the slot left there
+		int padded = rd->imgsz < rd->bufsiz ? rd->imgsz : rd->bufsiz;
+		if (rd->buffer && rd->nread < padded)
+			memset(rd->buffer + rd->nread, 0, padded - rd->nread);
+		rb = rdd;
+		retrBuf = &rb;
+		rd->buffer = NULL;
+}
+
 
 // static void  download_thread(NsDownload * d) {
 //	d->trun();	
@@ -470,6 +457,9 @@ void NsDownload::trun()
 			in_download = 1;
 			ctx->imgseq++;
 			zeroes = 0;
+			// bin the lines of each chunk while the next one downloads
+			if (xlen > 0 && ctx->imgp->xbinning > 1) binner.start(rd->buffer, rd->bufsiz, xstart, xlen, ctx->imgp->xbinning, rms);
+			else binner.cancel();
 		}
 	  while (in_download && !interrupted) {
 	  	//int rc2= cn->setDataRts();;
@@ -483,10 +473,12 @@ void NsDownload::trun()
 	  		down = downloader();
 	  	if (down < 0) {
 	  		DO_ERR( "unable to read download: %d\n", down);
+	  		binner.cancel();
 	  		do_download = 0;
 	  		in_download = 0;
 	  		continue;
 	  	}
+	  	binner.feed(rd->nread);
 	  	if (rd->nread < rd->imgsz) {
 	  		if (down == 0 && rd->nread > 0) {
     			zeroes++;
@@ -505,13 +497,10 @@ void NsDownload::trun()
 	    lastread = down;
 	    	   // IDLog("foop\n");
 
-	    if (zero_reads > 1) {
-	    	rb = rdd;
-	    	retrBuf = &rb;
-	    	rd->buffer = NULL;
-	    }
+	    if (zero_reads > 1) handoff();
 	    //IDLog("retr %p buf %p \n", retrBuf, rb.buffer);
 	    if(write_it) writedownload(pad, 0);
+	    binner.finish(rd->nread);
 			
 	  	do_download = 0;
 	  	in_download = 0;
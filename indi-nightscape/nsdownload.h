@@ -1,6 +1,7 @@
 #ifndef __NS_DOWNLOAD_H__
 #define __NS_DOWNLOAD_H__
 #include "nschannel.h"
+#include "nsbin.h"
 #include <stdio.h>
 #include <string.h>
 #include <pthread.h>
@@ -79,6 +80,10 @@ class NsDownload {
 		 }
 		 void setFrameYBinning(int  binning);
 		 void setFrameXBinning(int  binning);
+		 ~NsDownload();
+		 void setFrameX(int start, int len);
+		 void setMaxImgSize(int siz);
+		 void setBinRms(bool r);
 
 		 void setSetTemp (float temp);
 		 void setActTemp(float temp);
@@ -111,6 +116,7 @@ class NsDownload {
 	  void fitsheader(int x, int y, char * fbase, struct img_params * ip);
 		int fulldownload(); 
 		bool getDoDownload();
+		void handoff();
 		struct download_params dp;
 		struct img_params ip;
 	  ns_readdata_t  rdd;
@@ -136,5 +142,13 @@ class NsDownload {
 		ns_readdata_t * retrBuf;
 		int zero_reads { 1 };
 		int writelines{0};
+		int xstart { 0 };
+		int xlen { 0 };
+		bool rms { false };
+		NsBinner binner;
+		// the download alternates between two slots sized for the largest frame,
+		// so a finished frame stays intact while the next one is read
+		unsigned char * slots[2] { NULL, NULL };
+		size_t slotsiz { 0 };
 };
 #endif
\ No newline at end of file
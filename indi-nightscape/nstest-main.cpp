@@ -21,12 +21,14 @@
 #include "kaf_constants.h"
 #include "nsmsg.h"
 #include "nsdownload.h"
+#include "nsbin.h"
 #include "nsdebug.h"
 #include "nschannel-u.h"
 #ifdef HAVE_D2XX
 #include "nschannel-ftd.h"
 #endif
 #include <stdarg.h>
+#include <vector>
 
 static volatile int interrupted = 0;
 //static volatile int readdone = 0;
@@ -57,10 +59,238 @@ long long millis()
 
 void usage(char * prog)
 {
-		fprintf(stderr, "usage: %s [-c camera] [-f fanspeed=1-3] [-n num exp] [-t temp(c)] [ -d tdiff(c)] [-e exposure(s)] [-b binning=1|2] [-z start,lines] increment [-i] dark [-k]\n", prog);
+		fprintf(stderr, "usage: %s [-c camera] [-f fanspeed=1-3] [-n num exp] [-t temp(c)] [ -d tdiff(c)] [-e exposure(s)] [-b binning=1|2] [-z start,lines] increment [-i] dark [-k] [-B benchmark binning and buffers, no camera]\n", prog);
 		exit(-1);	
 }
 
+#define BENCH_LINE (KAF8300_MAX_X*2)
+#define BENCH_RATE 20 /* simulated download, MB/s */
+
+static long long micros()
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return (long long)now.tv_usec + (long long)now.tv_sec*1000000;
+}
+
+/* the binning loop copydownload used before nsBinLines, including its signed pixels */
+static void oldbin(unsigned char * dbufp, unsigned char * bufp, int nwrite, int xstart, int xlen, int binning, bool rms)
+{
+	unsigned char linebuf[KAF8300_MAX_X*2];
+	while (nwrite >= BENCH_LINE) {
+		if (binning > 1) {
+			uint8_t * lbufp = bufp + (KAF8300_POSTAMBLE*2) + xstart*2;
+			int len = xlen * 2;
+			int linelen = 0;
+			while (len > 0) {
+				short px[4];
+				long long pxsq =0;
+				long pxav =0;
+				short pxa;
+				memcpy(px, lbufp,binning * 2);
+				for (int a = 0; a < binning; a++) {
+					pxav += px[a];
+					pxsq	+= px[a]*px[a];
+				}
+				pxav /= binning;
+				pxsq /= binning;
+				if(rms) {
+					pxa = round(sqrt((double)	pxsq));
+				} else {
+					pxa = pxav;
+				}
+				memcpy (linebuf + linelen, &pxa, 2);
+				linelen += 2;
+				lbufp += 2*binning;
+				len -= 2* binning;
+			}
+			memcpy (dbufp, linebuf, (xlen*2)/binning);
+		} else {
+			memcpy (dbufp, bufp + (KAF8300_POSTAMBLE*2) + xstart*2, xlen * 2 );
+		}
+		bufp += BENCH_LINE;
+		dbufp += (xlen*2)/binning;
+		nwrite -= BENCH_LINE;
+	}
+}
+
+/* plain reference of the binned pixel values */
+static int checkbin(const unsigned char * out, const unsigned char * raw, int lines, int xstart, int xlen, int binning, bool rms)
+{
+	int bad = 0;
+	int outlen = xlen / binning;
+	for (int y = 0; y < lines; y++) {
+		const uint16_t * src = (const uint16_t *)(raw + y*BENCH_LINE + KAF8300_POSTAMBLE*2) + xstart;
+		const uint16_t * dst = (const uint16_t *)out + y*outlen;
+		for (int x = 0; x < outlen; x++) {
+			unsigned long long sum = 0;
+			for (int a = 0; a < binning; a++)
+				sum += rms ? (unsigned long long)src[x*binning + a] * src[x*binning + a] : src[x*binning + a];
+			sum /= binning;
+			uint16_t want = rms ? (uint16_t)floor(sqrt((double)sum) + 0.5) : (uint16_t)sum;
+			if (dst[x] != want) bad++;
+		}
+	}
+	return bad;
+}
+
+/* downloads raw in chunks at BENCH_RATE, binning after the download or alongside it */
+static long long benchdownload(unsigned char * dst, const unsigned char * src, int nbytes, NsBinner * binner, int xstart, int xlen, int binning, bool rms)
+{
+	static std::vector<unsigned char> raw;
+	raw.resize(nbytes);
+	const int chunk = DEFAULT_CHUNK_SIZE;
+	long long t0 = micros();
+	if (binner) binner->start(raw.data(), nbytes, xstart, xlen, binning, rms);
+	for (int nread = 0; nread < nbytes; ) {
+		int n = nbytes - nread < chunk ? nbytes - nread : chunk;
+		memcpy(raw.data() + nread, src + nread, n);
+		nread += n;
+		// wait out the transfer time of the chunk
+		long long due = t0 + (long long)nread / BENCH_RATE;
+		while (micros() < due) usleep(200);
+		if (binner) binner->feed(nread);
+	}
+	long long t1 = micros();
+	if (binner) {
+		binner->finish(nbytes);
+		binner->result(dst, raw.data(), xstart, xlen, binning, rms);
+	} else {
+		nsBinLines(dst, raw.data(), nbytes, xstart, xlen, binning, rms);
+	}
+	return micros() - t1;
+}
+
+/* serves a frame from memory in chunks, as the download channel would */
+class BenchChannel : public NsChannel {
+	public:
+		BenchChannel() { maxxfer = DEFAULT_CHUNK_SIZE; }
+		void load(const unsigned char * d, int n) { data = d; left = n; }
+		int readCommand(unsigned char *, size_t) { return 0; }
+		int writeCommand(const unsigned char *, size_t n) { return n; }
+		int readData(unsigned char * buf, size_t n) {
+			if (n > left) n = left;
+			memcpy(buf, data, n);
+			data += n;
+			left -= n;
+			return n;
+		}
+		int purgeData(void) { return 0; }
+		int setDataRts(void) { return 0; }
+		int resetcontrol (void) { return 0; }
+	protected:
+		int opencontrol (void) { return 0; }
+		int opendownload(void) { return 0; }
+		int scan(void) { return 0; }
+	private:
+		const unsigned char * data { NULL };
+		size_t left { 0 };
+};
+
+static unsigned char * volatile benchsink;
+
+/*
+ per exposure buffer setup, the malloc and memset initdownload did before
+ against the persistent slots, checked through full and short frames
+*/
+static int benchsetup(const unsigned char * raw)
+{
+	const int imgsz = KAF8300_MAX_X*IMG_MAX_Y*2;
+	const int reps = 10;
+	const long imgszmax = KAF8300_MAX_X*0x9ca*2 + DEFAULT_CHUNK_SIZE;
+	std::vector<unsigned char> out(imgsz);
+	int failed = 0;
+
+	long long told = 0;
+	for (int r = 0; r < reps; r++) {
+		long long t0 = micros();
+		unsigned char * buf = (unsigned char *)malloc(imgszmax);
+		memset(buf, 0, imgszmax);
+		// keeps the compiler from dropping the pair
+		benchsink = buf;
+		told += micros() - t0;
+		t0 = micros();
+		free(benchsink);
+		told += micros() - t0;
+	}
+
+	BenchChannel ch;
+	NsDownload d(&ch);
+	d.setMaxImgSize(imgsz);
+	d.setImgSize(imgsz);
+	long long tnew = 0;
+	for (int r = 0; r < reps; r++) {
+		// the last frame comes up 100 lines short, the padding must not show the previous one
+		int nbytes = r == reps - 1 ? imgsz - 100*BENCH_LINE : imgsz;
+		long long t0 = micros();
+		d.initdownload();
+		d.purgedownload();
+		tnew += micros() - t0;
+		ch.load(raw, nbytes);
+		while (d.downloader() > 0) ;
+		d.copydownload(out.data(), 0, KAF8300_ACTIVE_X, 1, 1, 0);
+		if (memcmp(out.data(), raw, nbytes) != 0) failed++;
+		for (int i = nbytes; i < imgsz; i++) {
+			if (out[i]) {
+				failed++;
+				break;
+			}
+		}
+		d.freeBuf();
+	}
+	fprintf(stderr, "exposure setup: malloc and memset %8.2f ms persistent %8.3f ms%s\n", told / 1000.0 / reps,
+	        tnew / 1000.0 / reps, failed ? "  MISMATCH" : "");
+	return failed;
+}
+
+static int benchmark()
+{
+	const int lines = IMG_MAX_Y;
+	const int nbytes = lines * BENCH_LINE;
+	const int xstart = 0;
+	const int xlen = KAF8300_ACTIVE_X - KAF8300_ACTIVE_X % 12;
+	const int reps = 10;
+	std::vector<unsigned char> raw(nbytes);
+	std::vector<unsigned char> out(nbytes), old(nbytes);
+	unsigned int seed = 1;
+	for (int i = 0; i < nbytes; i++) {
+		seed = seed * 1103515245 + 12345;
+		raw[i] = seed >> 16;
+	}
+	int failed = 0;
+
+	fprintf(stderr, "%d lines of %d pixels, %d passes\n", lines, xlen, reps);
+	for (int rms = 0; rms < 2; rms++) {
+		for (int binning = 1; binning <= 4; binning++) {
+			if (rms && binning == 1) continue;
+			long long t0 = micros();
+			for (int r = 0; r < reps; r++) oldbin(old.data(), raw.data(), nbytes, xstart, xlen, binning, rms);
+			long long t1 = micros();
+			for (int r = 0; r < reps; r++) nsBinLines(out.data(), raw.data(), nbytes, xstart, xlen, binning, rms);
+			long long t2 = micros();
+			int bad = checkbin(out.data(), raw.data(), lines, xstart, xlen, binning, rms);
+			failed += bad;
+			fprintf(stderr, "%s bin %d: old %8.2f ms new %8.2f ms x%5.1f  mismatches %d\n", rms ? "rms " : "mean", binning,
+			        (t1 - t0) / 1000.0 / reps, (t2 - t1) / 1000.0 / reps, (double)(t1 - t0) / (t2 - t1), bad);
+		}
+	}
+
+	// the time from the last chunk arriving until the binned frame is ready
+	NsBinner binner;
+	fprintf(stderr, "download at %d MB/s, binning left after the last chunk:\n", BENCH_RATE);
+	for (int binning = 2; binning <= 4; binning++) {
+		long long after = benchdownload(old.data(), raw.data(), nbytes, NULL, xstart, xlen, binning, false);
+		long long overlap = benchdownload(out.data(), raw.data(), nbytes, &binner, xstart, xlen, binning, false);
+		int bad = memcmp(old.data(), out.data(), (size_t)lines * (xlen / binning) * 2) != 0;
+		failed += bad;
+		fprintf(stderr, "bin %d: after download %8.2f ms overlapped %8.2f ms%s\n", binning, after / 1000.0, overlap / 1000.0,
+		        bad ? "  MISMATCH" : "");
+	}
+
+	failed += benchsetup(raw.data());
+	return failed ? 1 : 0;
+}
+
 
 int main(int argc, char **argv)
 {
@@ -99,7 +329,7 @@ int main(int argc, char **argv)
 
     //bigbuf = malloc(3358*2536*2);
     signal(SIGINT, siginthandler);
-    while ((i = getopt(argc, argv, "t:f:c:n:e:b:z:d:o:ik")) != -1)
+    while ((i = getopt(argc, argv, "t:f:c:n:e:b:z:d:o:ikB")) != -1)
     {
         switch (i)
         {
@@ -138,6 +368,9 @@ int main(int argc, char **argv)
 				  case 'k':
 				  	dark = true;
 				  	break;
+				  case 'B':
+				  	exit(benchmark());
+				  	break;
 					default:
 						usage(argv[0]);
 						break;
@@ -166,6 +399,7 @@ int main(int argc, char **argv)
 
  		d->setSetTemp(temp);
 
+    d->setMaxImgSize(m->getRawImgSize(0, 0, 1));
     d->setImgSize(m->getRawImgSize(zonestart,zoneend,binning));
 
 		d->setExpDur(expdur);
@@ -25,6 +25,8 @@
 #include "playerone_base.h"
 #include "playerone_helpers.h"
 
+#include <pixelconvert.h>
+
 #include "config.h"
 
 #include <stream/streammanager.h>
@@ -100,8 +102,7 @@ void POABase::workerStreamVideo(const std::atomic_bool &isAbortToQuit)
         }
 
         if (mCurrentVideoFormat == POA_RGB24)
-            for (uint32_t i = 0; i < totalBytes; i += 3)
-                std::swap(targetFrame[i], targetFrame[i + 2]);
+            pixelconvert_swap_rb24(targetFrame, totalBytes / 3);
 
         Streamer->newFrame(targetFrame, totalBytes);
     }
@@ -1259,19 +1260,8 @@ int POABase::grabImage(float duration)
 
     if (type == POA_RGB24)
     {
-        uint8_t *dstR = image;
-        uint8_t *dstG = image + subW * subH;
-        uint8_t *dstB = image + subW * subH * 2;
-
-        const uint8_t *src = buffer;
-        const uint8_t *end = buffer + subW * subH * 3;
-
-        while (src != end)
-        {
-            *dstB++ = *src++;
-            *dstG++ = *src++;
-            *dstR++ = *src++;
-        }
+        size_t nPixels = subW * subH;
+        pixelconvert_deinterleave_rgb24(buffer, image, image + nPixels, image + nPixels * 2, nPixels, PIXELCONVERT_ORDER_BGR);
 
         free(buffer);
     }
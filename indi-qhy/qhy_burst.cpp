@@ -0,0 +1,151 @@
+/*
+ QHY Burst Capture
+
+ Copyright (C) 2026 INDI Developers
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qhy_burst.h"
+#include "qhy_gps_header.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+QHYBurstStats QHYBurst::run(FrameRing &ring, size_t depth, size_t frameSize)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const auto timeout = std::chrono::duration<double>(exposure + QHY_BURST_TIMEOUT);
+    // Poll a few times per exposure, but not faster than the USB transfer can deliver
+    const auto pollUS = static_cast<useconds_t>(std::min(std::max(exposure * 250000.0, 100.0), 1000.0));
+    std::vector<uint8_t> discardFrame;
+    QHYBurstStats stats;
+    uint32_t gaps = 0;
+    double gapSum = 0;
+    Clock::time_point first, last;
+    QHYGPSHeader previous;
+
+    ring.allocate(std::min<size_t>(frames, depth), frameSize);
+    std::thread delivery(&QHYBurst::deliverFrames, this, std::ref(ring));
+
+    last = Clock::now();
+    while (stats.captured < frames && (!keepGoing || keepGoing()))
+    {
+        FrameRing::Slot *slot = ring.beginWrite();
+        uint8_t *buffer;
+        size_t size = 0;
+
+        if (slot != nullptr)
+            buffer = slot->data.data();
+        else
+        {
+            discardFrame.resize(frameSize);
+            buffer = discardFrame.data();
+        }
+
+        bool ready = readFrame(buffer, size);
+        auto now = Clock::now();
+
+        if (!ready)
+        {
+            if (now - last > timeout)
+            {
+                stats.timedOut = true;
+                break;
+            }
+
+            usleep(pollUS);
+            continue;
+        }
+
+        QHYGPSHeader header;
+        if (useGPS)
+            decodeGPSHeader(buffer, header);
+
+        if (stats.captured + stats.dropped == 0)
+            first = now;
+        else
+        {
+            // With GPS the dead time between shutter close and the next shutter open is known exactly,
+            // otherwise it is estimated from the frame arrival interval.
+            double gap;
+            if (useGPS)
+                gap = (static_cast<double>(header.start_sec) - previous.end_sec) + (header.start_us - previous.end_us) / 1e6;
+            else
+                gap = std::chrono::duration<double>(now - last).count() - exposure;
+
+            gap = std::max(gap, 0.0);
+            gapSum += gap;
+            stats.gapMax = std::max(stats.gapMax, gap);
+            gaps++;
+        }
+        last = now;
+        previous = header;
+
+        if (slot != nullptr)
+        {
+            slot->size = std::min(size, frameSize);
+            slot->timestamp = now;
+            ring.endWrite();
+            stats.captured++;
+        }
+        else
+            stats.dropped++;
+    }
+
+    if (captureDone)
+        captureDone();
+
+    ring.close();
+    delivery.join();
+    ring.release();
+
+    uint32_t total = stats.captured + stats.dropped;
+    double elapsed = std::chrono::duration<double>(last - first).count();
+    stats.fps = (total > 1 && elapsed > 0) ? (total - 1) / elapsed : 0;
+    stats.gapMean = gaps > 0 ? gapSum / gaps : 0;
+    return stats;
+}
+
+void QHYBurst::deliverFrames(FrameRing &ring)
+{
+    while (true)
+    {
+        // Sample the flag first so frames queued right before close() are still delivered
+        bool closed = ring.isClosed();
+        FrameRing::Slot *slot = ring.beginRead(std::chrono::milliseconds(100));
+
+        if (slot == nullptr)
+        {
+            if (closed)
+                break;
+            continue;
+        }
+
+        if (deliver)
+            deliver(slot->data.data(), slot->size);
+
+        // The slot is free again once delivered, whatever follows can take a while
+        ring.endRead();
+
+        if (delivered)
+            delivered();
+    }
+}
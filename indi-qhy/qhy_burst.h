@@ -0,0 +1,76 @@
+/*
+ QHY Burst Capture
+
+ Copyright (C) 2026 INDI Developers
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#pragma once
+
+#include <pixelconvert_framering.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/* Give up when no live frame arrives for this long past the exposure (s) */
+#define QHY_BURST_TIMEOUT 5
+
+struct QHYBurstStats
+{
+    uint32_t captured = 0;
+    uint32_t dropped = 0;
+    /** Frames per second over the whole burst */
+    double fps = 0;
+    /** Dead time between the end of a frame and the start of the next one (s) */
+    double gapMean = 0;
+    double gapMax = 0;
+    bool timedOut = false;
+};
+
+/**
+ * @brief Captures a burst of live frames back to back through a FrameRing.
+ *
+ * Frames are read on the calling thread and handed to a delivery thread, so a slow
+ * consumer only costs dropped frames and never stalls the camera. The driver and
+ * qhy_video_test both run their bursts through this class.
+ */
+class QHYBurst
+{
+    public:
+        /** Read one live frame into buffer. Returns false when no frame is ready yet */
+        std::function<bool(uint8_t *buffer, size_t &size)> readFrame;
+        /** Return false to stop the burst early */
+        std::function<bool()> keepGoing;
+        /** Called once the last frame was read, while queued frames are still being delivered */
+        std::function<void()> captureDone;
+        /** Called on the delivery thread for each frame. The slot is reused once this returns */
+        std::function<void(const uint8_t *frame, size_t size)> deliver;
+        /** Called on the delivery thread after the slot of a delivered frame was released */
+        std::function<void()> delivered;
+
+        uint32_t frames = 1;
+        /** Exposure of each frame (s) */
+        double exposure = 0;
+        /** Decode the GPS header to measure the gaps between frames exactly */
+        bool useGPS = false;
+
+        /** Run the burst through ring, allocating depth slots of frameSize bytes */
+        QHYBurstStats run(FrameRing &ring, size_t depth, size_t frameSize);
+
+    private:
+        void deliverFrames(FrameRing &ring);
+};
@@ -30,8 +30,12 @@
 #include <math.h>
 #include <memory>
 #include <deque>
+#include <thread>
 
 #define UPDATE_THRESHOLD       0.05   /* Differential temperature threshold (C)*/
+#define STREAM_RING_DEPTH      4      /* Default number of live frames buffered between capture and delivery */
+#define STREAM_STATS_INTERVAL  1000   /* Stream counter and GPS property update interval (ms) */
+#define STREAMING_TAB          "Streaming"
 
 //NB Disable for real driver
 //#define USE_SIMULATION
@@ -207,6 +211,33 @@ bool QHYCCD::initProperties()
     IUFillNumberVector(&HumidityNP, HumidityN, 1, getDeviceName(), "CCD_HUMIDITY", "Humidity", MAIN_CONTROL_TAB,
                        IP_RO, 60, IPS_IDLE);
 
+    // Stream Buffers
+    IUFillNumber(&StreamRingN[0], "STREAM_RING_DEPTH", "Buffers", "%.f", 2, 64, 1, STREAM_RING_DEPTH);
+    IUFillNumberVector(&StreamRingNP, StreamRingN, 1, getDeviceName(), "CCD_STREAM_BUFFERS", "Stream Buffers", STREAMING_TAB,
+                       IP_RW, 60, IPS_IDLE);
+
+    // Stream Stats
+    IUFillNumber(&StreamStatsN[STREAM_CAPTURED], "STREAM_CAPTURED", "Captured", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamStatsN[STREAM_DELIVERED], "STREAM_DELIVERED", "Delivered", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamStatsN[STREAM_DROPPED], "STREAM_DROPPED", "Dropped (ring)", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamStatsN[STREAM_SEQ_GAPS], "STREAM_SEQ_GAPS", "Dropped (camera)", "%.f", 0, 1e12, 0, 0);
+    IUFillNumberVector(&StreamStatsNP, StreamStatsN, 4, getDeviceName(), "CCD_STREAM_STATS", "Stream Stats", STREAMING_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
+    // Burst
+    IUFillNumber(&BurstN[BURST_FRAMES], "BURST_FRAMES", "Frames", "%.f", 1, 100000, 1, 10);
+    IUFillNumber(&BurstN[BURST_EXPOSURE], "BURST_EXPOSURE", "Exposure (s)", "%.6f", 0, 3600, 0.001, 0.01);
+    IUFillNumberVector(&BurstNP, BurstN, 2, getDeviceName(), "CCD_BURST", "Burst", STREAMING_TAB, IP_RW, 60, IPS_IDLE);
+
+    // Burst Stats
+    IUFillNumber(&BurstStatsN[BURST_CAPTURED], "BURST_CAPTURED", "Captured", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&BurstStatsN[BURST_DROPPED], "BURST_DROPPED", "Dropped", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&BurstStatsN[BURST_FPS], "BURST_FPS", "Frames/s", "%.2f", 0, 1e6, 0, 0);
+    IUFillNumber(&BurstStatsN[BURST_GAP_MEAN], "BURST_GAP_MEAN", "Mean gap (ms)", "%.3f", 0, 1e9, 0, 0);
+    IUFillNumber(&BurstStatsN[BURST_GAP_MAX], "BURST_GAP_MAX", "Max gap (ms)", "%.3f", 0, 1e9, 0, 0);
+    IUFillNumberVector(&BurstStatsNP, BurstStatsN, 5, getDeviceName(), "CCD_BURST_STATS", "Burst Stats", STREAMING_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
     // Cooler Mode
     IUFillSwitch(&CoolerModeS[COOLER_AUTOMATIC], "COOLER_AUTOMATIC", "Auto", ISS_ON);
     IUFillSwitch(&CoolerModeS[COOLER_MANUAL], "COOLER_MANUAL", "Manual", ISS_OFF);
@@ -371,6 +402,14 @@ void QHYCCD::ISGetProperties(const char *dev)
 
         defineProperty(&USBBufferNP);
 
+        if (HasStreaming())
+        {
+            defineProperty(&StreamRingNP);
+            defineProperty(&StreamStatsNP);
+            defineProperty(&BurstNP);
+            defineProperty(&BurstStatsNP);
+        }
+
         defineProperty(&SDKVersionTP);
 
         if (HasAmpGlow)
@@ -596,6 +635,14 @@ bool QHYCCD::updateProperties()
 
         defineProperty(&USBBufferNP);
 
+        if (HasStreaming())
+        {
+            defineProperty(&StreamRingNP);
+            defineProperty(&StreamStatsNP);
+            defineProperty(&BurstNP);
+            defineProperty(&BurstStatsNP);
+        }
+
         defineProperty(&SDKVersionTP);
 
         if (HasAmpGlow)
@@ -677,6 +724,14 @@ bool QHYCCD::updateProperties()
 
         deleteProperty(USBBufferNP.name);
 
+        if (HasStreaming())
+        {
+            deleteProperty(StreamRingNP.name);
+            deleteProperty(StreamStatsNP.name);
+            deleteProperty(BurstNP.name);
+            deleteProperty(BurstStatsNP.name);
+        }
+
         deleteProperty(SDKVersionTP.name);
 
         if (HasAmpGlow)
@@ -1417,14 +1472,23 @@ bool QHYCCD::AbortExposure()
     LOG_DEBUG("Aborting camera exposure...");
 
     pthread_mutex_lock(&condMutex);
+    bool burst = m_ThreadRequest == StateBurst || m_ThreadState == StateBurst;
     m_ThreadRequest = StateAbort;
     pthread_cond_signal(&cv);
-    while (m_ThreadState == StateExposure)
+    while (m_ThreadState == StateExposure || m_ThreadState == StateBurst)
     {
         pthread_cond_wait(&cv, &condMutex);
     }
     pthread_mutex_unlock(&condMutex);
 
+    // The burst thread leaves live mode on its own
+    if (burst)
+    {
+        InExposure = false;
+        LOG_INFO("Burst aborted.");
+        return true;
+    }
+
     if (std::string(m_CamID) != "QHY5-M-")
     {
         int rc = CancelQHYCCDExposingAndReadout(m_CameraHandle);
@@ -1555,7 +1619,10 @@ int QHYCCD::grabImage()
         LOG_DEBUG("Download complete.");
 
     if (HasGPS && GPSControlS[INDI_ENABLED].s == ISS_ON)
-        decodeGPSHeader();
+    {
+        decodeGPSHeader(PrimaryCCD.getFrameBuffer(), GPSHeader);
+        updateGPSProperties(GPSHeader);
+    }
 
     ExposureComplete(&PrimaryCCD);
 
@@ -2051,6 +2118,45 @@ bool QHYCCD::ISNewNumber(const char *dev, const char *name, double values[], cha
             return true;
         }
 
+        //////////////////////////////////////////////////////////////////////
+        /// Stream Buffers
+        //////////////////////////////////////////////////////////////////////
+        else if (!strcmp(name, StreamRingNP.name))
+        {
+            if (Streamer->isBusy())
+            {
+                LOG_WARN("Cannot change the number of stream buffers while streaming.");
+                StreamRingNP.s = IPS_ALERT;
+                IDSetNumber(&StreamRingNP, nullptr);
+                return true;
+            }
+
+            IUUpdateNumber(&StreamRingNP, values, names, n);
+            StreamRingNP.s = IPS_OK;
+            IDSetNumber(&StreamRingNP, nullptr);
+            return true;
+        }
+
+        //////////////////////////////////////////////////////////////////////
+        /// Burst
+        //////////////////////////////////////////////////////////////////////
+        else if (!strcmp(name, BurstNP.name))
+        {
+            if (BurstNP.s == IPS_BUSY)
+            {
+                LOG_WARN("A burst is already in progress.");
+                return true;
+            }
+
+            IUUpdateNumber(&BurstNP, values, names, n);
+            if (startBurst(static_cast<uint32_t>(BurstN[BURST_FRAMES].value), BurstN[BURST_EXPOSURE].value))
+                BurstNP.s = IPS_BUSY;
+            else
+                BurstNP.s = IPS_ALERT;
+            IDSetNumber(&BurstNP, nullptr);
+            return true;
+        }
+
         //////////////////////////////////////////////////////////////////////
         /// Read Modes Control
         //////////////////////////////////////////////////////////////////////
@@ -2366,6 +2472,9 @@ bool QHYCCD::saveConfigItems(FILE *fp)
 
     IUSaveConfigNumber(fp, &USBBufferNP);
 
+    if (HasStreaming())
+        IUSaveConfigNumber(fp, &StreamRingNP);
+
     return true;
 }
 
@@ -2379,9 +2488,6 @@ bool QHYCCD::StartStreaming()
     int ret = 0;
     m_ExposureRequest = 1.0 / Streamer->getTargetFPS();
 
-    //NEW CODE - Add support for overscan/calibration area
-    uint32_t subX = (PrimaryCCD.getSubX() + (IgnoreOverscanArea ? effectiveROI.subX : 0)) / PrimaryCCD.getBinX();
-    uint32_t subY = (PrimaryCCD.getSubY() + (IgnoreOverscanArea ? effectiveROI.subY : 0)) / PrimaryCCD.getBinY();
     uint32_t subW = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
     uint32_t subH = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
 
@@ -2392,6 +2498,79 @@ bool QHYCCD::StartStreaming()
         { "RGGB", INDI_BAYER_RGGB }
     };
 
+    if (!setupLiveMode(static_cast<long>(m_ExposureRequest * 950000.0)))
+        return false;
+
+    INDI_PIXEL_FORMAT qhyFormat = INDI_MONO;
+    if (BayerT[2].text && formats.count(BayerT[2].text) != 0)
+        qhyFormat = formats.at(BayerT[2].text);
+
+    ret = SetQHYCCDBitsMode(m_CameraHandle, 8);
+    if (ret == QHYCCD_SUCCESS)
+        Streamer->setPixelFormat(qhyFormat, 8);
+    else
+    {
+        LOG_WARN("SetQHYCCDBitsMode 8bit failed.");
+        Streamer->setPixelFormat(qhyFormat, PrimaryCCD.getBPP());
+    }
+
+    //LOG_INFO("start live mode"); //DEBUG
+
+    LOGF_INFO("Starting video streaming with exposure %.f seconds (%.f FPS), w=%d h=%d", m_ExposureRequest,
+              Streamer->getTargetFPS(), subW, subH);
+
+    // Live frames never exceed the exposure frame buffer the SDK used to write into
+    m_StreamFrameSize = PrimaryCCD.getFrameBufferSize();
+
+    BeginQHYCCDLive(m_CameraHandle);
+    pthread_mutex_lock(&condMutex);
+    m_ThreadRequest = StateStream;
+    pthread_cond_signal(&cv);
+    pthread_mutex_unlock(&condMutex);
+
+    return true;
+}
+
+bool QHYCCD::StopStreaming()
+{
+    pthread_mutex_lock(&condMutex);
+    m_ThreadRequest = StateAbort;
+    pthread_cond_signal(&cv);
+    while (m_ThreadState == StateStream)
+    {
+        pthread_cond_wait(&cv, &condMutex);
+    }
+    pthread_mutex_unlock(&condMutex);
+
+    //LOG_INFO("stopped live mode"); //DEBUG
+
+    //if (HasUSBSpeed)
+    //    SetQHYCCDParam(m_CameraHandle, CONTROL_SPEED, SpeedN[0].value);
+    //if (HasUSBTraffic)
+    //    SetQHYCCDParam(m_CameraHandle, CONTROL_USBTRAFFIC, USBTrafficN[0].value);
+
+    exitLiveMode();
+
+    // Try to set 16bit mode if supported back. Use PrimaryCCD.getBPP as this is what we use to allocate the image buffer.
+    // Instead of doing this here, set the new bitmode when we go into exposure mode out of streaming mode.
+    //SetQHYCCDBitsMode(m_CameraHandle, PrimaryCCD.getBPP());
+    return true;
+}
+
+/*
+ * Switch the camera to live mode with the current binning and ROI. The caller
+ * selects the bit depth and calls BeginQHYCCDLive afterwards.
+ */
+bool QHYCCD::setupLiveMode(double exposureUS)
+{
+    int ret = 0;
+
+    //NEW CODE - Add support for overscan/calibration area
+    uint32_t subX = (PrimaryCCD.getSubX() + (IgnoreOverscanArea ? effectiveROI.subX : 0)) / PrimaryCCD.getBinX();
+    uint32_t subY = (PrimaryCCD.getSubY() + (IgnoreOverscanArea ? effectiveROI.subY : 0)) / PrimaryCCD.getBinY();
+    uint32_t subW = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    uint32_t subH = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+
     // Set Stream Mode and re-initialize camera
     //SetQHYCCDStreamMode(m_CameraHandle, currentQHYStreamMode);
     if (currentQHYStreamMode == 0  && !isSimulation())
@@ -2447,13 +2626,7 @@ bool QHYCCD::StartStreaming()
 
     LOGF_DEBUG("SetQHYCCDResolution x: %d y: %d w: %d h: %d", subX, subY, subW, subH, ret);
 
-    INDI_PIXEL_FORMAT qhyFormat = INDI_MONO;
-    if (BayerT[2].text && formats.count(BayerT[2].text) != 0)
-        qhyFormat = formats.at(BayerT[2].text);
-
-    double uSecs = static_cast<long>(m_ExposureRequest * 950000.0);
-
-    SetQHYCCDParam(m_CameraHandle, CONTROL_EXPOSURE, uSecs);
+    SetQHYCCDParam(m_CameraHandle, CONTROL_EXPOSURE, exposureUS);
 
     if (HasUSBSpeed)
     {
@@ -2469,57 +2642,136 @@ bool QHYCCD::StartStreaming()
             LOG_WARN("SetQHYCCDParam CONTROL_USBTRAFFIC 20.0 failed.");
     }
 
-    ret = SetQHYCCDBitsMode(m_CameraHandle, 8);
-    if (ret == QHYCCD_SUCCESS)
-        Streamer->setPixelFormat(qhyFormat, 8);
-    else
+    return true;
+}
+
+void QHYCCD::exitLiveMode()
+{
+    StopQHYCCDLive(m_CameraHandle);
+
+    currentQHYStreamMode = 0;
+    SetQHYCCDStreamMode(m_CameraHandle, currentQHYStreamMode);
+
+    // FIX: Helps for cleaner teardown and prevents camera from staling
+    InitQHYCCD(m_CameraHandle);
+}
+
+/*
+ * A burst keeps the camera in live mode and captures frames back to back,
+ * avoiding the setup and teardown GetQHYCCDSingleFrame pays for every image.
+ * Frames go through the same ring as video streaming and are sent as
+ * individual FITS images by the delivery thread.
+ */
+bool QHYCCD::startBurst(uint32_t frames, double exposure)
+{
+    if (HasStreaming() && Streamer->isBusy())
     {
-        LOG_WARN("SetQHYCCDBitsMode 8bit failed.");
-        Streamer->setPixelFormat(qhyFormat, PrimaryCCD.getBPP());
+        LOG_ERROR("Cannot start a burst while streaming/recording is active.");
+        return false;
     }
 
-    //LOG_INFO("start live mode"); //DEBUG
+    if (InExposure)
+    {
+        LOG_ERROR("Cannot start a burst while an exposure is in progress.");
+        return false;
+    }
 
-    LOGF_INFO("Starting video streaming with exposure %.f seconds (%.f FPS), w=%d h=%d", m_ExposureRequest,
-              Streamer->getTargetFPS(), subW, subH);
+    if (frames == 0)
+        return false;
+
+    if (!setupLiveMode(static_cast<long>(exposure * 1000000.0)))
+        return false;
+
+    if (SetQHYCCDBitsMode(m_CameraHandle, PrimaryCCD.getBPP()) != QHYCCD_SUCCESS)
+        LOGF_WARN("SetQHYCCDBitsMode %dbit failed.", PrimaryCCD.getBPP());
+
+    m_BurstFrames = frames;
+    m_BurstExposure = exposure;
+    m_StreamFrameSize = PrimaryCCD.getFrameBufferSize();
+
+    LOGF_INFO("Starting burst of %u frames with exposure %.6f seconds.", frames, exposure);
+
+    InExposure = true;
     BeginQHYCCDLive(m_CameraHandle);
     pthread_mutex_lock(&condMutex);
-    m_ThreadRequest = StateStream;
+    m_ThreadRequest = StateBurst;
     pthread_cond_signal(&cv);
     pthread_mutex_unlock(&condMutex);
 
     return true;
 }
 
-bool QHYCCD::StopStreaming()
+void QHYCCD::captureBurst()
 {
-    pthread_mutex_lock(&condMutex);
-    m_ThreadRequest = StateAbort;
-    pthread_cond_signal(&cv);
-    while (m_ThreadState == StateStream)
-    {
-        pthread_cond_wait(&cv, &condMutex);
-    }
-    pthread_mutex_unlock(&condMutex);
-    StopQHYCCDLive(m_CameraHandle);
+    const bool useGPS = HasGPS && GPSControlS[INDI_ENABLED].s == ISS_ON;
+    QHYBurst burst;
 
-    //LOG_INFO("stopped live mode"); //DEBUG
+    burst.frames = m_BurstFrames;
+    burst.exposure = m_BurstExposure;
+    burst.useGPS = useGPS;
+    burst.readFrame = [this](uint8_t *buffer, size_t &size)
+    {
+        uint32_t w, h, bpp, channels;
+        if (GetQHYCCDLiveFrame(m_CameraHandle, &w, &h, &bpp, &channels, buffer) != QHYCCD_SUCCESS)
+            return false;
+        size = w * h * bpp / 8 * channels;
+        return true;
+    };
+    burst.keepGoing = [this]()
+    {
+        pthread_mutex_lock(&condMutex);
+        bool burstRequested = m_ThreadRequest == StateBurst;
+        pthread_mutex_unlock(&condMutex);
+        return burstRequested;
+    };
+    burst.captureDone = [this]()
+    {
+        exitLiveMode();
+    };
+    burst.deliver = [this, useGPS](const uint8_t *frame, size_t size)
+    {
+        std::unique_lock<std::mutex> guard(ccdBufferLock);
+        memcpy(PrimaryCCD.getFrameBuffer(), frame, std::min(size, static_cast<size_t>(PrimaryCCD.getFrameBufferSize())));
+        guard.unlock();
 
-    //if (HasUSBSpeed)
-    //    SetQHYCCDParam(m_CameraHandle, CONTROL_SPEED, SpeedN[0].value);
-    //if (HasUSBTraffic)
-    //    SetQHYCCDParam(m_CameraHandle, CONTROL_USBTRAFFIC, USBTrafficN[0].value);
+        // The GPS header is part of the frame, so it is decoded again from the slot
+        if (useGPS)
+        {
+            decodeGPSHeader(frame, GPSHeader);
+            updateGPSProperties(GPSHeader);
+        }
+    };
+    burst.delivered = [this]()
+    {
+        PrimaryCCD.setExposureDuration(m_BurstExposure);
+        ExposureComplete(&PrimaryCCD);
+    };
 
-    currentQHYStreamMode = 0;
-    SetQHYCCDStreamMode(m_CameraHandle, currentQHYStreamMode);
+    pthread_mutex_unlock(&condMutex);
+    QHYBurstStats stats = burst.run(m_FrameRing, static_cast<size_t>(StreamRingN[0].value), m_StreamFrameSize);
+
+    BurstStatsN[BURST_CAPTURED].value = stats.captured;
+    BurstStatsN[BURST_DROPPED].value = stats.dropped;
+    BurstStatsN[BURST_FPS].value = stats.fps;
+    BurstStatsN[BURST_GAP_MEAN].value = stats.gapMean * 1000.0;
+    BurstStatsN[BURST_GAP_MAX].value = stats.gapMax * 1000.0;
+    BurstStatsNP.s = IPS_OK;
+    IDSetNumber(&BurstStatsNP, nullptr);
+
+    if (stats.timedOut)
+        LOGF_ERROR("Burst timed out waiting for frame %u.", stats.captured + 1);
+    else
+        LOGF_INFO("Burst complete: %u frames at %.2f FPS, inter-frame gap mean %.3f ms max %.3f ms, %u dropped.",
+                  stats.captured, BurstStatsN[BURST_FPS].value, BurstStatsN[BURST_GAP_MEAN].value,
+                  BurstStatsN[BURST_GAP_MAX].value, stats.dropped);
 
-    // FIX: Helps for cleaner teardown and prevents camera from staling
-    InitQHYCCD(m_CameraHandle);
+    InExposure = false;
+    BurstNP.s = stats.captured == m_BurstFrames ? IPS_OK : IPS_ALERT;
+    IDSetNumber(&BurstNP, nullptr);
 
-    // Try to set 16bit mode if supported back. Use PrimaryCCD.getBPP as this is what we use to allocate the image buffer.
-    // Instead of doing this here, set the new bitmode when we go into exposure mode out of streaming mode.
-    //SetQHYCCDBitsMode(m_CameraHandle, PrimaryCCD.getBPP());
-    return true;
+    pthread_mutex_lock(&condMutex);
+    if (m_ThreadRequest == StateBurst)
+        m_ThreadRequest = StateIdle;
 }
 
 void *QHYCCD::imagingHelper(void *context)
@@ -2553,6 +2805,10 @@ void *QHYCCD::imagingThreadEntry()
         {
             streamVideo();
         }
+        else if (m_ThreadRequest == StateBurst)
+        {
+            captureBurst();
+        }
         else if (m_ThreadRequest == StateRestartExposure)
         {
             m_ThreadRequest = StateIdle;
@@ -2578,46 +2834,139 @@ void *QHYCCD::imagingThreadEntry()
     return nullptr;
 }
 
+/*
+ * Live frames are read into a ring of pre-allocated slots on the imaging
+ * thread and handed to the streamer from a separate delivery thread, so a
+ * slow recorder or encoder never holds up GetQHYCCDLiveFrame. The GPS header
+ * is read from the frame itself, so it always matches the frame delivered.
+ */
 void QHYCCD::streamVideo()
 {
     uint32_t ret = 0, w, h, bpp, channels;
-    //uint32_t t_start = time(NULL), frames = 0;
+    const bool useGPS = HasGPS && GPSControlS[INDI_ENABLED].s == ISS_ON;
+    // Frames read while the ring is full land here so the SDK keeps draining
+    std::vector<uint8_t> discardFrame;
+    bool haveSeqNumber = false;
+    uint32_t lastSeqNumber = 0;
+
+    m_FrameRing.allocate(static_cast<size_t>(StreamRingN[0].value), m_StreamFrameSize);
+    m_StreamCaptured = m_StreamDelivered = m_StreamDropped = m_StreamSeqGaps = 0;
+    StreamStatsNP.s = IPS_BUSY;
+    updateStreamStats();
+
+    std::thread delivery(&QHYCCD::deliverVideo, this, useGPS);
+
     while (m_ThreadRequest == StateStream)
     {
         pthread_mutex_unlock(&condMutex);
         uint32_t retries = 0;
-        std::unique_lock<std::mutex> guard(ccdBufferLock);
-        uint8_t *buffer = PrimaryCCD.getFrameBuffer();
-        while (retries++ < 10)
+        FrameRing::Slot *slot = m_FrameRing.beginWrite();
+        uint8_t *buffer;
+
+        if (slot != nullptr)
+            buffer = slot->data.data();
+        else
         {
+            discardFrame.resize(m_StreamFrameSize);
+            buffer = discardFrame.data();
+        }
 
+        while (retries++ < 10)
+        {
             ret = GetQHYCCDLiveFrame(m_CameraHandle, &w, &h, &bpp, &channels, buffer);
             if (ret == QHYCCD_ERROR)
                 usleep(1000);
             else
                 break;
         }
-        guard.unlock();
+
         if (ret == QHYCCD_SUCCESS)
+        {
+            m_StreamCaptured++;
+
+            QHYGPSHeader header;
+            if (useGPS)
+            {
+                decodeGPSHeader(buffer, header);
+                // The camera numbers every frame it exposes, so a jump means the SDK lost frames before we saw them
+                if (haveSeqNumber && header.seqNumber > lastSeqNumber + 1)
+                    m_StreamSeqGaps += header.seqNumber - lastSeqNumber - 1;
+                haveSeqNumber = true;
+                lastSeqNumber = header.seqNumber;
+            }
+
+            if (slot != nullptr)
+            {
+                slot->size = w * h * bpp / 8 * channels;
+                slot->timestamp = std::chrono::steady_clock::now();
+                m_FrameRing.endWrite();
+            }
+            else
+                m_StreamDropped++;
+        }
+        pthread_mutex_lock(&condMutex);
+    }
+
+    m_FrameRing.close();
+    delivery.join();
+    m_FrameRing.release();
+
+    StreamStatsNP.s = IPS_OK;
+    updateStreamStats();
+}
+
+void QHYCCD::deliverVideo(bool useGPS)
+{
+    const auto statsInterval = std::chrono::milliseconds(STREAM_STATS_INTERVAL);
+    auto lastStats = std::chrono::steady_clock::now();
+    bool haveGPS = false;
+
+    while (true)
+    {
+        // Sample the flag first so frames queued right before close() are still delivered
+        bool closed = m_FrameRing.isClosed();
+        FrameRing::Slot *slot = m_FrameRing.beginRead(statsInterval);
+
+        if (slot != nullptr)
         {
             uint64_t timestamp = 0;
-            if (HasGPS && GPSControlS[INDI_ENABLED].s == ISS_ON)
+            if (useGPS)
             {
-                decodeGPSHeader();
+                decodeGPSHeader(slot->data.data(), GPSHeader);
                 timestamp = (uint64_t)GPSHeader.start_sec * 1e6;
                 timestamp += GPSHeader.start_us + QHY_SER_US_EPOCH;
+                haveGPS = true;
             }
 
-            Streamer->newFrame(buffer, w * h * bpp / 8 * channels, timestamp);
+            Streamer->newFrame(slot->data.data(), slot->size, timestamp);
+            m_FrameRing.endRead();
+            m_StreamDelivered++;
+        }
+        else if (closed)
+            break;
 
-            //DEBUG
-            //if(!frames)
-            //    LOGF_DEBUG("Receiving frames ...");
-            //if(!(++frames % 30))
-            //    LOGF_DEBUG("Frames received: %d (%.1f fps)", frames, 1.0 * frames / (time(NULL) - t_start));
+        // Publishing the GPS properties for every frame would flood clients at high frame rates
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastStats >= statsInterval)
+        {
+            lastStats = now;
+            updateStreamStats();
+            if (haveGPS)
+                updateGPSProperties(GPSHeader);
         }
-        pthread_mutex_lock(&condMutex);
     }
+
+    if (haveGPS)
+        updateGPSProperties(GPSHeader);
+}
+
+void QHYCCD::updateStreamStats()
+{
+    StreamStatsN[STREAM_CAPTURED].value = m_StreamCaptured;
+    StreamStatsN[STREAM_DELIVERED].value = m_StreamDelivered;
+    StreamStatsN[STREAM_DROPPED].value = m_StreamDropped;
+    StreamStatsN[STREAM_SEQ_GAPS].value = m_StreamSeqGaps;
+    IDSetNumber(&StreamStatsNP, nullptr);
 }
 
 void QHYCCD::getExposure()
@@ -2829,121 +3178,86 @@ void QHYCCD::setLEDStartPosNP(const INumberVectorProperty &value)
     GPSLEDStartPosNP = value;
 }
 
-void QHYCCD::decodeGPSHeader()
+void QHYCCD::updateGPSProperties(const QHYGPSHeader &header)
 {
     char ts[64] = {0}, iso8601[64] = {0}, data[64] = {0};
 
-    uint8_t gpsarray[64] = {0};
-    memcpy(gpsarray, PrimaryCCD.getFrameBuffer(), 64);
-
     // Sequence Number
-    GPSHeader.seqNumber = gpsarray[0] << 24 | gpsarray[1] << 16 | gpsarray[2] << 8 | gpsarray[3];
-    snprintf(data, 64, "%u", GPSHeader.seqNumber);
+    snprintf(data, 64, "%u", header.seqNumber);
     IUSaveText(&GPSDataHeaderT[GPS_DATA_SEQ_NUMBER], data);
 
-    GPSHeader.tempNumber = gpsarray[4];
-
     // Width
-    GPSHeader.width = gpsarray[5] << 8 | gpsarray[6];
-    snprintf(data, 64, "%u", GPSHeader.width);
+    snprintf(data, 64, "%u", header.width);
     IUSaveText(&GPSDataHeaderT[GPS_DATA_WIDTH], data);
 
     // Height
-    GPSHeader.height = gpsarray[7] << 8 | gpsarray[8];
-    snprintf(data, 64, "%u", GPSHeader.height);
+    snprintf(data, 64, "%u", header.height);
     IUSaveText(&GPSDataHeaderT[GPS_DATA_HEIGHT], data);
 
     // Latitude
-    uint32_t latitude = gpsarray[9] << 24 | gpsarray[10] << 16 | gpsarray[11] << 8 | gpsarray[12];
-    // convert SDDMMMMMMM to DD.DDDDDDD
-    GPSHeader.latitude = (latitude % 1000000000) / 10000000;
-    GPSHeader.latitude += (latitude % 10000000) / 6000000.0;
-    GPSHeader.latitude *= latitude > 1000000000 ? -1.0 : 1.0;
-    snprintf(data, 64, "%f", GPSHeader.latitude);
+    snprintf(data, 64, "%f", header.latitude);
     IUSaveText(&GPSDataHeaderT[GPS_DATA_LATITUDE], data);
 
     // Longitude
-    uint32_t longitude = gpsarray[13] << 24 | gpsarray[14] << 16 | gpsarray[15] << 8 | gpsarray[16];
-    // convert SDDDMMMMMM to DDD.DDDDDDD
-    GPSHeader.longitude = (longitude % 1000000000) / 1000000;
-    GPSHeader.longitude += (longitude % 1000000) / 600000.0;
-    GPSHeader.longitude *= longitude > 1000000000 ? -1.0 : 1.0;
-    snprintf(data, 64, "%f", GPSHeader.longitude);
+    snprintf(data, 64, "%f", header.longitude);
     IUSaveText(&GPSDataHeaderT[GPS_DATA_LONGITUDE], data);
 
     // Start Flag
-    GPSHeader.start_flag = gpsarray[17];
-    snprintf(data, 64, "%u", GPSHeader.start_flag);
+    snprintf(data, 64, "%u", header.start_flag);
     IUSaveText(&GPSDataStartT[GPS_DATA_START_FLAG], data);
 
     // Start Seconds
-    GPSHeader.start_sec = gpsarray[18] << 24 | gpsarray[19] << 16 | gpsarray[20] << 8 | gpsarray[21];
-    snprintf(data, 64, "%u", GPSHeader.start_sec);
+    snprintf(data, 64, "%u", header.start_sec);
     IUSaveText(&GPSDataStartT[GPS_DATA_START_SEC], data);
 
     // Start microseconds
-    // It's a 10Mhz crystal so we divide by 10 to get microseconds
-    GPSHeader.start_us = (gpsarray[22] << 16 | gpsarray[23] << 8 | gpsarray[24]) / 10.0;
-    snprintf(data, 64, "%.1f", GPSHeader.start_us);
+    snprintf(data, 64, "%.1f", header.start_us);
     IUSaveText(&GPSDataStartT[GPS_DATA_START_USEC], data);
 
-    // Start JD
-    GPSHeader.start_jd = JStoJD(GPSHeader.start_sec, GPSHeader.start_us);
     // Get ISO8601
-    JDtoISO8601(GPSHeader.start_jd, iso8601);
+    JDtoISO8601(header.start_jd, iso8601);
     // Add millisecond
-    snprintf(ts, sizeof(ts), "%s.%03d", iso8601, static_cast<int>(GPSHeader.start_us / 1000.0));
+    snprintf(ts, sizeof(ts), "%s.%03d", iso8601, static_cast<int>(header.start_us / 1000.0));
     IUSaveText(&GPSDataStartT[GPS_DATA_START_TS], ts);
 
     // End Flag
-    GPSHeader.end_flag = gpsarray[25];
-    snprintf(data, 64, "%u", GPSHeader.end_flag);
+    snprintf(data, 64, "%u", header.end_flag);
     IUSaveText(&GPSDataEndT[GPS_DATA_END_FLAG], data);
 
     // End Seconds
-    GPSHeader.end_sec = gpsarray[26] << 24 | gpsarray[27] << 16 | gpsarray[28] << 8 | gpsarray[29];
-    snprintf(data, 64, "%u", GPSHeader.end_sec);
+    snprintf(data, 64, "%u", header.end_sec);
     IUSaveText(&GPSDataEndT[GPS_DATA_END_SEC], data);
 
     // End Microseconds
-    GPSHeader.end_us = (gpsarray[30] << 16 | gpsarray[31] << 8 | gpsarray[32]) / 10.0;
-    snprintf(data, 64, "%.1f", GPSHeader.end_us);
+    snprintf(data, 64, "%.1f", header.end_us);
     IUSaveText(&GPSDataEndT[GPS_DATA_END_USEC], data);
 
-    // End JD
-    GPSHeader.end_jd = JStoJD(GPSHeader.end_sec, GPSHeader.end_us);
     // Get ISO8601
-    JDtoISO8601(GPSHeader.end_jd, iso8601);
+    JDtoISO8601(header.end_jd, iso8601);
     // Add millisecond
-    snprintf(ts, sizeof(ts), "%s.%03d", iso8601, static_cast<int>(GPSHeader.end_us / 1000.0));
+    snprintf(ts, sizeof(ts), "%s.%03d", iso8601, static_cast<int>(header.end_us / 1000.0));
     IUSaveText(&GPSDataEndT[GPS_DATA_END_TS], ts);
 
     // Now Flag
-    GPSHeader.now_flag = gpsarray[33];
-    snprintf(data, 64, "%u", GPSHeader.now_flag);
+    snprintf(data, 64, "%u", header.now_flag);
     IUSaveText(&GPSDataNowT[GPS_DATA_NOW_FLAG], data);
 
     // Now Seconds
-    GPSHeader.now_sec = gpsarray[34] << 24 | gpsarray[35] << 16 | gpsarray[36] << 8 | gpsarray[37];
-    snprintf(data, 64, "%u", GPSHeader.now_sec);
+    snprintf(data, 64, "%u", header.now_sec);
     IUSaveText(&GPSDataNowT[GPS_DATA_NOW_SEC], data);
 
     // Now microseconds
-    GPSHeader.now_us = (gpsarray[38] << 16 | gpsarray[39] << 8 | gpsarray[40]) / 10.0;
-    snprintf(data, 64, "%.1f", GPSHeader.now_us);
+    snprintf(data, 64, "%.1f", header.now_us);
     IUSaveText(&GPSDataNowT[GPS_DATA_NOW_USEC], data);
 
-    // Now JD
-    GPSHeader.now_jd = JStoJD(GPSHeader.now_sec, GPSHeader.now_us);
     // Get ISO8601
-    JDtoISO8601(GPSHeader.now_jd, iso8601);
+    JDtoISO8601(header.now_jd, iso8601);
     // Add millisecond
-    snprintf(ts, sizeof(ts), "%s.%03d", iso8601, static_cast<int>(GPSHeader.now_us / 1000.0));
+    snprintf(ts, sizeof(ts), "%s.%03d", iso8601, static_cast<int>(header.now_us / 1000.0));
     IUSaveText(&GPSDataNowT[GPS_DATA_NOW_TS], ts);
 
     // PPS
-    GPSHeader.max_clock = gpsarray[41] << 16 | gpsarray[42] << 8 | gpsarray[43];
-    snprintf(data, 64, "%u", GPSHeader.max_clock);
+    snprintf(data, 64, "%u", header.max_clock);
     IUSaveText(&GPSDataHeaderT[GPS_DATA_MAX_CLOCK], data);
 
     IDSetText(&GPSDataHeaderTP, nullptr);
@@ -2951,7 +3265,10 @@ void QHYCCD::decodeGPSHeader()
     IDSetText(&GPSDataEndTP, nullptr);
     IDSetText(&GPSDataNowTP, nullptr);
 
-    GPSState newGPState = static_cast<GPSState>((GPSHeader.now_flag & 0xF0) >> 4);
+    if (header.gps_status > GPS_LOCKED)
+        return;
+
+    GPSState newGPState = static_cast<GPSState>(header.gps_status);
     if (GPSStateL[newGPState].s == IPS_IDLE)
     {
         GPSStateL[GPS_ON].s = IPS_IDLE;
@@ -2965,14 +3282,6 @@ void QHYCCD::decodeGPSHeader()
     }
 }
 
-double QHYCCD::JStoJD(uint32_t JS, double us)
-{
-    // Convert Julian seconds (plus microsecond) to Julian Days since epoch 2450000
-    // Since this is why QHY apparently uses as the basis.
-    // The 0.5 is added there since JD starts from MID day of the previous day
-    return (JS + us / 1e6) / (3600 * 24) + 2450000.5;
-}
-
 void QHYCCD::JDtoISO8601(double JD, char *iso8601)
 {
     struct tm *tp = nullptr;
@@ -21,10 +21,15 @@
 
 #pragma once
 
+#include "qhy_burst.h"
+#include "qhy_gps_header.h"
+
 #include <qhyccd.h>
+#include <pixelconvert_framering.h>
 #include <indiccd.h>
 #include <indifilterinterface.h>
 #include <unistd.h>
+#include <atomic>
 #include <functional>
 #include <pthread.h>
 
@@ -179,6 +184,46 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         // Humidity Readout
         INumber HumidityN[1];
         INumberVectorProperty HumidityNP;
+
+        /////////////////////////////////////////////////////////////////////////////
+        /// Properties: Streaming
+        /////////////////////////////////////////////////////////////////////////////
+        // Number of live frames buffered between capture and delivery
+        INumber StreamRingN[1];
+        INumberVectorProperty StreamRingNP;
+
+        // Live frame counters
+        INumber StreamStatsN[4];
+        INumberVectorProperty StreamStatsNP;
+        enum
+        {
+            STREAM_CAPTURED,
+            STREAM_DELIVERED,
+            STREAM_DROPPED,
+            STREAM_SEQ_GAPS,
+        };
+
+        // Burst: capture a number of frames back to back in live mode
+        INumber BurstN[2];
+        INumberVectorProperty BurstNP;
+        enum
+        {
+            BURST_FRAMES,
+            BURST_EXPOSURE,
+        };
+
+        // Burst results
+        INumber BurstStatsN[5];
+        INumberVectorProperty BurstStatsNP;
+        enum
+        {
+            BURST_CAPTURED,
+            BURST_DROPPED,
+            BURST_FPS,
+            BURST_GAP_MEAN,
+            BURST_GAP_MAX,
+        };
+
         /////////////////////////////////////////////////////////////////////////////
         /// Properties: Utility Controls
         /////////////////////////////////////////////////////////////////////////////
@@ -301,6 +346,7 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
             StateStream,
             StateExposure,
             StateRestartExposure,
+            StateBurst,
             StateAbort,
             StateTerminate,
             StateTerminated
@@ -330,48 +376,7 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
             GPS_LOCKED
         } GPSState;
 
-        struct
-        {
-            // Sequences
-            uint32_t seqNumber = 0;
-            uint32_t seqNumber_old = 0;
-            uint8_t tempNumber = 0;
-
-            // Dimension
-            uint16_t width = 0;
-            uint16_t height = 0;
-
-            // Location
-            double latitude = 0;
-            double longitude = 0;
-
-            // Start Time
-            uint8_t start_flag = 0;
-            uint32_t start_sec = 0;
-            double start_us = 0;
-            double start_jd = 0;
-            char start_js_ts[MAXINDIDEVICE] = {0};
-
-            // End Time
-            uint8_t end_flag = 0;
-            uint32_t end_sec = 0;
-            double end_us = 0;
-            double end_jd = 0;
-            char end_js_ts[MAXINDIDEVICE] = {0};
-
-            // Now time
-            uint8_t now_flag = 0;
-            uint32_t now_sec = 0;
-            double now_us = 0;
-            double now_jd = 0;
-            char now_js_ts[MAXINDIDEVICE] = {0};
-
-            // Clock
-            uint32_t max_clock = 0;
-
-            // GPS Status
-            GPSState gps_status = GPS_ON;
-        } GPSHeader;
+        QHYGPSHeader GPSHeader;
 
         struct
         {
@@ -389,6 +394,12 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         static void *imagingHelper(void *context);
         void *imagingThreadEntry();
         void streamVideo();
+        void deliverVideo(bool useGPS);
+        void updateStreamStats();
+        bool setupLiveMode(double exposureUS);
+        void exitLiveMode();
+        bool startBurst(uint32_t frames, double exposure);
+        void captureBurst();
         void getExposure();
         void exposureSetRequest(ImageState request);
         int grabImage();
@@ -414,15 +425,8 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         bool isQHY5PIIC();
         // Call when max filter count is known
         bool updateFilterProperties();
-        // Decode GPS Header
-        void decodeGPSHeader();
-        /**
-         * @brief JStoJD Convert Julian Second to Julian Date
-         * @param JS Julian Second
-         * @param us microsends
-         * @return Julian Date
-         */
-        double JStoJD(uint32_t JS, double us);
+        // Publish a decoded GPS Header to the GPS Data properties
+        void updateGPSProperties(const QHYGPSHeader &header);
         void JDtoISO8601(double JD, char *iso8601);
 
         /////////////////////////////////////////////////////////////////////////////
@@ -489,6 +493,18 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         pthread_cond_t cv         = PTHREAD_COND_INITIALIZER;
         pthread_mutex_t condMutex = PTHREAD_MUTEX_INITIALIZER;
 
+        // Live frames travel from the imaging thread to the delivery thread through this ring
+        FrameRing m_FrameRing;
+        // Bytes of each live frame slot
+        size_t m_StreamFrameSize {0};
+        std::atomic<uint32_t> m_StreamCaptured {0};
+        std::atomic<uint32_t> m_StreamDelivered {0};
+        std::atomic<uint32_t> m_StreamDropped {0};
+        std::atomic<uint32_t> m_StreamSeqGaps {0};
+        // Requested burst frames and exposure (s)
+        uint32_t m_BurstFrames {0};
+        double m_BurstExposure {0};
+
         void logQHYMessages(const std::string &message);
         std::function<void(const std::string &)> m_QHYLogCallback;
 
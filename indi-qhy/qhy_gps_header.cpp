@@ -0,0 +1,93 @@
+/*
+ QHY GPS Frame Header
+
+ Copyright (C) 2026 INDI Developers
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qhy_gps_header.h"
+
+void decodeGPSHeader(const uint8_t *gpsarray, QHYGPSHeader &header)
+{
+    // Sequence Number
+    header.seqNumber = gpsarray[0] << 24 | gpsarray[1] << 16 | gpsarray[2] << 8 | gpsarray[3];
+
+    header.tempNumber = gpsarray[4];
+
+    // Width
+    header.width = gpsarray[5] << 8 | gpsarray[6];
+
+    // Height
+    header.height = gpsarray[7] << 8 | gpsarray[8];
+
+    // Latitude
+    uint32_t latitude = gpsarray[9] << 24 | gpsarray[10] << 16 | gpsarray[11] << 8 | gpsarray[12];
+    // convert SDDMMMMMMM to DD.DDDDDDD
+    header.latitude = (latitude % 1000000000) / 10000000;
+    header.latitude += (latitude % 10000000) / 6000000.0;
+    header.latitude *= latitude > 1000000000 ? -1.0 : 1.0;
+
+    // Longitude
+    uint32_t longitude = gpsarray[13] << 24 | gpsarray[14] << 16 | gpsarray[15] << 8 | gpsarray[16];
+    // convert SDDDMMMMMM to DDD.DDDDDDD
+    header.longitude = (longitude % 1000000000) / 1000000;
+    header.longitude += (longitude % 1000000) / 600000.0;
+    header.longitude *= longitude > 1000000000 ? -1.0 : 1.0;
+
+    // Start Flag
+    header.start_flag = gpsarray[17];
+
+    // Start Seconds
+    header.start_sec = gpsarray[18] << 24 | gpsarray[19] << 16 | gpsarray[20] << 8 | gpsarray[21];
+
+    // Start microseconds
+    // It's a 10Mhz crystal so we divide by 10 to get microseconds
+    header.start_us = (gpsarray[22] << 16 | gpsarray[23] << 8 | gpsarray[24]) / 10.0;
+    header.start_jd = JStoJD(header.start_sec, header.start_us);
+
+    // End Flag
+    header.end_flag = gpsarray[25];
+
+    // End Seconds
+    header.end_sec = gpsarray[26] << 24 | gpsarray[27] << 16 | gpsarray[28] << 8 | gpsarray[29];
+
+    // End Microseconds
+    header.end_us = (gpsarray[30] << 16 | gpsarray[31] << 8 | gpsarray[32]) / 10.0;
+    header.end_jd = JStoJD(header.end_sec, header.end_us);
+
+    // Now Flag
+    header.now_flag = gpsarray[33];
+
+    // Now Seconds
+    header.now_sec = gpsarray[34] << 24 | gpsarray[35] << 16 | gpsarray[36] << 8 | gpsarray[37];
+
+    // Now microseconds
+    header.now_us = (gpsarray[38] << 16 | gpsarray[39] << 8 | gpsarray[40]) / 10.0;
+    header.now_jd = JStoJD(header.now_sec, header.now_us);
+
+    // PPS
+    header.max_clock = gpsarray[41] << 16 | gpsarray[42] << 8 | gpsarray[43];
+
+    header.gps_status = (header.now_flag & 0xF0) >> 4;
+}
+
+double JStoJD(uint32_t JS, double us)
+{
+    // Convert Julian seconds (plus microsecond) to Julian Days since epoch 2450000
+    // Since this is why QHY apparently uses as the basis.
+    // The 0.5 is added there since JD starts from MID day of the previous day
+    return (JS + us / 1e6) / (3600 * 24) + 2450000.5;
+}
@@ -0,0 +1,80 @@
+/*
+ QHY GPS Frame Header
+
+ Copyright (C) 2026 INDI Developers
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/* Size of the GPS header QHY cameras write over the first bytes of every frame */
+#define QHY_GPS_HEADER_SIZE 64
+
+struct QHYGPSHeader
+{
+    // Sequences
+    uint32_t seqNumber = 0;
+    uint8_t tempNumber = 0;
+
+    // Dimension
+    uint16_t width = 0;
+    uint16_t height = 0;
+
+    // Location
+    double latitude = 0;
+    double longitude = 0;
+
+    // Start Time
+    uint8_t start_flag = 0;
+    uint32_t start_sec = 0;
+    double start_us = 0;
+    double start_jd = 0;
+
+    // End Time
+    uint8_t end_flag = 0;
+    uint32_t end_sec = 0;
+    double end_us = 0;
+    double end_jd = 0;
+
+    // Now time
+    uint8_t now_flag = 0;
+    uint32_t now_sec = 0;
+    double now_us = 0;
+    double now_jd = 0;
+
+    // Clock
+    uint32_t max_clock = 0;
+
+    // GPS Status (upper nibble of now_flag)
+    uint8_t gps_status = 0;
+};
+
+/**
+ * @brief decodeGPSHeader Parse the GPS header at the start of a frame.
+ * @param frame frame as returned by the SDK, at least QHY_GPS_HEADER_SIZE bytes.
+ * @param header receives the decoded fields.
+ */
+void decodeGPSHeader(const uint8_t *frame, QHYGPSHeader &header);
+
+/**
+ * @brief JStoJD Convert Julian Second to Julian Date
+ * @param JS Julian Second
+ * @param us microsends
+ * @return Julian Date
+ */
+double JStoJD(uint32_t JS, double us);
@@ -26,9 +26,14 @@
 #include <string.h>
 #include <qhyccd.h>
 
+#include "qhy_burst.h"
+
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 
 #define VERSION 1.00
 
@@ -65,13 +70,72 @@ int videoThread(qhyccd_handle *pCamHandle, unsigned char *pImgData)
     return 0;
 }
 
-int main(int, char **)
+/*
+ * Burst benchmark: run a burst through QHYBurst, the capture and delivery code of the
+ * driver's burst mode, with the same ring depth and a delivery that copies every frame
+ * into an image buffer like the driver does. Reports the achieved frame rate and the
+ * dead time between frames.
+ */
+int burstBenchmark(qhyccd_handle *pCamHandle, uint32_t length, int frames, int exposureUS)
+{
+    using Clock = std::chrono::steady_clock;
+    const size_t RING_DEPTH = 4;
+    uint32_t w = 0, h = 0, bpp = 0, channels = 0;
+    std::vector<unsigned char> image(length);
+    uint32_t delivered = 0;
+    FrameRing ring;
+    QHYBurst burst;
+
+    fprintf(stderr, "Burst: %d frames, exposure %d us\n", frames, exposureUS);
+
+    burst.frames = frames;
+    burst.exposure = exposureUS / 1e6;
+    burst.readFrame = [&](uint8_t *buffer, size_t &size)
+    {
+        if (GetQHYCCDLiveFrame(pCamHandle, &w, &h, &bpp, &channels, buffer) != QHYCCD_SUCCESS)
+            return false;
+        size = w * h * bpp / 8 * channels;
+        return true;
+    };
+    burst.deliver = [&](const uint8_t *frame, size_t size)
+    {
+        memcpy(image.data(), frame, std::min<size_t>(size, image.size()));
+    };
+    burst.delivered = [&]()
+    {
+        delivered++;
+    };
+
+    auto start = Clock::now();
+    QHYBurstStats stats = burst.run(ring, RING_DEPTH, length);
+    double total = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (stats.timedOut)
+        fprintf(stderr, "Burst: timed out waiting for frame %u\n", stats.captured + 1);
+    if (stats.captured + stats.dropped < 2)
+    {
+        fprintf(stderr, "Burst: only %u frames received\n", stats.captured + stats.dropped);
+        return 1;
+    }
+
+    double exposure = exposureUS / 1e6;
+
+    fprintf(stderr, "Burst: %u frames %dx%d %d-bit in %.3f seconds, %u delivered, %u dropped\n",
+            stats.captured, w, h, bpp, total, delivered, stats.dropped);
+    fprintf(stderr, "Burst: %.2f FPS (exposure limit %.2f FPS)\n", stats.fps, 1.0 / std::max(exposure, 1e-6));
+    fprintf(stderr, "Burst: gap mean %.3f ms max %.3f ms\n", stats.gapMean * 1000, stats.gapMax * 1000);
+
+    return static_cast<int>(delivered) == frames ? 0 : 1;
+}
+
+int main(int argc, char **argv)
 {
     int USB_TRAFFIC = 20;
     int USB_SPEED = 2;
     int CHIP_GAIN = 1;
     int CHIP_OFFSET = 180;
     int EXPOSURE_TIME = 1;
+    int BURST_FRAMES = 0;
     int camBinX = 1;
     int camBinY = 1;
 
@@ -107,6 +171,23 @@ int main(int, char **)
 
     fprintf(stderr, "QHY Video Test using VideoFrameMode, Version: %.2f\n", VERSION);
 
+    int opt;
+    while ((opt = getopt(argc, argv, "n:e:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                BURST_FRAMES = atoi(optarg);
+                break;
+            case 'e':
+                EXPOSURE_TIME = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n burst frames] [-e exposure (us)]\n", argv[0]);
+                return 1;
+        }
+    }
+
     // init SDK
     int rc = InitQHYCCDResource();
     if (QHYCCD_SUCCESS == rc)
@@ -402,18 +483,25 @@ int main(int, char **)
         fprintf(stderr, "BeginQHYCCDLive failed: %d", rc);
     }
 
-    fprintf(stderr, "Press any key to exit...\n");
+    if (BURST_FRAMES > 0)
+    {
+        burstBenchmark(pCamHandle, length, BURST_FRAMES, EXPOSURE_TIME);
+    }
+    else
+    {
+        fprintf(stderr, "Press any key to exit...\n");
 
-    // Video Frame
-    std::thread t(&videoThread, pCamHandle, pImgData);
+        // Video Frame
+        std::thread t(&videoThread, pCamHandle, pImgData);
 
-    // wait for user key
-    std::getchar();
+        // wait for user key
+        std::getchar();
 
-    if (!exit_thread)
-    {
-        exit_thread = true;
-        t.join();
+        if (!exit_thread)
+        {
+            exit_thread = true;
+            t.join();
+        }
     }
 
     StopQHYCCDLive(pCamHandle);
@@ -39,6 +39,8 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <deque>
 
@@ -52,6 +54,7 @@
 #define MAX_DEVICES         20   /* Max device cameraCount */
 #define MAX_THREAD_RETRIES  3
 #define MAX_THREAD_WAIT     300000
+#define READOUT_BLOCK_LINES 64   /* Lines read per driver handle selection in block readout */
 
 static class Loader
 {
@@ -306,6 +309,8 @@ SBIGCCD::SBIGCCD() : FilterInterface(this)
 
 SBIGCCD::~SBIGCCD()
 {
+    m_AbortReadout = true;
+    stopReadoutThread();
     CloseDevice();
     CloseDriver();
 }
@@ -383,6 +388,20 @@ bool SBIGCCD::initProperties()
     IUFillSwitchVector(&IgnoreErrorsSP, IgnoreErrorsS, 1, getDeviceName(), "CCD_IGNORE_ERRORS", "Ignore", OPTIONS_TAB, IP_RW,
                        ISR_NOFMANY, 0, IPS_OK);
 
+    // Readout method
+    IUFillSwitch(&ReadoutMethodS[READOUT_METHOD_LINE], "READOUT_LINE", "Line", ISS_OFF);
+    IUFillSwitch(&ReadoutMethodS[READOUT_METHOD_BLOCK], "READOUT_BLOCK", "Block", ISS_ON);
+    IUFillSwitchVector(&ReadoutMethodSP, ReadoutMethodS, 2, getDeviceName(), "CCD_READOUT_METHOD", "Readout", OPTIONS_TAB,
+                       IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
+    // Readout telemetry of the last primary frame
+    IUFillNumber(&ReadoutN[READOUT_PROGRESS], "READOUT_PROGRESS", "Progress [%]", "%.f", 0, 100, 0, 0);
+    IUFillNumber(&ReadoutN[READOUT_DURATION], "READOUT_DURATION", "Duration [s]", "%.3f", 0, 3600, 0, 0);
+    IUFillNumber(&ReadoutN[READOUT_LINE_TIME], "READOUT_LINE_TIME", "Per line [ms]", "%.3f", 0, 1e6, 0, 0);
+    IUFillNumber(&ReadoutN[READOUT_PIXEL_RATE], "READOUT_PIXEL_RATE", "Rate [kpx/s]", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumberVector(&ReadoutNP, ReadoutN, 4, getDeviceName(), "CCD_READOUT_TIME", "Readout Time", OPTIONS_TAB, IP_RO,
+                       0, IPS_IDLE);
+
     // CFW PRODUCT
     IUFillText(&FilterProdcutT[0], "NAME", "Name", "");
     IUFillText(&FilterProdcutT[1], "ID", "ID", "");
@@ -530,6 +549,8 @@ bool SBIGCCD::updateProperties()
             defineProperty(&CoolerNP);
         }
         defineProperty(&IgnoreErrorsSP);
+        defineProperty(&ReadoutMethodSP);
+        defineProperty(&ReadoutNP);
         if (m_hasFilterWheel)
         {
             defineProperty(&FilterConnectionSP);
@@ -572,6 +593,8 @@ bool SBIGCCD::updateProperties()
             deleteProperty(CoolerNP.name);
         }
         deleteProperty(IgnoreErrorsSP.name);
+        deleteProperty(ReadoutMethodSP.name);
+        deleteProperty(ReadoutNP.name);
 
         if (m_hasAO)
         {
@@ -723,6 +746,15 @@ bool SBIGCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, ch
             saveConfig(true);
             return true;
         }
+        // Readout method
+        else if (!strcmp(name, ReadoutMethodSP.name))
+        {
+            IUUpdateSwitch(&ReadoutMethodSP, states, names, n);
+            ReadoutMethodSP.s = IPS_OK;
+            IDSetSwitch(&ReadoutMethodSP, nullptr);
+            saveConfig(true);
+            return true;
+        }
         // Filter connection
         else if (!strcmp(name, FilterConnectionSP.name))
         {
@@ -904,6 +936,8 @@ bool SBIGCCD::Disconnect()
         return true;
     m_useExternalTrackingCCD = false;
     m_hasGuideHead           = false;
+    m_AbortReadout           = true;
+    stopReadoutThread();
 #ifdef ASYNC_READOUT
     pthread_mutex_lock(&condMutex);
     grabPredicate   = GRAB_PRIMARY_CCD;
@@ -1137,6 +1171,13 @@ int SBIGCCD::StartExposure(INDI::CCDChip *targetChip, double duration)
 
 bool SBIGCCD::StartExposure(float duration)
 {
+    {
+        // A readout still running keeps an abort issued against it, the next one starts with its own flag
+        std::lock_guard<std::mutex> lock(m_ReadoutMutex);
+        if (!m_ReadoutActive)
+            m_AbortReadout = false;
+    }
+
     ExposureRequest = duration;
 
     if (duration >= 3)
@@ -1194,6 +1235,18 @@ int SBIGCCD::AbortExposure(INDI::CCDChip *targetChip)
 
 bool SBIGCCD::AbortExposure()
 {
+    {
+        std::lock_guard<std::mutex> lock(m_ReadoutMutex);
+        if (m_ReadoutActive)
+        {
+            // The readout thread holds the driver, let it end the readout between two blocks
+            m_AbortReadout = true;
+            m_AbortQueued  = m_ReadoutRequested;
+            LOG_DEBUG("Aborting primary camera readout...");
+            return true;
+        }
+    }
+
     int res = CE_NO_ERROR;
     LOG_DEBUG("Aborting primary camera exposure...");
     for (int i = 0; i < MAX_THREAD_RETRIES; i++)
@@ -1467,20 +1520,39 @@ bool SBIGCCD::grabImage(INDI::CCDChip *targetChip)
     {
         uint16_t *buffer = reinterpret_cast<uint16_t *>(targetChip->getFrameBuffer());
         int res                = 0;
+        auto start             = std::chrono::steady_clock::now();
         for (int i = 0; i < MAX_THREAD_RETRIES; i++)
         {
             res = readoutCCD(left, top, width, height, buffer, targetChip);
-            if (res == CE_NO_ERROR)
+            if (res == CE_NO_ERROR || (targetChip == &PrimaryCCD && m_AbortReadout))
                 break;
             LOGF_DEBUG("Readout error, retrying...", res);
             usleep(MAX_THREAD_WAIT);
         }
+        if (targetChip == &PrimaryCCD && m_AbortReadout)
+        {
+            LOG_INFO("Primary camera readout aborted");
+            return true;
+        }
         if (res != CE_NO_ERROR)
         {
             LOGF_ERROR("%s readout error",
                        targetChip == &PrimaryCCD ? "Primary camera" : "Guide head");
             return false;
         }
+
+        if (targetChip == &PrimaryCCD && height > 0)
+        {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            ReadoutN[READOUT_PROGRESS].value   = 100;
+            ReadoutN[READOUT_DURATION].value   = seconds;
+            ReadoutN[READOUT_LINE_TIME].value  = seconds * 1000.0 / height;
+            ReadoutN[READOUT_PIXEL_RATE].value = seconds > 0 ? width * height / seconds / 1000.0 : 0;
+            ReadoutNP.s = IPS_OK;
+            IDSetNumber(&ReadoutNP, nullptr);
+            LOGF_DEBUG("Primary camera readout of %dx%d took %.3f s (%s)", width, height, seconds,
+                       ReadoutMethodS[READOUT_METHOD_BLOCK].s == ISS_ON ? "block" : "line");
+        }
     }
     LOGF_DEBUG("%s readout complete", targetChip == &PrimaryCCD ? "Primary camera" : "Guide head");
     ExposureComplete(targetChip);
@@ -1494,6 +1566,7 @@ bool SBIGCCD::saveConfigItems(FILE *fp)
     IUSaveConfigSwitch(fp, &PortSP);
     IUSaveConfigText(fp, &IpTP);
     IUSaveConfigSwitch(fp, &IgnoreErrorsSP);
+    IUSaveConfigSwitch(fp, &ReadoutMethodSP);
 
     if (FilterNameT)
         INDI::FilterInterface::saveConfigItems(fp);
@@ -1521,7 +1594,9 @@ void SBIGCCD::TimerHit()
             LOG_DEBUG("Primay camera exposure done, downloading image...");
             targetChip->setExposureLeft(0);
             InExposure = false;
-            if (grabImage(targetChip) == false)
+            if (ReadoutMethodS[READOUT_METHOD_BLOCK].s == ISS_ON)
+                startReadout();
+            else if (grabImage(targetChip) == false)
                 targetChip->setExposureFailed();
         }
         else
@@ -1531,7 +1606,15 @@ void SBIGCCD::TimerHit()
         }
     }
 
-    if (InGuideExposure)
+    if (m_ReadoutActive && m_ReadoutHeight > 0)
+    {
+        ReadoutN[READOUT_PROGRESS].value = 100.0 * m_ReadoutLines / m_ReadoutHeight;
+        ReadoutNP.s = IPS_BUSY;
+        IDSetNumber(&ReadoutNP, nullptr);
+    }
+
+    // The guide head can only be polled once the primary readout has released the driver
+    if (InGuideExposure && !m_ReadoutActive)
     {
         targetChip = &GuideCCD;
         std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - GuideExpStart;
@@ -2520,6 +2603,13 @@ void SBIGCCD::updateTemperature()
     bool enabled;
     double ccdTemp, setpointTemp, percentTE, power;
 
+    // Do not stall the main thread behind a block readout, poll again later
+    if (m_ReadoutActive)
+    {
+        IEAddTimer(TEMPERATURE_POLL_MS, SBIGCCD::updateTemperatureHelper, this);
+        return;
+    }
+
     std::unique_lock<std::mutex> guard(sbigLock);
     int res = QueryTemperatureStatus(enabled, ccdTemp, setpointTemp, percentTE);
     guard.unlock();
@@ -2678,23 +2768,122 @@ int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t he
     rlp.readoutMode = binning;
     rlp.pixelStart  = left;
     rlp.pixelLength = width;
-    for (h = 0; h < height; h++)
+    if (ReadoutMethodS[READOUT_METHOD_BLOCK].s == ISS_ON)
     {
-        ReadoutLine(&rlp, buffer + (h * width), false);
+        res = readoutBlocks(&rlp, height, buffer, targetChip);
+    }
+    else
+    {
+        for (h = 0; h < height; h++)
+        {
+            ReadoutLine(&rlp, buffer + (h * width), false);
+        }
     }
     EndReadoutParams erp;
     erp.ccd = ccd;
-    if ((res = EndReadout(&erp)) != CE_NO_ERROR)
+    int endRes = EndReadout(&erp);
+    if (endRes != CE_NO_ERROR)
     {
         LOGF_ERROR("%s readoutCCD - EndReadout error! (%s)",
-                   (targetChip == &PrimaryCCD) ? "Primary" : "Guide", GetErrorString(res));
+                   (targetChip == &PrimaryCCD) ? "Primary" : "Guide", GetErrorString(endRes));
         guard.unlock();
-        return res;
+        return endRes;
     }
     guard.unlock();
     return res;
 }
 
+/*
+ * The universal driver only digitizes one line per CC_READOUT_LINE, so a block is a run of
+ * line commands issued after a single driver handle selection instead of one per line.
+ * Errors stop the readout, and abort requests are honoured between blocks.
+ * Must be called with sbigLock held, between StartReadout and EndReadout.
+ */
+int SBIGCCD::readoutBlocks(ReadoutLineParams *rlp, unsigned short height, unsigned short *buffer,
+                           INDI::CCDChip *targetChip)
+{
+    if (isSimulation())
+        return CE_NO_ERROR;
+
+    SetDriverHandleParams sdhp;
+    sdhp.handle = GetDriverHandle();
+    if (sdhp.handle == INVALID_HANDLE_VALUE)
+        return CE_DRIVER_NOT_OPEN;
+
+    int res = CE_NO_ERROR;
+    for (int block = 0; block < height; block += READOUT_BLOCK_LINES)
+    {
+        if (targetChip == &PrimaryCCD && m_AbortReadout)
+            break;
+
+        res = ::SBIGUnivDrvCommand(CC_SET_DRIVER_HANDLE, &sdhp, nullptr);
+        int end = std::min<int>(height, block + READOUT_BLOCK_LINES);
+        for (int h = block; h < end && res == CE_NO_ERROR; h++)
+            res = ::SBIGUnivDrvCommand(CC_READOUT_LINE, rlp, buffer + h * rlp->pixelLength);
+
+        if (res != CE_NO_ERROR)
+        {
+            LOGF_ERROR("%s: CC_READOUT_LINE -> (%s)", __FUNCTION__, GetErrorString(res));
+            break;
+        }
+
+        if (targetChip == &PrimaryCCD)
+            m_ReadoutLines = end;
+    }
+    return res;
+}
+
+void SBIGCCD::startReadout()
+{
+    std::lock_guard<std::mutex> lock(m_ReadoutMutex);
+    m_AbortQueued      = false;
+    m_ReadoutLines     = 0;
+    m_ReadoutHeight    = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    m_ReadoutActive    = true;
+    m_ReadoutRequested = true;
+    if (!m_ReadoutThread.joinable())
+    {
+        m_ReadoutQuit   = false;
+        m_ReadoutThread = std::thread(&SBIGCCD::readoutThread, this);
+    }
+    m_ReadoutCondition.notify_one();
+}
+
+void SBIGCCD::readoutThread()
+{
+    std::unique_lock<std::mutex> lock(m_ReadoutMutex);
+    while (true)
+    {
+        m_ReadoutCondition.wait(lock, [this]() { return m_ReadoutRequested || m_ReadoutQuit; });
+        if (m_ReadoutQuit)
+            break;
+        m_ReadoutRequested = false;
+        m_AbortReadout     = m_AbortQueued;
+        m_AbortQueued      = false;
+        lock.unlock();
+
+        // A fast exposure started from ExposureComplete can queue its readout before this one returns
+        if (grabImage(&PrimaryCCD) == false)
+            PrimaryCCD.setExposureFailed();
+
+        lock.lock();
+        if (!m_ReadoutRequested)
+            m_ReadoutActive = false;
+    }
+    m_ReadoutActive = false;
+}
+
+void SBIGCCD::stopReadoutThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_ReadoutMutex);
+        m_ReadoutQuit = true;
+    }
+    m_ReadoutCondition.notify_one();
+    if (m_ReadoutThread.joinable())
+        m_ReadoutThread.join();
+}
+
 //==========================================================================
 
 int SBIGCCD::CFWConnect()
@@ -37,7 +37,11 @@
 #include <sbigudrv.h>
 #endif
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #define DEVICE struct usb_device *
 
@@ -251,6 +255,27 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         ISwitch IgnoreErrorsS[1];
         ISwitchVectorProperty IgnoreErrorsSP;
 
+        /////////////////////////////////////////////////////////////////////////////
+        /// Readout Properties
+        /////////////////////////////////////////////////////////////////////////////
+        ISwitch ReadoutMethodS[2];
+        ISwitchVectorProperty ReadoutMethodSP;
+        enum
+        {
+            READOUT_METHOD_LINE,
+            READOUT_METHOD_BLOCK,
+        };
+
+        INumber ReadoutN[4];
+        INumberVectorProperty ReadoutNP;
+        enum
+        {
+            READOUT_PROGRESS,
+            READOUT_DURATION,
+            READOUT_LINE_TIME,
+            READOUT_PIXEL_RATE,
+        };
+
         /////////////////////////////////////////////////////////////////////////////
         /// Filter Wheel Properties
         /////////////////////////////////////////////////////////////////////////////
@@ -278,6 +303,21 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         /////////////////////////////////////////////////////////////////////////////
         std::mutex sbigLock;
 
+        // Block readout of the primary chip runs here so the main thread stays free for progress and abort.
+        // The thread lives until disconnect, ExposureComplete on it may already start the next exposure.
+        std::thread m_ReadoutThread;
+        std::mutex m_ReadoutMutex;
+        std::condition_variable m_ReadoutCondition;
+        bool m_ReadoutRequested { false };
+        bool m_ReadoutQuit { false };
+        std::atomic_bool m_ReadoutActive { false };
+        // Aborts the readout running on the thread. m_AbortQueued carries an abort over to a readout
+        // queued behind it, the thread hands it to m_AbortReadout when it starts that readout.
+        std::atomic_bool m_AbortReadout { false };
+        bool m_AbortQueued { false };
+        std::atomic_int m_ReadoutLines { 0 };
+        int m_ReadoutHeight { 0 };
+
         /////////////////////////////////////////////////////////////////////////////
         /// Exposure Variables
         /////////////////////////////////////////////////////////////////////////////
@@ -409,6 +449,10 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         int getShutterMode(INDI::CCDChip *targetChip, int &shutter);
         int readoutCCD(unsigned short left, unsigned short top, unsigned short width, unsigned short height,
                        unsigned short *buffer, INDI::CCDChip *targetChip);
+        int readoutBlocks(ReadoutLineParams *rlp, unsigned short height, unsigned short *buffer, INDI::CCDChip *targetChip);
+        void startReadout();
+        void readoutThread();
+        void stopReadoutThread();
 
         /////////////////////////////////////////////////////////////////////////////
         /// Filter Wheel Functions
@@ -32,6 +32,7 @@
 #include "sxccd.h"
 
 #include "sxconfig.h"
+#include "sxfield.h"
 
 #include <cmath>
 #include <deque>
@@ -447,6 +448,9 @@ bool SXCCD::AbortExposure()
             IERmTimer(ExposureTimerID);
         if (HasShutter)
             sxSetShutter(handle, 1);
+        // Stop the transfers of a readout in progress
+        if (DidLatch)
+            sxCancelReadPixels(handle);
         ExposureTimerID = 0;
         PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
         DidLatch = false;
@@ -477,7 +481,6 @@ void SXCCD::ExposureTimerHit()
             int subH          = PrimaryCCD.getSubH();
             int binX          = PrimaryCCD.getBinX();
             int binY          = PrimaryCCD.getBinY();
-            int subWW         = subW * 2;
             bool isICX453     = sxIsICX453(model);
             uint8_t *buf      = PrimaryCCD.getFrameBuffer();
             int size;
@@ -509,18 +512,26 @@ void SXCCD::ExposureTimerHit()
                     gettimeofday(&tv, nullptr);
                     wipeDelay = tv.tv_sec * 1000000 + tv.tv_usec - startTime;
                     if (rc)
+                    {
+                        // Merge the even field while the odd one is latched and transferred,
+                        // then merge the odd field block by block as it arrives.
+                        // Field rows are binned horizontally, size counts subW / binX pixels per row.
+                        size_t rowBytes = subW / binX * 2;
+                        uint8_t *even   = reinterpret_cast<uint8_t *>(evenBuf);
+                        uint8_t *odd    = reinterpret_cast<uint8_t *>(oddBuf);
+                        FieldWorker worker;
+                        worker.post([buf, even, rowBytes, subH]()
+                        {
+                            sxMergeField(buf, even, rowBytes, 0, subH / 2, 1);
+                        });
                         rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_ODD | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2,
                                            subW, subH / 2, binX, 1);
-                    if (rc)
-                        rc = sxReadPixels(handle, oddBuf, size);
-                    if (rc)
-                    {
-                        for (int i = 0, j = 0; i < subH; i += 2, j++)
+                        if (rc)
+                            rc = sxReadRows(handle, odd, rowBytes, subH / 2, worker, [buf, odd, rowBytes](int first, int rows)
                         {
-                            memcpy(buf + i * subWW, oddBuf + (j * subWW), subWW);
-                            memcpy(buf + ((i + 1) * subWW), evenBuf + (j * subWW), subWW);
-                        }
-                        //            deinterlace((unsigned short *)buf, subW, subH);
+                            sxMergeField(buf, odd, rowBytes, first, rows, 0);
+                        });
+                        worker.wait();
                     }
                 }
             }
@@ -531,37 +542,25 @@ void SXCCD::ExposureTimerHit()
                 {
                     if (binX == 1 && binY == 1)
                     {
-                        rc = sxReadPixels(handle, evenBuf, size * 2);
-                        if (rc)
+                        int offset_1 = 2, offset_2 = 3;
+                        if (strstr(getDeviceName(), "SXVF-M25C"))
                         {
-                            uint16_t *buf16 = reinterpret_cast<uint16_t *>(buf);
-                            uint16_t *evenBuf16 = reinterpret_cast<uint16_t *>(evenBuf);
-
-                            int offset_1 = 2, offset_2 = 3;
-                            if (strstr(getDeviceName(), "SXVF-M25C"))
-                            {
-                                // Patch by Greg Bosch on 2020-01-02 to fix bayer pattern
-                                // on SXVF-M25C.
-                                offset_1 = 3;
-                                offset_2 = 2;
-                            }
-
-                            for (int i = 0; i < subH; i += 2)
-                            {
-                                for (int j = 0; j < subW; j += 2)
-                                {
-                                    int isubW = i * subW;
-                                    int i1subW = (i + 1) * subW;
-                                    int j2 = j * 2;
-
-                                    buf16[isubW + j]  = evenBuf16[isubW + j2];
-                                    buf16[isubW + j + 1]  = evenBuf16[isubW + j2 + offset_1];
-                                    buf16[i1subW + j]  = evenBuf16[isubW + j2 + 1];
-                                    buf16[i1subW + j + 1]  = evenBuf16[isubW + j2 + offset_2];
-
-                                }
-                            }
+                            // Patch by Greg Bosch on 2020-01-02 to fix bayer pattern
+                            // on SXVF-M25C.
+                            offset_1 = 3;
+                            offset_2 = 2;
                         }
+
+                        // Reorder each block of raw rows while the next one is transferred
+                        uint16_t *buf16     = reinterpret_cast<uint16_t *>(buf);
+                        uint16_t *evenBuf16 = reinterpret_cast<uint16_t *>(evenBuf);
+                        FieldWorker worker;
+                        rc = sxReadRows(handle, reinterpret_cast<uint8_t *>(evenBuf), subW * 4, subH / 2, worker,
+                                        [buf16, evenBuf16, subW, offset_1, offset_2](int first, int rows)
+                        {
+                            sxReorderICX453(buf16, evenBuf16, subW, first, rows, offset_1, offset_2);
+                        });
+                        worker.wait();
                     }
                     else
                     {
@@ -31,9 +31,13 @@
 
 #include "sxconfig.h"
 
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <memory.h>
+#include <stdlib.h>
 #include <unistd.h>
+#include <vector>
 
 int n;
 DEVICE devices[20];
@@ -43,10 +47,90 @@ HANDLE handles[20];
 struct t_sxccd_params params;
 unsigned short pixels[10 * 10];
 
-int main()
+/*
+ * Read full frames with the synchronous path and with several in-flight transfer
+ * configurations. The latch to last byte time includes the CCD readout itself,
+ * the difference between the modes is the USB transfer overhead.
+ */
+static void readoutBenchmark(HANDLE handle, bool interlaced, int iterations)
+{
+    static const struct
+    {
+        const char *name;
+        int depth;
+        unsigned long chunkSize;
+    } modes[] = { { "synchronous", 1, 0 },
+        { "2 x 1MB", 2, 1024 * 1024 },
+        { "4 x 1MB", 4, 1024 * 1024 },
+        { "8 x 512kB", 8, 512 * 1024 },
+        { "4 x 4MB", 4, 4 * 1024 * 1024 }
+    };
+
+    memset(&params, 0, sizeof(params));
+    if (!sxGetCameraParams(handle, 0, &params))
+        return;
+
+    // Interlaced sensors are read as one combined field, like the driver does for binned frames
+    int height           = interlaced ? params.height / 2 : params.height;
+    unsigned long size   = (unsigned long)params.width * height * (params.bits_per_pixel > 8 ? 2 : 1);
+    std::vector<unsigned char> buffer(size);
+
+    std::cout << "readout benchmark " << params.width << "x" << height << ", " << size << " bytes, " << iterations
+              << " frames per mode" << std::endl << std::endl;
+
+    for (const auto &mode : modes)
+    {
+        sxSetReadTransfers(mode.depth, mode.chunkSize);
+
+        double total = 0, best = 0;
+        int failed   = 0;
+        for (int k = 0; k < iterations; k++)
+        {
+            sxClearPixels(handle, 0, 0);
+            auto start = std::chrono::steady_clock::now();
+            if (!sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, 0, 0, params.width, height, 1, 1) ||
+                    !sxReadPixels(handle, buffer.data(), size))
+            {
+                failed++;
+                continue;
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            total += ms;
+            if (best == 0 || ms < best)
+                best = ms;
+        }
+
+        int done = iterations - failed;
+        std::cout << std::setw(12) << mode.name << ": ";
+        if (done > 0)
+            std::cout << std::fixed << std::setprecision(1) << total / done << " ms mean, " << best << " ms best, "
+                      << size / (total / done) / 1000.0 << " MB/s";
+        if (failed > 0)
+            std::cout << " (" << failed << " failed)";
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char *argv[])
 {
     int i = 0;
     unsigned short us = 0;
+    int benchmark = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                benchmark = atoi(optarg);
+                break;
+            default:
+                std::cerr << "Usage: " << argv[0] << " [-b frames]" << std::endl;
+                return 1;
+        }
+    }
 
     sxDebug(true);
 
@@ -151,6 +235,9 @@ int main()
             std::cout << std::endl;
         }
 
+        if (benchmark > 0)
+            readoutBenchmark(handle, sxIsInterlaced(us), benchmark);
+
         sxClose(&handle);
         std::cout << "sxClose() " << std::endl << std::endl;
     }
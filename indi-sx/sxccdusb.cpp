@@ -39,7 +39,12 @@
 
 #include <indidevapi.h>
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
 
 #include <stdarg.h>
 #include <stdlib.h>
@@ -125,6 +130,10 @@
 //#warning "Intel mode, 16MB CHUNK_SIZE"
 #endif
 
+#define READ_TRANSFERS      4               /* Bulk transfers kept in flight during readout, 1 = synchronous */
+#define READ_CHUNK_SIZE     (1024 * 1024)   /* Size of each in-flight transfer */
+#define READ_EVENT_TIMEOUT  100             /* ms, event loop tick while waiting for readout transfers */
+
 #if 1
 #define TRACE(c) (c)
 #define DEBUG(c) (c)
@@ -622,8 +631,12 @@ int sxSetCooler(HANDLE sxHandle, unsigned char setStatus, unsigned short setTemp
     return 0;
 }
 
+static bool readCancelled(HANDLE sxHandle, bool clear);
+
 int sxClearPixels(HANDLE sxHandle, unsigned short flags, unsigned short camIndex)
 {
+    // A new exposure starts, a cancel aimed at the previous readout no longer applies
+    readCancelled(sxHandle, true);
     unsigned char setup_data[8];
     int transferred;
     setup_data[USB_REQ_TYPE]     = USB_REQ_VENDOR | USB_REQ_DATAOUT;
@@ -672,6 +685,7 @@ int sxExposePixels(HANDLE sxHandle, unsigned short flags, unsigned short camInde
                    unsigned short yoffset, unsigned short width, unsigned short height, unsigned short xbin,
                    unsigned short ybin, unsigned long msec)
 {
+    readCancelled(sxHandle, true);
     unsigned char setup_data[22];
     int transferred;
     setup_data[USB_REQ_TYPE]      = USB_REQ_VENDOR | USB_REQ_DATAOUT;
@@ -705,6 +719,7 @@ int sxExposePixelsGated(HANDLE sxHandle, unsigned short flags, unsigned short ca
                         unsigned short yoffset, unsigned short width, unsigned short height, unsigned short xbin,
                         unsigned short ybin, unsigned long msec)
 {
+    readCancelled(sxHandle, true);
     unsigned char setup_data[22];
     int transferred;
     setup_data[USB_REQ_TYPE]      = USB_REQ_VENDOR | USB_REQ_DATAOUT;
@@ -734,13 +749,44 @@ int sxExposePixelsGated(HANDLE sxHandle, unsigned short flags, unsigned short ca
     return rc >= 0;
 }
 
-int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count)
+static int readTransfers           = READ_TRANSFERS;
+static unsigned long readChunkSize = READ_CHUNK_SIZE;
+
+static std::mutex cancelMutex;
+static std::set<HANDLE> cancelRequests;
+
+void sxSetReadTransfers(int depth, unsigned long chunkSize)
+{
+    readTransfers = depth < 1 ? 1 : depth;
+    // Keep whole 512 byte packets per transfer so only the last transfer can come back short
+    readChunkSize = chunkSize < 512 ? 512 : chunkSize - chunkSize % 512;
+}
+
+void sxCancelReadPixels(HANDLE sxHandle)
+{
+    std::lock_guard<std::mutex> lock(cancelMutex);
+    cancelRequests.insert(sxHandle);
+}
+
+static bool readCancelled(HANDLE sxHandle, bool clear)
+{
+    std::lock_guard<std::mutex> lock(cancelMutex);
+    bool cancelled = cancelRequests.count(sxHandle) > 0;
+    if (clear)
+        cancelRequests.erase(sxHandle);
+    return cancelled;
+}
+
+static int readPixelsSync(HANDLE sxHandle, void *pixels, unsigned long count,
+                          const std::function<void(unsigned long)> &onData)
 {
     int transferred;
     unsigned long read = 0;
     int rc             = 0;
     while (read < count && rc >= 0)
     {
+        if (readCancelled(sxHandle, false))
+            return 0;
         int size = count - read;
         if (size > CHUNK_SIZE)
             size = CHUNK_SIZE;
@@ -751,10 +797,189 @@ int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count)
         {
             read += transferred;
         }
+        if (rc >= 0 && transferred > 0 && onData)
+            onData(read);
     }
     return rc >= 0;
 }
 
+/*
+ * One readout, on the stack of readPixelsAsync. All cameras share ctx, so its
+ * callbacks may run inside the libusb_handle_events call of another camera's
+ * reading thread while its own thread checks progress; the lock serializes them.
+ */
+struct t_sx_read
+{
+    unsigned char *pixels;
+    unsigned long count;
+    unsigned long submitted;
+    unsigned long received;
+    int inFlight;
+    int rc;
+    const std::function<void(unsigned long)> *onData;
+    std::mutex lock;
+};
+
+static void LIBUSB_CALL readPixelsCallback(struct libusb_transfer *transfer)
+{
+    struct t_sx_read *read = (struct t_sx_read *)transfer->user_data;
+    // Held to the end, the readout must not see inFlight drop to 0 while this still uses it
+    std::lock_guard<std::mutex> guard(read->lock);
+    read->inFlight--;
+
+    if (transfer->status == LIBUSB_TRANSFER_CANCELLED)
+        return;
+
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED)
+    {
+        if (read->rc == 0)
+            read->rc = transfer->status == LIBUSB_TRANSFER_NO_DEVICE ? LIBUSB_ERROR_NO_DEVICE : LIBUSB_ERROR_IO;
+        return;
+    }
+
+    read->received += transfer->actual_length;
+
+    // Transfers are queued at fixed offsets, a short one leaves a hole the following transfers cannot fill
+    if (transfer->actual_length < transfer->length && read->submitted < read->count)
+    {
+        DEBUG(log(true, "sxReadPixels: short transfer %d of %d bytes\n", transfer->actual_length, transfer->length));
+        if (read->rc == 0)
+            read->rc = LIBUSB_ERROR_OVERFLOW;
+        return;
+    }
+
+    if (read->rc == 0 && read->submitted < read->count)
+    {
+        unsigned long size = read->count - read->submitted;
+        if (size > readChunkSize)
+            size = readChunkSize;
+        transfer->buffer = read->pixels + read->submitted;
+        transfer->length = size;
+        int rc           = libusb_submit_transfer(transfer);
+        if (rc < 0)
+        {
+            DEBUG(log(true, "sxReadPixels: libusb_submit_transfer -> %s\n", libusb_error_name(rc)));
+            read->rc = rc;
+            return;
+        }
+        read->submitted += size;
+        read->inFlight++;
+    }
+
+    // Transfers of one endpoint complete in order, so the first received bytes are all in place
+    if (read->rc == 0 && *read->onData)
+        (*read->onData)(read->received);
+}
+
+static int readPixelsAsync(HANDLE sxHandle, void *pixels, unsigned long count,
+                           const std::function<void(unsigned long)> &onData)
+{
+    struct t_sx_read read;
+    read.pixels    = (unsigned char *)pixels;
+    read.count     = count;
+    read.submitted = 0;
+    read.received  = 0;
+    read.inFlight  = 0;
+    read.rc        = 0;
+    read.onData    = &onData;
+    int depth      = readTransfers;
+    std::vector<struct libusb_transfer *> transfers(depth, nullptr);
+
+    // A transfer may complete on another camera's thread before its submission is counted
+    std::unique_lock<std::mutex> submitting(read.lock);
+    for (int i = 0; i < depth && read.submitted < count; i++)
+    {
+        transfers[i] = libusb_alloc_transfer(0);
+        if (transfers[i] == nullptr)
+        {
+            read.rc = LIBUSB_ERROR_NO_MEM;
+            break;
+        }
+
+        unsigned long size = count - read.submitted;
+        if (size > readChunkSize)
+            size = readChunkSize;
+        // No per-transfer timeout, queued transfers may wait for the whole CCD readout before data arrives
+        libusb_fill_bulk_transfer(transfers[i], sxHandle, BULK_IN, read.pixels + read.submitted, size,
+                                  readPixelsCallback, &read, 0);
+        int rc = libusb_submit_transfer(transfers[i]);
+        if (rc < 0)
+        {
+            DEBUG(log(true, "sxReadPixels: libusb_submit_transfer -> %s\n", libusb_error_name(rc)));
+            read.rc = rc;
+            break;
+        }
+        read.submitted += size;
+        read.inFlight++;
+    }
+    submitting.unlock();
+
+    bool cancelling    = false;
+    unsigned long last = 0;
+    auto progress      = std::chrono::steady_clock::now();
+    while (true)
+    {
+        bool cancel = false;
+        {
+            std::lock_guard<std::mutex> guard(read.lock);
+            if (read.inFlight == 0)
+                break;
+
+            if (read.received != last)
+            {
+                last     = read.received;
+                progress = std::chrono::steady_clock::now();
+            }
+
+            if (!cancelling)
+            {
+                bool timeout = std::chrono::steady_clock::now() - progress > std::chrono::milliseconds(BULK_DATA_TIMEOUT);
+                if (timeout && read.rc == 0)
+                    read.rc = LIBUSB_ERROR_TIMEOUT;
+                if (read.rc == 0 && readCancelled(sxHandle, false))
+                    read.rc = LIBUSB_ERROR_INTERRUPTED;
+                cancel = cancelling = read.rc != 0;
+            }
+        }
+
+        if (cancel)
+        {
+            // Only transfers still owned by libusb are cancelled, the others return NOT_FOUND
+            for (int i = 0; i < depth; i++)
+                if (transfers[i] != nullptr)
+                    libusb_cancel_transfer(transfers[i]);
+        }
+
+        struct timeval tv = { 0, READ_EVENT_TIMEOUT * 1000 };
+        libusb_handle_events_timeout_completed(ctx, &tv, nullptr);
+    }
+
+    for (int i = 0; i < depth; i++)
+        if (transfers[i] != nullptr)
+            libusb_free_transfer(transfers[i]);
+
+    DEBUG(log(true, "sxReadPixels: %lu of %lu bytes in %d transfers -> %s\n", read.received, count, depth,
+              read.rc < 0 ? libusb_error_name(read.rc) : "OK"));
+    return read.rc == 0 && read.received == count;
+}
+
+int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count)
+{
+    return sxReadPixels(sxHandle, pixels, count, nullptr);
+}
+
+int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count, const std::function<void(unsigned long)> &onData)
+{
+    // A cancel issued before the read started still applies, it is consumed once the read returns
+    int rc;
+    if (readTransfers <= 1 || count <= readChunkSize)
+        rc = readPixelsSync(sxHandle, pixels, count, onData);
+    else
+        rc = readPixelsAsync(sxHandle, pixels, count, onData);
+    readCancelled(sxHandle, true);
+    return rc;
+}
+
 int sxSetSTAR2000(HANDLE sxHandle, char star2k)
 {
     unsigned char setup_data[8];
@@ -43,6 +43,8 @@
 #include <libusb-1.0/libusb.h>
 #endif
 
+#include <functional>
+
 /*
  * CCD color representation.
  *  Packed colors allow individual sizes up to 16 bits.
@@ -160,6 +162,22 @@ int sxExposePixelsGated(HANDLE sxHandle, unsigned short flags, unsigned short ca
                         unsigned short yoffset, unsigned short width, unsigned short height, unsigned short xbin,
                         unsigned short ybin, unsigned long msec);
 int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count);
+/*
+ * Same as above, calling onData(received) on the reading thread whenever more
+ * of pixels has arrived. The first received bytes are then complete.
+ */
+int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count, const std::function<void(unsigned long)> &onData);
+/*
+ * Number of bulk transfers sxReadPixels keeps in flight and their size.
+ * depth 1 reads synchronously in CHUNK_SIZE pieces.
+ */
+void sxSetReadTransfers(int depth, unsigned long chunkSize);
+/*
+ * Abort a sxReadPixels running on another thread, it then returns 0.
+ * A cancel issued before the read starts aborts it as well, starting a
+ * new exposure with sxClearPixels or sxExposePixels discards it.
+ */
+void sxCancelReadPixels(HANDLE sxHandle);
 int sxSetShutter(HANDLE sxHandle, unsigned short state);
 int sxSetTimer(HANDLE sxHandle, unsigned long msec);
 unsigned long sxGetTimer(HANDLE sxHandle);
@@ -0,0 +1,174 @@
+/*
+ Starlight Xpress CCD INDI Driver - Field Readout
+
+ Copyright (C) 2026 INDI Developers
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the Free
+ Software Foundation; either version 2 of the License, or (at your option)
+ any later version.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ more details.
+
+ You should have received a copy of the GNU General Public License along with
+ this program; if not, write to the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+ The full GNU General Public License is included in this distribution in the
+ file called LICENSE.
+ */
+
+#include "sxfield.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define READ_BLOCKS 10 /* Blocks per field handed to the worker, the transfer itself is not split */
+
+FieldWorker::FieldWorker()
+{
+    thread = std::thread(&FieldWorker::run, this);
+}
+
+FieldWorker::~FieldWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    jobCondition.notify_one();
+    thread.join();
+}
+
+void FieldWorker::post(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobCondition.notify_one();
+}
+
+void FieldWorker::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [this] { return jobs.empty() && !busy; });
+}
+
+void FieldWorker::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        jobCondition.wait(lock, [this] { return !jobs.empty() || quit; });
+        if (jobs.empty())
+            return;
+
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        busy = true;
+        lock.unlock();
+        job();
+        lock.lock();
+        busy = false;
+        if (jobs.empty())
+            idleCondition.notify_all();
+    }
+}
+
+int sxReadRows(HANDLE sxHandle, uint8_t *pixels, size_t rowBytes, int rows, FieldWorker &worker,
+               const std::function<void(int, int)> &onRows)
+{
+    int blockRows = (rows + READ_BLOCKS - 1) / READ_BLOCKS;
+    if (blockRows < 1)
+        blockRows = 1;
+
+    // One read keeps the transfer queue full for the whole field, rows are handed over as they arrive
+    int posted = 0;
+    auto post  = [&](int complete)
+    {
+        int first = posted, count = complete - posted;
+        worker.post([onRows, first, count]()
+        {
+            onRows(first, count);
+        });
+        posted = complete;
+    };
+
+    int rc = sxReadPixels(sxHandle, pixels, rows * rowBytes, [&](unsigned long received)
+    {
+        int complete = received / rowBytes;
+        if (complete - posted >= blockRows || (complete == rows && complete > posted))
+            post(complete);
+    });
+    return rc;
+}
+
+void sxMergeField(uint8_t *frame, const uint8_t *field, size_t rowBytes, int firstRow, int rows, int parity)
+{
+    for (int j = firstRow; j < firstRow + rows; j++)
+        memcpy(frame + (2 * j + parity) * rowBytes, field + j * rowBytes, rowBytes);
+}
+
+void sxReorderICX453(uint16_t *frame, const uint16_t *raw, int width, int firstRow, int rows, int offset1, int offset2)
+{
+    // offset1 == 3 swaps the last two pixels of every group, after that both layouts are a plain even/odd split
+    const bool swap = offset1 == 3 && offset2 == 2;
+    const bool simd = swap || (offset1 == 2 && offset2 == 3);
+
+    for (int r = firstRow; r < firstRow + rows; r++)
+    {
+        const uint16_t *src = raw + static_cast<size_t>(r) * 2 * width;
+        uint16_t *even      = frame + static_cast<size_t>(2 * r) * width;
+        uint16_t *odd       = even + width;
+        int j               = 0;
+
+#if defined(__SSE2__)
+        for (; simd && j + 8 <= width; j += 8)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * j));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * j + 8));
+            if (swap)
+            {
+                a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(2, 3, 1, 0)), _MM_SHUFFLE(2, 3, 1, 0));
+                b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, _MM_SHUFFLE(2, 3, 1, 0)), _MM_SHUFFLE(2, 3, 1, 0));
+            }
+            // Sign extending each half keeps the 16 bit pattern intact through the saturating pack
+            __m128i evenLanes = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                                                _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+            __m128i oddLanes  = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(even + j), evenLanes);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(odd + j), oddLanes);
+        }
+#elif defined(__ARM_NEON)
+        for (; simd && j + 16 <= width; j += 16)
+        {
+            uint16x8x4_t groups = vld4q_u16(src + 2 * j);
+            uint16x8x2_t evenPairs, oddPairs;
+            evenPairs.val[0] = groups.val[0];
+            evenPairs.val[1] = swap ? groups.val[3] : groups.val[2];
+            oddPairs.val[0]  = groups.val[1];
+            oddPairs.val[1]  = swap ? groups.val[2] : groups.val[3];
+            vst2q_u16(even + j, evenPairs);
+            vst2q_u16(odd + j, oddPairs);
+        }
+#endif
+
+        for (; j < width; j += 2)
+        {
+            const uint16_t *group = src + 2 * j;
+            even[j]     = group[0];
+            even[j + 1] = group[offset1];
+            odd[j]      = group[1];
+            odd[j + 1]  = group[offset2];
+        }
+    }
+}
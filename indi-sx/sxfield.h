@@ -0,0 +1,82 @@
+/*
+ Starlight Xpress CCD INDI Driver - Field Readout
+
+ Copyright (C) 2026 INDI Developers
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the Free
+ Software Foundation; either version 2 of the License, or (at your option)
+ any later version.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ more details.
+
+ You should have received a copy of the GNU General Public License along with
+ this program; if not, write to the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+ The full GNU General Public License is included in this distribution in the
+ file called LICENSE.
+ */
+
+#pragma once
+
+#include "sxccdusb.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*
+ * Runs row processing jobs on a worker thread, in order, while the caller
+ * keeps transferring the next rows from the camera.
+ */
+class FieldWorker
+{
+    public:
+        FieldWorker();
+        ~FieldWorker();
+
+        void post(std::function<void()> job);
+        /* Wait until every posted job has run */
+        void wait();
+
+    private:
+        void run();
+
+        std::deque<std::function<void()>> jobs;
+        bool busy { false };
+        bool quit { false };
+        std::mutex mutex;
+        std::condition_variable jobCondition;
+        std::condition_variable idleCondition;
+        std::thread thread;
+};
+
+/*
+ * Read rows * rowBytes bytes with a single sxReadPixels and post
+ * onRows(firstRow, rows) to the worker each time about a tenth of the field
+ * has arrived. Returns the sxReadPixels result, the worker may still be busy
+ * with the last block.
+ */
+int sxReadRows(HANDLE sxHandle, uint8_t *pixels, size_t rowBytes, int rows, FieldWorker &worker,
+               const std::function<void(int, int)> &onRows);
+
+/*
+ * Copy field rows [firstRow, firstRow + rows) into every second frame row,
+ * starting at frame row parity.
+ */
+void sxMergeField(uint8_t *frame, const uint8_t *field, size_t rowBytes, int firstRow, int rows, int parity);
+
+/*
+ * ICX453 sensors read two frame rows as one raw row of 2 * width pixels in
+ * groups of four. Frame row 2r gets pixels 0 and offset1 of each group, frame
+ * row 2r + 1 gets pixels 1 and offset2. Converts raw rows [firstRow, firstRow + rows).
+ */
+void sxReorderICX453(uint16_t *frame, const uint16_t *raw, int width, int firstRow, int rows, int offset1, int offset2);
@@ -0,0 +1,162 @@
+/*
+ Starlight Xpress CCD INDI Driver - Field Readout Tests
+
+ Copyright (C) 2026 INDI Developers
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the Free
+ Software Foundation; either version 2 of the License, or (at your option)
+ any later version.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ more details.
+
+ You should have received a copy of the GNU General Public License along with
+ this program; if not, write to the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+ The full GNU General Public License is included in this distribution in the
+ file called LICENSE.
+ */
+
+#include "sxfield.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+std::vector<uint16_t> makeRaw(size_t size, uint32_t seed)
+{
+    std::vector<uint16_t> raw(size);
+    for (uint16_t &v : raw)
+    {
+        seed = seed * 1103515245u + 12345u;
+        v    = (uint16_t)(seed >> 8);
+    }
+    return raw;
+}
+
+// The loop the driver used before sxReorderICX453
+void reorderReference(uint16_t *frame, const uint16_t *raw, int width, int height, int offset1, int offset2)
+{
+    for (int i = 0; i < height; i += 2)
+    {
+        for (int j = 0; j < width; j += 2)
+        {
+            frame[i * width + j]           = raw[i * width + j * 2];
+            frame[i * width + j + 1]       = raw[i * width + j * 2 + offset1];
+            frame[(i + 1) * width + j]     = raw[i * width + j * 2 + 1];
+            frame[(i + 1) * width + j + 1] = raw[i * width + j * 2 + offset2];
+        }
+    }
+}
+}
+
+TEST(SXField, ReorderICX453MatchesReference)
+{
+    // Widths below, at and past the vector width cover the scalar tail
+    for (int width : { 2, 6, 16, 18, 30, 34, 3032 })
+    {
+        for (int height : { 2, 4, 10, 2016 })
+        {
+            for (int swap = 0; swap < 2; swap++)
+            {
+                int offset1 = swap ? 3 : 2, offset2 = swap ? 2 : 3;
+                std::vector<uint16_t> raw = makeRaw(width * height, width * 31 + height);
+                std::vector<uint16_t> expected(width * height), frame(width * height);
+                reorderReference(expected.data(), raw.data(), width, height, offset1, offset2);
+                sxReorderICX453(frame.data(), raw.data(), width, 0, height / 2, offset1, offset2);
+                EXPECT_EQ(expected, frame) << width << "x" << height << " offset1 " << offset1;
+            }
+        }
+    }
+}
+
+TEST(SXField, ReorderICX453ByBlocks)
+{
+    const int width = 66, height = 40;
+    std::vector<uint16_t> raw = makeRaw(width * height, 7);
+    std::vector<uint16_t> expected(width * height), frame(width * height, 0);
+    reorderReference(expected.data(), raw.data(), width, height, 2, 3);
+
+    // The driver converts each block of raw rows as soon as it arrives
+    for (int first = 0; first < height / 2; first += 3)
+    {
+        int rows = height / 2 - first < 3 ? height / 2 - first : 3;
+        sxReorderICX453(frame.data(), raw.data(), width, first, rows, 2, 3);
+    }
+    EXPECT_EQ(expected, frame);
+}
+
+TEST(SXField, MergeField)
+{
+    const size_t rowBytes = 6;
+    const int fieldRows   = 4;
+    std::vector<uint8_t> even(rowBytes * fieldRows), odd(rowBytes * fieldRows), frame(rowBytes * fieldRows * 2, 0);
+    for (size_t i = 0; i < even.size(); i++)
+    {
+        even[i] = (uint8_t)i;
+        odd[i]  = (uint8_t)(100 + i);
+    }
+
+    sxMergeField(frame.data(), even.data(), rowBytes, 0, fieldRows, 1);
+    sxMergeField(frame.data(), odd.data(), rowBytes, 0, 1, 0);
+    sxMergeField(frame.data(), odd.data(), rowBytes, 1, fieldRows - 1, 0);
+
+    for (int row = 0; row < 2 * fieldRows; row++)
+    {
+        const uint8_t *field = (row % 2 ? even.data() : odd.data()) + (row / 2) * rowBytes;
+        EXPECT_EQ(std::vector<uint8_t>(field, field + rowBytes),
+                  std::vector<uint8_t>(frame.begin() + row * rowBytes, frame.begin() + (row + 1) * rowBytes))
+                << "row " << row;
+    }
+}
+
+TEST(SXField, MergeBinnedFields)
+{
+    // Interlaced readout binned 2x1, sized like the frame buffer of SXCCD::ExposureTimerHit
+    const int subW = 24, subH = 8, binX = 2, binY = 1;
+    const size_t size     = subW * subH / binX / binY;
+    const size_t rowBytes = subW / binX * 2;
+    std::vector<uint8_t> even(size), odd(size), frame(size * 2 + 64, 0xa5);
+    for (size_t i = 0; i < size; i++)
+    {
+        even[i] = (uint8_t)i;
+        odd[i]  = (uint8_t)(100 + i);
+    }
+
+    sxMergeField(frame.data(), even.data(), rowBytes, 0, subH / 2, 1);
+    sxMergeField(frame.data(), odd.data(), rowBytes, 0, subH / 2, 0);
+
+    for (int row = 0; row < subH; row++)
+    {
+        const uint8_t *field = (row % 2 ? even.data() : odd.data()) + (row / 2) * rowBytes;
+        EXPECT_EQ(std::vector<uint8_t>(field, field + rowBytes),
+                  std::vector<uint8_t>(frame.begin() + row * rowBytes, frame.begin() + (row + 1) * rowBytes))
+                << "row " << row;
+    }
+    // Unbinned rows of subW pixels would run past the binned frame
+    for (size_t i = size * 2; i < frame.size(); i++)
+        ASSERT_EQ(0xa5, frame[i]) << "byte " << i;
+}
+
+TEST(SXField, WorkerRunsJobsInOrder)
+{
+    std::vector<int> done;
+    {
+        FieldWorker worker;
+        for (int i = 0; i < 1000; i++)
+            worker.post([&done, i]()
+        {
+            done.push_back(i);
+        });
+        worker.wait();
+        ASSERT_EQ(1000u, done.size());
+    }
+    for (int i = 0; i < 1000; i++)
+        EXPECT_EQ(i, done[i]);
+}
@@ -22,11 +22,17 @@
 #include "indi_toupbase.h"
 #include "config.h"
 #include <stream/streammanager.h>
+#include <pixelconvert.h>
 #include <unistd.h>
+#include <algorithm>
 #include <deque>
 
 #define BITDEPTH_FLAG       (CP(FLAG_RAW10) | CP(FLAG_RAW12) | CP(FLAG_RAW14) | CP(FLAG_RAW16))
 #define CONTROL_TAB         "Control"
+#define STREAMING_TAB       "Streaming"
+#define FRAME_POOL_DEPTH    3       /* Frames buffered between the SDK callback and the processing worker */
+#define SEQUENCE_POOL_DEPTH 8       /* Frames buffered while a triggered sequence is running */
+#define SEQUENCE_MAX_FRAMES 65534   /* Trigger() takes an unsigned short, 0xffff means continuous */
 
 #ifndef MAKEFOURCC
 #define MAKEFOURCC(ch0, ch1, ch2, ch3) \
@@ -223,6 +229,23 @@ bool ToupBase::initProperties()
     IUFillNumberVector(&m_TimeoutFactorNP, &m_TimeoutFactorN, 1, getDeviceName(), "TIMEOUT_FACTOR", "Timeout", OPTIONS_TAB,
                        IP_RW, 60, IPS_IDLE);
 
+    ///////////////////////////////////////////////////////////////////////////////////
+    /// Frame Counters
+    ///////////////////////////////////////////////////////////////////////////////////
+    IUFillNumber(&m_FrameStatsN[TC_FRAMES_DELIVERED], "FRAMES_DELIVERED", "Delivered", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&m_FrameStatsN[TC_FRAMES_DROPPED], "FRAMES_DROPPED", "Dropped (driver)", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&m_FrameStatsN[TC_FRAMES_SDK_DROPPED], "FRAMES_SDK_DROPPED", "Dropped (SDK)", "%.f", 0, 1e12, 0, 0);
+    IUFillNumberVector(&m_FrameStatsNP, m_FrameStatsN, 3, getDeviceName(), "CCD_FRAME_STATS", "Frames", STREAMING_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
+    ///////////////////////////////////////////////////////////////////////////////////
+    /// Sequence
+    ///////////////////////////////////////////////////////////////////////////////////
+    IUFillNumber(&m_SequenceN[TC_SEQUENCE_FRAMES], "SEQUENCE_FRAMES", "Frames", "%.f", 1, SEQUENCE_MAX_FRAMES, 1, 10);
+    IUFillNumber(&m_SequenceN[TC_SEQUENCE_EXPOSURE], "SEQUENCE_EXPOSURE", "Exposure (s)", "%.6f", 0, 3600, 0.001, 0.01);
+    IUFillNumberVector(&m_SequenceNP, m_SequenceN, 2, getDeviceName(), "CCD_SEQUENCE", "Sequence", STREAMING_TAB,
+                       IP_RW, 60, IPS_IDLE);
+
     if (m_Instance->model->flag & (CP(FLAG_CG) | CP(FLAG_CGHDR)))
     {
         ///////////////////////////////////////////////////////////////////////////////////
@@ -343,6 +366,8 @@ bool ToupBase::updateProperties()
             defineProperty(&m_FanSP);
 
         defineProperty(&m_TimeoutFactorNP);
+        defineProperty(&m_FrameStatsNP);
+        defineProperty(&m_SequenceNP);
         defineProperty(&m_ControlNP);
         defineProperty(&m_AutoExposureSP);
         defineProperty(&m_ResolutionSP);
@@ -392,6 +417,8 @@ bool ToupBase::updateProperties()
             deleteProperty(m_FanSP.name);
 
         deleteProperty(m_TimeoutFactorNP.name);
+        deleteProperty(m_FrameStatsNP.name);
+        deleteProperty(m_SequenceNP.name);
         deleteProperty(m_ControlNP.name);
         deleteProperty(m_AutoExposureSP.name);
         deleteProperty(m_ResolutionSP.name);
@@ -459,6 +486,14 @@ bool ToupBase::Connect()
     PrimaryCCD.setMinMaxStep("CCD_EXPOSURE", "CCD_EXPOSURE_VALUE", min / 1000000.0, max / 1000000.0, 0, false);
     PrimaryCCD.setBin(1, 1);
 
+    m_FramesDelivered = 0;
+    m_FramesDropped = 0;
+    m_SequenceRemaining = 0;
+    m_SequenceDone = false;
+    m_SequenceNP.s = IPS_IDLE;
+    m_FramePool.open();
+    m_ProcessThread = std::thread(&ToupBase::processFrames, this);
+
     LOGF_INFO("%s connect", getDeviceName());
     return true;
 }
@@ -470,12 +505,11 @@ bool ToupBase::Disconnect()
 
     FP(Close(m_Handle));
 
-    if (m_rgbBuffer)
-    {
-        free(m_rgbBuffer);
-        m_rgbBuffer = nullptr;
-    }
-    m_rgbBufferSize = 0;
+    // No more callbacks after Close, stop the worker and free the frames
+    m_FramePool.close();
+    if (m_ProcessThread.joinable())
+        m_ProcessThread.join();
+    m_FramePool.release();
 
     return true;
 }
@@ -783,6 +817,10 @@ void ToupBase::allocateFrameBuffer()
     }
 
     Streamer->setSize(PrimaryCCD.getXRes(), PrimaryCCD.getYRes());
+
+    // Pool frames hold a full resolution image in the current format, so ROI and binning changes never reallocate
+    size_t frameSize = PrimaryCCD.getXRes() * PrimaryCCD.getYRes() * m_Channels * (m_BitsPerPixel > 8 ? 2 : 1);
+    m_FramesDropped += m_FramePool.resize(FRAME_POOL_DEPTH, frameSize);
 }
 
 bool ToupBase::ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n)
@@ -978,6 +1016,26 @@ bool ToupBase::ISNewNumber(const char *dev, const char *name, double values[], c
             IDSetNumber(&m_TimeoutFactorNP, nullptr);
             return true;
         }
+
+        //////////////////////////////////////////////////////////////////////
+        /// Sequence
+        //////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, m_SequenceNP.name))
+        {
+            if (m_SequenceNP.s == IPS_BUSY)
+            {
+                LOG_ERROR("A sequence is already running.");
+                return true;
+            }
+
+            IUUpdateNumber(&m_SequenceNP, values, names, n);
+            if (startSequence(static_cast<uint32_t>(m_SequenceN[TC_SEQUENCE_FRAMES].value), m_SequenceN[TC_SEQUENCE_EXPOSURE].value))
+                m_SequenceNP.s = IPS_BUSY;
+            else
+                m_SequenceNP.s = IPS_ALERT;
+            IDSetNumber(&m_SequenceNP, nullptr);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -1379,9 +1437,105 @@ bool ToupBase::AbortExposure()
 {
     FP(Trigger(m_Handle, 0));
     InExposure = false;
+    if (m_SequenceRemaining.exchange(0) > 0)
+    {
+        LOG_INFO("Sequence aborted.");
+        m_SequenceDone = true;
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// A single Trigger(N) arms all frames, the SDK then delivers them back to back through the usual
+/// EVENT_IMAGE path without a command round trip per frame.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ToupBase::startSequence(uint32_t frames, double exposure)
+{
+    if (Streamer->isBusy())
+    {
+        LOG_ERROR("Cannot start a sequence while streaming/recording is active.");
+        return false;
+    }
+
+    if (InExposure)
+    {
+        LOG_ERROR("Cannot start a sequence while an exposure is in progress.");
+        return false;
+    }
+
+    if (frames == 0 || frames > SEQUENCE_MAX_FRAMES)
+        return false;
+
+    HRESULT rc = 0;
+    time_t uSecs = static_cast<time_t>(exposure * 1000000.0);
+    if (FAILED(rc = FP(put_ExpoTime(m_Handle, uSecs))))
+    {
+        LOGF_ERROR("Failed to set exposure time. %s", errorCodes(rc).c_str());
+        return false;
+    }
+
+    if (m_CurrentTriggerMode != TRIGGER_SOFTWARE)
+    {
+        rc = FP(put_Option(m_Handle, CP(OPTION_TRIGGER), 1));
+        if (FAILED(rc))
+            LOGF_ERROR("Failed to set software trigger mode. %s", errorCodes(rc).c_str());
+        m_CurrentTriggerMode = TRIGGER_SOFTWARE;
+    }
+
+    // A few more frames absorb FITS encoding and upload jitter on the worker
+    m_FramesDropped += m_FramePool.resize(std::max<size_t>(FRAME_POOL_DEPTH, std::min<uint32_t>(frames, SEQUENCE_POOL_DEPTH)),
+                                          m_FramePool.frameSize());
+
+    PrimaryCCD.setExposureDuration(exposure);
+    m_ExposureRequest = exposure;
+
+    // Count down the whole sequence
+    timeval current_time, exposure_time;
+    uint64_t totalUSecs = static_cast<uint64_t>(uSecs) * frames;
+    exposure_time.tv_sec = totalUSecs / 1000000;
+    exposure_time.tv_usec = totalUSecs % 1000000;
+    gettimeofday(&current_time, nullptr);
+    timeradd(&current_time, &exposure_time, &m_ExposureEnd);
+
+    m_SequenceFrames = frames;
+    m_SequenceStartDelivered = m_FramesDelivered;
+    m_SequenceStartDropped = m_FramesDropped;
+    m_SequenceDone = false;
+    m_SequenceRemaining = frames;
+
+    LOGF_INFO("Starting sequence of %u frames with exposure %.6f seconds.", frames, exposure);
+
+    InExposure = true;
+    if (FAILED(rc = FP(Trigger(m_Handle, static_cast<unsigned short>(frames)))))
+    {
+        LOGF_ERROR("Failed to trigger sequence. %s", errorCodes(rc).c_str());
+        m_SequenceRemaining = 0;
+        InExposure = false;
+        m_FramesDropped += m_FramePool.resize(FRAME_POOL_DEPTH, m_FramePool.frameSize());
+        return false;
+    }
+
     return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::finishSequence()
+{
+    m_SequenceDone = false;
+
+    // Give the extra sequence frames back
+    m_FramesDropped += m_FramePool.resize(FRAME_POOL_DEPTH, m_FramePool.frameSize());
+
+    uint32_t delivered = m_FramesDelivered - m_SequenceStartDelivered;
+    uint32_t dropped = m_FramesDropped - m_SequenceStartDropped;
+    LOGF_INFO("Sequence complete. %u of %u frames delivered, %u dropped.", delivered, m_SequenceFrames, dropped);
+
+    m_SequenceNP.s = (delivered == m_SequenceFrames) ? IPS_OK : IPS_ALERT;
+    IDSetNumber(&m_SequenceNP, nullptr);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ///
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1487,6 +1641,12 @@ void ToupBase::TimerHit()
             timeleft = 0;
         PrimaryCCD.setExposureLeft(timeleft);
     }
+    updateFrameStats();
+
+    // Wait for the worker to deliver the last frames before shrinking the pool
+    if (m_SequenceDone && m_FramePool.isIdle())
+        finishSequence();
+
     if (m_Instance->model->flag & CP(FLAG_GETTEMPERATURE))
     {
         int16_t currentTemperature = (int16_t)(TemperatureN[0].value * 10);
@@ -1773,16 +1933,164 @@ void ToupBase::eventCB(unsigned event, void* pCtx)
     static_cast<ToupBase*>(pCtx)->eventCallBack(event);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Runs on the SDK callback thread: only pull the image into a free pool frame and hand it over to
+/// the processing worker, anything slower here stalls the SDK pipeline.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::pullImage()
+{
+    FramePool::FrameType type;
+    bool sequence = false;
+    if (Streamer->isStreaming() || Streamer->isRecording())
+        type = FramePool::FRAME_STREAM;
+    else if (m_SequenceRemaining > 0)
+    {
+        sequence = true;
+        type = FramePool::FRAME_EXPOSURE;
+        if (--m_SequenceRemaining == 0)
+        {
+            InExposure = false;
+            m_SequenceDone = true;
+        }
+    }
+    else if (InExposure)
+    {
+        InExposure = false;
+        type = FramePool::FRAME_EXPOSURE;
+    }
+    else
+    {
+        HRESULT rc = FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
+        if (FAILED(rc))
+            LOGF_ERROR("Failed to flush image. %s", errorCodes(rc).c_str());
+        return;
+    }
+
+    int captureBits = m_BitsPerPixel == 8 ? 8 : m_maxBitDepth;
+    FramePool::Frame *frame = m_FramePool.acquire();
+    if (frame == nullptr)
+    {
+        // Worker is behind, drop the pending image so the SDK can move on
+        FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
+        m_FramesDropped++;
+        if (sequence)
+            LOG_WARN("Sequence frame dropped, no free frame buffer.");
+        else if (type == FramePool::FRAME_EXPOSURE)
+        {
+            LOG_ERROR("Failed to pull image, no free frame buffer.");
+            PrimaryCCD.setExposureFailed();
+        }
+        return;
+    }
+
+    XP(FrameInfoV2) info;
+    memset(&info, 0, sizeof(XP(FrameInfoV2)));
+
+    HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, frame->data.data(), captureBits * m_Channels, -1, &info));
+    if (FAILED(rc))
+    {
+        m_FramePool.done(frame);
+        if (sequence)
+            LOGF_WARN("Failed to pull sequence frame. %s", errorCodes(rc).c_str());
+        else if (type == FramePool::FRAME_EXPOSURE)
+        {
+            LOGF_ERROR("Failed to pull image. %s", errorCodes(rc).c_str());
+            PrimaryCCD.setExposureFailed();
+        }
+        return;
+    }
+
+    frame->type   = type;
+    frame->width  = info.width;
+    frame->height = info.height;
+    frame->size   = static_cast<size_t>(info.width) * info.height * m_Channels * (captureBits > 8 ? 2 : 1);
+    m_FramePool.submit(frame);
+
+    if (type == FramePool::FRAME_EXPOSURE)
+        LOGF_DEBUG("Image received. Width: %d, Height: %d, flag: %d, timestamp: %ld", info.width, info.height, info.flag,
+                   info.timestamp);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::processFrames()
+{
+    while (true)
+    {
+        FramePool::Frame *frame = m_FramePool.next(std::chrono::milliseconds(500));
+        if (frame == nullptr)
+        {
+            if (m_FramePool.isClosed())
+                break;
+            continue;
+        }
+
+        processFrame(frame);
+        m_FramePool.done(frame);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::processFrame(FramePool::Frame *frame)
+{
+    if (frame->type == FramePool::FRAME_STREAM)
+    {
+        Streamer->newFrame(frame->data.data(), std::min(frame->size, static_cast<size_t>(PrimaryCCD.getFrameBufferSize())));
+        m_FramesDelivered++;
+        return;
+    }
+
+    PrimaryCCD.setExposureLeft(0);
+
+    {
+        std::unique_lock<std::mutex> guard(ccdBufferLock);
+        uint8_t *image = PrimaryCCD.getFrameBuffer();
+
+        if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
+        {
+            size_t nPixels  = (PrimaryCCD.getSubW() / PrimaryCCD.getBinX()) * (PrimaryCCD.getSubH() / PrimaryCCD.getBinY());
+
+            // RGB to three sepearate R-frame, G-frame, and B-frame for color FITS.
+            // Each plane holds nPixels samples whatever the bit depth, 16-bit samples move as whole words.
+            if (PrimaryCCD.getBPP() == 16)
+            {
+                uint16_t *image16 = reinterpret_cast<uint16_t *>(image);
+                pixelconvert_deinterleave_rgb48(reinterpret_cast<uint16_t *>(frame->data.data()), image16, image16 + nPixels,
+                                                image16 + nPixels * 2, nPixels, PIXELCONVERT_ORDER_RGB);
+            }
+            else
+                pixelconvert_deinterleave_rgb24(frame->data.data(), image, image + nPixels, image + nPixels * 2, nPixels,
+                                                PIXELCONVERT_ORDER_RGB);
+        }
+        else
+            memcpy(image, frame->data.data(), std::min(frame->size, static_cast<size_t>(PrimaryCCD.getFrameBufferSize())));
+    }
+
+    ExposureComplete(&PrimaryCCD);
+    m_FramesDelivered++;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ///
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-uint8_t* ToupBase::getRgbBuffer()
+void ToupBase::updateFrameStats()
 {
-    if (m_rgbBuffer && (m_rgbBufferSize == PrimaryCCD.getXRes() * PrimaryCCD.getYRes() * 3))
-        return m_rgbBuffer;
-    m_rgbBufferSize = PrimaryCCD.getXRes() * PrimaryCCD.getYRes() * 3;
-    m_rgbBuffer = static_cast<uint8_t*>(realloc(m_rgbBuffer, m_rgbBufferSize));
-    return m_rgbBuffer;
+    int sdkDropped = 0;
+    FP(get_Option(m_Handle, CP(OPTION_NUMBER_DROP_FRAME), &sdkDropped));
+
+    if (m_FrameStatsN[TC_FRAMES_DELIVERED].value == m_FramesDelivered &&
+            m_FrameStatsN[TC_FRAMES_DROPPED].value == m_FramesDropped &&
+            m_FrameStatsN[TC_FRAMES_SDK_DROPPED].value == sdkDropped)
+        return;
+
+    m_FrameStatsN[TC_FRAMES_DELIVERED].value = m_FramesDelivered;
+    m_FrameStatsN[TC_FRAMES_DROPPED].value = m_FramesDropped;
+    m_FrameStatsN[TC_FRAMES_SDK_DROPPED].value = sdkDropped;
+    m_FrameStatsNP.s = (m_FramesDropped > 0 || sdkDropped > 0) ? IPS_BUSY : IPS_OK;
+    IDSetNumber(&m_FrameStatsNP, nullptr);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1803,67 +2111,8 @@ void ToupBase::eventCallBack(unsigned event)
         }
         break;
         case CP(EVENT_IMAGE):
-        {
-            int captureBits = m_BitsPerPixel == 8 ? 8 : m_maxBitDepth;
-            if (Streamer->isStreaming() || Streamer->isRecording())
-            {
-                HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, PrimaryCCD.getFrameBuffer(), captureBits * m_Channels, -1, nullptr));
-                if (SUCCEEDED(rc))
-                    Streamer->newFrame(PrimaryCCD.getFrameBuffer(), PrimaryCCD.getFrameBufferSize());
-            }
-            else if (InExposure)
-            {
-                InExposure = false;
-                PrimaryCCD.setExposureLeft(0);
-
-                XP(FrameInfoV2) info;
-                memset(&info, 0, sizeof(XP(FrameInfoV2)));
-
-                uint8_t *buffer = PrimaryCCD.getFrameBuffer();
-                if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
-                    buffer = getRgbBuffer();
-
-                HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, buffer, captureBits * m_Channels, -1, &info));
-                if (FAILED(rc))
-                {
-                    LOGF_ERROR("Failed to pull image. %s", errorCodes(rc).c_str());
-                    PrimaryCCD.setExposureFailed();
-                }
-                else
-                {
-                    if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
-                    {
-                        uint8_t *image  = PrimaryCCD.getFrameBuffer();
-                        uint32_t width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX() * (PrimaryCCD.getBPP() / 8);
-                        uint32_t height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY() * (PrimaryCCD.getBPP() / 8);
-
-                        uint8_t *subR = image;
-                        uint8_t *subG = image + width * height;
-                        uint8_t *subB = image + width * height * 2;
-                        int size      = width * height * 3 - 3;
-
-                        // RGB to three sepearate R-frame, G-frame, and B-frame for color FITS
-                        for (int i = 0; i <= size; i += 3)
-                        {
-                            *subR++ = buffer[i];
-                            *subG++ = buffer[i + 1];
-                            *subB++ = buffer[i + 2];
-                        }
-                    }
-
-                    LOGF_DEBUG("Image received. Width: %d, Height: %d, flag: %d, timestamp: %ld", info.width, info.height, info.flag,
-                               info.timestamp);
-                    ExposureComplete(&PrimaryCCD);
-                }
-            }
-            else
-            {
-                HRESULT rc = FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
-                if (FAILED(rc))
-                    LOGF_ERROR("Failed to flush image. %s", errorCodes(rc).c_str());
-            }
-        }
-        break;
+            pullImage();
+            break;
         case CP(EVENT_WBGAIN):
         {
             int aGain[3] = { 0 };
@@ -23,7 +23,10 @@
 
 #include <indiccd.h>
 #include <inditimer.h>
+#include <atomic>
+#include <thread>
 #include "libtoupbase.h"
+#include "toupbase_frame_pool.h"
 
 class ToupBase : public INDI::CCD
 {
@@ -143,6 +146,36 @@ class ToupBase : public INDI::CCD
         //#############################################################################
         static void eventCB(unsigned event, void* pCtx);
         void eventCallBack(unsigned event);
+        // Pull the image into a pool frame, called from the SDK callback thread
+        void pullImage();
+
+        //#############################################################################
+        // Frame Processing
+        //#############################################################################
+        // Worker thread, processes frames pulled by the callback
+        void processFrames();
+        void processFrame(FramePool::Frame *frame);
+        void updateFrameStats();
+
+        //#############################################################################
+        // Sequence
+        //#############################################################################
+        // Arm frames software triggered exposures with a single trigger command
+        bool startSequence(uint32_t frames, double exposure);
+        // Called from TimerHit once the last frame of the sequence has been processed
+        void finishSequence();
+
+        FramePool m_FramePool;
+        std::thread m_ProcessThread;
+        std::atomic<uint32_t> m_FramesDelivered { 0 };
+        std::atomic<uint32_t> m_FramesDropped { 0 };
+
+        // Frames of the running sequence not yet received from the SDK
+        std::atomic<uint32_t> m_SequenceRemaining { 0 };
+        std::atomic_bool m_SequenceDone { false };
+        uint32_t m_SequenceFrames { 0 };
+        uint32_t m_SequenceStartDelivered { 0 };
+        uint32_t m_SequenceStartDropped { 0 };
 
         //#############################################################################
         // Camera Handle & Instance
@@ -270,6 +303,25 @@ class ToupBase : public INDI::CCD
         INumberVectorProperty m_TimeoutFactorNP;
         INumber m_TimeoutFactorN;
 
+        // Frame counters
+        INumberVectorProperty m_FrameStatsNP;
+        INumber m_FrameStatsN[3];
+        enum
+        {
+            TC_FRAMES_DELIVERED,
+            TC_FRAMES_DROPPED,
+            TC_FRAMES_SDK_DROPPED,
+        };
+
+        // Sequence
+        INumberVectorProperty m_SequenceNP;
+        INumber m_SequenceN[2];
+        enum
+        {
+            TC_SEQUENCE_FRAMES,
+            TC_SEQUENCE_EXPOSURE,
+        };
+
         ISwitchVectorProperty m_GainConversionSP;
         ISwitch m_GainConversionS[3];
         enum
@@ -288,10 +340,6 @@ class ToupBase : public INDI::CCD
         uint8_t m_BitsPerPixel { 8 };
         uint8_t m_maxBitDepth { 8 };
         uint8_t m_Channels { 1 };
-        
-        uint8_t *getRgbBuffer();
-        uint8_t *m_rgbBuffer { nullptr };
-        int32_t m_rgbBufferSize { 0 };
 
         int m_ConfigResolutionIndex {-1};
 };
@@ -0,0 +1,146 @@
+/*
+ Toupcam & oem CCD Driver - Frame Pool
+
+ Copyright (C) 2026 INDI Developers
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "toupbase_frame_pool.h"
+
+size_t FramePool::resize(size_t count, size_t frameSize)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    // Frames held by the callback or the worker must not move under them
+    m_IdleCondition.wait(lock, [this] { return m_Busy == 0; });
+
+    size_t dropped = m_Queue.size();
+    m_Queue.clear();
+    m_Free.clear();
+
+    // std::deque keeps the addresses of existing frames stable while it grows
+    while (m_Frames.size() < count)
+        m_Frames.emplace_back();
+    while (m_Frames.size() > count)
+        m_Frames.pop_back();
+
+    m_FrameSize = frameSize;
+    for (auto &frame : m_Frames)
+    {
+        // Never shrink, a smaller ROI or bit depth reuses the existing allocation
+        if (frame.data.size() < frameSize)
+            frame.data.resize(frameSize);
+        frame.size = 0;
+        m_Free.push_back(&frame);
+    }
+
+    return dropped;
+}
+
+void FramePool::release()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_IdleCondition.wait(lock, [this] { return m_Busy == 0; });
+
+    m_Queue.clear();
+    m_Free.clear();
+    m_Frames.clear();
+    m_FrameSize = 0;
+}
+
+FramePool::Frame *FramePool::acquire()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    if (m_Free.empty())
+        return nullptr;
+
+    Frame *frame = m_Free.back();
+    m_Free.pop_back();
+    m_Busy++;
+    return frame;
+}
+
+void FramePool::submit(Frame *frame)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Busy--;
+        if (m_Closed)
+            m_Free.push_back(frame);
+        else
+            m_Queue.push_back(frame);
+    }
+    m_QueueCondition.notify_one();
+    m_IdleCondition.notify_all();
+}
+
+FramePool::Frame *FramePool::next(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    if (!m_QueueCondition.wait_for(lock, timeout, [this] { return !m_Queue.empty() || m_Closed; }))
+        return nullptr;
+
+    if (m_Closed)
+        return nullptr;
+
+    Frame *frame = m_Queue.front();
+    m_Queue.pop_front();
+    m_Busy++;
+    return frame;
+}
+
+void FramePool::done(Frame *frame)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Busy--;
+        m_Free.push_back(frame);
+    }
+    m_IdleCondition.notify_all();
+}
+
+void FramePool::close()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Closed = true;
+        for (auto frame : m_Queue)
+            m_Free.push_back(frame);
+        m_Queue.clear();
+    }
+    m_QueueCondition.notify_all();
+}
+
+void FramePool::open()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Closed = false;
+}
+
+bool FramePool::isClosed()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    return m_Closed;
+}
+
+bool FramePool::isIdle()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    return m_Queue.empty() && m_Busy == 0;
+}
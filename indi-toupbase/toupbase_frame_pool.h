@@ -0,0 +1,102 @@
+/*
+ Toupcam & oem CCD Driver - Frame Pool
+
+ Copyright (C) 2026 INDI Developers
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Fixed set of pre-allocated frame buffers passed from the SDK callback to a processing worker.
+ *
+ * The callback takes a free frame with acquire(), which never blocks, pulls the image into it and
+ * queues it with submit(). The worker waits for queued frames with next() and gives them back with
+ * done(). Buffers only grow when the pool is resized, so no allocation happens per frame.
+ */
+class FramePool
+{
+    public:
+        enum FrameType
+        {
+            FRAME_STREAM,
+            FRAME_EXPOSURE,
+        };
+
+        struct Frame
+        {
+            std::vector<uint8_t> data;
+            /** Number of valid bytes in data */
+            size_t size {0};
+            FrameType type {FRAME_STREAM};
+            uint32_t width {0};
+            uint32_t height {0};
+        };
+
+    public:
+        /**
+         * @brief Make count frames of at least frameSize bytes available and drop all queued frames.
+         * Waits until every frame handed out by acquire() or next() has been returned.
+         * @return number of queued frames dropped, for the caller to count as lost
+         */
+        size_t resize(size_t count, size_t frameSize);
+
+        /** Free all buffers */
+        void release();
+
+        /** @return a free frame, or nullptr if all frames are queued or being processed */
+        Frame *acquire();
+        /** Queue a frame obtained by acquire() for the worker */
+        void submit(Frame *frame);
+
+        /** Wait up to timeout for a queued frame. Returns nullptr on timeout or once the pool is closed */
+        Frame *next(std::chrono::milliseconds timeout);
+        /** Return a frame obtained by next(), or by acquire() without submitting it, to the free list */
+        void done(Frame *frame);
+
+        /** Stop the worker. Queued frames are discarded */
+        void close();
+        /** Accept frames again after close() */
+        void open();
+        bool isClosed();
+        /** @return true when no frame is queued or held by the callback or the worker */
+        bool isIdle();
+
+        size_t frameSize() const
+        {
+            return m_FrameSize;
+        }
+
+    private:
+        std::deque<Frame> m_Frames;
+        std::vector<Frame *> m_Free;
+        std::deque<Frame *> m_Queue;
+        size_t m_FrameSize {0};
+        int m_Busy {0};
+        bool m_Closed {false};
+
+        std::mutex m_Mutex;
+        std::condition_variable m_QueueCondition;
+        std::condition_variable m_IdleCondition;
+};
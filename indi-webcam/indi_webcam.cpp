@@ -29,18 +29,28 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <eventloop.h>
 
 #include "indi_webcam.h"
+#include "webcam_bands.h"
+#include "webcam_convert.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
 #include "libavutil/dict.h"
+#include "libavutil/pixdesc.h"
 #ifdef __cplusplus
 }
 #endif
 
+#include <algorithm>
+#include <functional>
+
 #include "config.h"
 
 static std::unique_ptr<indi_webcam> webcam(new indi_webcam());
 
+//Frames are converted in bands of at least this many rows, each band on its own thread
+static const int MIN_SWS_SLICE_ROWS = 120;
+static const int MAX_SWS_SLICES = 8;
+
 //Note this is how we get information about AVFoundation Devices
 //FFMpeg does not provide a way to programmatically get them, but there is a way to log them.
 //So we capture the logging and parse it to get the list of devices.
@@ -158,7 +168,6 @@ indi_webcam::indi_webcam()
     optionsDict = nullptr;
     pFrame = nullptr;
     pFrameOUT = nullptr;
-    sws_ctx = nullptr;
     buffer = nullptr;
 
     // These calls are depreciated, but are required for some older FFMPEG distributions on Linux
@@ -193,7 +202,7 @@ indi_webcam::indi_webcam()
     frameRate = 30;
     videoSize = "640x480";
     webcamStacking = false;
-    averaging = false;
+    stackMode = WebcamStacker::STACK_INTEGRATION;
     outputFormat = "8 bit RGB";
 
     protocol = "HTTP";
@@ -520,12 +529,13 @@ bool indi_webcam::initProperties()
     CaptureFormat rgb = {"INDI_RGB", "RGB", 8, true};
     addCaptureFormat(rgb);
 
-    RapidStacking = new ISwitch[3];
+    RapidStacking = new ISwitch[4];
     IUFillSwitch(&RapidStacking[0], "Integration", "Integration", ISS_OFF);
     IUFillSwitch(&RapidStacking[1], "Average", "Average", ISS_OFF);
-    IUFillSwitch(&RapidStacking[2], "Off", "Off", ISS_ON);
+    IUFillSwitch(&RapidStacking[2], "Rejection", "Average, min/max rejected", ISS_OFF);
+    IUFillSwitch(&RapidStacking[3], "Off", "Off", ISS_ON);
 
-    IUFillSwitchVector(&RapidStackingSelection, RapidStacking, 3, getDeviceName(), "RAPID_STACKING_OPTION", "Rapid Stacking",
+    IUFillSwitchVector(&RapidStackingSelection, RapidStacking, 4, getDeviceName(), "RAPID_STACKING_OPTION", "Rapid Stacking",
                        MAIN_CONTROL_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
     defineProperty(&RapidStackingSelection);
 
@@ -652,6 +662,15 @@ bool indi_webcam::initProperties()
                        "Video Adjustment Options", IMAGE_SETTINGS_TAB, IP_RW, 0, IPS_IDLE);
     defineProperty(&VideoAdjustmentsTP);
 
+    IUFillNumber(&CaptureTimingN[STAGE_READ], "READ", "Read (ms)", "%.2f", 0, 100000, 0, 0);
+    IUFillNumber(&CaptureTimingN[STAGE_DECODE], "DECODE", "Decode (ms)", "%.2f", 0, 100000, 0, 0);
+    IUFillNumber(&CaptureTimingN[STAGE_CONVERT], "CONVERT", "Convert (ms)", "%.2f", 0, 100000, 0, 0);
+    IUFillNumber(&CaptureTimingN[STAGE_DELIVER], "DELIVER", "Deliver (ms)", "%.2f", 0, 100000, 0, 0);
+    IUFillNumber(&CaptureTimingN[STAGE_COUNT], "FPS", "Frames per second", "%.1f", 0, 100000, 0, 0);
+    IUFillNumberVector(&CaptureTimingNP, CaptureTimingN, NARRAY(CaptureTimingN), getDeviceName(), "CAPTURE_TIMING",
+                       "Capture Timing", OPTIONS_TAB, IP_RO, 0, IPS_IDLE);
+    defineProperty(&CaptureTimingNP);
+
     //Setting the log level
     av_log_set_level(AV_LOG_INFO);
 
@@ -873,9 +892,12 @@ bool indi_webcam::ISNewNumber (const char *dev, const char *name, double values[
     {
         IUUpdateNumber(&VideoAdjustmentsTP, values, names, n);
 
-        brightness = IUFindNumber( &VideoAdjustmentsTP, "BRIGHTNESS" )->value;
-        contrast = IUFindNumber( &VideoAdjustmentsTP, "CONTRAST" )->value;
-        saturation = IUFindNumber( &VideoAdjustmentsTP, "SATURATION" )->value;
+        {
+            std::lock_guard<std::mutex> lock(adjustmentsLock);
+            brightness = IUFindNumber( &VideoAdjustmentsTP, "BRIGHTNESS" )->value;
+            contrast = IUFindNumber( &VideoAdjustmentsTP, "CONTRAST" )->value;
+            saturation = IUFindNumber( &VideoAdjustmentsTP, "SATURATION" )->value;
+        }
 
         DEBUGF(INDI::Logger::DBG_SESSION, "New Video Adjustments: brightness: %.3f, contrast: %.3f, saturation: %.3f", brightness,
                contrast, saturation);
@@ -1042,17 +1064,22 @@ bool indi_webcam::ISNewSwitch (const char *dev, const char *name, ISState *state
             if(!strcmp(sp->name, "Integration"))
             {
                 webcamStacking = true;
-                averaging = false;
+                stackMode = WebcamStacker::STACK_INTEGRATION;
             }
             if(!strcmp(sp->name, "Average"))
             {
                 webcamStacking = true;
-                averaging = true;
+                stackMode = WebcamStacker::STACK_AVERAGE;
+            }
+            if(!strcmp(sp->name, "Rejection"))
+            {
+                webcamStacking = true;
+                stackMode = WebcamStacker::STACK_REJECTION;
             }
             if(!strcmp(sp->name, "Off"))
             {
                 webcamStacking = false;
-                averaging = false;
+                stackMode = WebcamStacker::STACK_INTEGRATION;
             }
             RapidStackingSelection.s = IPS_OK;
             IDSetSwitch(&RapidStackingSelection, nullptr);
@@ -1233,14 +1260,6 @@ bool indi_webcam::StartExposure(float duration)
         return false;
     }
 
-    //This resets the stack buffer
-    if(webcamStacking)
-    {
-        if(stackBuffer)
-            free(stackBuffer);
-        stackBuffer = nullptr;
-    }
-
     //This sets up the output format for the exposure
     if(outputFormat == "16 bit RGB")
     {
@@ -1273,6 +1292,11 @@ bool indi_webcam::StartExposure(float duration)
         return false;
     }
 
+    //This resets the stack, the frame buffer holds one plane per color, so each plane adds its rows
+    if(webcamStacking)
+        stacker.reset(stackMode, PrimaryCCD.getBPP(), pCodecCtx->width,
+                      pCodecCtx->height * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1));
+
     //This will ensure that we get the current frame, not some old frame still in the buffer
     if(!flush_frame_buffer())
         DEBUG(INDI::Logger::DBG_SESSION, "FFMPEG Issue in flushing buffer");
@@ -1299,8 +1323,7 @@ bool indi_webcam::StartExposure(float duration)
 
 bool indi_webcam::AbortExposure()
 {
-    if(stackBuffer)
-        free(stackBuffer);
+    stacker.clear();
     InExposure = false;
     return true;
 }
@@ -1353,6 +1376,7 @@ void indi_webcam::TimerHit()
             PrimaryCCD.setExposureLeft(0);
             InExposure = false;
             LOG_INFO("Download complete.");
+            reportCaptureTiming(true);
             finishExposure();
             freeMemory();
             return;
@@ -1371,11 +1395,17 @@ bool indi_webcam::grabImage()
     if(getStreamFrame())
     {
         if(PrimaryCCD.getNAxis() == 3)
-            convertINDI_RGBtoFITS_RGB(pFrameOUT->data[0], PrimaryCCD.getFrameBuffer());
+        {
+            convertINDI_RGBtoFITS_RGB(outputData, PrimaryCCD.getFrameBuffer());
+            if(webcamStacking)
+                addToStack(PrimaryCCD.getFrameBuffer());
+        }
+        //Grayscale frames are stacked straight from the capture, the final stack is copied to the frame buffer
+        else if(webcamStacking)
+            addToStack(outputData);
         else
-            memcpy(PrimaryCCD.getFrameBuffer(), pFrameOUT->data[0], numBytes);
-        if(webcamStacking)
-            addToStack();
+            memcpy(PrimaryCCD.getFrameBuffer(), outputData, numBytes);
+        endStage(STAGE_DELIVER);
         gotAnImageAlready = true;
     }
     else
@@ -1388,97 +1418,22 @@ bool indi_webcam::grabImage()
 }
 
 //This adds each image to the running stack
-bool indi_webcam::addToStack()
+bool indi_webcam::addToStack(const uint8_t *frame)
 {
-    if(!stackBuffer)
+    if(!stacker.add(frame))
     {
-        stackBuffer = (float *)malloc(numBytes * sizeof(float_t));
-        numberOfFramesInStack = 0;
-    }
-
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    int h = pCodecCtx->height;
-
-    for (int i = 0; i < w * h; i++)
-    {
-        int x = i % w;
-        int y = i / w;
-        if(x >= 0 && y >= 0 && x < w && y < h)
-        {
-            if(numberOfFramesInStack == 0)
-                stackBuffer[i] = getImageDataFloatValue(x, y);
-            else
-                stackBuffer[i] += getImageDataFloatValue(x, y);
-        }
+        LOGF_DEBUG("Stack is full at %d exposures, frame left out.", stacker.frames());
+        return false;
     }
-    numberOfFramesInStack++;
     return true;
 }
 
-//This gets the pixel value at an x, y position in the image
-float indi_webcam::getImageDataFloatValue(int x, int y)
-{
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    uint8_t *primaryBuffer = PrimaryCCD.getFrameBuffer();
-    if(PrimaryCCD.getBPP() == 8)
-        return (float) primaryBuffer[y * w + x];
-    else if(PrimaryCCD.getBPP() == 16)
-    {
-        uint16_t *newBuffer = reinterpret_cast<uint16_t *>(primaryBuffer);
-        return (float) newBuffer[y * w + x];
-    }
-    else
-        return 0;
-}
-//This sets the pixel value at an x, y position in the image
-void indi_webcam::setImageDataValueFromFloat(int x, int y, float value, bool roundAnswer)
-{
-    uint8_t *primaryBuffer = PrimaryCCD.getFrameBuffer();
-    int w = pCodecCtx->width * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    if(!stackBuffer)
-        return;
-    if(PrimaryCCD.getBPP() == 8)
-    {
-        int max = std::numeric_limits<uint8_t>::max();
-        if (value > max)
-            value = max;
-        if(roundAnswer)
-            primaryBuffer[y * w + x] = round(value);
-        else
-            primaryBuffer[y * w + x] = value;
-    }
-    else if(PrimaryCCD.getBPP() == 16)
-    {
-        int max = std::numeric_limits<uint16_t>::max();
-        if (value > max)
-            value = max;
-        uint16_t *newBuffer = reinterpret_cast<uint16_t *>(primaryBuffer);
-        if(roundAnswer)
-            newBuffer[y * w + x] = round(value);
-        else
-            newBuffer[y * w + x] = value;
-    }
-}
-
 //This will take the final image stack and copy it back to the primary buffer for final download.
 void indi_webcam::copyFinalStackToPrimaryFrameBuffer()
 {
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    int h = pCodecCtx->height;
-    for (int i = 0; i < w * h; i++)
-    {
-        int x = i % w;
-        int y = i / w;
-        if(x >= 0 && y >= 0 && x < w && y < h)
-        {
-            if(averaging)
-                setImageDataValueFromFloat(x, y, round(stackBuffer[i] / numberOfFramesInStack), true);
-            else //Integrating
-                setImageDataValueFromFloat(x, y, round(stackBuffer[i]), true);
-        }
-    }
+    stacker.finish(PrimaryCCD.getFrameBuffer());
 
-    LOGF_INFO("Final Image is a stack of %u exposures.", numberOfFramesInStack);
+    LOGF_INFO("Final Image is a stack of %d exposures.", stacker.frames());
 }
 
 //This will crop the image to a subframe if desired.
@@ -1507,12 +1462,24 @@ void indi_webcam::finishExposure()
                    subFrameSize, oneFrameSize,
                    subX, subY, subW, subH);
 
+        //Full width subframes are one block of rows in each plane
+        bool fullRows = (subX == 0 && subW == w);
+
         if (naxis == 2)
         {
             // JM 2020-08-29: Using memmove since regions are overlaping
             // as proposed by Camiel Severijns on INDI forums.
-            for (int i = subY; i < subY + subH; i++)
-                memmove(memptr + (i - subY) * lineW, memptr + (i * w + subX) * bpp / 8, lineW);
+            if (fullRows)
+                memmove(memptr, memptr + subY * lineW, oneFrameSize);
+            else
+                for (int i = subY; i < subY + subH; i++)
+                    memmove(memptr + (i - subY) * lineW, memptr + (i * w + subX) * bpp / 8, lineW);
+        }
+        else if (fullRows)
+        {
+            //Each plane moves down to the end of the previous one, so a plane only overlaps itself
+            for (int plane = 0; plane < 3; plane++)
+                memmove(memptr + plane * oneFrameSize, memptr + (plane * h + subY) * lineW, oneFrameSize);
         }
         else
         {
@@ -1666,7 +1633,11 @@ void indi_webcam::run_capture()
     {
 
         if(getStreamFrame())
-            Streamer->newFrame(pFrameOUT->data[0], numBytes);
+        {
+            Streamer->newFrame(outputData, numBytes);
+            endStage(STAGE_DELIVER);
+            reportCaptureTiming(false);
+        }
         else
         {
             is_capturing = false;
@@ -1674,6 +1645,7 @@ void indi_webcam::run_capture()
         }
     }
 
+    reportCaptureTiming(true);
     freeMemory();
 
     DEBUG(INDI::Logger::DBG_SESSION, "Capture thread releasing device.");
@@ -1739,32 +1711,161 @@ bool indi_webcam::setupStreaming()
     av_image_fill_arrays (pFrameOUT->data, pFrameOUT->linesize, buffer, out_pix_fmt,
                           pCodecCtx->width, pCodecCtx->height, 1);
 
-    // initialize SWS context for software scaling
-    sws_ctx = sws_getContext( pCodecCtx->width, pCodecCtx->height,
-                              pCodecCtx->pix_fmt, pCodecCtx->width, pCodecCtx->height,
-                              out_pix_fmt, SWS_BILINEAR, nullptr, nullptr, nullptr
-                            );
-    if(sws_ctx == nullptr)
-        return false;
+    // initialize SWS contexts for software scaling, one for each band of rows.
+    // Palette formats keep the palette in the second plane, so they are converted in one piece.
+    // So are vertically subsampled formats (yuv420p, yuvj420p, NV12...): a context only sees the chroma
+    // rows of its own band, so chroma interpolated across a band seam would differ from a single conversion.
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pCodecCtx->pix_fmt);
+    int slices = 1;
+    if(desc && !(desc->flags & AV_PIX_FMT_FLAG_PAL) && desc->log2_chroma_h == 0)
+        slices = std::min({ WebcamBandPool::instance().threads(), MAX_SWS_SLICES, pCodecCtx->height / MIN_SWS_SLICE_ROWS });
+
+    // Bands start on a multiple of 16 rows
+    std::vector<int> starts = webcamSliceRows(pCodecCtx->height, slices, 16);
+    for(size_t i = 0; i + 1 < starts.size(); i++)
+    {
+        SwsSlice slice = { nullptr, starts[i], starts[i + 1] - starts[i] };
+        slice.ctx = sws_getContext( pCodecCtx->width, slice.h,
+                                    pCodecCtx->pix_fmt, pCodecCtx->width, slice.h,
+                                    out_pix_fmt, SWS_BILINEAR, nullptr, nullptr, nullptr
+                                  );
+        if(slice.ctx == nullptr)
+            return false;
+        sws_slices.push_back(slice);
+    }
+    LOGF_DEBUG("Converting %s to %s in %d bands.", av_get_pix_fmt_name(pCodecCtx->pix_fmt),
+               av_get_pix_fmt_name(out_pix_fmt), (int)sws_slices.size());
 
     updateVideoAdjustments();
 
     PrimaryCCD.setFrameBufferSize(numBytes);
     PrimaryCCD.setResolution(pCodecCtx->width, pCodecCtx->height);
 
+    std::fill(std::begin(stageSeconds), std::end(stageSeconds), 0.0);
+    timedFrames = 0;
+    timingStart = std::chrono::steady_clock::now();
+
     return true;
 }
 
+//The scaling contexts belong to the thread converting the frames, so new adjustments
+//are only noted here and convertFrame applies them before the next frame.
 void indi_webcam::updateVideoAdjustments()
 {
-    if(sws_ctx == nullptr)
-        return;
+    std::lock_guard<std::mutex> lock(adjustmentsLock);
+    adjustmentsChanged = true;
+}
 
+//Called by the converting thread with adjustmentsLock held
+void indi_webcam::applyVideoAdjustments()
+{
     int src_range = 1, dst_range = 1; //These are just flags 1 for Jpeg and 2 for Mpeg
     const int* coefs = sws_getCoefficients(SWS_CS_DEFAULT);
     //Note these last 3 values are reported in 16.16 fixed point format
-    sws_setColorspaceDetails(sws_ctx, coefs, src_range, coefs, dst_range,
-                             (int)(brightness * 65536), (int)(contrast * 65536), (int)(saturation * 65536));
+    for(SwsSlice &slice : sws_slices)
+        sws_setColorspaceDetails(slice.ctx, coefs, src_range, coefs, dst_range,
+                                 (int)(brightness * 65536), (int)(contrast * 65536), (int)(saturation * 65536));
+}
+
+//This converts the decoded frame to the output format.
+//When the device already delivers the output format, the decoded frame is used as it is.
+void indi_webcam::convertFrame()
+{
+    int w = pCodecCtx->width;
+    int h = pCodecCtx->height;
+    AVPixelFormat in_pix_fmt = (AVPixelFormat)pFrame->format;
+
+    //All output formats are packed in one plane, swscale would only copy it
+    if(in_pix_fmt == out_pix_fmt)
+    {
+        int lineBytes = av_image_get_linesize(out_pix_fmt, w, 0);
+        if(pFrame->linesize[0] == lineBytes)
+            outputData = pFrame->data[0];
+        else
+        {
+            av_image_copy_plane(buffer, pFrameOUT->linesize[0], pFrame->data[0], pFrame->linesize[0], lineBytes, h);
+            outputData = buffer;
+        }
+        return;
+    }
+
+    bool adjusted;
+    {
+        std::lock_guard<std::mutex> lock(adjustmentsLock);
+        if(adjustmentsChanged)
+            applyVideoAdjustments();
+        adjustmentsChanged = false;
+        //With both ranges set to full range, swscale gives the Y samples unchanged as 8 bit grayscale
+        adjusted = brightness != 0 || contrast != 1 || saturation != 1;
+    }
+
+    if(in_pix_fmt == AV_PIX_FMT_YUYV422 && out_pix_fmt == AV_PIX_FMT_GRAY8 && !adjusted)
+    {
+        for(int y = 0; y < h; y++)
+            webcamExtractLuma(buffer + y * pFrameOUT->linesize[0], pFrame->data[0] + y * pFrame->linesize[0], w);
+        outputData = buffer;
+        return;
+    }
+
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pCodecCtx->pix_fmt);
+    auto convertSlice = [this, desc](const SwsSlice & slice)
+    {
+        const uint8_t *src[4] = { nullptr };
+        uint8_t *dst[4] = { nullptr };
+        for(int p = 0; p < 4 && pFrame->data[p]; p++)
+        {
+            //The chroma planes have fewer rows when they are subsampled
+            int y = (p == 1 || p == 2) ? (slice.y >> desc->log2_chroma_h) : slice.y;
+            src[p] = pFrame->data[p] + (ptrdiff_t)y * pFrame->linesize[p];
+        }
+        dst[0] = pFrameOUT->data[0] + (ptrdiff_t)slice.y * pFrameOUT->linesize[0];
+        sws_scale(slice.ctx, src, pFrame->linesize, 0, slice.h, dst, pFrameOUT->linesize);
+    };
+
+    WebcamBandPool::instance().run((int)sws_slices.size(), [this, &convertSlice](int band)
+    {
+        convertSlice(sws_slices[band]);
+    });
+
+    outputData = buffer;
+}
+
+//This adds the time since the end of the previous stage to a stage of the capture path.
+void indi_webcam::endStage(int stage)
+{
+    auto now = std::chrono::steady_clock::now();
+    stageSeconds[stage] += std::chrono::duration<double>(now - stageStart).count();
+    stageStart = now;
+    //A frame is done once it has been delivered
+    if(stage == STAGE_DELIVER)
+        timedFrames++;
+}
+
+//This reports the average time per frame of each stage, about once a second while streaming
+//and at the end of an exposure or a stream.
+void indi_webcam::reportCaptureTiming(bool last)
+{
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - timingStart).count();
+    if(timedFrames == 0 || (!last && elapsed < 1))
+        return;
+
+    for(int i = 0; i < STAGE_COUNT; i++)
+    {
+        CaptureTimingN[i].value = stageSeconds[i] * 1000 / timedFrames;
+        stageSeconds[i] = 0;
+    }
+    CaptureTimingN[STAGE_COUNT].value = timedFrames / elapsed;
+    CaptureTimingNP.s = IPS_OK;
+    IDSetNumber(&CaptureTimingNP, nullptr);
+
+    if(last)
+        LOGF_DEBUG("Capture per frame: read %.2f ms, decode %.2f ms, convert %.2f ms, deliver %.2f ms, %.1f frames per second.",
+                   CaptureTimingN[STAGE_READ].value, CaptureTimingN[STAGE_DECODE].value, CaptureTimingN[STAGE_CONVERT].value,
+                   CaptureTimingN[STAGE_DELIVER].value, CaptureTimingN[STAGE_COUNT].value);
+
+    timedFrames = 0;
+    timingStart = now;
 }
 
 //This gets one image from the camera.
@@ -1772,6 +1873,7 @@ void indi_webcam::updateVideoAdjustments()
 bool indi_webcam::getStreamFrame()
 {
     AVPacket packet;
+    stageStart = std::chrono::steady_clock::now();
     //If at first you don't succees to get a frame, try again.
     int ret = -1;
     while(ret < 0)
@@ -1815,6 +1917,7 @@ bool indi_webcam::getStreamFrame()
             }
         }
     }
+    endStage(STAGE_READ);
     if(packet.stream_index == videoStream)
     {
         int ret;
@@ -1839,10 +1942,10 @@ bool indi_webcam::getStreamFrame()
                 return false;
             }
             // We have a frame at that point
+            endStage(STAGE_DECODE);
             // Convert the image from its native format to our output format
-            sws_scale(sws_ctx, (uint8_t const * const *)pFrame->data,
-                      pFrame->linesize, 0, pCodecCtx->height,
-                      pFrameOUT->data, pFrameOUT->linesize);
+            convertFrame();
+            endStage(STAGE_CONVERT);
             av_packet_unref(&packet);
             return true;
         }
@@ -1884,10 +1987,12 @@ bool indi_webcam::getStreamFrame()
 //This frees up the resources used for streaming/exposing
 void indi_webcam::freeMemory()
 {
-    // Free the sws_context
-    if(sws_ctx)
-        sws_freeContext(sws_ctx);
-    sws_ctx = nullptr;
+    // Free the sws_contexts
+    for(SwsSlice &slice : sws_slices)
+        if(slice.ctx)
+            sws_freeContext(slice.ctx);
+    sws_slices.clear();
+    outputData = nullptr;
 
     // Free the Buffer
     if(buffer)
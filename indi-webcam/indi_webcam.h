@@ -28,6 +28,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <indiccd.h>
 #include <stream/streammanager.h>
 
+#include "webcam_stack.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -42,6 +44,8 @@ extern "C" {
 }
 #endif
 //#include <ctime>
+#include <chrono>
+#include <mutex>
 #include <thread>
 
 //These are required to check for AVFoundation Devices
@@ -117,15 +121,10 @@ private:
     bool webcamStacking = false;
     bool gotAnImageAlready = false;
     bool loadingSettings = false;
-    bool averaging = false;
-    float *stackBuffer = nullptr;
-    int numberOfFramesInStack = 0;
-    bool addToStack();
+    WebcamStacker::Mode stackMode = WebcamStacker::STACK_INTEGRATION;
+    WebcamStacker stacker;
+    bool addToStack(const uint8_t *frame);
     void copyFinalStackToPrimaryFrameBuffer();
-    void setImageDataValueFromFloat(int x, int y, float value, bool roundAnswer);
-    void setRGBImageDataValueFromFloat(int x, int y, int channel, float value, bool roundAnswer);
-    float getImageDataFloatValue(int x, int y);
-    float getRGBImageDataFloatValue(int x, int y, int channel);
 
     //These are our device capture settings
     bool use16Bit = true;
@@ -186,12 +185,24 @@ private:
     INumber VideoAdjustmentsT[3] {};
     INumberVectorProperty VideoAdjustmentsTP;
 
+    //Time spent in each stage of the capture path, reported in ms per frame
+    enum { STAGE_READ, STAGE_DECODE, STAGE_CONVERT, STAGE_DELIVER, STAGE_COUNT };
+    INumber CaptureTimingN[STAGE_COUNT + 1] {};
+    INumberVectorProperty CaptureTimingNP;
+    double stageSeconds[STAGE_COUNT] {};
+    int timedFrames = 0;
+    std::chrono::steady_clock::time_point stageStart;
+    std::chrono::steady_clock::time_point timingStart;
+    void endStage(int stage);
+    void reportCaptureTiming(bool last);
+
 
     //Webcam setup, release, and frame capture
     bool flush_frame_buffer();
     bool setupStreaming();
     void freeMemory();
     bool getStreamFrame();
+    void convertFrame();
 
     //Related to streaming
     std::thread capture_thread;
@@ -203,8 +214,17 @@ private:
     void stop_capturing();
 
     //FFMpeg Variables to make captures work.
-    struct SwsContext *sws_ctx;
+    //One scaling context per band of rows, so that large frames are converted on several threads
+    struct SwsSlice
+    {
+        struct SwsContext *ctx;
+        int y;
+        int h;
+    };
+    std::vector<SwsSlice> sws_slices;
     uint8_t *buffer;
+    //The frame in the output format, in buffer or, when the device already delivers that format, in pFrame
+    uint8_t *outputData = nullptr;
     int numBytes = 0;
     AVPixelFormat out_pix_fmt;
     AVFormatContext *pFormatCtx;
@@ -219,11 +239,14 @@ private:
     AVFrame         *pFrameOUT;
     AVDictionary *optionsDict;
 
-    //FFMpeg Video Adjustments
+    //FFMpeg Video Adjustments, set by the INDI thread and applied to sws_slices by the converting thread
+    std::mutex adjustmentsLock;
     double brightness = 0.0;
     double contrast = 1.0;
     double saturation = 1.0;
+    bool adjustmentsChanged = false;
     void updateVideoAdjustments();
+    void applyVideoAdjustments();
 
 };
 #endif // indi_webcam_H
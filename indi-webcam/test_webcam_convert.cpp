@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2026, INDI Developers
+ *
+ * Checks the conversions the webcam driver does without swscale and the
+ * bands it converts in parallel.
+ */
+
+#include "webcam_convert.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+std::vector<uint8_t> makeYuyv(size_t pixels, unsigned int seed)
+{
+    std::vector<uint8_t> frame(2 * pixels);
+    uint32_t state = seed * 2654435761u + 1;
+    for (uint8_t &v : frame)
+    {
+        state = state * 1103515245u + 12345u;
+        v     = (uint8_t)(state >> 16);
+    }
+    return frame;
+}
+}
+
+TEST(WebcamConvert, ExtractLuma)
+{
+    // Odd sizes to cover the scalar tail
+    for (size_t pixels : { (size_t)1, (size_t)15, (size_t)16, (size_t)640 * 3 + 7 })
+    {
+        std::vector<uint8_t> yuyv = makeYuyv(pixels, (unsigned int)pixels);
+        std::vector<uint8_t> gray(pixels + 1, 0xA5), expected(pixels + 1, 0xA5);
+        for (size_t i = 0; i < pixels; i++)
+            expected[i] = yuyv[2 * i];
+        webcamExtractLuma(gray.data(), yuyv.data(), pixels);
+        EXPECT_EQ(expected, gray) << pixels << " pixels";
+    }
+}
+
+TEST(WebcamConvert, SliceRows)
+{
+    for (int height : { 1, 15, 240, 480, 720, 1080, 1200 })
+    {
+        for (int slices : { 1, 2, 3, 4, 7, 8 })
+        {
+            for (int alignment : { 1, 2, 16 })
+            {
+                std::vector<int> starts = webcamSliceRows(height, slices, alignment);
+                ASSERT_GE(starts.size(), 2u);
+                EXPECT_LE((int)starts.size() - 1, slices);
+                EXPECT_EQ(0, starts.front());
+                EXPECT_EQ(height, starts.back());
+                for (size_t i = 0; i + 1 < starts.size(); i++)
+                {
+                    EXPECT_LT(starts[i], starts[i + 1]);
+                    EXPECT_EQ(0, starts[i] % alignment) << height << " rows, " << slices << " slices";
+                }
+            }
+        }
+    }
+}
+
+TEST(WebcamConvert, Benchmark)
+{
+    using Clock      = std::chrono::steady_clock;
+    const int frames = 100;
+    const size_t pixels = 1920 * 1080;
+    std::vector<uint8_t> yuyv = makeYuyv(pixels, 3), gray(pixels), reference(pixels);
+
+    auto t0 = Clock::now();
+    for (int f = 0; f < frames; f++)
+        for (size_t i = 0; i < pixels; i++)
+            reference[i] = yuyv[2 * i];
+    auto t1 = Clock::now();
+    for (int f = 0; f < frames; f++)
+        webcamExtractLuma(gray.data(), yuyv.data(), pixels);
+    auto t2 = Clock::now();
+
+    EXPECT_EQ(reference, gray);
+    double plainMs = std::chrono::duration<double, std::milli>(t1 - t0).count() / frames;
+    double lumaMs  = std::chrono::duration<double, std::milli>(t2 - t1).count() / frames;
+    printf("1080p YUYV to GRAY8 per frame: byte loop %6.3f ms  extract %6.3f ms\n", plainMs, lumaMs);
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright © 2026, INDI Developers
+ *
+ * Stacks synthetic frames with the rapid stacking engine of the webcam
+ * driver and compares it with the float stack it replaced.
+ */
+
+#include "webcam_stack.h"
+#include "webcam_bands.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/* Frame buffer layouts the driver stacks: one plane per color after
+ * convertINDI_RGBtoFITS_RGB, 8 or 16 bit samples. */
+struct Layout
+{
+    const char *name;
+    int width, height, bpp, planes;
+
+    size_t samples() const
+    {
+        return (size_t)width * height * planes;
+    }
+    size_t bytes() const
+    {
+        return samples() * bpp / 8;
+    }
+};
+
+/* Frames as swscale delivers them from common sources: a smooth YUV scene,
+ * an RGB scene, and a Bayer mosaic with its high frequency pattern. */
+enum Source
+{
+    SOURCE_YUV,
+    SOURCE_RGB,
+    SOURCE_BAYER
+};
+
+std::vector<uint8_t> makeFrame(const Layout &l, Source source, unsigned int seed)
+{
+    std::vector<uint8_t> frame(l.bytes());
+    const uint32_t max = l.bpp == 8 ? 0xFF : 0xFFFF;
+    uint32_t state     = seed * 2654435761u + 1;
+    for (size_t i = 0; i < l.samples(); i++)
+    {
+        size_t x = i % l.width, y = (i / l.width) % l.height;
+        state    = state * 1103515245u + 12345u;
+        uint32_t noise = (state >> 16) & 0x3F;
+        uint32_t v;
+        if (source == SOURCE_YUV)
+            v = (uint32_t)((x + y) * max / (l.width + l.height)) + noise;
+        else if (source == SOURCE_RGB)
+            v = (state >> 8) % (max + 1);
+        else
+            v = ((x ^ y) & 1) ? max - noise : noise;
+        v = std::min(v, max);
+        if (l.bpp == 8)
+            frame[i] = (uint8_t)v;
+        else
+            reinterpret_cast<uint16_t *>(frame.data())[i] = (uint16_t)v;
+    }
+    return frame;
+}
+
+/* The per pixel float stack of indi_webcam before WebcamStacker. */
+class LegacyStack
+{
+public:
+    LegacyStack(const Layout &l, uint8_t *primary) : layout(l), primaryBuffer(primary) {}
+
+    void add()
+    {
+        if (stackBuffer.empty())
+        {
+            stackBuffer.resize(layout.bytes());
+            numberOfFramesInStack = 0;
+        }
+        int w = layout.width * ((layout.planes == 3) ? 3 : 1);
+        int h = layout.height;
+        for (int i = 0; i < w * h; i++)
+        {
+            int x = i % w;
+            int y = i / w;
+            if (x >= 0 && y >= 0 && x < w && y < h)
+            {
+                if (numberOfFramesInStack == 0)
+                    stackBuffer[i] = getImageDataFloatValue(x, y);
+                else
+                    stackBuffer[i] += getImageDataFloatValue(x, y);
+            }
+        }
+        numberOfFramesInStack++;
+    }
+
+    void finish(bool averaging)
+    {
+        int w = layout.width * ((layout.planes == 3) ? 3 : 1);
+        int h = layout.height;
+        for (int i = 0; i < w * h; i++)
+        {
+            int x = i % w;
+            int y = i / w;
+            if (x >= 0 && y >= 0 && x < w && y < h)
+            {
+                if (averaging)
+                    setImageDataValueFromFloat(x, y, round(stackBuffer[i] / numberOfFramesInStack));
+                else
+                    setImageDataValueFromFloat(x, y, round(stackBuffer[i]));
+            }
+        }
+    }
+
+private:
+    float getImageDataFloatValue(int x, int y)
+    {
+        int w = layout.width * ((layout.planes == 3) ? 3 : 1);
+        if (layout.bpp == 8)
+            return (float)primaryBuffer[y * w + x];
+        else if (layout.bpp == 16)
+            return (float)reinterpret_cast<uint16_t *>(primaryBuffer)[y * w + x];
+        else
+            return 0;
+    }
+
+    void setImageDataValueFromFloat(int x, int y, float value)
+    {
+        int w = layout.width * ((layout.planes == 3) ? 3 : 1);
+        if (layout.bpp == 8)
+        {
+            int max = std::numeric_limits<uint8_t>::max();
+            if (value > max)
+                value = max;
+            primaryBuffer[y * w + x] = round(value);
+        }
+        else if (layout.bpp == 16)
+        {
+            int max = std::numeric_limits<uint16_t>::max();
+            if (value > max)
+                value = max;
+            reinterpret_cast<uint16_t *>(primaryBuffer)[y * w + x] = round(value);
+        }
+    }
+
+    Layout layout;
+    uint8_t *primaryBuffer;
+    std::vector<float> stackBuffer;
+    int numberOfFramesInStack = 0;
+};
+
+std::vector<uint32_t> samplesOf(const Layout &l, const std::vector<uint8_t> &frame)
+{
+    std::vector<uint32_t> v(l.samples());
+    for (size_t i = 0; i < v.size(); i++)
+        v[i] = l.bpp == 8 ? frame[i] : reinterpret_cast<const uint16_t *>(frame.data())[i];
+    return v;
+}
+
+const Layout small[] = {
+    { "RGB24", 101, 37, 8, 3 },
+    { "RGB48", 101, 37, 16, 3 },
+    { "GRAY16", 333, 29, 16, 1 },
+};
+}
+
+TEST(WebcamStack, MatchesLegacyFloatStack)
+{
+    for (const Layout &l : small)
+    {
+        for (bool averaging : { false, true })
+        {
+            std::vector<uint8_t> primary(l.bytes()), expected, result(l.bytes());
+            LegacyStack legacy(l, primary.data());
+            WebcamStacker stacker;
+            stacker.reset(averaging ? WebcamStacker::STACK_AVERAGE : WebcamStacker::STACK_INTEGRATION, l.bpp, l.width,
+                          l.height * l.planes);
+            for (unsigned int f = 0; f < 7; f++)
+            {
+                std::vector<uint8_t> frame = makeFrame(l, SOURCE_RGB, f);
+                std::copy(frame.begin(), frame.end(), primary.begin());
+                legacy.add();
+                ASSERT_TRUE(stacker.add(frame.data()));
+            }
+            legacy.finish(averaging);
+            stacker.finish(result.data());
+            EXPECT_EQ(primary, result) << l.name << (averaging ? " average" : " integration");
+        }
+    }
+}
+
+TEST(WebcamStack, MinMaxRejection)
+{
+    for (const Layout &l : small)
+    {
+        const unsigned int frames = 9;
+        std::vector<uint64_t> sum(l.samples(), 0);
+        std::vector<uint32_t> lo(l.samples(), 0xFFFFFFFF), hi(l.samples(), 0);
+        WebcamStacker stacker;
+        stacker.reset(WebcamStacker::STACK_REJECTION, l.bpp, l.width, l.height * l.planes);
+        for (unsigned int f = 0; f < frames; f++)
+        {
+            std::vector<uint8_t> frame = makeFrame(l, SOURCE_BAYER, f + 100);
+            // A satellite trail through one frame
+            if (f == 4)
+                std::fill(frame.begin(), frame.begin() + l.bytes() / 4, 0xFF);
+            std::vector<uint32_t> v = samplesOf(l, frame);
+            for (size_t i = 0; i < v.size(); i++)
+            {
+                sum[i] += v[i];
+                lo[i] = std::min(lo[i], v[i]);
+                hi[i] = std::max(hi[i], v[i]);
+            }
+            ASSERT_TRUE(stacker.add(frame.data()));
+        }
+
+        std::vector<uint8_t> result(l.bytes());
+        stacker.finish(result.data());
+        std::vector<uint32_t> got = samplesOf(l, result);
+        for (size_t i = 0; i < got.size(); i++)
+            ASSERT_EQ((sum[i] - lo[i] - hi[i] + (frames - 2) / 2) / (frames - 2), got[i]) << l.name << " sample " << i;
+    }
+}
+
+TEST(WebcamStack, ThreadsAgree)
+{
+    const Layout l = { "RGB48", 640, 480, 16, 3 };
+    std::vector<std::vector<uint8_t>> frames;
+    for (unsigned int f = 0; f < 5; f++)
+        frames.push_back(makeFrame(l, SOURCE_YUV, f));
+
+    for (WebcamStacker::Mode mode :
+            { WebcamStacker::STACK_INTEGRATION, WebcamStacker::STACK_AVERAGE, WebcamStacker::STACK_REJECTION })
+    {
+        std::vector<uint8_t> single(l.bytes()), threaded(l.bytes());
+        WebcamStacker a, b;
+        a.reset(mode, l.bpp, l.width, l.height * l.planes, 1);
+        b.reset(mode, l.bpp, l.width, l.height * l.planes, 7);
+        for (const std::vector<uint8_t> &frame : frames)
+        {
+            a.add(frame.data());
+            b.add(frame.data());
+        }
+        a.finish(single.data());
+        b.finish(threaded.data());
+        EXPECT_EQ(single, threaded) << "mode " << mode;
+    }
+}
+
+TEST(WebcamBandPool, RunsEveryBandOnce)
+{
+    WebcamBandPool pool(3);
+    EXPECT_EQ(4, pool.threads());
+    for (int run = 0; run < 200; run++)
+    {
+        int bands = run % 12;
+        std::vector<std::atomic<int>> calls(bands);
+        for (std::atomic<int> &c : calls)
+            c = 0;
+        pool.run(bands, [&calls](int band)
+        {
+            calls[band]++;
+        });
+        for (int i = 0; i < bands; i++)
+            ASSERT_EQ(1, calls[i]) << bands << " bands, band " << i;
+    }
+}
+
+TEST(WebcamStack, StopsBeforeOverflow)
+{
+    const Layout l = { "GRAY16", 16, 2, 16, 1 };
+    std::vector<uint8_t> frame(l.bytes(), 0xFF), result(l.bytes());
+    WebcamStacker stacker;
+    stacker.reset(WebcamStacker::STACK_AVERAGE, l.bpp, l.width, l.height);
+    for (int f = 0; f < stacker.maxFrames(); f++)
+        ASSERT_TRUE(stacker.add(frame.data()));
+    EXPECT_FALSE(stacker.add(frame.data()));
+    stacker.finish(result.data());
+    EXPECT_EQ(frame, result);
+}
+
+TEST(WebcamStack, Benchmark)
+{
+    using Clock         = std::chrono::steady_clock;
+    const int frames    = 30;
+    const Layout full[] = {
+        { "1080p RGB24", 1920, 1080, 8, 3 },
+        { "1080p RGB48", 1920, 1080, 16, 3 },
+        { "1080p GRAY16", 1920, 1080, 16, 1 },
+    };
+    const struct
+    {
+        const char *name;
+        Source source;
+    } sources[] = { { "YUV", SOURCE_YUV }, { "RGB", SOURCE_RGB }, { "Bayer", SOURCE_BAYER } };
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    printf("frames per second stacked, %d frames, up to %d threads\n", frames, threads);
+    for (const Layout &l : full)
+    {
+        for (const auto &source : sources)
+        {
+            std::vector<uint8_t> frame = makeFrame(l, source.source, 1);
+            std::vector<uint8_t> primary(frame), result(l.bytes());
+
+            LegacyStack legacy(l, primary.data());
+            auto t0 = Clock::now();
+            for (int f = 0; f < frames; f++)
+                legacy.add();
+            auto t1 = Clock::now();
+
+            double fps[3];
+            const WebcamStacker::Mode modes[] = { WebcamStacker::STACK_AVERAGE, WebcamStacker::STACK_AVERAGE,
+                                                  WebcamStacker::STACK_REJECTION
+                                                };
+            for (int m = 0; m < 3; m++)
+            {
+                WebcamStacker stacker;
+                stacker.reset(modes[m], l.bpp, l.width, l.height * l.planes, m == 0 ? 1 : threads);
+                auto s0 = Clock::now();
+                for (int f = 0; f < frames; f++)
+                    stacker.add(frame.data());
+                stacker.finish(result.data());
+                auto s1 = Clock::now();
+                fps[m] = frames / std::chrono::duration<double>(s1 - s0).count();
+                EXPECT_EQ(frame, result);
+            }
+
+            double legacyFps = frames / std::chrono::duration<double>(t1 - t0).count();
+            printf("%-12s %-5s legacy %7.1f  average 1 thread %7.1f  average %7.1f  rejection %7.1f\n", l.name,
+                   source.name, legacyFps, fps[0], fps[1], fps[2]);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/*
+INDI Webcam CCD Driver
+
+Worker threads that process a frame in bands of rows.
+
+This driver is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "webcam_bands.h"
+
+#include <algorithm>
+
+//More bands than this do not pay off for the frame sizes of webcams
+static const unsigned MAX_THREADS = 8;
+
+WebcamBandPool::WebcamBandPool(unsigned threads)
+{
+    for (unsigned i = 0; i < threads; i++)
+        workers.emplace_back(&WebcamBandPool::worker, this);
+}
+
+WebcamBandPool::~WebcamBandPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread &t : workers)
+        t.join();
+}
+
+WebcamBandPool &WebcamBandPool::instance()
+{
+    //The calling thread works on a run as well
+    static WebcamBandPool pool(std::max(std::min(std::thread::hardware_concurrency(), MAX_THREADS), 1u) - 1);
+    return pool;
+}
+
+void WebcamBandPool::run(int bands, const BandFunc &fn)
+{
+    if (workers.empty() || bands <= 1)
+    {
+        for (int i = 0; i < bands; i++)
+            fn(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> running(runMutex);
+
+    Job current(fn, bands);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &current;
+        generation++;
+    }
+    wakeCondition.notify_all();
+
+    while (current.runBand()) {}
+
+    //No new worker may pick the job up, wait for the ones busy with it
+    std::unique_lock<std::mutex> lock(mutex);
+    job = nullptr;
+    doneCondition.wait(lock, [this]() { return active == 0; });
+}
+
+bool WebcamBandPool::Job::runBand()
+{
+    int band = next.fetch_add(1);
+    if (band >= bands)
+        return false;
+    fn(band);
+    return true;
+}
+
+void WebcamBandPool::worker()
+{
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wakeCondition.wait(lock, [&]() { return stop || (job && generation != seen); });
+        if (stop)
+            return;
+
+        seen = generation;
+        Job *current = job;
+        active++;
+        lock.unlock();
+
+        while (current->runBand()) {}
+
+        lock.lock();
+        if (--active == 0)
+            doneCondition.notify_all();
+    }
+}
@@ -0,0 +1,79 @@
+/*
+INDI Webcam CCD Driver
+
+Worker threads that process a frame in bands of rows.
+
+This driver is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef webcam_bands_H
+#define webcam_bands_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Small pool of worker threads shared by the stacker and the frame conversion, started once
+//instead of for every frame. The workers and the calling thread claim bands until none are left.
+//Runs from different threads are done one after the other.
+class WebcamBandPool
+{
+public:
+    typedef std::function<void(int)> BandFunc;
+
+    explicit WebcamBandPool(unsigned threads);
+    ~WebcamBandPool();
+
+    static WebcamBandPool &instance();
+
+    //Calls fn(band) once for each band in [0, bands) and returns when all are done.
+    void run(int bands, const BandFunc &fn);
+
+    //Threads working on a run, the calling one included
+    int threads() const
+    {
+        return (int)workers.size() + 1;
+    }
+
+private:
+    struct Job
+    {
+        Job(const BandFunc &f, int b) : fn(f), bands(b), next(0) {}
+        bool runBand();
+
+        const BandFunc &fn;
+        const int bands;
+        std::atomic<int> next;
+    };
+
+    void worker();
+
+    std::vector<std::thread> workers;
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    bool stop { false };
+    uint64_t generation { 0 };
+    Job *job { nullptr };
+    int active { 0 };
+};
+
+#endif // webcam_bands_H
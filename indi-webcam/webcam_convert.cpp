@@ -0,0 +1,69 @@
+/*
+INDI Webcam CCD Driver
+
+Frame conversions that do not need swscale.
+
+This driver is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "webcam_convert.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+void webcamExtractLuma(uint8_t *gray, const uint8_t *yuyv, size_t pixels)
+{
+    size_t x = 0;
+
+#if defined(__SSE2__)
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    for (; x + 16 <= pixels; x += 16)
+    {
+        __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *)(yuyv + 2 * x)), lowBytes);
+        __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i *)(yuyv + 2 * x + 16)), lowBytes);
+        _mm_storeu_si128((__m128i *)(gray + x), _mm_packus_epi16(a, b));
+    }
+#elif defined(__ARM_NEON)
+    for (; x + 16 <= pixels; x += 16)
+        vst1q_u8(gray + x, vld2q_u8(yuyv + 2 * x).val[0]);
+#endif
+
+    for (; x < pixels; x++)
+        gray[x] = yuyv[2 * x];
+}
+
+std::vector<int> webcamSliceRows(int height, int slices, int alignment)
+{
+    std::vector<int> starts;
+    if (slices < 1)
+        slices = 1;
+    if (alignment < 1)
+        alignment = 1;
+
+    //Round the band height up so there are never more than slices bands
+    int rows = (height + slices - 1) / slices;
+    rows     = (rows + alignment - 1) / alignment * alignment;
+    if (rows < 1)
+        rows = 1;
+
+    for (int y = 0; y < height; y += rows)
+        starts.push_back(y);
+    starts.push_back(height);
+    return starts;
+}
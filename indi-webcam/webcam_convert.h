@@ -0,0 +1,36 @@
+/*
+INDI Webcam CCD Driver
+
+Frame conversions that do not need swscale.
+
+This driver is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef webcam_convert_H
+#define webcam_convert_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Copies the Y samples of a packed YUYV 4:2:2 row, which is the whole 8 bit grayscale image of it.
+void webcamExtractLuma(uint8_t *gray, const uint8_t *yuyv, size_t pixels);
+
+//Splits height rows into at most slices bands whose starts are multiples of alignment.
+//Returns the first row of each band followed by height.
+std::vector<int> webcamSliceRows(int height, int slices, int alignment);
+
+#endif // webcam_convert_H
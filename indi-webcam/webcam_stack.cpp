@@ -0,0 +1,265 @@
+/*
+INDI Webcam CCD Driver
+
+Rapid stacking of webcam frames.
+
+This driver is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "webcam_stack.h"
+#include "webcam_bands.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+//Below this many samples per band, handing it to another thread costs more than it saves
+static const size_t MIN_SAMPLES_PER_THREAD = 128 * 1024;
+static const int MAX_THREADS = 8;
+
+#if defined(__SSE2__)
+static inline __m128i load8(const uint8_t *p)
+{
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p), _mm_setzero_si128());
+}
+static inline __m128i load8(const uint16_t *p)
+{
+    return _mm_loadu_si128((const __m128i *)p);
+}
+#elif defined(__ARM_NEON)
+static inline uint16x8_t load8(const uint8_t *p)
+{
+    return vmovl_u8(vld1_u8(p));
+}
+static inline uint16x8_t load8(const uint16_t *p)
+{
+    return vld1q_u16(p);
+}
+#endif
+
+//Adds one row of samples to the sums, the first frame of a stack sets them.
+template <typename T>
+static void accumulateRow(uint32_t *sum, uint16_t *lowest, uint16_t *highest, const T *src, size_t n, bool first)
+{
+    size_t x = 0;
+
+    if (first)
+    {
+        for (; x < n; x++)
+            sum[x] = src[x];
+        if (lowest)
+        {
+            std::copy(src, src + n, lowest);
+            std::copy(src, src + n, highest);
+        }
+        return;
+    }
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 8 <= n; x += 8)
+    {
+        __m128i v  = load8(src + x);
+        __m128i s0 = _mm_loadu_si128((const __m128i *)(sum + x));
+        __m128i s1 = _mm_loadu_si128((const __m128i *)(sum + x + 4));
+        _mm_storeu_si128((__m128i *)(sum + x), _mm_add_epi32(s0, _mm_unpacklo_epi16(v, zero)));
+        _mm_storeu_si128((__m128i *)(sum + x + 4), _mm_add_epi32(s1, _mm_unpackhi_epi16(v, zero)));
+        if (lowest)
+        {
+            //Unsigned 16 bit min and max without SSE4.1
+            __m128i lo = _mm_loadu_si128((const __m128i *)(lowest + x));
+            __m128i hi = _mm_loadu_si128((const __m128i *)(highest + x));
+            _mm_storeu_si128((__m128i *)(lowest + x), _mm_sub_epi16(lo, _mm_subs_epu16(lo, v)));
+            _mm_storeu_si128((__m128i *)(highest + x), _mm_add_epi16(v, _mm_subs_epu16(hi, v)));
+        }
+    }
+#elif defined(__ARM_NEON)
+    for (; x + 8 <= n; x += 8)
+    {
+        uint16x8_t v = load8(src + x);
+        vst1q_u32(sum + x, vaddw_u16(vld1q_u32(sum + x), vget_low_u16(v)));
+        vst1q_u32(sum + x + 4, vaddw_u16(vld1q_u32(sum + x + 4), vget_high_u16(v)));
+        if (lowest)
+        {
+            vst1q_u16(lowest + x, vminq_u16(vld1q_u16(lowest + x), v));
+            vst1q_u16(highest + x, vmaxq_u16(vld1q_u16(highest + x), v));
+        }
+    }
+#endif
+
+    for (; x < n; x++)
+    {
+        sum[x] += src[x];
+        if (lowest)
+        {
+            lowest[x]  = std::min<uint16_t>(lowest[x], src[x]);
+            highest[x] = std::max<uint16_t>(highest[x], src[x]);
+        }
+    }
+}
+
+//Rounded quotient of x / d through a reciprocal, corrected to the exact result.
+static inline uint32_t roundedQuotient(uint32_t x, uint32_t d, double reciprocal)
+{
+    uint64_t r = (uint64_t)x + d / 2;
+    uint64_t q = (uint64_t)(r * reciprocal);
+    if ((q + 1) * d <= r)
+        q++;
+    else if (q * d > r)
+        q--;
+    return (uint32_t)q;
+}
+
+template <typename T>
+static void finishRow(T *out, const uint32_t *sum, const uint16_t *lowest, const uint16_t *highest, size_t n,
+                      WebcamStacker::Mode mode, int frames)
+{
+    const uint32_t max = std::numeric_limits<T>::max();
+
+    if (mode == WebcamStacker::STACK_INTEGRATION)
+    {
+        for (size_t x = 0; x < n; x++)
+            out[x] = (T)std::min(sum[x], max);
+    }
+    else if (mode == WebcamStacker::STACK_REJECTION && frames >= 3)
+    {
+        const double reciprocal = 1.0 / (frames - 2);
+        for (size_t x = 0; x < n; x++)
+            out[x] = (T)roundedQuotient(sum[x] - lowest[x] - highest[x], frames - 2, reciprocal);
+    }
+    else
+    {
+        const double reciprocal = 1.0 / frames;
+        for (size_t x = 0; x < n; x++)
+            out[x] = (T)roundedQuotient(sum[x], frames, reciprocal);
+    }
+}
+
+void WebcamStacker::reset(Mode newMode, int newBitsPerSample, size_t newRowSamples, size_t newRows, int newThreads)
+{
+    mode           = newMode;
+    bitsPerSample  = newBitsPerSample;
+    rowSamples     = newRowSamples;
+    rows           = newRows;
+    numberOfFrames = 0;
+
+    //Every sum is written by the first frame, so nothing needs clearing
+    sums.resize(samples());
+    if (mode == STACK_REJECTION)
+    {
+        lowest.resize(samples());
+        highest.resize(samples());
+    }
+    else
+    {
+        lowest.clear();
+        highest.clear();
+    }
+
+    if (newThreads <= 0)
+        newThreads = WebcamBandPool::instance().threads();
+    size_t bySize = samples() / MIN_SAMPLES_PER_THREAD;
+    threads       = (int)std::max<size_t>(1, std::min<size_t>({ (size_t)newThreads, (size_t)MAX_THREADS, bySize, rows }));
+}
+
+void WebcamStacker::clear()
+{
+    numberOfFrames = 0;
+    rowSamples = rows = 0;
+    std::vector<uint32_t>().swap(sums);
+    std::vector<uint16_t>().swap(lowest);
+    std::vector<uint16_t>().swap(highest);
+}
+
+int WebcamStacker::maxFrames() const
+{
+    return (int)(std::numeric_limits<uint32_t>::max() / (bitsPerSample == 8 ? 0xFFu : 0xFFFFu));
+}
+
+template <typename F>
+void WebcamStacker::forEachBand(F fn)
+{
+    if (threads <= 1)
+    {
+        fn(0, rows);
+        return;
+    }
+
+    WebcamBandPool::instance().run(threads, [this, &fn](int band)
+    {
+        //The first rows % threads bands get one row more
+        size_t base  = rows / threads, extra = rows % threads;
+        size_t first = band * base + std::min<size_t>(band, extra);
+        fn(first, base + ((size_t)band < extra ? 1 : 0));
+    });
+}
+
+bool WebcamStacker::add(const uint8_t *frame)
+{
+    if (samples() == 0 || numberOfFrames >= maxFrames())
+        return false;
+
+    forEachBand([this, frame](size_t firstRow, size_t numRows)
+    {
+        addRows(frame, firstRow, numRows);
+    });
+    numberOfFrames++;
+    return true;
+}
+
+void WebcamStacker::addRows(const uint8_t *frame, size_t firstRow, size_t numRows)
+{
+    bool first = numberOfFrames == 0;
+    for (size_t y = firstRow; y < firstRow + numRows; y++)
+    {
+        size_t offset = y * rowSamples;
+        uint16_t *lo  = lowest.empty() ? nullptr : lowest.data() + offset;
+        uint16_t *hi  = highest.empty() ? nullptr : highest.data() + offset;
+        if (bitsPerSample == 8)
+            accumulateRow(sums.data() + offset, lo, hi, frame + offset, rowSamples, first);
+        else
+            accumulateRow(sums.data() + offset, lo, hi, reinterpret_cast<const uint16_t *>(frame) + offset, rowSamples,
+                          first);
+    }
+}
+
+void WebcamStacker::finish(uint8_t *out)
+{
+    if (numberOfFrames == 0)
+        return;
+
+    forEachBand([this, out](size_t firstRow, size_t numRows)
+    {
+        finishRows(out, firstRow, numRows);
+    });
+}
+
+void WebcamStacker::finishRows(uint8_t *out, size_t firstRow, size_t numRows)
+{
+    size_t offset      = firstRow * rowSamples;
+    size_t n           = numRows * rowSamples;
+    const uint16_t *lo = lowest.empty() ? nullptr : lowest.data() + offset;
+    const uint16_t *hi = highest.empty() ? nullptr : highest.data() + offset;
+    if (bitsPerSample == 8)
+        finishRow(out + offset, sums.data() + offset, lo, hi, n, mode, numberOfFrames);
+    else
+        finishRow(reinterpret_cast<uint16_t *>(out) + offset, sums.data() + offset, lo, hi, n, mode, numberOfFrames);
+}
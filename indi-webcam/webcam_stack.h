@@ -0,0 +1,78 @@
+/*
+INDI Webcam CCD Driver
+
+Rapid stacking of webcam frames.
+
+This driver is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef webcam_stack_H
+#define webcam_stack_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Stacks frames of 8 or 16 bit samples, as they are in the primary frame buffer.
+//Frames are summed into 32 bit integers row by row, split in bands over the WebcamBandPool threads.
+class WebcamStacker
+{
+public:
+    enum Mode
+    {
+        STACK_INTEGRATION, //Sum, clipped to the sample range
+        STACK_AVERAGE,     //Rounded mean
+        STACK_REJECTION    //Rounded mean without the lowest and highest sample of each pixel
+    };
+
+    //Starts a new stack of frames with rows of rowSamples samples.
+    void reset(Mode mode, int bitsPerSample, size_t rowSamples, size_t rows, int threads = 0);
+    //Adds a frame, returns false once the sums could overflow and the frame was left out.
+    bool add(const uint8_t *frame);
+    //Writes the stacked frame in the input sample format.
+    void finish(uint8_t *out);
+    void clear();
+
+    int frames() const
+    {
+        return numberOfFrames;
+    }
+    size_t samples() const
+    {
+        return rowSamples * rows;
+    }
+    int maxFrames() const;
+
+private:
+    void addRows(const uint8_t *frame, size_t firstRow, size_t numRows);
+    void finishRows(uint8_t *out, size_t firstRow, size_t numRows);
+    template <typename F>
+    void forEachBand(F fn);
+
+    Mode mode { STACK_INTEGRATION };
+    int bitsPerSample { 8 };
+    size_t rowSamples { 0 };
+    size_t rows { 0 };
+    int threads { 1 };
+    int numberOfFrames { 0 };
+
+    std::vector<uint32_t> sums;
+    //Lowest and highest sample of each pixel, only for rejection
+    std::vector<uint16_t> lowest;
+    std::vector<uint16_t> highest;
+};
+
+#endif // webcam_stack_H
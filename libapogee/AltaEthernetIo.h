@@ -16,10 +16,13 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 #include "ICamIo.h" 
 #include "IAltaSerialPortIo.h" 
 
+class CLibCurlWrap;
+
 class AltaEthernetIo : public ICamIo, public IAltaSerialPortIo
 { 
     public: 
@@ -84,6 +87,8 @@ class AltaEthernetIo : public ICamIo, public IAltaSerialPortIo
         const std::string m_url;
         const std::string m_fileName;
         std::vector<uint16_t> m_StatusRegs;
+        // one handle per camera, so the connection is kept alive between requests
+        std::shared_ptr<CLibCurlWrap> m_libcurl;
 
         //disabling the copy ctor and assignment operator
         //generated by the compiler - don't want them
@@ -3098,6 +3098,29 @@ bool ApogeeCam::CheckAndWaitForStatus( const Apg::Status desired, Apg::Status &
     return true;
 }
 
+//////////////////////////// 
+//      VERIFY       IMAGE      BUFFER
+void ApogeeCam::VerifyImageBuffer( const uint16_t * out, const size_t outSize, 
+                                  const size_t rowStride, const int32_t rows, 
+                                  const int32_t cols )
+{
+    if( rows <= 0 || cols <= 0 )
+    {
+        return;
+    }
+
+    const size_t needed = ( static_cast<size_t>(rows) - 1 ) * rowStride + cols;
+
+    if( !out || rowStride < static_cast<size_t>(cols) || outSize < needed )
+    {
+        std::stringstream msg;
+        msg << "Invalid image buffer: size = " << outSize << ", row stride = " << rowStride;
+        msg << ", image = " << cols << "x" << rows << ", required size = " << needed;
+        apgHelper::throwRuntimeException( m_fileName, msg.str(), 
+            __LINE__, Apg::ErrorType_InvalidUsage );
+    }
+}
+
 //////////////////////////// 
 //      CANCEL     EXPOSURE    NO      THROW
 void ApogeeCam::CancelExposureNoThrow()
@@ -1166,6 +1166,19 @@ class DLL_EXPORT ApogeeCam
          */
         virtual void GetImage( std::vector<uint16_t> & out ) = 0;
 
+        /*! 
+         * Downloads the image data from the camera directly into a caller supplied 
+         * buffer, without an intermediate image vector.  The same rows and columns 
+         * as GetImage( std::vector<uint16_t> & ) are written: GetRoiNumCols() pixels 
+         * per row and GetRoiNumRows() rows per downloaded image.
+         * \param [out] out Buffer that will recieve the image data
+         * \param [in] outSize Number of pixels available at out
+         * \param [in] rowStride Distance in pixels between the starts of two rows of out, 
+         * 0 for GetRoiNumCols().  Allows writing the ROI into a larger frame.
+         * \exception std::runtime_error
+         */
+        virtual void GetImage( uint16_t * out, size_t outSize, size_t rowStride = 0 ) = 0;
+
         /*! 
          * This method halts an in progress exposure. If this method is called 
          * and there is no exposure in progress a std::runtime_error exception is thrown.
@@ -1267,6 +1280,8 @@ class DLL_EXPORT ApogeeCam
         void SetNumAdOutputs( const uint16_t num );
 
         bool CheckAndWaitForStatus( Apg::Status desired, Apg::Status & acutal );
+        void VerifyImageBuffer( const uint16_t * out, size_t outSize, size_t rowStride,
+            int32_t rows, int32_t cols );
         void CancelExposureNoThrow();
         double DefaultGetTempHeatsink();
 
@@ -1284,7 +1299,7 @@ class DLL_EXPORT ApogeeCam
         virtual uint16_t GetImageZ() = 0;
         virtual uint16_t GetIlluminationMask() = 0;
         virtual void FixImgFromCamera( const std::vector<uint16_t> & data,
-            std::vector<uint16_t> & out,  int32_t rows, int32_t cols) = 0;
+            uint16_t * out, int32_t outStride, int32_t rows, int32_t cols) = 0;
                 
 //this code removes vc++ compiler warning C4251
 //from http://www.unknownroad.com/rtfm/VisualStudio/warningC4251.html
@@ -1316,6 +1331,9 @@ class DLL_EXPORT ApogeeCam
         bool m_IsInitialized;
         bool m_IsConnected;
 		double m_LastExposureTime;
+
+        // download buffer of GetImage( uint16_t *, ... ), reused from one image to the next
+        std::vector<uint16_t> m_ImgFromCam;
      
     private:
 
@@ -201,32 +201,20 @@ void AspenEthernetIo::WriteReg( uint16_t reg, uint16_t val )
 // GET  IMAGE   DATA
 void AspenEthernetIo::GetImageData(std::vector<uint16_t> & ImageData)
 {
-    const int32_t NumBytesExpected = apgHelper::SizeT2Uint32(ImageData.size())*sizeof(uint16_t);
-
-    //grab the data
+    //grab the data, straight into the caller's buffer
     std::string fullUrl = m_url + "/aspen.bin?keyval=" + m_sessionKey;
     
-    std::vector<uint8_t> result;
-	// set container capacity so it doesn't waste time
-	// dynamically allocating space
-	result.reserve( NumBytesExpected );
 	m_libcurl->setTimeout( 60 + getLastExposureTime() ); // set extended timeout
-    m_libcurl->HttpGet( fullUrl, result );
-	m_libcurl->setTimeout( -1 ); // restore default timeout
-
-    if( NumBytesExpected !=  apgHelper::SizeT2Int32( result.size() ) )
+    try
     {
-        std::stringstream msg;
-        msg <<  fullUrl.c_str() << " error -  requested ";
-        msg << NumBytesExpected << " bytes, but received ";
-        msg << result.size() << " bytes.";
-
-        apgHelper::throwRuntimeException( m_fileName, msg.str() , 
-            __LINE__, Apg::ErrorType_Critical );
+        m_libcurl->HttpGet( fullUrl, ImageData.data(), ImageData.size(), false );
     }
-
-    //faster than for loop
-    memcpy(&(*ImageData.begin()), &(*result.begin()), NumBytesExpected);
+    catch( std::exception & )
+    {
+        m_libcurl->setTimeout( -1 );
+        throw;
+    }
+	m_libcurl->setTimeout( -1 ); // restore default timeout
 }
 
 
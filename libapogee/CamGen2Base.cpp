@@ -316,11 +316,37 @@ Apg::Status CamGen2Base::GetImagingStatus()
 //////////////////////////// 
 // GET  IMAGE 
 void CamGen2Base::GetImage( std::vector<uint16_t> & out )
+{
+    uint16_t r=0, c= 0;
+    ExposureAndGetImgRC( r, c );
+    const int32_t size = r*GetImageZ()*GetRoiNumCols();
+
+    if( size != apgHelper::SizeT2Int32( out.size() ) )
+    {
+        out.clear();
+        out.resize( size );
+    }
+
+    GetImage( out.data(), out.size(), GetRoiNumCols() );
+}
+
+//////////////////////////// 
+//      GET    IMAGE
+void CamGen2Base::GetImage( uint16_t * out, const size_t outSize, const size_t rowStride )
 {
 #ifdef DEBUGGING_CAMERA
     apgHelper::DebugMsg( "CamGen2Base::GetImage -> BEGIN" );
 #endif
 
+    // validate the buffer before the download, so a bad one does not cost the image
+    uint16_t r=0, c= 0;
+    ExposureAndGetImgRC( r, c );
+    const uint16_t z = GetImageZ();
+    const int32_t dataLen = r*z;
+    const int32_t numCols = GetRoiNumCols();
+    const int32_t outStride = rowStride ? apgHelper::SizeT2Int32( rowStride ) : numCols;
+    VerifyImageBuffer( out, outSize, outStride, dataLen, numCols );
+
     ApgLogger::Instance().Write(ApgLogger::LEVEL_DEBUG,"info","Getting Image.");
 
 
@@ -342,29 +368,19 @@ void CamGen2Base::GetImage( std::vector<uint16_t> & out )
     }
 
 
-    // allocating the buffers for the image
-    // doing this outside of the try / catch, so that
+    // sizing the download buffer for the image, it is kept
+    // between images so this only allocates when the geometry
+    // changes. doing this outside of the try / catch, so that
     // even if the GetImage function throws
     // we can try to copy whatever data we managed
     // to fetch from the camera into the user supplied
-    // vector
-    uint16_t r=0, c= 0;
-    ExposureAndGetImgRC( r, c );
-    const uint16_t z = GetImageZ();
-    std::vector<uint16_t>  datafromCam( r*c*z );
-
-    const int32_t dataLen = r*z;
-    const int32_t numCols = GetRoiNumCols();
-    
-    if( dataLen*numCols != apgHelper::SizeT2Int32( out.size() ) )
-    {
-        out.clear();
-        out.resize( dataLen*numCols );
-    }
+    // buffer
+    // GetImageData may have grown it by the USB padding last time
+    m_ImgFromCam.resize( r*c*z );
 
     try
     {
-        m_CamIo->GetImageData( datafromCam );
+        m_CamIo->GetImageData( m_ImgFromCam );
     }
     catch(std::exception & err )
     {
@@ -374,7 +390,7 @@ void CamGen2Base::GetImage( std::vector<uint16_t> & out )
         ApgLogger::Instance().Write(ApgLogger::LEVEL_RELEASE,"error",
         apgHelper::mkMsg( m_fileName, msg, __LINE__) );
 
-        FixImgFromCamera( datafromCam, out, dataLen, numCols );
+        FixImgFromCamera( m_ImgFromCam, out, outStride, dataLen, numCols );
         throw;
     }
         
@@ -401,7 +417,7 @@ void CamGen2Base::GetImage( std::vector<uint16_t> & out )
     }
     
     // at a minimum removing the AD garbage pixels at the beginning of every row
-    FixImgFromCamera( datafromCam, out, dataLen, numCols );
+    FixImgFromCamera( m_ImgFromCam, out, outStride, dataLen, numCols );
 
    ApgLogger::Instance().Write(ApgLogger::LEVEL_DEBUG,"info","Get Image Completed.");
 
@@ -25,6 +25,7 @@ class DLL_EXPORT CamGen2Base  : public ApogeeCam
         Apg::Status GetImagingStatus();
 
         void GetImage( std::vector<uint16_t> & out );
+        void GetImage( uint16_t * out, size_t outSize, size_t rowStride = 0 );
 
         void StopExposure( bool Digitize );
 
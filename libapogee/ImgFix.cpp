@@ -11,6 +11,277 @@
 
 #include "ImgFix.h" 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    // frames smaller than this are reordered on the calling thread
+    const int32_t PARALLEL_MIN_PIXELS = 1 << 20;
+    // rows (row pairs for quad outputs) handed to a thread at a time
+    const int32_t TILE_ROWS = 32;
+    const unsigned MAX_THREADS = 4;
+
+    //////////////////////////// 
+    //      TILE      POOL
+    // Small pool of worker threads shared by all cameras. A job is split in
+    // tiles of consecutive rows that the workers and the calling thread claim
+    // until none are left. Jobs from different cameras run one after the other.
+    class TilePool
+    {
+        public:
+            typedef std::function<void(int32_t, int32_t)> TileFunc;
+
+            explicit TilePool( unsigned threads ) : m_Stop( false ), m_Generation( 0 ),
+                m_Job( nullptr ), m_Active( 0 )
+            {
+                for( unsigned i = 0; i < threads; ++i )
+                {
+                    m_Threads.push_back( std::thread( &TilePool::Worker, this ) );
+                }
+            }
+
+            ~TilePool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock( m_Mutex );
+                    m_Stop = true;
+                }
+                m_WakeCv.notify_all();
+
+                for( std::thread & t : m_Threads )
+                {
+                    t.join();
+                }
+            }
+
+            static TilePool & Instance()
+            {
+                static TilePool pool( std::max( std::min( std::thread::hardware_concurrency(), MAX_THREADS ), 1u ) - 1 );
+                return pool;
+            }
+
+            // calls fn(begin, end) for consecutive ranges covering [0, count)
+            void Run( const int32_t count, const int32_t tile, const TileFunc & fn )
+            {
+                if( m_Threads.empty() || count <= tile )
+                {
+                    fn( 0, count );
+                    return;
+                }
+
+                std::lock_guard<std::mutex> run( m_RunMutex );
+
+                Job job( fn, count, tile );
+                {
+                    std::lock_guard<std::mutex> lock( m_Mutex );
+                    m_Job = &job;
+                    ++m_Generation;
+                }
+                m_WakeCv.notify_all();
+
+                while( job.RunTile() ) {}
+
+                // no new worker may pick the job up, wait for the ones busy with it
+                std::unique_lock<std::mutex> lock( m_Mutex );
+                m_Job = nullptr;
+                m_DoneCv.wait( lock, [this]() { return m_Active == 0; } );
+            }
+
+        private:
+            struct Job
+            {
+                Job( const TileFunc & f, int32_t c, int32_t t ) : fn( f ), count( c ), tile( t ), next( 0 ) {}
+
+                bool RunTile()
+                {
+                    const int32_t begin = next.fetch_add( tile );
+                    if( begin >= count )
+                    {
+                        return false;
+                    }
+
+                    fn( begin, std::min( begin + tile, count ) );
+                    return true;
+                }
+
+                const TileFunc & fn;
+                const int32_t count;
+                const int32_t tile;
+                std::atomic<int32_t> next;
+            };
+
+            void Worker()
+            {
+                uint64_t seen = 0;
+                std::unique_lock<std::mutex> lock( m_Mutex );
+
+                while( true )
+                {
+                    m_WakeCv.wait( lock, [&]() { return m_Stop || ( m_Job && m_Generation != seen ); } );
+                    if( m_Stop )
+                    {
+                        return;
+                    }
+
+                    seen = m_Generation;
+                    Job * job = m_Job;
+                    ++m_Active;
+                    lock.unlock();
+
+                    while( job->RunTile() ) {}
+
+                    lock.lock();
+                    if( --m_Active == 0 )
+                    {
+                        m_DoneCv.notify_all();
+                    }
+                }
+            }
+
+            std::vector<std::thread> m_Threads;
+            std::mutex m_RunMutex;
+            std::mutex m_Mutex;
+            std::condition_variable m_WakeCv;
+            std::condition_variable m_DoneCv;
+            bool m_Stop;
+            uint64_t m_Generation;
+            Job * m_Job;
+            int32_t m_Active;
+    };
+
+    void ForEachTile( const int32_t count, const int64_t pixels, const TilePool::TileFunc & fn )
+    {
+        if( pixels < PARALLEL_MIN_PIXELS )
+        {
+            fn( 0, count );
+            return;
+        }
+
+        TilePool::Instance().Run( count, TILE_ROWS, fn );
+    }
+
+#if defined(__SSE2__)
+    inline __m128i Reverse8( __m128i v )
+    {
+        v = _mm_shufflelo_epi16( v, _MM_SHUFFLE(0, 1, 2, 3) );
+        v = _mm_shufflehi_epi16( v, _MM_SHUFFLE(0, 1, 2, 3) );
+        return _mm_shuffle_epi32( v, _MM_SHUFFLE(1, 0, 3, 2) );
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    inline uint16x8_t Reverse8( uint16x8_t v )
+    {
+        v = vrev64q_u16( v );
+        return vcombine_u16( vget_high_u16( v ), vget_low_u16( v ) );
+    }
+#endif
+
+    //////////////////////////// 
+    //      QUAD       FIX       ROWS
+    // src holds the four outputs interleaved: upper left, upper right (reversed),
+    // lower right (reversed), lower left
+    void QuadFixRowPair( const uint16_t * src, uint16_t * top, uint16_t * bottom,
+        const int32_t cols )
+    {
+        const int32_t HALF_COLS = cols / 2;
+        int32_t c = 0;
+
+#if defined(__SSE2__)
+        for( ; c + 8 <= HALF_COLS; c += 8, src += 32 )
+        {
+            const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src ) );
+            const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src + 8 ) );
+            const __m128i cc = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src + 16 ) );
+            const __m128i d = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src + 24 ) );
+
+            // 4-way de-interleave of 16 bit words
+            const __m128i t0 = _mm_unpacklo_epi16( a, b );
+            const __m128i t1 = _mm_unpackhi_epi16( a, b );
+            const __m128i t2 = _mm_unpacklo_epi16( cc, d );
+            const __m128i t3 = _mm_unpackhi_epi16( cc, d );
+            const __m128i u0 = _mm_unpacklo_epi16( t0, t1 );
+            const __m128i u1 = _mm_unpackhi_epi16( t0, t1 );
+            const __m128i u2 = _mm_unpacklo_epi16( t2, t3 );
+            const __m128i u3 = _mm_unpackhi_epi16( t2, t3 );
+
+            _mm_storeu_si128( reinterpret_cast<__m128i *>( top + c ), _mm_unpacklo_epi64( u0, u2 ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i *>( top + cols - c - 8 ), Reverse8( _mm_unpackhi_epi64( u0, u2 ) ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i *>( bottom + cols - c - 8 ), Reverse8( _mm_unpacklo_epi64( u1, u3 ) ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i *>( bottom + c ), _mm_unpackhi_epi64( u1, u3 ) );
+        }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for( ; c + 8 <= HALF_COLS; c += 8, src += 32 )
+        {
+            const uint16x8x4_t v = vld4q_u16( src );
+
+            vst1q_u16( top + c, v.val[0] );
+            vst1q_u16( top + cols - c - 8, Reverse8( v.val[1] ) );
+            vst1q_u16( bottom + cols - c - 8, Reverse8( v.val[2] ) );
+            vst1q_u16( bottom + c, v.val[3] );
+        }
+#endif
+
+        for( ; c < HALF_COLS; ++c, src += 4 )
+        {
+            top[c] = src[0];
+            top[cols-(c+1)] = src[1];
+            bottom[cols-(c+1)] = src[2];
+            bottom[c] = src[3];
+        }
+    }
+
+    //////////////////////////// 
+    //      DUAL       FIX       ROW
+    // src holds the two outputs interleaved: right (reversed), left
+    void DualFixRow( const uint16_t * src, uint16_t * row, const int32_t cols )
+    {
+        const int32_t HALF_COLS = cols / 2;
+        // the odd no op col stays untouched
+        uint16_t * right = row + cols - ( cols % 2 );
+        int32_t c = 0;
+
+#if defined(__SSE2__)
+        for( ; c + 8 <= HALF_COLS; c += 8, src += 16 )
+        {
+            const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src ) );
+            const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src + 8 ) );
+
+            // sign extend so the saturating pack keeps every value
+            const __m128i even = _mm_packs_epi32( _mm_srai_epi32( _mm_slli_epi32( a, 16 ), 16 ),
+                _mm_srai_epi32( _mm_slli_epi32( b, 16 ), 16 ) );
+            const __m128i odd = _mm_packs_epi32( _mm_srai_epi32( a, 16 ), _mm_srai_epi32( b, 16 ) );
+
+            _mm_storeu_si128( reinterpret_cast<__m128i *>( right - c - 8 ), Reverse8( even ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i *>( row + c ), odd );
+        }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for( ; c + 8 <= HALF_COLS; c += 8, src += 16 )
+        {
+            const uint16x8x2_t v = vld2q_u16( src );
+
+            vst1q_u16( right - c - 8, Reverse8( v.val[0] ) );
+            vst1q_u16( row + c, v.val[1] );
+        }
+#endif
+
+        for( ; c < HALF_COLS; ++c, src += 2 )
+        {
+            right[-(c+1)] = src[0];
+            row[c] = src[1];
+        }
+    }
+}
+
 
 //////////////////////////// 
 //      SINGLE       OUPUT       ERASE
@@ -32,18 +303,24 @@ void ImgFix::SingleOuputCopy( const std::vector<uint16_t> & data,
       std::vector<uint16_t> & out, const int32_t rows,  const int32_t numImgCols,  
       const int32_t numLatencyPixels )
 {
-
     // in testing found that this function is much faster than the erase function
+    SingleOuputCopy( data.data(), out.data(), numImgCols, rows, numImgCols, numLatencyPixels );
+}
+
+void ImgFix::SingleOuputCopy( const uint16_t * data, uint16_t * out, const int32_t outStride,
+      const int32_t rows, const int32_t numImgCols, const int32_t numLatencyPixels )
+{
     const int32_t actNumCols = numImgCols + numLatencyPixels;
 
-    for(int32_t r = 0, actColsOffset=numLatencyPixels, outColsOffset=0; r < rows;
-		    actColsOffset += actNumCols, outColsOffset += numImgCols, ++r)
+    ForEachTile( rows, static_cast<int64_t>( rows ) * numImgCols, [&]( int32_t begin, int32_t end )
     {
-        std::vector<uint16_t>::const_iterator start = data.begin()+actColsOffset;
-        std::vector<uint16_t>::const_iterator end = start + numImgCols;
-        std::vector<uint16_t>::iterator outStart = out.begin() + outColsOffset;
-        std::copy( start, end, outStart );
-    }
+        for( int32_t r = begin; r < end; ++r )
+        {
+            std::memcpy( out + static_cast<int64_t>( outStride ) * r,
+                data + static_cast<int64_t>( actNumCols ) * r + numLatencyPixels,
+                numImgCols * sizeof(uint16_t) );
+        }
+    } );
 }
 
 
@@ -53,27 +330,53 @@ void ImgFix::QuadOuputCopy( const std::vector<uint16_t> & data,
       std::vector<uint16_t> & out, const int32_t rows,  const int32_t cols,  
       const int32_t numLatencyPixels, const int32_t outputBuffOffset )
 {
-    int32_t numGood =  ( cols / 2 ) * 4;
-    int32_t numBad = numLatencyPixels*2;
+    QuadOuputCopy( data.data(), out.data() + outputBuffOffset, cols, rows, cols, numLatencyPixels );
+}
 
-    int32_t down = rows*cols;
-    
-    int32_t goodStart = 0;
-    int32_t badStart = numLatencyPixels*2;
+void ImgFix::QuadOuputCopy( const uint16_t * data, uint16_t * out, const int32_t outStride,
+      const int32_t rows, const int32_t cols, const int32_t numLatencyPixels )
+{
+    const int32_t numGood =  ( cols / 2 ) * 4;
+    const int32_t numBad = numLatencyPixels*2;
+    const int32_t total = rows*cols;
 
-    while( down > 0 )
+    if( total <= 0 || numGood <= 0 )
     {
-         int32_t len = std::min<int32_t>( down, numGood );
+        return;
+    }
 
-        std::vector<uint16_t>::const_iterator start = data.begin()+badStart;
-        std::vector<uint16_t>::const_iterator end = start + len;
-        std::vector<uint16_t>::iterator outStart = out.begin() + outputBuffOffset + goodStart;
-        std::copy( start, end, outStart );
+    // every run of good pixels is followed by the latency pixels of the next one
+    const int32_t runs = ( total + numGood - 1 ) / numGood;
+    const uint16_t * src = data + numBad;
 
-         goodStart += len;
-         badStart += (len + numBad);
-         down -= len;
-    }
+    ForEachTile( runs, total, [&]( int32_t begin, int32_t end )
+    {
+        for( int32_t i = begin; i < end; ++i )
+        {
+            int32_t pos = i * numGood;
+            int32_t len = std::min<int32_t>( total - pos, numGood );
+            const uint16_t * run = src + static_cast<int64_t>( i ) * ( numGood + numBad );
+
+            if( outStride == cols )
+            {
+                std::memcpy( out + pos, run, len * sizeof(uint16_t) );
+                continue;
+            }
+
+            // runs do not follow the row boundaries of a strided output
+            while( len > 0 )
+            {
+                const int32_t col = pos % cols;
+                const int32_t n = std::min( len, cols - col );
+
+                std::memcpy( out + static_cast<int64_t>( outStride ) * ( pos / cols ) + col, run,
+                    n * sizeof(uint16_t) );
+                run += n;
+                pos += n;
+                len -= n;
+            }
+        }
+    } );
 }
 
 //////////////////////////// 
@@ -82,40 +385,30 @@ void ImgFix::QuadOuputFix( const std::vector<uint16_t> & data,
                                              std::vector<uint16_t> & out,
                                              const int32_t rows,  const int32_t cols,
                                              const int32_t numLatencyPixels)
+{
+    QuadOuputFix( data.data(), out.data(), cols, rows, cols, numLatencyPixels );
+}
+
+void ImgFix::QuadOuputFix( const uint16_t * data, uint16_t * out, const int32_t outStride,
+                                             const int32_t rows,  const int32_t cols,
+                                             const int32_t numLatencyPixels)
 {
     const int32_t HALF_COLS = cols / 2;
     const int32_t HALF_ROWS = rows / 2;
-    
-    int32_t index = numLatencyPixels*2;
-  
-    for( int32_t r=0; r < HALF_ROWS; ++r )
-    {
-        int32_t topOffset = cols*r;
-        int32_t bottomOffset = (cols*(rows-(r+1)));
 
-        for( int32_t c=0; c < HALF_COLS; ++c)
+    // each row pair is the latency pixels followed by the four outputs
+    const int32_t srcPitch = HALF_COLS*4 + numLatencyPixels*2;
+    const uint16_t * src = data + numLatencyPixels*2;
+
+    ForEachTile( HALF_ROWS, static_cast<int64_t>( rows ) * cols, [&]( int32_t begin, int32_t end )
+    {
+        for( int32_t r = begin; r < end; ++r )
         {
-            int32_t ul = topOffset + c;
-            out[ul] = data[index];
-
-            int32_t ur =  topOffset + (cols-(c+1) );
-            ++index;
-            out[ur] = data[index];
-            
-            int32_t lr = bottomOffset + (cols-(c+1) );
-            ++index;
-            out[lr] = data[index];
-
-            int32_t ll = bottomOffset+c;
-            ++index;
-            out[ll] = data[index];
-
-            ++index;
+            QuadFixRowPair( src + static_cast<int64_t>( r ) * srcPitch,
+                out + static_cast<int64_t>( outStride ) * r,
+                out + static_cast<int64_t>( outStride ) * ( rows - ( r + 1 ) ), cols );
         }
-
-        //skip the latency pixels
-        index += numLatencyPixels*2;
-    }
+    } );
 }
 
 //////////////////////////// 
@@ -125,33 +418,24 @@ void ImgFix::DualOuputFix( const std::vector<uint16_t> & data,
                                              const int32_t rows,  const int32_t cols,
                                              const int32_t numLatencyPixels)
 {
-   
+    DualOuputFix( data.data(), out.data(), cols, rows, cols, numLatencyPixels );
+}
+
+void ImgFix::DualOuputFix( const uint16_t * data, uint16_t * out, const int32_t outStride,
+                                             const int32_t rows,  const int32_t cols,
+                                             const int32_t numLatencyPixels)
+{
     const int32_t HALF_COLS = cols / 2;
 
-     //account for the odd no op col
-    const int32_t oddAdjust = ( cols % 2 ) ? 1 : 0;
-    const int32_t START_UR_COL = cols;
+    const int32_t srcPitch = HALF_COLS*2 + numLatencyPixels;
+    const uint16_t * src = data + numLatencyPixels;
 
-    int32_t index = numLatencyPixels;
-  
-    for( int32_t r=0; r < rows; ++r )
+    ForEachTile( rows, static_cast<int64_t>( rows ) * cols, [&]( int32_t begin, int32_t end )
     {
-        int32_t topOffset = cols*r;
-
-        for( int32_t c=0; c < HALF_COLS; ++c)
+        for( int32_t r = begin; r < end; ++r )
         {
-            // skip odd col if need with oddAdjust
-            int32_t ur =  topOffset + (START_UR_COL-(c+1) ) - oddAdjust;
-            out[ur] = data[index];
-
-           int32_t ul = topOffset + c;
-            ++index;
-            out[ul] = data[index];
-            
-            ++index;
+            DualFixRow( src + static_cast<int64_t>( r ) * srcPitch,
+                out + static_cast<int64_t>( outStride ) * r, cols );
         }
-
-        //skip the latency pixels
-        index += numLatencyPixels;
-    }
+    } );
 }
@@ -11,37 +11,33 @@
 
 #include "libCurlWrap.h" 
 #include <stdexcept>
+#include <sstream>
+#include <cstring>
 
 #include "apgHelper.h" 
 
-//////////////////////////// 
-// Write any errors in here  
-static char errorBuffer[CURL_ERROR_SIZE];  
-
 //////////////////////////// 
 // VECT WRITER
-static std::vector<uint8_t> bufferVect;  
-static int32_t vectWriter(uint8_t *data, size_t size, size_t nmemb,  
-                  std::vector<uint8_t> &bufferVect) 
+static size_t vectWriter(uint8_t *data, size_t size, size_t nmemb,  
+                  std::vector<uint8_t> *bufferVect) 
 {
-	const int32_t numBytes = apgHelper::SizeT2Int32(size) * apgHelper::SizeT2Int32(nmemb);
-	bufferVect.insert( bufferVect.end(), &data[0], &data[numBytes] );
-	return numBytes;
+    const size_t numBytes = size * nmemb;
+    bufferVect->insert( bufferVect->end(), &data[0], &data[numBytes] );
+    return numBytes;
 }
  
 //////////////////////////// 
 // STR WRITER
 // This is the writer call back function used by curl  
-static std::string bufferStr; 
-static int32_t strWriter(char *data, size_t size, size_t nmemb,  
-                  std::string &bufferStr) 
+static size_t strWriter(char *data, size_t size, size_t nmemb,  
+                  std::string *bufferStr) 
 {
  
     const size_t numBytes = size * nmemb;
 
-    bufferStr.append( data, numBytes );
+    bufferStr->append( data, numBytes );
 
-    return apgHelper::SizeT2Int32( numBytes );
+    return numBytes;
 }
 
 //////////////////////////// 
@@ -49,6 +45,64 @@ static int32_t strWriter(char *data, size_t size, size_t nmemb,
 namespace
 {
     const long OPERATION_TIMEOUT = (60*1);  //60 seconds * the number of minutes
+
+    // big endian byte pairs to host words
+    void SwapCopy( const uint8_t * src, uint16_t * dst, const size_t numWords )
+    {
+        for( size_t i = 0; i < numWords; ++i )
+        {
+            dst[i] = static_cast<uint16_t>( (src[2*i] << 8) | src[2*i+1] );
+        }
+    }
+}
+
+//////////////////////////// 
+// WORD WRITER
+// Stores the data as it arrives, so no copy of the whole
+// response is ever held.  A word may be split across two
+// calls, its first byte is then kept in the carry.
+size_t CLibCurlWrap::wordWriter(char *data, size_t size, size_t nmemb,  
+                  void *userp) 
+{
+    WordSink & sink = *static_cast<WordSink *>( userp );
+    const size_t numBytes = size * nmemb;
+
+    if( numBytes > sink.capacity - sink.received )
+    {
+        //returning a short count aborts the transfer
+        sink.overflow = true;
+        return 0;
+    }
+
+    const uint8_t * src = reinterpret_cast<const uint8_t *>( data );
+
+    if( !sink.swap )
+    {
+        memcpy( reinterpret_cast<uint8_t *>( sink.out ) + sink.received, src, numBytes );
+        sink.received += numBytes;
+        return numBytes;
+    }
+
+    size_t i = 0;
+    uint16_t * dst = sink.out + sink.received / 2;
+
+    if( (sink.received & 1) && numBytes )
+    {
+        *dst++ = static_cast<uint16_t>( (sink.carry << 8) | src[0] );
+        i = 1;
+    }
+
+    const size_t numWords = (numBytes - i) / 2;
+    SwapCopy( src + i, dst, numWords );
+    i += 2*numWords;
+
+    if( i < numBytes )
+    {
+        sink.carry = src[i];
+    }
+
+    sink.received += numBytes;
+    return numBytes;
 }
 
 //////////////////////////// 
@@ -56,6 +110,7 @@ namespace
 CLibCurlWrap::CLibCurlWrap() : m_curlHandle( 0 ),
                                m_fileName( __BASE_FILE__ )
 { 
+    m_errorBuffer[0] = 0;
     m_curlHandle = curl_easy_init();
 	m_timeout = OPERATION_TIMEOUT;
     if( !m_curlHandle )
@@ -64,6 +119,10 @@ CLibCurlWrap::CLibCurlWrap() : m_curlHandle( 0 ),
          apgHelper::throwRuntimeException( m_fileName, 
              errStr, __LINE__, Apg::ErrorType_Connection );
     }
+
+    // the handle keeps its connection to the camera open between
+    // requests, probe it so a dead peer is noticed
+    curl_easy_setopt(m_curlHandle, CURLOPT_TCP_KEEPALIVE, 1L);
 } 
 
 //////////////////////////// 
@@ -80,8 +139,9 @@ CLibCurlWrap::~CLibCurlWrap()
 void CLibCurlWrap::HttpGet(const std::string & url,
                             std::string & result)
 {
-    CurlSetupStrWrite ( url );
-    result = ExecuteStr();
+    CurlSetupStrWrite ( url, result );
+    curl_easy_setopt(m_curlHandle, CURLOPT_HTTPGET, 1L);
+    ExecuteStr( result );
 }
 
 //////////////////////////// 
@@ -90,19 +150,59 @@ void CLibCurlWrap::HttpGet(const std::string & url,
             std::vector<uint8_t> & result)
 {
     CurlSetupVectWrite ( url, result );
+    curl_easy_setopt(m_curlHandle, CURLOPT_HTTPGET, 1L);
     ExecuteVect( result );
 }
 
+//////////////////////////// 
+// HTTP GET 
+void CLibCurlWrap::HttpGet(const std::string & url,
+            uint16_t * out, const size_t count, const bool bigEndian)
+{
+    WordSink sink = { out, count * sizeof(uint16_t), 0, bigEndian, false, 0 };
+
+    CurlSetup( url );
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEFUNCTION, &CLibCurlWrap::wordWriter);
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEDATA, &sink);
+    curl_easy_setopt(m_curlHandle, CURLOPT_HTTPGET, 1L);
+
+    const CURLcode returnCode = curl_easy_perform(m_curlHandle);
+
+    if( sink.overflow || ( CURLE_OK == returnCode && sink.received != sink.capacity ) )
+    {
+        std::stringstream msg;
+        msg << url << " error - requested " << sink.capacity << " bytes, but received ";
+        if( sink.overflow )
+        {
+            msg << "more.";
+        }
+        else
+        {
+            msg << sink.received << " bytes.";
+        }
+        apgHelper::throwRuntimeException( m_fileName, msg.str(), 
+            __LINE__, Apg::ErrorType_Critical );
+    }
+
+    if( CURLE_OK != returnCode )
+    {
+        std::string curlError( m_errorBuffer );
+
+        apgHelper::throwRuntimeException( m_fileName, curlError, 
+            __LINE__, Apg::ErrorType_Critical );
+    }
+}
+
 //////////////////////////// 
 // HTTP POST 
 void CLibCurlWrap::HttpPost(const std::string & url,
                             const std::string & postFields,
                             std::string & result)
 {
-    CurlSetupStrWrite ( url );
+    CurlSetupStrWrite ( url, result );
     curl_easy_setopt(m_curlHandle, CURLOPT_POSTFIELDS, postFields.c_str());
 
-    result = ExecuteStr();
+    ExecuteStr( result );
 }
 
 //////////////////////////// 
@@ -117,51 +217,59 @@ void CLibCurlWrap::HttpPost(const std::string & url,
     ExecuteVect( result );
 }
 
-
 //////////////////////////// 
-// CURL     SETUP  STR  WRITE
-void CLibCurlWrap::CurlSetupStrWrite(const std::string & url)
+// CURL     SETUP
+void CLibCurlWrap::CurlSetup(const std::string & url)
 {
      // Now set up all of the curl options  
-    curl_easy_setopt(m_curlHandle, CURLOPT_ERRORBUFFER, errorBuffer);  
+    m_errorBuffer[0] = 0;
+    curl_easy_setopt(m_curlHandle, CURLOPT_ERRORBUFFER, m_errorBuffer);  
     curl_easy_setopt(m_curlHandle, CURLOPT_URL, url.c_str());  
+    curl_easy_setopt(m_curlHandle, CURLOPT_TIMEOUT, static_cast<long>(m_timeout));
+}
+
+//////////////////////////// 
+// CURL     SETUP  STR  WRITE
+void CLibCurlWrap::CurlSetupStrWrite(const std::string & url, std::string & result)
+{
+    CurlSetup( url );
     curl_easy_setopt(m_curlHandle, CURLOPT_WRITEFUNCTION, strWriter);  
-    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEDATA, &bufferStr); 
-    curl_easy_setopt(m_curlHandle, CURLOPT_TIMEOUT, m_timeout);
-    
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEDATA, &result); 
 }
 
 //////////////////////////// 
 // CURL     SETUP       VECTOR          WRITE
-void CLibCurlWrap::CurlSetupVectWrite(const std::string & url, const std::vector<uint8_t> & result)
+void CLibCurlWrap::CurlSetupVectWrite(const std::string & url, std::vector<uint8_t> & result)
 {
-     // Now set up all of the curl options  
-    curl_easy_setopt(m_curlHandle, CURLOPT_ERRORBUFFER, errorBuffer);  
-    curl_easy_setopt(m_curlHandle, CURLOPT_URL, url.c_str());  
+    CurlSetup( url );
     curl_easy_setopt(m_curlHandle, CURLOPT_WRITEFUNCTION, vectWriter);  
     curl_easy_setopt(m_curlHandle, CURLOPT_WRITEDATA, &result); 
-    curl_easy_setopt(m_curlHandle, CURLOPT_TIMEOUT, m_timeout);
 }
 
 //////////////////////////// 
-// EXECUTE  STR
-std::string CLibCurlWrap::ExecuteStr()
+// EXECUTE
+void CLibCurlWrap::Execute()
 {
-    //clear out the string
-    bufferStr.clear();
-
     //perform the transfer
-    const CURLcode result = curl_easy_perform(m_curlHandle);
+    const CURLcode returnCode = curl_easy_perform(m_curlHandle);
 
-    if( CURLE_OK != result )
+    if( CURLE_OK != returnCode )
     {
-        std::string curlError( errorBuffer );
+        std::string curlError( m_errorBuffer );
 
         apgHelper::throwRuntimeException( m_fileName, curlError, 
             __LINE__, Apg::ErrorType_Critical );
     }
+}
+
+//////////////////////////// 
+// EXECUTE  STR
+void CLibCurlWrap::ExecuteStr( std::string & result )
+{
+    //clear out the string
+    result.clear();
 
-    return bufferStr;
+    Execute();
 }
 
 //////////////////////////// 
@@ -171,17 +279,7 @@ void CLibCurlWrap::ExecuteVect( std::vector<uint8_t> & result )
     //clear out the vector
     result.resize(0);
 
-	//perform the transfer
-    const CURLcode returnCode = curl_easy_perform(m_curlHandle);
-
-    if( CURLE_OK != returnCode )
-    {
-        std::string curlError( errorBuffer );
-
-        apgHelper::throwRuntimeException( m_fileName, curlError, 
-            __LINE__, Apg::ErrorType_Critical );
-    }
-
+    Execute();
 }
 
 //////////////////////////// 
@@ -38,6 +38,12 @@ class CLibCurlWrap
             const std::string & postFields, 
             std::vector<uint8_t> & result);
 
+        // streams the response straight into out as count 16 bit words,
+        // swapping every byte pair on the way when bigEndian is set.
+        // throws unless exactly count words are received.
+        void HttpGet(const std::string & url,
+            uint16_t * out, size_t count, bool bigEndian);
+
 		void setTimeout( int timeout );
 		unsigned int getTimeout();
 
@@ -45,13 +51,28 @@ class CLibCurlWrap
     private:
 		unsigned int m_timeout;
 
-        void CurlSetupStrWrite(const std::string & url);
-        std::string ExecuteStr();
+        void CurlSetup(const std::string & url);
+        void Execute();
 
-        void CurlSetupVectWrite(const std::string & url, const std::vector<uint8_t> & result);
+        void CurlSetupStrWrite(const std::string & url, std::string & result);
+        void ExecuteStr(std::string & result);
+
+        void CurlSetupVectWrite(const std::string & url, std::vector<uint8_t> & result);
         void ExecuteVect(std::vector<uint8_t> & result);
 
+        struct WordSink
+        {
+            uint16_t * out;
+            size_t capacity;    // bytes
+            size_t received;    // bytes
+            bool swap;
+            bool overflow;
+            uint8_t carry;      // first byte of a word split across two callbacks
+        };
+        static size_t wordWriter(char *data, size_t size, size_t nmemb, void *userp);
+
         CURL * m_curlHandle;
+        char m_errorBuffer[CURL_ERROR_SIZE];
         const std::string m_fileName;
 
         //disable the copy ctor and assignment operator
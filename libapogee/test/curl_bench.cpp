@@ -0,0 +1,83 @@
+/*!
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* Copyright(c) 2026 INDI Developers
+* \brief throughput of the ethernet image download against a local stand-in
+* for the camera web server
+*
+* Usage: curl_bench [rows] [cols] [iterations]
+* Compares the former download, a new handle per frame into a string
+* followed by a byte swapping copy, with the streaming download over
+* a persistent handle.
+*/
+
+#include "libCurlWrap.h"
+#include "http_stub.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+static double Run( const int iterations, const std::function<void()> & fn )
+{
+    fn();
+    const auto start = std::chrono::steady_clock::now();
+    for( int i = 0; i < iterations; ++i )
+    {
+        fn();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>( end - start ).count() / iterations;
+}
+
+int main( int argc, char * argv[] )
+{
+    const int32_t rows = argc > 1 ? atoi( argv[1] ) : 4096;
+    const int32_t cols = argc > 2 ? atoi( argv[2] ) : 4096;
+    const int iterations = argc > 3 ? atoi( argv[3] ) : 10;
+
+    if( rows < 1 || cols < 1 || iterations <= 0 )
+    {
+        fprintf( stderr, "usage: %s [rows] [cols] [iterations]\n", argv[0] );
+        return 1;
+    }
+
+    const size_t numWords = static_cast<size_t>( rows ) * cols;
+    const double mb = numWords * sizeof(uint16_t) / 1e6;
+
+    HttpStub server;
+    server.Serve( "/UE/image.bin", MakeBigEndianFrame( numWords ) );
+    const std::string url = server.Url() + "/UE/image.bin";
+
+    std::vector<uint16_t> out( numWords );
+
+    const double legacy = Run( iterations, [&]()
+    {
+        CLibCurlWrap theCurl;
+        std::string result;
+        theCurl.HttpGet( url, result );
+
+        for( size_t i = 0; i < numWords; ++i )
+        {
+            const uint8_t a = result[2*i];
+            const uint8_t b = result[2*i+1];
+            out.at( i ) = static_cast<uint16_t>( (a << 8) | b );
+        }
+    } );
+
+    CLibCurlWrap persistent;
+    const double streaming = Run( iterations, [&]()
+    {
+        persistent.HttpGet( url, out.data(), out.size(), true );
+    } );
+
+    printf( "%dx%d, %d frames\n", cols, rows, iterations );
+    printf( "image.bin  legacy %8.2f ms %8.1f MB/s   streaming %8.2f ms %8.1f MB/s  x%.2f\n",
+        legacy, mb / legacy * 1000, streaming, mb / streaming * 1000, legacy / streaming );
+    printf( "connections: %d for %d requests\n", server.Connections(), server.Requests() );
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+/*!
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* Copyright(c) 2026 INDI Developers
+* \class HttpStub
+* \brief Minimal HTTP/1.1 server on the loopback interface standing in for
+* the web server of an Apogee ethernet camera.
+*
+* Every path is answered with a fixed body, connections are kept alive and
+* the body is written in chunks of ChunkSize bytes so clients see it arrive
+* in pieces, like from the camera.
+*/
+
+#ifndef HTTPSTUB_INCLUDE_H__
+#define HTTPSTUB_INCLUDE_H__
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class HttpStub
+{
+    public:
+        explicit HttpStub( size_t chunkSize = 64 * 1024 ) : m_ChunkSize( chunkSize )
+        {
+            m_Listen = socket( AF_INET, SOCK_STREAM, 0 );
+
+            int on = 1;
+            setsockopt( m_Listen, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on) );
+
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+            addr.sin_port = 0;
+
+            socklen_t len = sizeof(addr);
+            if( m_Listen < 0 ||
+                bind( m_Listen, reinterpret_cast<sockaddr *>(&addr), sizeof(addr) ) ||
+                listen( m_Listen, 8 ) ||
+                getsockname( m_Listen, reinterpret_cast<sockaddr *>(&addr), &len ) )
+            {
+                throw std::runtime_error( "HttpStub: failed to listen on the loopback interface" );
+            }
+
+            m_Port = ntohs( addr.sin_port );
+            m_Acceptor = std::thread( &HttpStub::AcceptLoop, this );
+        }
+
+        ~HttpStub()
+        {
+            m_Stop = true;
+            shutdown( m_Listen, SHUT_RDWR );
+            m_Acceptor.join();
+            close( m_Listen );
+
+            {
+                std::lock_guard<std::mutex> lock( m_Mutex );
+                for( int fd : m_Clients )
+                {
+                    shutdown( fd, SHUT_RDWR );
+                }
+            }
+
+            for( std::thread & t : m_Workers )
+            {
+                t.join();
+            }
+        }
+
+        //! base url of the server, e.g. http://127.0.0.1:40000
+        std::string Url() const
+        {
+            std::stringstream ss;
+            ss << "http://127.0.0.1:" << m_Port;
+            return ss.str();
+        }
+
+        //! answer requests whose path, including the query, starts with prefix
+        void Serve( const std::string & prefix, const std::string & body )
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_Bodies[prefix] = std::make_shared<const std::string>( body );
+        }
+
+        //! TCP connections accepted so far
+        int Connections() const { return m_Connections; }
+
+        //! requests answered so far
+        int Requests() const { return m_Requests; }
+
+    private:
+        void AcceptLoop()
+        {
+            while( !m_Stop )
+            {
+                const int fd = accept( m_Listen, nullptr, nullptr );
+                if( fd < 0 )
+                {
+                    continue;
+                }
+
+                ++m_Connections;
+
+                std::lock_guard<std::mutex> lock( m_Mutex );
+                m_Clients.push_back( fd );
+                m_Workers.push_back( std::thread( &HttpStub::Session, this, fd ) );
+            }
+        }
+
+        void Session( const int fd )
+        {
+            std::string pending;
+            char buf[4096];
+
+            while( !m_Stop )
+            {
+                size_t end = pending.find( "\r\n\r\n" );
+                if( std::string::npos == end )
+                {
+                    const ssize_t n = recv( fd, buf, sizeof(buf), 0 );
+                    if( n <= 0 )
+                    {
+                        break;
+                    }
+                    pending.append( buf, n );
+                    continue;
+                }
+
+                // request line: METHOD PATH HTTP/1.1
+                const std::string request = pending.substr( 0, end );
+                pending.erase( 0, end + 4 );
+
+                const size_t p0 = request.find( ' ' ) + 1;
+                const std::string path = request.substr( p0, request.find( ' ', p0 ) - p0 );
+
+                if( !Respond( fd, path ) )
+                {
+                    break;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            for( size_t i = 0; i < m_Clients.size(); ++i )
+            {
+                if( m_Clients[i] == fd )
+                {
+                    m_Clients.erase( m_Clients.begin() + i );
+                    break;
+                }
+            }
+            close( fd );
+        }
+
+        bool Respond( const int fd, const std::string & path )
+        {
+            static const std::string empty;
+            std::shared_ptr<const std::string> found;
+            {
+                std::lock_guard<std::mutex> lock( m_Mutex );
+                for( const auto & entry : m_Bodies )
+                {
+                    if( 0 == path.compare( 0, entry.first.size(), entry.first ) )
+                    {
+                        found = entry.second;
+                    }
+                }
+            }
+            const std::string & body = found ? *found : empty;
+
+            std::stringstream ss;
+            ss << ( found ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n" );
+            ss << "Content-Type: application/octet-stream\r\n";
+            ss << "Content-Length: " << body.size() << "\r\n\r\n";
+            const std::string header = ss.str();
+
+            ++m_Requests;
+
+            return SendAll( fd, header.data(), header.size() ) &&
+                   SendAll( fd, body.data(), body.size() );
+        }
+
+        bool SendAll( const int fd, const char * data, size_t size )
+        {
+            while( size )
+            {
+                const size_t chunk = size < m_ChunkSize ? size : m_ChunkSize;
+                const ssize_t n = send( fd, data, chunk, MSG_NOSIGNAL );
+                if( n <= 0 )
+                {
+                    return false;
+                }
+                data += n;
+                size -= n;
+            }
+            return true;
+        }
+
+        const size_t m_ChunkSize;
+        int m_Listen { -1 };
+        uint16_t m_Port { 0 };
+        std::atomic<bool> m_Stop { false };
+        std::atomic<int> m_Connections { 0 };
+        std::atomic<int> m_Requests { 0 };
+
+        std::mutex m_Mutex;
+        std::map<std::string, std::shared_ptr<const std::string> > m_Bodies;
+        std::vector<int> m_Clients;
+        std::vector<std::thread> m_Workers;
+        std::thread m_Acceptor;
+};
+
+//! synthetic frame as the camera sends it: big endian words
+inline std::string MakeBigEndianFrame( const size_t numWords )
+{
+    std::string body( numWords * 2, '\0' );
+    for( size_t i = 0; i < numWords; ++i )
+    {
+        const uint16_t v = static_cast<uint16_t>( i * 2654435761u >> 13 );
+        body[2*i] = static_cast<char>( v >> 8 );
+        body[2*i+1] = static_cast<char>( v & 0xFF );
+    }
+    return body;
+}
+
+//! expected value of word i of MakeBigEndianFrame
+inline uint16_t FrameWord( const size_t i )
+{
+    return static_cast<uint16_t>( i * 2654435761u >> 13 );
+}
+
+#endif
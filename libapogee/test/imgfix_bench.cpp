@@ -0,0 +1,75 @@
+/*! 
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* Copyright(c) 2026 INDI Developers
+* \brief throughput of the ImgFix multi output reordering against the scalar implementation
+*
+* Usage: imgfix_bench [rows] [cols] [iterations]
+* Defaults to a 4096x4096 frame, the size of the HiC sensor.
+*/ 
+
+#include "ImgFix.h"
+#include "imgfix_legacy.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+static double Run( const int iterations, const std::function<void()> & fn )
+{
+    fn();
+    const auto start = std::chrono::steady_clock::now();
+    for( int i = 0; i < iterations; ++i )
+    {
+        fn();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>( end - start ).count() / iterations;
+}
+
+static void Report( const char * label, const double mb, const double legacy, const double tiled )
+{
+    printf( "%-14s legacy %8.2f ms %8.1f MB/s   tiled %8.2f ms %8.1f MB/s  x%.2f\n",
+        label, legacy, mb / legacy * 1000, tiled, mb / tiled * 1000, legacy / tiled );
+}
+
+int main( int argc, char * argv[] )
+{
+    const int32_t rows = argc > 1 ? atoi( argv[1] ) : 4096;
+    const int32_t cols = argc > 2 ? atoi( argv[2] ) : 4096;
+    const int iterations = argc > 3 ? atoi( argv[3] ) : 20;
+    const int32_t latency = 8;
+
+    if( rows < 2 || cols < 2 || iterations <= 0 )
+    {
+        fprintf( stderr, "usage: %s [rows] [cols] [iterations]\n", argv[0] );
+        return 1;
+    }
+
+    std::vector<uint16_t> data( static_cast<size_t>( rows ) * ( cols + latency * 2 ) + latency * 2 );
+    for( size_t i = 0; i < data.size(); ++i )
+    {
+        data[i] = static_cast<uint16_t>( i * 2654435761u >> 7 );
+    }
+    std::vector<uint16_t> out( static_cast<size_t>( rows ) * cols );
+    const double mb = out.size() * sizeof(uint16_t) / 1e6;
+
+    printf( "%dx%d, %d latency pixels\n", cols, rows, latency );
+
+    Report( "QuadOuputFix", mb,
+        Run( iterations, [&]() { LegacyImgFix::QuadOuputFix( data, out, rows, cols, latency ); } ),
+        Run( iterations, [&]() { ImgFix::QuadOuputFix( data, out, rows, cols, latency ); } ) );
+
+    Report( "DualOuputFix", mb,
+        Run( iterations, [&]() { LegacyImgFix::DualOuputFix( data, out, rows, cols, latency ); } ),
+        Run( iterations, [&]() { ImgFix::DualOuputFix( data, out, rows, cols, latency ); } ) );
+
+    Report( "QuadOuputCopy", mb,
+        Run( iterations, [&]() { LegacyImgFix::QuadOuputCopy( data, out, rows, cols, latency ); } ),
+        Run( iterations, [&]() { ImgFix::QuadOuputCopy( data, out, rows, cols, latency ); } ) );
+
+    return 0;
+}
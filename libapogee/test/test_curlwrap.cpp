@@ -0,0 +1,128 @@
+/*!
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* Copyright(c) 2026 INDI Developers
+* \brief checks the streaming image download of CLibCurlWrap and AltaEthernetIo
+* against a local stand-in for the camera web server
+*
+*/
+
+#include "libCurlWrap.h"
+#include "AltaEthernetIo.h"
+#include "http_stub.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    const size_t FRAME_WORDS = 1024 * 1024 + 3;
+}
+
+// chunk sizes of the server, odd ones split words across write callbacks
+class CurlStreamTest : public ::testing::TestWithParam<size_t> {};
+
+TEST_P( CurlStreamTest, SwapsBigEndianWordsIntoBuffer )
+{
+    HttpStub server( GetParam() );
+    server.Serve( "/UE/image.bin", MakeBigEndianFrame( FRAME_WORDS ) );
+
+    std::vector<uint16_t> out( FRAME_WORDS );
+    CLibCurlWrap curl;
+    curl.HttpGet( server.Url() + "/UE/image.bin", out.data(), out.size(), true );
+
+    for( size_t i = 0; i < FRAME_WORDS; ++i )
+    {
+        ASSERT_EQ( FrameWord( i ), out[i] ) << "word " << i;
+    }
+}
+
+TEST_P( CurlStreamTest, CopiesHostOrderWords )
+{
+    std::vector<uint16_t> expected( FRAME_WORDS );
+    for( size_t i = 0; i < FRAME_WORDS; ++i )
+    {
+        expected[i] = FrameWord( i );
+    }
+
+    HttpStub server( GetParam() );
+    server.Serve( "/aspen.bin", std::string( reinterpret_cast<const char *>( expected.data() ), FRAME_WORDS * 2 ) );
+
+    std::vector<uint16_t> out( FRAME_WORDS );
+    CLibCurlWrap curl;
+    curl.HttpGet( server.Url() + "/aspen.bin", out.data(), out.size(), false );
+
+    EXPECT_EQ( expected, out );
+}
+
+INSTANTIATE_TEST_CASE_P( ChunkSizes, CurlStreamTest, ::testing::Values( 1023, 4096, 64 * 1024 + 1 ) );
+
+TEST( CurlWrap, ThrowsOnShortOrLongResponse )
+{
+    HttpStub server;
+    server.Serve( "/UE/image.bin", MakeBigEndianFrame( 1000 ) );
+
+    CLibCurlWrap curl;
+    std::vector<uint16_t> out( 1001 );
+    EXPECT_THROW( curl.HttpGet( server.Url() + "/UE/image.bin", out.data(), 1001, true ), std::runtime_error );
+    EXPECT_THROW( curl.HttpGet( server.Url() + "/UE/image.bin", out.data(), 999, true ), std::runtime_error );
+
+    // the handle is still usable afterwards
+    EXPECT_NO_THROW( curl.HttpGet( server.Url() + "/UE/image.bin", out.data(), 1000, true ) );
+    EXPECT_EQ( FrameWord( 999 ), out[999] );
+}
+
+TEST( CurlWrap, ReusesConnection )
+{
+    HttpStub server;
+    server.Serve( "/FPGA", "RR[0]=0x1234\n" );
+    server.Serve( "/UE/image.bin", MakeBigEndianFrame( 4096 ) );
+
+    CLibCurlWrap curl;
+    std::vector<uint16_t> out( 4096 );
+    for( int i = 0; i < 5; ++i )
+    {
+        std::string result;
+        curl.HttpGet( server.Url() + "/FPGA?RR=0", result );
+        EXPECT_EQ( "RR[0]=0x1234\n", result );
+
+        curl.HttpGet( server.Url() + "/UE/image.bin", out.data(), out.size(), true );
+    }
+
+    EXPECT_EQ( 10, server.Requests() );
+    EXPECT_EQ( 1, server.Connections() );
+}
+
+TEST( AltaEthernetIo, GetImageDataStreamsFrame )
+{
+    HttpStub server( 1499 );
+    server.Serve( "/SESSION", "SessionId=1\n" );
+    server.Serve( "/UE/image.bin", MakeBigEndianFrame( FRAME_WORDS ) );
+
+    {
+        AltaEthernetIo io( server.Url() );
+
+        for( int frame = 0; frame < 3; ++frame )
+        {
+            std::vector<uint16_t> data( FRAME_WORDS );
+            io.GetImageData( data );
+
+            for( size_t i = 0; i < FRAME_WORDS; ++i )
+            {
+                ASSERT_EQ( FrameWord( i ), data[i] ) << "frame " << frame << " word " << i;
+            }
+        }
+
+        std::vector<uint16_t> wrongSize( FRAME_WORDS - 1 );
+        EXPECT_THROW( io.GetImageData( wrongSize ), std::runtime_error );
+    }
+
+    // open, three frames, the failed one and close over one connection;
+    // a failed download may cost the connection, nothing else may
+    EXPECT_EQ( 6, server.Requests() );
+    EXPECT_LE( server.Connections(), 2 );
+}
@@ -0,0 +1,181 @@
+/*! 
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* Copyright(c) 2026 INDI Developers
+* \brief checks the tiled ImgFix reordering is bit exact with the scalar implementation
+* 
+*/ 
+
+#include "ImgFix.h"
+#include "imgfix_legacy.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <tuple>
+
+namespace
+{
+    std::vector<uint16_t> SyntheticFrame( const size_t size, const uint32_t seed )
+    {
+        std::vector<uint16_t> data( size );
+        uint32_t v = seed;
+        for( size_t i = 0; i < size; ++i )
+        {
+            v = v * 1664525u + 1013904223u;
+            data[i] = static_cast<uint16_t>( v >> 16 );
+        }
+        return data;
+    }
+
+    // rows, cols, latency pixels
+    typedef std::tuple<int32_t, int32_t, int32_t> Geometry;
+
+    const Geometry GEOMETRIES[] =
+    {
+        Geometry( 2, 16, 0 ),
+        Geometry( 8, 30, 4 ),
+        Geometry( 9, 31, 3 ),          // odd rows and columns leave a row and a column untouched
+        Geometry( 64, 17, 8 ),         // narrower than one vector per output
+        Geometry( 256, 1024, 0 ),
+        Geometry( 1024, 1024, 8 ),     // large enough to run on the thread pool
+        Geometry( 1025, 1031, 15 ),
+        Geometry( 2048, 2048, 8 ),
+        Geometry( 4096, 4096, 0 ),     // HiC 4k x 4k
+    };
+}
+
+class ImgFixTest : public ::testing::TestWithParam<Geometry> {};
+
+TEST_P( ImgFixTest, QuadOuputFixIsBitExact )
+{
+    int32_t rows, cols, latency;
+    std::tie( rows, cols, latency ) = GetParam();
+
+    const std::vector<uint16_t> data = SyntheticFrame( ( rows / 2 ) * ( ( cols / 2 ) * 4 + latency * 2 ) + latency * 2, 1 );
+    std::vector<uint16_t> expected = SyntheticFrame( rows * cols, 2 );
+    std::vector<uint16_t> out = expected;
+
+    LegacyImgFix::QuadOuputFix( data, expected, rows, cols, latency );
+    ImgFix::QuadOuputFix( data, out, rows, cols, latency );
+
+    ASSERT_EQ( out, expected );
+}
+
+TEST_P( ImgFixTest, DualOuputFixIsBitExact )
+{
+    int32_t rows, cols, latency;
+    std::tie( rows, cols, latency ) = GetParam();
+
+    const std::vector<uint16_t> data = SyntheticFrame( rows * ( ( cols / 2 ) * 2 + latency ) + latency, 3 );
+    std::vector<uint16_t> expected = SyntheticFrame( rows * cols, 4 );
+    std::vector<uint16_t> out = expected;
+
+    LegacyImgFix::DualOuputFix( data, expected, rows, cols, latency );
+    ImgFix::DualOuputFix( data, out, rows, cols, latency );
+
+    ASSERT_EQ( out, expected );
+}
+
+TEST_P( ImgFixTest, QuadOuputCopyIsBitExact )
+{
+    int32_t rows, cols, latency;
+    std::tie( rows, cols, latency ) = GetParam();
+
+    const int32_t numGood = ( cols / 2 ) * 4;
+    const int32_t runs = ( rows * cols + numGood - 1 ) / numGood;
+    const std::vector<uint16_t> data = SyntheticFrame( runs * ( numGood + latency * 2 ) + latency * 2, 5 );
+
+    for( int32_t offset : { 0, cols } )
+    {
+        std::vector<uint16_t> expected = SyntheticFrame( rows * cols + offset, 6 );
+        std::vector<uint16_t> out = expected;
+
+        LegacyImgFix::QuadOuputCopy( data, expected, rows, cols, latency, offset );
+        ImgFix::QuadOuputCopy( data, out, rows, cols, latency, offset );
+
+        ASSERT_EQ( out, expected ) << "output offset " << offset;
+    }
+}
+
+TEST_P( ImgFixTest, StridedOutputMatchesContiguous )
+{
+    int32_t rows, cols, latency;
+    std::tie( rows, cols, latency ) = GetParam();
+
+    const int32_t stride = cols + 13;
+    const uint16_t PAD = 0xBEEF;
+    const std::vector<uint16_t> data = SyntheticFrame( rows * ( cols + latency * 2 ) + latency * 2, 8 );
+
+    typedef std::function<void(uint16_t *, int32_t)> Fix;
+    const Fix fixes[] =
+    {
+        [&]( uint16_t * out, int32_t outStride ) { ImgFix::SingleOuputCopy( data.data(), out, outStride, rows, cols, latency ); },
+        [&]( uint16_t * out, int32_t outStride ) { ImgFix::QuadOuputCopy( data.data(), out, outStride, rows, cols, latency ); },
+        [&]( uint16_t * out, int32_t outStride ) { ImgFix::QuadOuputFix( data.data(), out, outStride, rows, cols, latency ); },
+        [&]( uint16_t * out, int32_t outStride ) { ImgFix::DualOuputFix( data.data(), out, outStride, rows, cols, latency ); },
+    };
+
+    for( const Fix & fix : fixes )
+    {
+        std::vector<uint16_t> expected( rows * cols, PAD );
+        std::vector<uint16_t> strided( rows * stride, PAD );
+
+        fix( expected.data(), cols );
+        fix( strided.data(), stride );
+
+        for( int32_t r = 0; r < rows; ++r )
+        {
+            ASSERT_TRUE( std::equal( expected.begin() + r * cols, expected.begin() + ( r + 1 ) * cols,
+                strided.begin() + r * stride ) ) << "row " << r;
+            ASSERT_TRUE( std::all_of( strided.begin() + r * stride + cols, strided.begin() + ( r + 1 ) * stride,
+                []( uint16_t v ) { return v == PAD; } ) ) << "padding of row " << r;
+        }
+    }
+}
+
+TEST_P( ImgFixTest, SingleOuputCopyIsBitExact )
+{
+    int32_t rows, cols, latency;
+    std::tie( rows, cols, latency ) = GetParam();
+
+    const std::vector<uint16_t> data = SyntheticFrame( rows * ( cols + latency ), 9 );
+    std::vector<uint16_t> expected = SyntheticFrame( rows * cols, 10 );
+    std::vector<uint16_t> out = expected;
+
+    LegacyImgFix::SingleOuputCopy( data, expected, rows, cols, latency );
+    ImgFix::SingleOuputCopy( data, out, rows, cols, latency );
+
+    ASSERT_EQ( out, expected );
+}
+
+INSTANTIATE_TEST_CASE_P( Geometries, ImgFixTest, ::testing::ValuesIn( GEOMETRIES ) );
+
+TEST( ImgFix, ConcurrentCallsAreBitExact )
+{
+    const int32_t rows = 2048, cols = 2048;
+    const std::vector<uint16_t> data = SyntheticFrame( ( rows / 2 ) * cols * 2, 7 );
+    std::vector<uint16_t> expected( rows * cols );
+    LegacyImgFix::QuadOuputFix( data, expected, rows, cols, 0 );
+
+    // several cameras downloading at once share the pool
+    std::vector<std::vector<uint16_t>> outs( 4, std::vector<uint16_t>( rows * cols ) );
+    std::vector<std::thread> threads;
+    for( auto & out : outs )
+    {
+        threads.emplace_back( [&]()
+        {
+            for( int i = 0; i < 5; ++i )
+                ImgFix::QuadOuputFix( data, out, rows, cols, 0 );
+        } );
+    }
+    for( auto & t : threads )
+        t.join();
+
+    for( const auto & out : outs )
+        ASSERT_EQ( out, expected );
+}
@@ -34,6 +34,8 @@ POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "fishcamp.h"
+#include "fishcamp_calibration.h"
+#include "fishcamp_kernels.h"
 #include "indimacros.h"
 
 #include <errno.h>
@@ -1669,151 +1671,18 @@ void fcImage_PRO_calibrateProCamera(int camNum, UInt16 *frameBufferPtr, int imag
 
 // routine to perform a 3x3 kernel filter on the image buffer
 //
+// the filters work 'in place' on a rolling window of rows, see fishcamp_kernels.c
+//
 void fcImage_do_3x3_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
 {
-    //float reference;
-    int row, col;
-    UInt16 *inputPtr;
-    UInt16 *outputPtr;
-    UInt16 aPixel;
-    UInt32 accumPixel;
-    UInt16 *tempBuffer;
-    size_t size;
-
-    // this routine will work 'in place'.  We will first allocate a temporary image buffer
-    // we copy the image to it and then fill the original buffer with the filtered image
-    //
-    size       = imageWidth * imageHeight * 2; // 2 bytes/pixel
-    tempBuffer = (UInt16 *)malloc(size);
-
-    if (tempBuffer != NULL)
-    {
-        // copy the image buffer to my local storage
-        memcpy(tempBuffer, frameBuffer, size);
-
-        // Start at row '1'
-        for (row = 1; row < (imageHeight - 1); row++)
-        {
-            for (col = 1; col < (imageWidth - 1); col++)
-            {
-                inputPtr  = tempBuffer;
-                inputPtr  = inputPtr + (row * imageWidth) + col;
-                outputPtr = frameBuffer;
-                outputPtr = outputPtr + (row * imageWidth) + col;
-
-                accumPixel = 0;
-
-                inputPtr   = inputPtr - imageWidth - 1; // 1
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-                inputPtr++; // 2
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-                inputPtr++; // 3
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-                inputPtr   = inputPtr + imageWidth - 2; // 4
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-                inputPtr++; // 5
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-                inputPtr++; // 6
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-                inputPtr   = inputPtr + imageWidth - 2; // 7
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-                inputPtr++; // 8
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-                inputPtr++; // 9
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-
-                // divide by the kernel size
-                accumPixel = accumPixel / 9;
-
-                // put filtered value back
-                *outputPtr = (UInt16)accumPixel;
-            }
-        }
-
-        free(tempBuffer);
-    }
+    fcKernel_3x3(frameBuffer, imageWidth, imageHeight, fcKernel_numThreads(imageWidth, imageHeight));
 }
 
 // routine to perform a 5x5 kernel filter on the image buffer
 //
 void fcImage_do_5x5_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
 {
-    //float reference;
-    int row, col;
-    UInt16 *inputPtr;
-    UInt16 *outputPtr;
-    UInt16 aPixel;
-    UInt32 accumPixel;
-    UInt16 *tempBuffer;
-    size_t size;
-    int x, y;
-
-    // this routine will work 'in place'.  We will first allocate a temporary image buffer
-    // we copy the image to it and then fill the original buffer with the filtered image
-    //
-    size       = imageWidth * imageHeight * 2; // 2 bytes/pixel
-    tempBuffer = (UInt16 *)malloc(size);
-
-    if (tempBuffer != NULL)
-    {
-        // copy the image buffer to my local storage
-        memcpy(tempBuffer, frameBuffer, size);
-
-        // Start at row '2'
-        for (row = 2; row < (imageHeight - 2); row++)
-        {
-            for (col = 2; col < (imageWidth - 2); col++)
-            {
-                inputPtr  = tempBuffer;
-                inputPtr  = inputPtr + (row * imageWidth) + col;
-                outputPtr = frameBuffer;
-                outputPtr = outputPtr + (row * imageWidth) + col;
-
-                accumPixel = 0;
-
-                inputPtr = inputPtr - (3 * imageWidth) + 2;
-
-                for (y = 0; y < 5; y++)
-                {
-                    inputPtr   = inputPtr + imageWidth - 4;
-                    aPixel     = *inputPtr;
-                    accumPixel = accumPixel + (UInt32)aPixel;
-
-                    for (x = 0; x < 4; x++)
-                    {
-                        inputPtr++;
-                        aPixel     = *inputPtr;
-                        accumPixel = accumPixel + (UInt32)aPixel;
-                    }
-                }
-
-                // divide by the kernel size
-                accumPixel = accumPixel / 25;
-
-                // put filtered value back
-                *outputPtr = (UInt16)accumPixel;
-            }
-        }
-
-        free(tempBuffer);
-    }
+    fcKernel_5x5(frameBuffer, imageWidth, imageHeight, fcKernel_numThreads(imageWidth, imageHeight));
 }
 
 // routine to perform hot pixel removal filter on the image buffer
@@ -1824,118 +1693,7 @@ void fcImage_do_5x5_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameB
 //
 void fcImage_do_hotPixel_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
 {
-    float floatBrightPixel;
-    float floatCenterPixel;
-    int row, col;
-    UInt16 *inputPtr;
-    UInt16 *outputPtr;
-    UInt16 aPixel;
-    UInt32 accumPixel;
-    UInt16 *tempBuffer;
-    size_t size;
-    UInt16 brightestNeighbor;
-    UInt16 thisPixel;
-    int numHotPixels;
-
-    // this routine will work 'in place'.  We will first allocate a temporary image buffer
-    // we copy the image to it and then fill the original buffer with the filtered image
-    //
-    size       = imageWidth * imageHeight * 2; // 2 bytes/pixel
-    tempBuffer = (UInt16 *)malloc(size);
-
-    if (tempBuffer != NULL)
-    {
-        numHotPixels = 0;
-
-        // copy the image buffer to my local storage
-        memcpy(tempBuffer, frameBuffer, size);
-
-        // Start at row '1'
-        for (row = 1; row < (imageHeight - 1); row++)
-        {
-            for (col = 1; col < (imageWidth - 1); col++)
-            {
-                inputPtr  = tempBuffer;
-                inputPtr  = inputPtr + (row * imageWidth) + col;
-                outputPtr = frameBuffer;
-                outputPtr = outputPtr + (row * imageWidth) + col;
-
-                accumPixel        = 0;
-                brightestNeighbor = 0;
-
-                inputPtr   = inputPtr - imageWidth - 1; // 1
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-                if (brightestNeighbor < aPixel)
-                    brightestNeighbor = aPixel;
-
-                inputPtr++; // 2
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-                if (brightestNeighbor < aPixel)
-                    brightestNeighbor = aPixel;
-
-                inputPtr++; // 3
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-                if (brightestNeighbor < aPixel)
-                    brightestNeighbor = aPixel;
-
-                inputPtr   = inputPtr + imageWidth - 2; // 4
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-                if (brightestNeighbor < aPixel)
-                    brightestNeighbor = aPixel;
-
-                inputPtr++; // 5 - center pixel
-                aPixel    = *inputPtr;
-                thisPixel = aPixel;
-
-                inputPtr++; // 6
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-                if (brightestNeighbor < aPixel)
-                    brightestNeighbor = aPixel;
-
-                inputPtr   = inputPtr + imageWidth - 2; // 7
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-                if (brightestNeighbor < aPixel)
-                    brightestNeighbor = aPixel;
-
-                inputPtr++; // 8
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-                if (brightestNeighbor < aPixel)
-                    brightestNeighbor = aPixel;
-
-                inputPtr++; // 9
-                aPixel     = *inputPtr;
-                accumPixel = accumPixel + (UInt32)aPixel;
-                if (brightestNeighbor < aPixel)
-                    brightestNeighbor = aPixel;
-
-                // divide by the number of surrounding pixels
-                accumPixel = accumPixel / 8;
-
-                floatBrightPixel = (float)brightestNeighbor;
-                floatBrightPixel = floatBrightPixel * 1.2;
-
-                floatCenterPixel = (float)thisPixel;
-
-                if (floatCenterPixel > floatBrightPixel)
-                {
-                    numHotPixels++;
-                    // substitute average
-                    *outputPtr = (UInt16)accumPixel;
-                }
-            }
-        }
-
-        free(tempBuffer);
-    }
-
-    //	Starfish_LogFmt("fcImage_do_hotPixel_kernel numHotPixels = %d\n", numHotPixels);
+    fcKernel_hotPixel(frameBuffer, imageWidth, imageHeight, fcKernel_numThreads(imageWidth, imageHeight));
 }
 
 // This is the framework initialization routine and needs to be called once upon application startup
@@ -3778,23 +3536,23 @@ int fcUsb_cmd_getRawFrame(int camNum, UInt16 numRows, UInt16 numCols, UInt16 *fr
     if (gCamerasFound[camNum - 1].camFinalProduct == starfish_pro4m_final_deviceID)
     {
         maxBytes     = numRows * numCols * 2; // 2 bytes / pixel
-        numBytesRead = RcvUSB(camNum, (unsigned char *)&frameBuffer, maxBytes);
+        numBytesRead = RcvUSB(camNum, (unsigned char *)frameBuffer, maxBytes);
 
         Starfish_LogFmt("   read - %ld bytes\n", numBytesRead);
         
 
         if (gProWantColNormalization)
-            fcImage_PRO_doFullFrameColLevelNormalization(frameBuffer, numCols, numRows);
+            fcCalibrate_PRO(frameBuffer, numCols, numRows, gProBlackColOffsets);
     }
     else
     {
         if (gCamerasFound[camNum - 1].camFinalProduct == starfish_ibis13_final_deviceID)
         {
             maxBytes     = numRows * numCols * 2; // 2 bytes / pixel
-            numBytesRead = RcvUSB(camNum, (unsigned char *)&frameBuffer, maxBytes);
+            numBytesRead = RcvUSB(camNum, (unsigned char *)frameBuffer, maxBytes);
 
-            fcImage_IBIS_doFullFrameColLevelNormalization(frameBuffer, numCols, numRows);
-            fcImage_IBIS_subtractPedestal(frameBuffer, numCols, numRows);
+            // column level normalization and pedestal subtraction in one pass
+            fcCalibrate_IBIS(frameBuffer, numCols, numRows, gBlackOffsets);
         }
         else
         {
@@ -3814,8 +3572,8 @@ int fcUsb_cmd_getRawFrame(int camNum, UInt16 numRows, UInt16 numCols, UInt16 *fr
             
             if (gReadBlack[camNum - 1] && numBytesRead != 0)
             {
-                fcImage_doFullFrameRowLevelNormalization(gFrameBuffer, (numCols + 16), numRows);
-                fcImage_StripBlackCols(camNum, frameBuffer);
+                // row level normalization while stripping the black cols into the caller's buffer
+                fcCalibrate_rowLevelStrip(gFrameBuffer, frameBuffer, numCols, numRows);
             }
         } // if Starfish
     }
@@ -0,0 +1,277 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  ======================================================================
+*/
+
+#include "fishcamp_calibration.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// black columns at the start of each raw Starfish row, and how many of them are measured
+#define FC_BLACK_COLS     16
+#define FC_BLACK_COLS_AVG 14
+
+// offsets beyond a full pixel range clamp the same way, keep them in 32 bits
+static int32_t fcCalibrate_clampOffset(long offset)
+{
+    if (offset > 65536)
+        return 65536;
+    if (offset < -65536)
+        return -65536;
+    return (int32_t)offset;
+}
+
+static unsigned short fcCalibrate_clampPixel(int32_t pixel)
+{
+    if (pixel > 65535)
+        return 65535;
+    if (pixel < 0)
+        return 0;
+    return (unsigned short)pixel;
+}
+
+// the float correction of the original passes: add, clamp, truncate
+static unsigned short fcCalibrate_floatPixel(unsigned short pixel, float offset)
+{
+    float floatPixel = (float)pixel;
+
+    floatPixel += offset;
+
+    if (floatPixel > 65535.0)
+        floatPixel = 65535.0;
+
+    if (floatPixel < 0.0)
+        floatPixel = 0.0;
+
+    return (unsigned short)floatPixel;
+}
+
+#if defined(__SSE2__)
+// pack two vectors of 32-bit values into 16-bit lanes, clamping them to 0 .. 65535
+static inline __m128i fcCalibrate_pack_epu32(__m128i lo, __m128i hi)
+{
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+
+    return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32)), bias16);
+}
+
+// fcCalibrate_floatPixel on 4 pixels
+static inline __m128i fcCalibrate_float_epi32(__m128i pixels, __m128 offsets)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 max  = _mm_set1_ps(65535.0f);
+
+    __m128 floatPixels = _mm_add_ps(_mm_cvtepi32_ps(pixels), offsets);
+
+    return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(floatPixels, zero), max));
+}
+#endif
+
+// one row of pixels + offsets[col], each clamped and truncated like fcCalibrate_floatPixel
+static void fcCalibrate_floatRow(const unsigned short *in, unsigned short *out, int width, const float *offsets,
+                                 float rowOffset)
+{
+    int col = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 vrow  = _mm_set1_ps(rowOffset);
+
+    for (; col + 8 <= width; col += 8)
+    {
+        __m128i v    = _mm_loadu_si128((const __m128i *)(in + col));
+        __m128 offLo = offsets ? _mm_loadu_ps(offsets + col) : vrow;
+        __m128 offHi = offsets ? _mm_loadu_ps(offsets + col + 4) : vrow;
+
+        __m128i lo = fcCalibrate_float_epi32(_mm_unpacklo_epi16(v, zero), offLo);
+        __m128i hi = fcCalibrate_float_epi32(_mm_unpackhi_epi16(v, zero), offHi);
+
+        _mm_storeu_si128((__m128i *)(out + col), fcCalibrate_pack_epu32(lo, hi));
+    }
+#endif
+
+    for (; col < width; col++)
+        out[col] = fcCalibrate_floatPixel(in[col], offsets ? offsets[col] : rowOffset);
+}
+
+void fcCalibrate_IBIS(unsigned short *frameBuffer, int imageWidth, int imageHeight, const long *blackOffsets)
+{
+    float frameAvg = 0.0;
+    int32_t pedestal;
+    int32_t *colOffsets;
+    int row, col;
+
+    if (imageWidth <= 0 || imageHeight <= 1)
+        return;
+
+    colOffsets = (int32_t *)malloc(imageWidth * sizeof(int32_t));
+    if (colOffsets == NULL)
+        return;
+
+    // average of the first black row, as fcImage_IBIS_calcFirstBlackRowAverage
+    for (col = 0; col < imageWidth; col++)
+        frameAvg += (float)blackOffsets[col];
+
+    frameAvg = frameAvg / (float)imageWidth;
+
+    // the column normalization offsets each column to the black average, the
+    // pedestal subtraction then takes that same average off every pixel
+    for (col = 0; col < imageWidth; col++)
+        colOffsets[col] = fcCalibrate_clampOffset((long)frameAvg - blackOffsets[col]);
+
+    pedestal = fcCalibrate_clampOffset((long)frameAvg);
+
+    // don't touch the black row.  Start at row '1'
+    for (row = 1; row < imageHeight; row++)
+    {
+        unsigned short *pixels = frameBuffer + (size_t)row * imageWidth;
+
+        col = 0;
+
+#if defined(__SSE2__)
+        {
+            const __m128i zero      = _mm_setzero_si128();
+            const __m128i vpedestal = _mm_set1_epi32(pedestal);
+
+            for (; col + 8 <= imageWidth; col += 8)
+            {
+                __m128i v  = _mm_loadu_si128((const __m128i *)(pixels + col));
+                __m128i lo = _mm_add_epi32(_mm_unpacklo_epi16(v, zero), _mm_loadu_si128((const __m128i *)(colOffsets + col)));
+                __m128i hi = _mm_add_epi32(_mm_unpackhi_epi16(v, zero), _mm_loadu_si128((const __m128i *)(colOffsets + col + 4)));
+
+                // both steps clamp, as the two original passes did
+                v  = fcCalibrate_pack_epu32(lo, hi);
+                lo = _mm_sub_epi32(_mm_unpacklo_epi16(v, zero), vpedestal);
+                hi = _mm_sub_epi32(_mm_unpackhi_epi16(v, zero), vpedestal);
+
+                _mm_storeu_si128((__m128i *)(pixels + col), fcCalibrate_pack_epu32(lo, hi));
+            }
+        }
+#endif
+
+        for (; col < imageWidth; col++)
+            pixels[col] = fcCalibrate_clampPixel(fcCalibrate_clampPixel(pixels[col] + colOffsets[col]) - pedestal);
+    }
+
+    free(colOffsets);
+}
+
+void fcCalibrate_PRO(unsigned short *frameBuffer, int imageWidth, int imageHeight, const long *colOffsets)
+{
+    float *offsets;
+    int row, col;
+
+    if (imageWidth <= 0 || imageHeight <= 0)
+        return;
+
+    offsets = (float *)malloc(imageWidth * sizeof(float));
+    if (offsets == NULL)
+        return;
+
+    // the original subtracts the float offset, adding its negation is the same
+    for (col = 0; col < imageWidth; col++)
+        offsets[col] = -(float)colOffsets[col];
+
+    for (row = 0; row < imageHeight; row++)
+    {
+        unsigned short *pixels = frameBuffer + (size_t)row * imageWidth;
+
+        fcCalibrate_floatRow(pixels, pixels, imageWidth, offsets, 0.0f);
+    }
+
+    free(offsets);
+}
+
+// average of the measured black pixels of one row, as fcImage_calcFullFrameRowAvgForRow
+static float fcCalibrate_blackRowAvg(const unsigned short *row)
+{
+    float retValue = 0.0;
+    int col;
+
+    for (col = 0; col < FC_BLACK_COLS_AVG; col++)
+        retValue += (float)row[col];
+
+    retValue = retValue / 14.0;
+
+    return retValue;
+}
+
+void fcCalibrate_rowLevelStrip(const unsigned short *rawFrame, unsigned short *frameBuffer, int imageWidth,
+                               int imageHeight)
+{
+    const int rawWidth = imageWidth + FC_BLACK_COLS;
+    unsigned short prevBlack[FC_BLACK_COLS_AVG];
+    float frameAvg = 0.0;
+    float prevRowAvg = 0.0;
+    int row, col;
+
+    if (imageWidth <= 0 || imageHeight <= 0)
+        return;
+
+    // statistics pass, reads only the black columns.
+    // average of all the black pixels, as fcImage_calcFullFrameAllColAvg
+    for (row = 0; row < imageHeight; row++)
+    {
+        const unsigned short *raw = rawFrame + (size_t)row * rawWidth;
+
+        for (col = 0; col < FC_BLACK_COLS_AVG; col++)
+            frameAvg += (float)raw[col];
+    }
+
+    frameAvg = frameAvg / (14.0 * (float)imageHeight);
+
+    // correction pass.  Each row is leveled to the corrected black columns of the
+    // row above, only those 14 pixels of the previous row have to be kept.
+    for (row = 0; row < imageHeight; row++)
+    {
+        const unsigned short *raw = rawFrame + (size_t)row * rawWidth;
+        float thisRowAvg          = fcCalibrate_blackRowAvg(raw);
+        float rowOffset;
+
+        if (row == 0)
+            rowOffset = frameAvg - thisRowAvg;
+        else
+            rowOffset = prevRowAvg - thisRowAvg;
+
+        for (col = 0; col < FC_BLACK_COLS_AVG; col++)
+            prevBlack[col] = fcCalibrate_floatPixel(raw[col], rowOffset);
+
+        prevRowAvg = fcCalibrate_blackRowAvg(prevBlack);
+
+        fcCalibrate_floatRow(raw + FC_BLACK_COLS, frameBuffer + (size_t)row * imageWidth, imageWidth, NULL, rowOffset);
+    }
+}
@@ -0,0 +1,63 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  ======================================================================
+*/
+
+#ifndef FISHCAMP_CALIBRATION_H
+#define FISHCAMP_CALIBRATION_H
+
+// Single pass calibration of the raw frames read by fcUsb_cmd_getRawFrame.
+//
+// Each routine produces exactly the result of the original chain of full
+// frame passes in fishcamp.c, but reads and writes every image pixel once.
+// The statistics the corrections depend on come either from calibration
+// vectors or from the few black columns, never from the image area, so they
+// are gathered up front without touching the rest of the frame.
+//
+// Column offset vectors are SInt32, i.e. signed long, as in fishcamp.c.
+
+// IBIS1300: column level normalization against the averaged first black row
+// followed by the pedestal subtraction, rows 1 .. imageHeight - 1.
+// Same as fcImage_IBIS_doFullFrameColLevelNormalization + fcImage_IBIS_subtractPedestal.
+void fcCalibrate_IBIS(unsigned short *frameBuffer, int imageWidth, int imageHeight, const long *blackOffsets);
+
+// PRO4M: column level normalization with the offsets measured in the vertical overscan.
+// Same as fcImage_PRO_doFullFrameColLevelNormalization.
+void fcCalibrate_PRO(unsigned short *frameBuffer, int imageWidth, int imageHeight, const long *colOffsets);
+
+// Starfish with black columns: row level normalization against the black columns
+// of the raw frame, imageWidth + 16 pixels wide, written to frameBuffer without them.
+// Same as fcImage_doFullFrameRowLevelNormalization + fcImage_StripBlackCols, except
+// that rawFrame itself is left as read.
+void fcCalibrate_rowLevelStrip(const unsigned short *rawFrame, unsigned short *frameBuffer, int imageWidth,
+                               int imageHeight);
+
+#endif // FISHCAMP_CALIBRATION_H
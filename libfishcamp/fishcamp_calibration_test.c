@@ -0,0 +1,292 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  ======================================================================
+*/
+
+// Equivalence test and benchmark for fishcamp_calibration.c.
+//
+// Usage: fishcamp_calibration_test [iterations]
+//
+// Runs random frames through the original chain of full frame passes in
+// fishcamp.c and through the single pass calibration, and requires identical
+// output for the IBIS1300, PRO4M and Starfish black column paths.  Then both
+// are timed on full size frames.
+
+#include "fishcamp.h"
+#include "fishcamp_calibration.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the original passes and their state in fishcamp.c
+extern UInt16 *gFrameBuffer;
+extern UInt16 gRoi_left[];
+extern UInt16 gRoi_top[];
+extern UInt16 gRoi_right[];
+extern UInt16 gRoi_bottom[];
+extern SInt32 gBlackOffsets[1280];
+extern SInt32 gProBlackColOffsets[4096];
+
+void fcImage_doFullFrameRowLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight);
+void fcImage_StripBlackCols(int camNum, UInt16 *frameBuffer);
+void fcImage_IBIS_subtractPedestal(UInt16 *frameBufferPtr, int imageWidth, int imageHeight);
+void fcImage_IBIS_doFullFrameColLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight);
+void fcImage_PRO_doFullFrameColLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight);
+
+static unsigned int rng_state = 4711;
+
+static unsigned int rng(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// 0: noise over the full range, 1: dark frame, 2: near saturation
+static void fill_frame(UInt16 *frame, size_t pixels, int style)
+{
+    size_t i;
+
+    for (i = 0; i < pixels; i++)
+    {
+        if (style == 0)
+            frame[i] = (UInt16)rng();
+        else if (style == 1)
+            frame[i] = (UInt16)(300 + rng() % 200);
+        else
+            frame[i] = (UInt16)(65535 - rng() % 400);
+    }
+}
+
+static int compare(const char *what, int width, int height, int style, const UInt16 *ref, const UInt16 *img)
+{
+    size_t i;
+
+    for (i = 0; i < (size_t)width * height; i++)
+    {
+        if (ref[i] != img[i])
+        {
+            fprintf(stderr, "%s %dx%d, frame %d: mismatch at x=%d y=%d, %u != %u\n", what, width, height, style,
+                    (int)(i % width), (int)(i / width), ref[i], img[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void legacy_IBIS(UInt16 *frame, int width, int height)
+{
+    fcImage_IBIS_doFullFrameColLevelNormalization(frame, width, height);
+    fcImage_IBIS_subtractPedestal(frame, width, height);
+}
+
+static void legacy_rowLevelStrip(UInt16 *raw, UInt16 *out, int width, int height)
+{
+    gFrameBuffer   = raw;
+    gRoi_left[0]   = 0;
+    gRoi_top[0]    = 0;
+    gRoi_right[0]  = width - 1;
+    gRoi_bottom[0] = height - 1;
+
+    fcImage_doFullFrameRowLevelNormalization(raw, width + 16, height);
+    fcImage_StripBlackCols(1, out);
+}
+
+static int test_IBIS(int width, int height, int style, UInt16 *ref, UInt16 *img)
+{
+    size_t pixels = (size_t)width * height;
+    int col;
+
+    for (col = 0; col < 1280; col++)
+        gBlackOffsets[col] = (style == 2) ? (SInt32)(rng() % 65536) : (SInt32)(250 + rng() % 300);
+
+    fill_frame(ref, pixels, style);
+    memcpy(img, ref, pixels * sizeof(UInt16));
+
+    legacy_IBIS(ref, width, height);
+    fcCalibrate_IBIS(img, width, height, gBlackOffsets);
+
+    return compare("IBIS", width, height, style, ref, img);
+}
+
+static int test_PRO(int width, int height, int style, UInt16 *ref, UInt16 *img)
+{
+    size_t pixels = (size_t)width * height;
+    int col;
+
+    for (col = 0; col < 4096; col++)
+        gProBlackColOffsets[col] = (style == 2) ? (SInt32)(rng() % 140000) - 70000 : (SInt32)(rng() % 101) - 50;
+
+    fill_frame(ref, pixels, style);
+    memcpy(img, ref, pixels * sizeof(UInt16));
+
+    fcImage_PRO_doFullFrameColLevelNormalization(ref, width, height);
+    fcCalibrate_PRO(img, width, height, gProBlackColOffsets);
+
+    return compare("PRO", width, height, style, ref, img);
+}
+
+static int test_rowLevelStrip(int width, int height, int style, UInt16 *raw, UInt16 *ref, UInt16 *img)
+{
+    size_t rawPixels = (size_t)(width + 16) * height;
+
+    fill_frame(raw, rawPixels, style);
+    memcpy(img, raw, rawPixels * sizeof(UInt16));
+
+    // img holds an untouched copy of the raw frame, the legacy passes level raw in place
+    legacy_rowLevelStrip(raw, ref, width, height);
+    fcCalibrate_rowLevelStrip(img, raw, width, height);
+
+    return compare("Starfish", width, height, style, ref, raw);
+}
+
+int main(int argc, char *argv[])
+{
+    static const int sizes[][2] = { { 1, 2 }, { 7, 3 }, { 8, 8 }, { 13, 5 }, { 64, 31 }, { 333, 17 }, { 1280, 1024 } };
+    int iterations = (argc > 1) ? atoi(argv[1]) : 10;
+    size_t maxPixels = (size_t)4096 * 4096;
+    UInt16 *raw, *ref, *img;
+    double t0, tlegacy, tfused;
+    int s, style, it, failed = 0;
+
+    if (iterations <= 0)
+    {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    raw = malloc(maxPixels * sizeof(UInt16));
+    ref = malloc(maxPixels * sizeof(UInt16));
+    img = malloc(maxPixels * sizeof(UInt16));
+    if (raw == NULL || ref == NULL || img == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+    {
+        for (style = 0; style < 3; style++)
+        {
+            failed |= test_IBIS(sizes[s][0], sizes[s][1], style, ref, img);
+            failed |= test_PRO(sizes[s][0], sizes[s][1], style, ref, img);
+            failed |= test_rowLevelStrip(sizes[s][0], sizes[s][1], style, raw, ref, img);
+        }
+    }
+
+    for (style = 0; style < 3; style++)
+        failed |= test_PRO(4096, 4096, style, ref, img);
+
+    if (failed)
+        return 1;
+
+    printf("calibration output identical to the original passes\n");
+
+    // IBIS1300, 1280x1024
+    fill_frame(raw, (size_t)1280 * 1024, 1);
+
+    t0 = now_ms();
+    for (it = 0; it < iterations; it++)
+    {
+        memcpy(ref, raw, (size_t)1280 * 1024 * sizeof(UInt16));
+        legacy_IBIS(ref, 1280, 1024);
+    }
+    tlegacy = (now_ms() - t0) / iterations;
+
+    t0 = now_ms();
+    for (it = 0; it < iterations; it++)
+    {
+        memcpy(img, raw, (size_t)1280 * 1024 * sizeof(UInt16));
+        fcCalibrate_IBIS(img, 1280, 1024, gBlackOffsets);
+    }
+    tfused = (now_ms() - t0) / iterations;
+
+    printf("%-20s legacy %8.2f ms   single pass %8.2f ms x%.2f\n", "IBIS 1280x1024", tlegacy, tfused, tlegacy / tfused);
+
+    // PRO4M, 2048x2048
+    fill_frame(raw, (size_t)2048 * 2048, 1);
+
+    t0 = now_ms();
+    for (it = 0; it < iterations; it++)
+    {
+        memcpy(ref, raw, (size_t)2048 * 2048 * sizeof(UInt16));
+        fcImage_PRO_doFullFrameColLevelNormalization(ref, 2048, 2048);
+    }
+    tlegacy = (now_ms() - t0) / iterations;
+
+    t0 = now_ms();
+    for (it = 0; it < iterations; it++)
+    {
+        memcpy(img, raw, (size_t)2048 * 2048 * sizeof(UInt16));
+        fcCalibrate_PRO(img, 2048, 2048, gProBlackColOffsets);
+    }
+    tfused = (now_ms() - t0) / iterations;
+
+    printf("%-20s legacy %8.2f ms   single pass %8.2f ms x%.2f\n", "PRO 2048x2048", tlegacy, tfused, tlegacy / tfused);
+
+    // Starfish with black columns, 1280x1024
+    fill_frame(raw, (size_t)1296 * 1024, 1);
+    memcpy(img, raw, (size_t)1296 * 1024 * sizeof(UInt16));
+
+    t0 = now_ms();
+    for (it = 0; it < iterations; it++)
+    {
+        memcpy(raw, img, (size_t)1296 * 1024 * sizeof(UInt16));
+        legacy_rowLevelStrip(raw, ref, 1280, 1024);
+    }
+    tlegacy = (now_ms() - t0) / iterations;
+
+    t0 = now_ms();
+    for (it = 0; it < iterations; it++)
+    {
+        memcpy(raw, img, (size_t)1296 * 1024 * sizeof(UInt16));
+        fcCalibrate_rowLevelStrip(raw, ref, 1280, 1024);
+    }
+    tfused = (now_ms() - t0) / iterations;
+
+    printf("%-20s legacy %8.2f ms   single pass %8.2f ms x%.2f\n", "Starfish 1280x1024", tlegacy, tfused, tlegacy / tfused);
+
+    free(raw);
+    free(ref);
+    free(img);
+
+    return 0;
+}
@@ -0,0 +1,504 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  ======================================================================
+*/
+
+// Regression test and benchmark for the image filters in fishcamp_kernels.c.
+//
+// Usage: fishcamp_kernel_bench [width] [height] [iterations]
+// Defaults to a 1280x1024 frame, the size of the Starfish and IBIS sensors.
+//
+// Every kernel is first checked bit for bit against the original full copy
+// implementation on random frames of many sizes and thread counts, then both
+// are timed on a width x height frame.
+
+#include "fishcamp_kernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef unsigned short UInt16;
+typedef unsigned long UInt32;
+
+// The original implementations from fishcamp.c, kept here as the reference.
+
+// routine to perform a 3x3 kernel filter on the image buffer
+//
+static void legacy_do_3x3_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+    //float reference;
+    int row, col;
+    UInt16 *inputPtr;
+    UInt16 *outputPtr;
+    UInt16 aPixel;
+    UInt32 accumPixel;
+    UInt16 *tempBuffer;
+    size_t size;
+
+    // this routine will work 'in place'.  We will first allocate a temporary image buffer
+    // we copy the image to it and then fill the original buffer with the filtered image
+    //
+    size       = imageWidth * imageHeight * 2; // 2 bytes/pixel
+    tempBuffer = (UInt16 *)malloc(size);
+
+    if (tempBuffer != NULL)
+    {
+        // copy the image buffer to my local storage
+        memcpy(tempBuffer, frameBuffer, size);
+
+        // Start at row '1'
+        for (row = 1; row < (imageHeight - 1); row++)
+        {
+            for (col = 1; col < (imageWidth - 1); col++)
+            {
+                inputPtr  = tempBuffer;
+                inputPtr  = inputPtr + (row * imageWidth) + col;
+                outputPtr = frameBuffer;
+                outputPtr = outputPtr + (row * imageWidth) + col;
+
+                accumPixel = 0;
+
+                inputPtr   = inputPtr - imageWidth - 1; // 1
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+
+                inputPtr++; // 2
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+
+                inputPtr++; // 3
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+
+                inputPtr   = inputPtr + imageWidth - 2; // 4
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+
+                inputPtr++; // 5
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+
+                inputPtr++; // 6
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+
+                inputPtr   = inputPtr + imageWidth - 2; // 7
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+
+                inputPtr++; // 8
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+
+                inputPtr++; // 9
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+
+                // divide by the kernel size
+                accumPixel = accumPixel / 9;
+
+                // put filtered value back
+                *outputPtr = (UInt16)accumPixel;
+            }
+        }
+
+        free(tempBuffer);
+    }
+}
+
+// routine to perform a 5x5 kernel filter on the image buffer
+//
+static void legacy_do_5x5_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+    //float reference;
+    int row, col;
+    UInt16 *inputPtr;
+    UInt16 *outputPtr;
+    UInt16 aPixel;
+    UInt32 accumPixel;
+    UInt16 *tempBuffer;
+    size_t size;
+    int x, y;
+
+    // this routine will work 'in place'.  We will first allocate a temporary image buffer
+    // we copy the image to it and then fill the original buffer with the filtered image
+    //
+    size       = imageWidth * imageHeight * 2; // 2 bytes/pixel
+    tempBuffer = (UInt16 *)malloc(size);
+
+    if (tempBuffer != NULL)
+    {
+        // copy the image buffer to my local storage
+        memcpy(tempBuffer, frameBuffer, size);
+
+        // Start at row '2'
+        for (row = 2; row < (imageHeight - 2); row++)
+        {
+            for (col = 2; col < (imageWidth - 2); col++)
+            {
+                inputPtr  = tempBuffer;
+                inputPtr  = inputPtr + (row * imageWidth) + col;
+                outputPtr = frameBuffer;
+                outputPtr = outputPtr + (row * imageWidth) + col;
+
+                accumPixel = 0;
+
+                inputPtr = inputPtr - (3 * imageWidth) + 2;
+
+                for (y = 0; y < 5; y++)
+                {
+                    inputPtr   = inputPtr + imageWidth - 4;
+                    aPixel     = *inputPtr;
+                    accumPixel = accumPixel + (UInt32)aPixel;
+
+                    for (x = 0; x < 4; x++)
+                    {
+                        inputPtr++;
+                        aPixel     = *inputPtr;
+                        accumPixel = accumPixel + (UInt32)aPixel;
+                    }
+                }
+
+                // divide by the kernel size
+                accumPixel = accumPixel / 25;
+
+                // put filtered value back
+                *outputPtr = (UInt16)accumPixel;
+            }
+        }
+
+        free(tempBuffer);
+    }
+}
+
+// routine to perform hot pixel removal filter on the image buffer
+//
+// algorithm looks for the center pixel ina 3x3 grid being more than 20%
+// brighter than the brightest of the neigboring pixels.  If it is
+// then it will replace it with the average of the neighboring pixels.
+//
+static void legacy_do_hotPixel_kernel(UInt16 imageHeight, UInt16 imageWidth, UInt16 *frameBuffer)
+{
+    float floatBrightPixel;
+    float floatCenterPixel;
+    int row, col;
+    UInt16 *inputPtr;
+    UInt16 *outputPtr;
+    UInt16 aPixel;
+    UInt32 accumPixel;
+    UInt16 *tempBuffer;
+    size_t size;
+    UInt16 brightestNeighbor;
+    UInt16 thisPixel;
+    int numHotPixels;
+
+    // this routine will work 'in place'.  We will first allocate a temporary image buffer
+    // we copy the image to it and then fill the original buffer with the filtered image
+    //
+    size       = imageWidth * imageHeight * 2; // 2 bytes/pixel
+    tempBuffer = (UInt16 *)malloc(size);
+
+    if (tempBuffer != NULL)
+    {
+        numHotPixels = 0;
+
+        // copy the image buffer to my local storage
+        memcpy(tempBuffer, frameBuffer, size);
+
+        // Start at row '1'
+        for (row = 1; row < (imageHeight - 1); row++)
+        {
+            for (col = 1; col < (imageWidth - 1); col++)
+            {
+                inputPtr  = tempBuffer;
+                inputPtr  = inputPtr + (row * imageWidth) + col;
+                outputPtr = frameBuffer;
+                outputPtr = outputPtr + (row * imageWidth) + col;
+
+                accumPixel        = 0;
+                brightestNeighbor = 0;
+
+                inputPtr   = inputPtr - imageWidth - 1; // 1
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+                if (brightestNeighbor < aPixel)
+                    brightestNeighbor = aPixel;
+
+                inputPtr++; // 2
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+                if (brightestNeighbor < aPixel)
+                    brightestNeighbor = aPixel;
+
+                inputPtr++; // 3
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+                if (brightestNeighbor < aPixel)
+                    brightestNeighbor = aPixel;
+
+                inputPtr   = inputPtr + imageWidth - 2; // 4
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+                if (brightestNeighbor < aPixel)
+                    brightestNeighbor = aPixel;
+
+                inputPtr++; // 5 - center pixel
+                aPixel    = *inputPtr;
+                thisPixel = aPixel;
+
+                inputPtr++; // 6
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+                if (brightestNeighbor < aPixel)
+                    brightestNeighbor = aPixel;
+
+                inputPtr   = inputPtr + imageWidth - 2; // 7
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+                if (brightestNeighbor < aPixel)
+                    brightestNeighbor = aPixel;
+
+                inputPtr++; // 8
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+                if (brightestNeighbor < aPixel)
+                    brightestNeighbor = aPixel;
+
+                inputPtr++; // 9
+                aPixel     = *inputPtr;
+                accumPixel = accumPixel + (UInt32)aPixel;
+                if (brightestNeighbor < aPixel)
+                    brightestNeighbor = aPixel;
+
+                // divide by the number of surrounding pixels
+                accumPixel = accumPixel / 8;
+
+                floatBrightPixel = (float)brightestNeighbor;
+                floatBrightPixel = floatBrightPixel * 1.2;
+
+                floatCenterPixel = (float)thisPixel;
+
+                if (floatCenterPixel > floatBrightPixel)
+                {
+                    numHotPixels++;
+                    // substitute average
+                    *outputPtr = (UInt16)accumPixel;
+                }
+            }
+        }
+
+        free(tempBuffer);
+    }
+
+    //	Starfish_LogFmt("fcImage_do_hotPixel_kernel numHotPixels = %d\n", numHotPixels);
+}
+
+typedef int (*fcKernelFn)(unsigned short *, int, int, int);
+typedef void (*legacyKernelFn)(UInt16, UInt16, UInt16 *);
+
+typedef struct
+{
+    const char *name;
+    fcKernelFn kernel;
+    legacyKernelFn legacy;
+} kernelCase;
+
+static const kernelCase kernels[] = {
+    { "3x3", fcKernel_3x3, legacy_do_3x3_kernel },
+    { "5x5", fcKernel_5x5, legacy_do_5x5_kernel },
+    { "hotPixel", fcKernel_hotPixel, legacy_do_hotPixel_kernel },
+};
+
+#define NUM_KERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static unsigned int rng_state = 12345;
+
+static unsigned int rng(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+// 0: noise, 1: sky background with hot pixels, 2: near saturation, 3: hot pixel threshold
+static void fill_frame(unsigned short *frame, size_t pixels, int style)
+{
+    size_t i;
+
+    for (i = 0; i < pixels; i++)
+    {
+        switch (style)
+        {
+            case 0:
+                frame[i] = (unsigned short)rng();
+                break;
+            case 1:
+                frame[i] = (unsigned short)(1000 + rng() % 64);
+                if (rng() % 50 == 0)
+                    frame[i] = (unsigned short)(1200 + rng() % 200);
+                break;
+            case 2:
+                frame[i] = (rng() % 7 == 0) ? 65535 : (unsigned short)(60000 + rng() % 5536);
+                break;
+            default:
+                // centers right at the 20% threshold of their neighbors
+                frame[i] = (rng() % 4 == 0) ? (unsigned short)(599 + rng() % 3) : (unsigned short)(500 - rng() % 2);
+                break;
+        }
+    }
+}
+
+static int check(const kernelCase *k, int width, int height, int numThreads, int style,
+                 unsigned short *ref, unsigned short *img)
+{
+    size_t pixels = (size_t)width * height;
+    size_t i;
+
+    fill_frame(ref, pixels, style);
+    memcpy(img, ref, pixels * sizeof(unsigned short));
+
+    k->legacy((UInt16)height, (UInt16)width, ref);
+    if (k->kernel(img, width, height, numThreads) != 0)
+    {
+        fprintf(stderr, "%s %dx%d, %d threads: out of memory\n", k->name, width, height, numThreads);
+        return 1;
+    }
+
+    for (i = 0; i < pixels; i++)
+    {
+        if (ref[i] != img[i])
+        {
+            fprintf(stderr, "%s %dx%d, %d threads, frame %d: mismatch at x=%d y=%d, %u != %u\n", k->name, width,
+                    height, numThreads, style, (int)(i % width), (int)(i / width), ref[i], img[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    static const int sizes[][2] = { { 1, 1 },   { 2, 7 },    { 3, 3 },    { 5, 5 },     { 6, 4 },    { 9, 17 },
+                                    { 16, 16 }, { 17, 33 },  { 31, 5 },   { 64, 3 },    { 100, 61 }, { 257, 129 },
+                                    { 640, 9 }, { 1283, 37 } };
+    static const int threads[] = { 1, 2, 3, 4, 8 };
+    int width      = (argc > 1) ? atoi(argv[1]) : 1280;
+    int height     = (argc > 2) ? atoi(argv[2]) : 1024;
+    int iterations = (argc > 3) ? atoi(argv[3]) : 20;
+    int numThreads = fcKernel_numThreads(width, height);
+    size_t pixels, k, s, t;
+    unsigned short *ref, *img, *raw;
+    int style, it, failed = 0;
+
+    if (width <= 0 || height <= 0 || width > 65535 || height > 65535 || iterations <= 0)
+    {
+        fprintf(stderr, "usage: %s [width] [height] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    pixels = (size_t)width * height;
+    if (pixels < 1283 * 37)
+        pixels = 1283 * 37;
+
+    ref = malloc(pixels * sizeof(unsigned short));
+    img = malloc(pixels * sizeof(unsigned short));
+    raw = malloc(pixels * sizeof(unsigned short));
+    if (ref == NULL || img == NULL || raw == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    for (k = 0; k < NUM_KERNELS; k++)
+        for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+            for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+                for (style = 0; style < 4; style++)
+                    failed |= check(&kernels[k], sizes[s][0], sizes[s][1], threads[t], style, ref, img);
+
+    for (k = 0; k < NUM_KERNELS; k++)
+        for (style = 0; style < 4; style++)
+            failed |= check(&kernels[k], width, height, numThreads, style, ref, img);
+
+    if (failed)
+        return 1;
+
+    printf("%dx%d, %d threads\n", width, height, numThreads);
+
+    fill_frame(raw, pixels, 1);
+
+    for (k = 0; k < NUM_KERNELS; k++)
+    {
+        double t0, tlegacy, tsingle, tthreads;
+
+        t0 = now_ms();
+        for (it = 0; it < iterations; it++)
+        {
+            memcpy(ref, raw, (size_t)width * height * sizeof(unsigned short));
+            kernels[k].legacy((UInt16)height, (UInt16)width, ref);
+        }
+        tlegacy = (now_ms() - t0) / iterations;
+
+        t0 = now_ms();
+        for (it = 0; it < iterations; it++)
+        {
+            memcpy(img, raw, (size_t)width * height * sizeof(unsigned short));
+            kernels[k].kernel(img, width, height, 1);
+        }
+        tsingle = (now_ms() - t0) / iterations;
+
+        t0 = now_ms();
+        for (it = 0; it < iterations; it++)
+        {
+            memcpy(img, raw, (size_t)width * height * sizeof(unsigned short));
+            kernels[k].kernel(img, width, height, numThreads);
+        }
+        tthreads = (now_ms() - t0) / iterations;
+
+        printf("%-9s legacy %8.2f ms   tiled %8.2f ms x%.2f   %d threads %8.2f ms x%.2f\n", kernels[k].name,
+               tlegacy, tsingle, tlegacy / tsingle, numThreads, tthreads, tlegacy / tthreads);
+    }
+
+    free(ref);
+    free(img);
+    free(raw);
+
+    return 0;
+}
@@ -0,0 +1,405 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  ======================================================================
+*/
+
+#include "fishcamp_kernels.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define FC_KERNEL_MAX_RADIUS  2
+#define FC_KERNEL_MAX_THREADS 8
+
+// below this many pixels thread start up costs more than it saves
+#define FC_KERNEL_MIN_PIXELS_PER_THREAD (256 * 1024)
+
+typedef struct
+{
+    unsigned short *frame;
+    int width;
+    int radius;
+    bool hotPixel;
+
+    int rowStart; // first row written by this band
+    int rowEnd;   // one past the last row written by this band
+
+    unsigned short *ring;  // original rows, row r lives in slot r % (radius + 1)
+    unsigned short *below; // original rows rowEnd .. rowEnd + radius - 1, written by the next band
+    uint32_t *colSum;      // per column sum over the kernel rows
+    unsigned short *colMax; // per column max over the kernel rows
+} fcKernelBand;
+
+#if defined(__SSE2__)
+// exact x / d for x < 2^21 using the multiplier magic = ceil(2^shift / d)
+static inline __m128i fcKernel_div_epu32(__m128i x, __m128i magic, __m128i shift)
+{
+    __m128i even = _mm_srl_epi64(_mm_mul_epu32(x, magic), shift);
+    __m128i odd  = _mm_srl_epi64(_mm_mul_epu32(_mm_srli_epi64(x, 32), magic), shift);
+
+    return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+// pack two vectors of 32-bit values <= 65535 into 16-bit lanes
+static inline __m128i fcKernel_pack_epu32(__m128i lo, __m128i hi)
+{
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+
+    return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32)), bias16);
+}
+
+static inline __m128i fcKernel_max_epu16(__m128i a, __m128i b)
+{
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+
+    return _mm_xor_si128(_mm_max_epi16(_mm_xor_si128(a, bias16), _mm_xor_si128(b, bias16)), bias16);
+}
+#endif
+
+// box average of the 2 * radius + 1 rows into out, columns radius .. width - radius - 1, radius is 1 or 2
+static void fcKernel_boxRow(const unsigned short **rows, int radius, unsigned short *out, int width, uint32_t *colSum)
+{
+    int col = 0;
+
+#if defined(__SSE2__)
+    const int numRows  = 2 * radius + 1;
+    const __m128i zero = _mm_setzero_si128();
+    int j;
+
+    for (; col + 8 <= width; col += 8)
+    {
+        __m128i lo = _mm_setzero_si128();
+        __m128i hi = _mm_setzero_si128();
+
+        for (j = 0; j < numRows; j++)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(rows[j] + col));
+
+            lo = _mm_add_epi32(lo, _mm_unpacklo_epi16(v, zero));
+            hi = _mm_add_epi32(hi, _mm_unpackhi_epi16(v, zero));
+        }
+
+        _mm_storeu_si128((__m128i *)(colSum + col), lo);
+        _mm_storeu_si128((__m128i *)(colSum + col + 4), hi);
+    }
+#endif
+
+    // the kernel sizes are spelled out so the divisions are by constants
+    if (radius == 1)
+    {
+        for (; col < width; col++)
+            colSum[col] = (uint32_t)rows[0][col] + rows[1][col] + rows[2][col];
+    }
+    else
+    {
+        for (; col < width; col++)
+            colSum[col] = (uint32_t)rows[0][col] + rows[1][col] + rows[2][col] + rows[3][col] + rows[4][col];
+    }
+
+    col = radius;
+
+#if defined(__SSE2__)
+    {
+        // magic multipliers checked exhaustively over every possible sum
+        const __m128i magic = _mm_set1_epi32(radius == 1 ? 0x38E38E39 : (int)0xA3D70A3E);
+        const __m128i shift = _mm_cvtsi32_si128(radius == 1 ? 33 : 36);
+
+        for (; col + 8 <= width - radius; col += 8)
+        {
+            __m128i lo = _mm_setzero_si128();
+            __m128i hi = _mm_setzero_si128();
+
+            for (j = -radius; j <= radius; j++)
+            {
+                lo = _mm_add_epi32(lo, _mm_loadu_si128((const __m128i *)(colSum + col + j)));
+                hi = _mm_add_epi32(hi, _mm_loadu_si128((const __m128i *)(colSum + col + j + 4)));
+            }
+
+            lo = fcKernel_div_epu32(lo, magic, shift);
+            hi = fcKernel_div_epu32(hi, magic, shift);
+
+            _mm_storeu_si128((__m128i *)(out + col), fcKernel_pack_epu32(lo, hi));
+        }
+    }
+#endif
+
+    if (radius == 1)
+    {
+        for (; col < width - 1; col++)
+            out[col] = (unsigned short)((colSum[col - 1] + colSum[col] + colSum[col + 1]) / 9);
+    }
+    else
+    {
+        for (; col < width - 2; col++)
+            out[col] = (unsigned short)((colSum[col - 2] + colSum[col - 1] + colSum[col] + colSum[col + 1] +
+                                         colSum[col + 2]) / 25);
+    }
+}
+
+// hot pixel removal of the middle of the 3 rows into out, columns 1 .. width - 2
+//
+// The original test is (float)center > (float)(brightest * 1.2).  Over 16-bit
+// pixels that is exactly 5 * center > 6 * brightest, which keeps it in integers.
+static void fcKernel_hotPixelRow(const unsigned short **rows, unsigned short *out, int width,
+                                 uint32_t *colSum, unsigned short *colMax)
+{
+    const unsigned short *top = rows[0];
+    const unsigned short *mid = rows[1];
+    const unsigned short *bot = rows[2];
+    int col = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; col + 8 <= width; col += 8)
+    {
+        __m128i t = _mm_loadu_si128((const __m128i *)(top + col));
+        __m128i m = _mm_loadu_si128((const __m128i *)(mid + col));
+        __m128i b = _mm_loadu_si128((const __m128i *)(bot + col));
+
+        __m128i lo = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(t, zero), _mm_unpacklo_epi16(m, zero)),
+                                   _mm_unpacklo_epi16(b, zero));
+        __m128i hi = _mm_add_epi32(_mm_add_epi32(_mm_unpackhi_epi16(t, zero), _mm_unpackhi_epi16(m, zero)),
+                                   _mm_unpackhi_epi16(b, zero));
+
+        _mm_storeu_si128((__m128i *)(colSum + col), lo);
+        _mm_storeu_si128((__m128i *)(colSum + col + 4), hi);
+        _mm_storeu_si128((__m128i *)(colMax + col), fcKernel_max_epu16(fcKernel_max_epu16(t, m), b));
+    }
+#endif
+
+    for (; col < width; col++)
+    {
+        unsigned short vmax = top[col] > mid[col] ? top[col] : mid[col];
+
+        colSum[col] = (uint32_t)top[col] + mid[col] + bot[col];
+        colMax[col] = vmax > bot[col] ? vmax : bot[col];
+    }
+
+    col = 1;
+
+#if defined(__SSE2__)
+    for (; col + 8 <= width - 1; col += 8)
+    {
+        __m128i center = _mm_loadu_si128((const __m128i *)(mid + col));
+        __m128i bright = fcKernel_max_epu16(_mm_loadu_si128((const __m128i *)(colMax + col - 1)),
+                                            _mm_loadu_si128((const __m128i *)(colMax + col + 1)));
+        bright = fcKernel_max_epu16(bright, _mm_loadu_si128((const __m128i *)(top + col)));
+        bright = fcKernel_max_epu16(bright, _mm_loadu_si128((const __m128i *)(bot + col)));
+
+        __m128i cLo = _mm_unpacklo_epi16(center, zero);
+        __m128i cHi = _mm_unpackhi_epi16(center, zero);
+        __m128i bLo = _mm_unpacklo_epi16(bright, zero);
+        __m128i bHi = _mm_unpackhi_epi16(bright, zero);
+
+        // sum of the 8 neighbors / 8
+        __m128i sLo = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(colSum + col - 1)),
+                                    _mm_loadu_si128((const __m128i *)(colSum + col)));
+        __m128i sHi = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(colSum + col + 3)),
+                                    _mm_loadu_si128((const __m128i *)(colSum + col + 4)));
+        sLo = _mm_add_epi32(sLo, _mm_loadu_si128((const __m128i *)(colSum + col + 1)));
+        sHi = _mm_add_epi32(sHi, _mm_loadu_si128((const __m128i *)(colSum + col + 5)));
+        sLo = _mm_srli_epi32(_mm_sub_epi32(sLo, cLo), 3);
+        sHi = _mm_srli_epi32(_mm_sub_epi32(sHi, cHi), 3);
+
+        // 5 * center > 6 * brightest
+        __m128i hotLo = _mm_cmpgt_epi32(_mm_add_epi32(_mm_slli_epi32(cLo, 2), cLo),
+                                        _mm_add_epi32(_mm_slli_epi32(bLo, 2), _mm_slli_epi32(bLo, 1)));
+        __m128i hotHi = _mm_cmpgt_epi32(_mm_add_epi32(_mm_slli_epi32(cHi, 2), cHi),
+                                        _mm_add_epi32(_mm_slli_epi32(bHi, 2), _mm_slli_epi32(bHi, 1)));
+
+        __m128i avg = fcKernel_pack_epu32(sLo, sHi);
+        __m128i hot = _mm_packs_epi32(hotLo, hotHi);
+
+        _mm_storeu_si128((__m128i *)(out + col), _mm_or_si128(_mm_and_si128(hot, avg), _mm_andnot_si128(hot, center)));
+    }
+#endif
+
+    for (; col < width - 1; col++)
+    {
+        uint32_t center = mid[col];
+        uint32_t bright = colMax[col - 1] > colMax[col + 1] ? colMax[col - 1] : colMax[col + 1];
+        uint32_t avg    = (colSum[col - 1] + colSum[col] + colSum[col + 1] - center) / 8;
+
+        bright = top[col] > bright ? top[col] : bright;
+        bright = bot[col] > bright ? bot[col] : bright;
+
+        out[col] = (unsigned short)(5 * center > 6 * bright ? avg : center);
+    }
+}
+
+static void *fcKernel_runBand(void *arg)
+{
+    fcKernelBand *band = (fcKernelBand *)arg;
+    const unsigned short *rows[2 * FC_KERNEL_MAX_RADIUS + 1];
+    const int radius = band->radius;
+    const int width  = band->width;
+    int row, j;
+
+    for (row = band->rowStart; row < band->rowEnd; row++)
+    {
+        unsigned short *out = band->frame + (size_t)row * width;
+
+        // keep the original row, the next radius rows still need it
+        memcpy(band->ring + (size_t)(row % (radius + 1)) * width, out, width * sizeof(unsigned short));
+
+        for (j = 0; j <= 2 * radius; j++)
+        {
+            int src = row - radius + j;
+
+            if (src <= row)
+                rows[j] = band->ring + (size_t)(src % (radius + 1)) * width;
+            else if (src < band->rowEnd)
+                rows[j] = band->frame + (size_t)src * width;
+            else
+                rows[j] = band->below + (size_t)(src - band->rowEnd) * width;
+        }
+
+        if (band->hotPixel)
+            fcKernel_hotPixelRow(rows, out, width, band->colSum, band->colMax);
+        else
+            fcKernel_boxRow(rows, radius, out, width, band->colSum);
+    }
+
+    return NULL;
+}
+
+static int fcKernel_run(unsigned short *frameBuffer, int imageWidth, int imageHeight, int radius, bool hotPixel,
+                        int numThreads)
+{
+    const int rowsToFilter = imageHeight - 2 * radius;
+    fcKernelBand bands[FC_KERNEL_MAX_THREADS];
+    pthread_t threads[FC_KERNEL_MAX_THREADS];
+    bool started[FC_KERNEL_MAX_THREADS];
+    size_t rowPixels, bandBytes;
+    unsigned char *scratch;
+    int i, row;
+
+    if (frameBuffer == NULL || rowsToFilter <= 0 || imageWidth < 2 * radius + 1)
+        return 0;
+
+    if (numThreads < 1)
+        numThreads = 1;
+    if (numThreads > FC_KERNEL_MAX_THREADS)
+        numThreads = FC_KERNEL_MAX_THREADS;
+    if (numThreads > rowsToFilter)
+        numThreads = rowsToFilter;
+
+    // per band: radius + 1 ring rows, radius rows below, the column sums and maxima
+    rowPixels = (imageWidth + 7) & ~7;
+    bandBytes = (2 * radius + 1) * rowPixels * sizeof(unsigned short) + rowPixels * sizeof(uint32_t) +
+                rowPixels * sizeof(unsigned short);
+
+    scratch = (unsigned char *)malloc(numThreads * bandBytes);
+    if (scratch == NULL)
+        return -1;
+
+    for (i = 0; i < numThreads; i++)
+    {
+        fcKernelBand *band = &bands[i];
+        unsigned char *p   = scratch + i * bandBytes;
+
+        band->frame    = frameBuffer;
+        band->width    = imageWidth;
+        band->radius   = radius;
+        band->hotPixel = hotPixel;
+        band->rowStart = radius + (int)((long long)rowsToFilter * i / numThreads);
+        band->rowEnd   = radius + (int)((long long)rowsToFilter * (i + 1) / numThreads);
+
+        band->colSum = (uint32_t *)p;
+        p += rowPixels * sizeof(uint32_t);
+        band->ring = (unsigned short *)p;
+        p += (radius + 1) * rowPixels * sizeof(unsigned short);
+        band->below = (unsigned short *)p;
+        p += radius * rowPixels * sizeof(unsigned short);
+        band->colMax = (unsigned short *)p;
+
+        // neighbouring bands overwrite these rows, take them while they are still original
+        for (row = band->rowStart - radius; row < band->rowStart; row++)
+            memcpy(band->ring + (size_t)(row % (radius + 1)) * imageWidth, frameBuffer + (size_t)row * imageWidth,
+                   imageWidth * sizeof(unsigned short));
+
+        memcpy(band->below, frameBuffer + (size_t)band->rowEnd * imageWidth,
+               (size_t)radius * imageWidth * sizeof(unsigned short));
+    }
+
+    for (i = 1; i < numThreads; i++)
+        started[i] = pthread_create(&threads[i], NULL, fcKernel_runBand, &bands[i]) == 0;
+
+    fcKernel_runBand(&bands[0]);
+
+    for (i = 1; i < numThreads; i++)
+    {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            fcKernel_runBand(&bands[i]);
+    }
+
+    free(scratch);
+    return 0;
+}
+
+int fcKernel_3x3(unsigned short *frameBuffer, int imageWidth, int imageHeight, int numThreads)
+{
+    return fcKernel_run(frameBuffer, imageWidth, imageHeight, 1, false, numThreads);
+}
+
+int fcKernel_5x5(unsigned short *frameBuffer, int imageWidth, int imageHeight, int numThreads)
+{
+    return fcKernel_run(frameBuffer, imageWidth, imageHeight, 2, false, numThreads);
+}
+
+int fcKernel_hotPixel(unsigned short *frameBuffer, int imageWidth, int imageHeight, int numThreads)
+{
+    return fcKernel_run(frameBuffer, imageWidth, imageHeight, 1, true, numThreads);
+}
+
+int fcKernel_numThreads(int imageWidth, int imageHeight)
+{
+    long numCpus  = sysconf(_SC_NPROCESSORS_ONLN);
+    long byPixels = ((long)imageWidth * imageHeight) / FC_KERNEL_MIN_PIXELS_PER_THREAD;
+    long threads  = numCpus < byPixels ? numCpus : byPixels;
+
+    if (threads > FC_KERNEL_MAX_THREADS)
+        threads = FC_KERNEL_MAX_THREADS;
+
+    return threads < 1 ? 1 : (int)threads;
+}
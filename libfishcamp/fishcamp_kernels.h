@@ -0,0 +1,61 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  ======================================================================
+*/
+
+#ifndef FISHCAMP_KERNELS_H
+#define FISHCAMP_KERNELS_H
+
+// In place image filters used by fcUsb_cmd_getRawFrame.
+//
+// The frame is processed in bands of rows, one per thread.  Each band keeps
+// a rolling window of the original rows it still needs, so only a few rows
+// of scratch are allocated instead of a copy of the frame.  The results are
+// identical to the original full copy implementations, border rows and
+// columns the kernel does not cover are left untouched.
+//
+// All of them return 0, or -1 if the scratch rows could not be allocated,
+// in which case the frame is left unfiltered.
+
+// 3x3 box average
+int fcKernel_3x3(unsigned short *frameBuffer, int imageWidth, int imageHeight, int numThreads);
+
+// 5x5 box average
+int fcKernel_5x5(unsigned short *frameBuffer, int imageWidth, int imageHeight, int numThreads);
+
+// replaces pixels more than 20% brighter than their brightest neighbor
+// with the average of the 8 neighbors
+int fcKernel_hotPixel(unsigned short *frameBuffer, int imageWidth, int imageHeight, int numThreads);
+
+// number of threads worth using for a frame of this size
+int fcKernel_numThreads(int imageWidth, int imageHeight);
+
+#endif // FISHCAMP_KERNELS_H
@@ -0,0 +1,260 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+        Neither the name of the copyright holder nor the names of
+        its contributors may be used to endorse or promote products
+        derived from this software without specific prior written
+        permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+
+*/
+
+/* Stress test and benchmark for the libfli-mem pointer tracking.
+ *
+ * Usage: fli_mem_bench [blocks] [rounds]
+ *
+ * Allocates blocks through every x*alloc() flavour, frees and reallocates
+ * them in random order, checks that xfree_all() releases exactly what is
+ * left and compares the time per round with the linear pointer table
+ * libfli-mem used before. Returns non-zero when a check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libfli-mem.h"
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* xorshift, so runs are repeatable */
+static unsigned long rnd_state = 88172645463325252UL;
+
+static unsigned long rnd(void)
+{
+	rnd_state ^= rnd_state << 13;
+	rnd_state ^= rnd_state >> 7;
+	rnd_state ^= rnd_state << 17;
+	return rnd_state;
+}
+
+static void shuffle(size_t *order, size_t n)
+{
+	size_t i;
+
+	for (i = n - 1; i > 0; i--)
+	{
+		size_t j = rnd() % (i + 1), t = order[i];
+
+		order[i] = order[j];
+		order[j] = t;
+	}
+}
+
+/* The linear table saveptr()/findptr() scanned before, for comparison */
+static struct {
+	void **pointers;
+	size_t total;
+} legacy;
+
+static void *legacy_malloc(size_t size)
+{
+	void *ptr = malloc(size);
+	size_t i;
+
+	for (i = 0; i < legacy.total; i++)
+		if (legacy.pointers[i] == NULL)
+			break;
+
+	if (i == legacy.total)
+	{
+		size_t newtotal = legacy.total ? 2 * legacy.total : 1024;
+
+		legacy.pointers = realloc(legacy.pointers, newtotal * sizeof(void *));
+		memset(legacy.pointers + legacy.total, 0, (newtotal - legacy.total) * sizeof(void *));
+		legacy.total = newtotal;
+	}
+
+	legacy.pointers[i] = ptr;
+	return ptr;
+}
+
+static void legacy_free(void *ptr)
+{
+	size_t i;
+
+	for (i = 0; i < legacy.total; i++)
+	{
+		if (legacy.pointers[i] == ptr)
+		{
+			legacy.pointers[i] = NULL;
+			free(ptr);
+			return;
+		}
+	}
+}
+
+static int fail(const char *what)
+{
+	fprintf(stderr, "FAILED: %s\n", what);
+	return 1;
+}
+
+/* One round: allocate all blocks, reallocate a quarter and free half of
+   them in random order, then leave the rest to xfree_all() */
+static int stress(void **blocks, size_t *order, size_t n)
+{
+	size_t i, j;
+	char name[32];
+	int freed;
+
+	for (i = 0; i < n; i++)
+	{
+		size_t size = 16 + rnd() % 256;
+
+		switch (i % 4)
+		{
+			case 0:
+				blocks[i] = xmalloc(size);
+				break;
+			case 1:
+				blocks[i] = xcalloc(1, size);
+				break;
+			case 2:
+				snprintf(name, sizeof(name), "block %zu", i);
+				blocks[i] = xstrdup(name);
+				break;
+			default:
+				blocks[i] = NULL;
+				if (xasprintf((char **) &blocks[i], "block %zu", i) < 0)
+					blocks[i] = NULL;
+				break;
+		}
+
+		if (blocks[i] == NULL)
+			return fail("allocation");
+	}
+
+	shuffle(order, n);
+	for (i = 0; i < n / 4; i++)
+	{
+		j = order[i];
+		if ((blocks[j] = xrealloc(blocks[j], 512 + rnd() % 4096)) == NULL)
+			return fail("xrealloc of a tracked block");
+	}
+
+	shuffle(order, n);
+	for (i = 0; i < n / 2; i++)
+	{
+		xfree(blocks[order[i]]);
+		blocks[order[i]] = NULL;
+	}
+
+	/* Everything still allocated must be found again */
+	for (i = 0; i < n; i++)
+	{
+		if (blocks[i] == NULL)
+			continue;
+		if ((blocks[i] = xrealloc(blocks[i], 64)) == NULL)
+			return fail("lookup of a surviving block");
+	}
+
+	if ((freed = xfree_all()) != (int) (n - n / 2))
+	{
+		fprintf(stderr, "xfree_all() released %d blocks, expected %zu\n", freed, n - n / 2);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t n = (argc > 1) ? strtoul(argv[1], NULL, 0) : 50000;
+	int rounds = (argc > 2) ? atoi(argv[2]) : 5;
+	size_t *order, i;
+	void **blocks;
+	double t, tnew, tlegacy;
+	int r;
+
+	if ((n < 4) || (rounds <= 0))
+	{
+		fprintf(stderr, "usage: %s [blocks] [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	blocks = calloc(n, sizeof(void *));
+	order = malloc(n * sizeof(size_t));
+	if ((blocks == NULL) || (order == NULL))
+		return fail("out of memory");
+
+	for (i = 0; i < n; i++)
+		order[i] = i;
+
+	t = now_ms();
+	for (r = 0; r < rounds; r++)
+		if (stress(blocks, order, n))
+			return 1;
+	tnew = (now_ms() - t) / rounds;
+
+	if (xfree_all() != 0)
+		return fail("table not empty after xfree_all()");
+
+	/* Allocate and random free on the linear table, a subset of the work
+	   of a stress() round */
+	t = now_ms();
+	for (r = 0; r < rounds; r++)
+	{
+		for (i = 0; i < n; i++)
+			blocks[i] = legacy_malloc(16 + rnd() % 256);
+
+		shuffle(order, n);
+		for (i = 0; i < n; i++)
+			legacy_free(blocks[order[i]]);
+	}
+	tlegacy = (now_ms() - t) / rounds;
+	free(legacy.pointers);
+
+	printf("%zu blocks, %d rounds\n", n, rounds);
+	printf("%-8s %10.2f ms/round\n", "Linear", tlegacy);
+	printf("%-8s %10.2f ms/round  x%.1f\n", "Hashed", tnew, tlegacy / tnew);
+
+	free(blocks);
+	free(order);
+
+	return 0;
+}
@@ -0,0 +1,165 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+        Neither the name of the copyright holder nor the names of
+        its contributors may be used to endorse or promote products
+        derived from this software without specific prior written
+        permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+
+*/
+
+/* Microbenchmark for the grab path byte swap.
+ *
+ * Usage: fli_swab_bench [width] [height] [iterations]
+ * Defaults to a 4096x4096 frame, the size of the largest ProLine sensors.
+ *
+ * "Legacy" is the per-pixel ntohs() loop plus the per-row copy that
+ * FLIGrabRow() used to do, "fli_be16toh" converts straight into the
+ * destination image the way FLIGrabFrame() does.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <winsock.h>
+#else
+#include <netinet/in.h>
+#endif
+
+#include "libfli-swab.h"
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void legacy(unsigned short *img, unsigned short *gbuf, const unsigned short *raw,
+									 size_t width, size_t height, size_t batch)
+{
+	size_t row, x;
+
+	for (row = 0; row < height; row += batch)
+	{
+		size_t n = (height - row < batch) ? height - row : batch;
+
+		memcpy(gbuf, raw + row * width, n * width * 2);
+		for (x = 0; x < n * width; x++)
+			gbuf[x] = ntohs(gbuf[x]) + 32768;
+
+		for (x = 0; x < n; x++)
+			memcpy(img + (row + x) * width, gbuf + x * width, width * 2);
+	}
+}
+
+static void grabframe(unsigned short *img, unsigned short *gbuf, const unsigned short *raw,
+											size_t width, size_t height, size_t batch)
+{
+	size_t row;
+
+	for (row = 0; row < height; row += batch)
+	{
+		size_t n = (height - row < batch) ? height - row : batch;
+
+		memcpy(gbuf, raw + row * width, n * width * 2);
+		fli_be16toh(img + row * width, gbuf, n * width, 32768);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	size_t width = (argc > 1) ? strtoul(argv[1], NULL, 0) : 4096;
+	size_t height = (argc > 2) ? strtoul(argv[2], NULL, 0) : 4096;
+	int iterations = (argc > 3) ? atoi(argv[3]) : 20;
+	size_t pixels = width * height, batch, i;
+	unsigned short *raw, *gbuf, *ref, *img;
+	double t, mb, tlegacy, tframe;
+	int it;
+
+	if ((width == 0) || (height == 0) || (iterations <= 0))
+	{
+		fprintf(stderr, "usage: %s [width] [height] [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	/* Same batching as the MaxCam grab path: 64 rows or 64 KiB */
+	batch = 65536 / (width * 2);
+	if (batch < 1) batch = 1;
+	if (batch > 64) batch = 64;
+
+	raw = malloc(pixels * 2);
+	gbuf = malloc(batch * width * 2);
+	ref = malloc(pixels * 2);
+	img = malloc(pixels * 2);
+	if ((raw == NULL) || (gbuf == NULL) || (ref == NULL) || (img == NULL))
+	{
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	for (i = 0; i < pixels; i++)
+		raw[i] = (unsigned short) (i * 2654435761u >> 7);
+
+	legacy(ref, gbuf, raw, width, height, batch);
+	grabframe(img, gbuf, raw, width, height, batch);
+	if (memcmp(ref, img, pixels * 2) != 0)
+	{
+		fprintf(stderr, "Mismatch between legacy and fli_be16toh output\n");
+		return 1;
+	}
+
+	mb = pixels * 2 / 1e6;
+
+	t = now_ms();
+	for (it = 0; it < iterations; it++)
+		legacy(ref, gbuf, raw, width, height, batch);
+	tlegacy = (now_ms() - t) / iterations;
+
+	t = now_ms();
+	for (it = 0; it < iterations; it++)
+		grabframe(img, gbuf, raw, width, height, batch);
+	tframe = (now_ms() - t) / iterations;
+
+	printf("%zux%zu, %zu rows per transfer\n", width, height, batch);
+	printf("%-12s %8.2f ms %8.1f MB/s\n", "Legacy", tlegacy, mb / tlegacy * 1000);
+	printf("%-12s %8.2f ms %8.1f MB/s  x%.2f\n", "fli_be16toh", tframe, mb / tframe * 1000, tlegacy / tframe);
+
+	free(raw);
+	free(gbuf);
+	free(ref);
+	free(img);
+
+	return 0;
+}
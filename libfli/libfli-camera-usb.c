@@ -61,8 +61,12 @@
 #include "libfli-camera.h"
 #include "libfli-camera-usb.h"
 #include "libfli-usb.h"
+#include "libfli-swab.h"
 #include "indimacros.h"
 
+/* Early MaxCam hardware revisions deliver pixels offset by half the range */
+#define MAXCAM_PIXEL_OFFSET(d) ((((d)->devinfo.hwrev & 0xff00) == 0x0100) ? 32768 : 0)
+
 double dconvert(void *buf)
 {
   unsigned char *fnum = (unsigned char *) buf;
@@ -1085,17 +1089,8 @@ long fli_camera_usb_grab_row(flidev_t dev, void *buff, size_t width)
 				cam->gbuf[2] = htons((unsigned short) cam->grabrowbatchsize);
 				IO(dev, cam->gbuf, &wlen, &rlen);
 
-				for (x = 0; x < (cam->grabrowwidth * cam->grabrowbatchsize); x++)
-				{
-					if ((DEVICE->devinfo.hwrev & 0xff00) == 0x0100)
-					{
-						cam->gbuf[x] = ntohs(cam->gbuf[x]) + 32768;
-					}
-					else
-					{
-						cam->gbuf[x] = ntohs(cam->gbuf[x]);
-					}
-				}
+				fli_be16toh(cam->gbuf, cam->gbuf, cam->grabrowwidth * cam->grabrowbatchsize,
+					MAXCAM_PIXEL_OFFSET(DEVICE));
 				cam->grabrowbufferindex = 0;
 			}
 
@@ -1289,7 +1284,6 @@ long fli_camera_usb_grab_row(flidev_t dev, void *buff, size_t width)
 		case FLIUSB_PROLINE_ID:
 		{
 			long rlen = 0, rtotal = 0;
-			int index = 0;
 
 			/*
 			 * cam->gbuf_siz -- size of the grab buffer (bytes)
@@ -1527,11 +1521,8 @@ long fli_camera_usb_grab_row(flidev_t dev, void *buff, size_t width)
 					cam->bytesleft -= rlen;
 				}
 
-				for (index = 0; index < (rlen / (long) sizeof(unsigned short)); index ++)
-				{
-					*cam->ibuf_wr_idx = ((cam->gbuf[index] << 8) & 0xff00) | ((cam->gbuf[index] >> 8) & 0x00ff);
-					cam->ibuf_wr_idx++;
-				}
+				fli_swab16(cam->ibuf_wr_idx, cam->gbuf, rlen / sizeof(unsigned short), 0);
+				cam->ibuf_wr_idx += rlen / sizeof(unsigned short);
 			}
 
 			memset(left, 0x00, width * sizeof(unsigned short));
@@ -1730,6 +1721,124 @@ long fli_camera_usb_grab_row(flidev_t dev, void *buff, size_t width)
 	return 0;
 }
 
+long fli_camera_usb_grab_frame(flidev_t dev, void *buff, size_t buffsize, size_t *bytesgrabbed)
+{
+  flicamdata_t *cam = DEVICE->device_data;
+	unsigned short *img = (unsigned short *) buff;
+	size_t width, rowbytes, rows, row = 0;
+	long r;
+
+	*bytesgrabbed = 0;
+
+	switch (DEVICE->devinfo.devid)
+  {
+		/* MaxCam and IMG cameras */
+		case FLIUSB_CAM_ID:
+		{
+			long batch;
+
+			width = cam->grabrowwidth;
+			rowbytes = width * sizeof(unsigned short);
+			if ((width == 0) || (buffsize < rowbytes) || (cam->grabrowcount <= 0))
+				return -EINVAL;
+
+			rows = MIN(buffsize / rowbytes, (size_t) cam->grabrowcount);
+
+			/* Rows left over from an earlier FLIGrabRow() batch come first */
+			while ((row < rows) && (cam->grabrowbufferindex < cam->grabrowbatchsize))
+			{
+				if ((r = fli_camera_usb_grab_row(dev, img + row * width, width)))
+					return r;
+
+				row++;
+				*bytesgrabbed += rowbytes;
+			}
+
+			if (row == rows)
+				break;
+
+			if (cam->flushcountbeforefirstrow > 0)
+			{
+				debug(FLIDEBUG_INFO, "Flushing %d rows before image download.", cam->flushcountbeforefirstrow);
+				if ((r = fli_camera_usb_flush_rows(dev, cam->flushcountbeforefirstrow, 1)))
+					return r;
+
+				cam->flushcountbeforefirstrow = 0;
+			}
+
+			batch = (cam->grabrowbatchsize > 0) ? cam->grabrowbatchsize : 1;
+
+			/* Whole batches are converted from the grab buffer straight into
+			 * the caller's image, no intermediate row copy */
+			while (row < rows)
+			{
+				long n = (long) MIN((size_t) batch, rows - row);
+				long rlen, wlen;
+
+				debug(FLIDEBUG_INFO, "Grabbing %d rows of width %d.", n, width);
+				rlen = (long) width * 2 * n;
+				wlen = 6;
+				cam->gbuf[0] = htons(FLI_USBCAM_SENDROW);
+				cam->gbuf[1] = htons((unsigned short) width);
+				cam->gbuf[2] = htons((unsigned short) n);
+				IO(dev, cam->gbuf, &wlen, &rlen);
+
+				fli_be16toh(img + row * width, cam->gbuf, width * n, MAXCAM_PIXEL_OFFSET(DEVICE));
+
+				row += n;
+				cam->grabrowindex += n;
+				cam->grabrowcount -= n;
+				*bytesgrabbed += rowbytes * n;
+			}
+
+			/* Nothing is left buffered for FLIGrabRow() */
+			cam->grabrowbufferindex = cam->grabrowbatchsize;
+
+			if (cam->grabrowcount == 0)
+			{
+				if (cam->flushcountafterlastrow > 0)
+				{
+					debug(FLIDEBUG_INFO, "Flushing %d rows after image download.", cam->flushcountafterlastrow);
+					if ((r = fli_camera_usb_flush_rows(dev, cam->flushcountafterlastrow, 1)))
+						return r;
+				}
+
+				cam->flushcountafterlastrow = 0;
+				cam->grabrowbatchsize = 1;
+				cam->grabrowbufferindex = 1;
+			}
+		}
+		break;
+
+		/* Proline Camera, rows are assembled from the image buffer by
+		 * fli_camera_usb_grab_row() which converts whole transfers at a time */
+		case FLIUSB_PROLINE_ID:
+		{
+			width = cam->image_area.lr.x - cam->image_area.ul.x;
+			rowbytes = width * sizeof(unsigned short);
+			if ((width == 0) || (buffsize < rowbytes) || (cam->grabrowindex >= cam->grabrowcount))
+				return -EINVAL;
+
+			rows = MIN(buffsize / rowbytes, (size_t) (cam->grabrowcount - cam->grabrowindex));
+
+			for (; row < rows; row++)
+			{
+				if ((r = fli_camera_usb_grab_row(dev, img + row * width, width)))
+					return r;
+
+				*bytesgrabbed += rowbytes;
+			}
+		}
+		break;
+
+		default:
+			debug(FLIDEBUG_WARN, "Hmmm, shouldn't be here, operation on NO camera...");
+			return -EINVAL;
+	}
+
+	return 0;
+}
+
 long fli_camera_usb_stop_video_mode(flidev_t dev)
 {
   flicamdata_t *cam = DEVICE->device_data;
@@ -50,85 +50,130 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 #include "libfli-libfli.h"
 #include "libfli-mem.h"
-#include "indimacros.h"
 
 #define DEFAULT_NUM_POINTERS (1024)
 
+/* Outstanding allocations are kept in an open addressing hash table
+   (linear probing, power of two size, at most half full) so that
+   tracking a pointer costs the same however many are allocated. */
 static struct _mem_ptrs {
   void **pointers;
-  int total;
-  int used;
+  size_t total;
+  size_t used;
 } allocated = {NULL, 0, 0};
 
-static void *saveptr(void *ptr)
+static size_t hashptr(const void *ptr)
 {
-  int i, err = 0;
+  uintptr_t h = (uintptr_t) ptr >> 4;
 
-  if (allocated.used + 1 > allocated.total)
-  {
-    void **tmp;
-    int newtotal;
+  h ^= h >> 16;
+  h *= 0x45d9f3b;
+  h ^= h >> 16;
 
-    if (allocated.total == 0)
-      newtotal = DEFAULT_NUM_POINTERS;
-    else
-      newtotal = 2 * allocated.total;
+  return (size_t) h;
+}
 
-    if ((tmp = realloc(allocated.pointers,
-		       newtotal * sizeof(void **))) == NULL)
-    {
-      err = 1;
-      goto done;
-    }
+static void insertptr(void **pointers, size_t total, void *ptr)
+{
+  size_t i = hashptr(ptr) & (total - 1);
 
-    allocated.pointers = tmp;
-    memset(allocated.pointers + allocated.total, 0,
-	   (newtotal - allocated.total) * sizeof(void **));
-    allocated.total = newtotal;
-  }
+  while (pointers[i] != NULL)
+    i = (i + 1) & (total - 1);
 
-  for (i = 0; i < allocated.total; i++)
-    if (allocated.pointers[i] == NULL)
-      break;
+  pointers[i] = ptr;
+}
 
-  if (i == allocated.total)
-  {
-    /* This shouldn't happen */
-    debug(FLIDEBUG_WARN, "Internal memory allocation error");
-    err = 1;
-    goto done;
-  }
+static int growptrs(void)
+{
+  void **tmp;
+  size_t i, newtotal;
 
-  allocated.pointers[i] = ptr;
-  allocated.used++;
+  if (allocated.total == 0)
+    newtotal = DEFAULT_NUM_POINTERS;
+  else
+    newtotal = 2 * allocated.total;
+
+  if ((tmp = calloc(newtotal, sizeof(void *))) == NULL)
+    return -1;
+
+  for (i = 0; i < allocated.total; i++)
+    if (allocated.pointers[i] != NULL)
+      insertptr(tmp, newtotal, allocated.pointers[i]);
+
+  free(allocated.pointers);
+  allocated.pointers = tmp;
+  allocated.total = newtotal;
 
- done:
+  return 0;
+}
 
-  if (err)
+static void *saveptr(void *ptr)
+{
+  if (2 * (allocated.used + 1) > allocated.total)
   {
-    free(ptr);
-    return NULL;
+    if (growptrs())
+    {
+      debug(FLIDEBUG_WARN, "Internal memory allocation error");
+      free(ptr);
+      return NULL;
+    }
   }
 
+  insertptr(allocated.pointers, allocated.total, ptr);
+  allocated.used++;
+
   return ptr;
 }
 
 static void **findptr(void *ptr)
 {
-  int i;
+  size_t i;
 
-  for (i = 0; i < allocated.total; i++)
-    if (allocated.pointers[i] == ptr)
-      return &allocated.pointers[i];
+  if ((ptr != NULL) && (allocated.total != 0))
+  {
+    for (i = hashptr(ptr) & (allocated.total - 1); allocated.pointers[i] != NULL;
+	 i = (i + 1) & (allocated.total - 1))
+      if (allocated.pointers[i] == ptr)
+	return &allocated.pointers[i];
+  }
 
   debug(FLIDEBUG_WARN, "Invalid pointer not found: %p", ptr);
 
   return NULL;
 }
 
+/* Empty a slot, moving later entries of the probe sequence back so that
+   lookups never need tombstones */
+static void clearptr(void **allocatedptr)
+{
+  size_t mask = allocated.total - 1;
+  size_t i = allocatedptr - allocated.pointers, j = i, home;
+
+  allocated.pointers[i] = NULL;
+  allocated.used--;
+
+  while (1)
+  {
+    j = (j + 1) & mask;
+    if (allocated.pointers[j] == NULL)
+      break;
+
+    /* Entry j may fill the hole at i unless its home slot lies
+       cyclically in (i, j] */
+    home = hashptr(allocated.pointers[j]) & mask;
+    if (((j - home) & mask) < ((j - i) & mask))
+      continue;
+
+    allocated.pointers[i] = allocated.pointers[j];
+    allocated.pointers[j] = NULL;
+    i = j;
+  }
+}
+
 static int deleteptr(void *ptr)
 {
   void **allocatedptr;
@@ -136,8 +181,7 @@ static int deleteptr(void *ptr)
   if ((allocatedptr = findptr(ptr)) == NULL)
     return -1;
 
-  *allocatedptr = NULL;
-  allocated.used--;
+  clearptr(allocatedptr);
 
   return 0;
 }
@@ -194,20 +238,30 @@ void *xrealloc(void *ptr, size_t size)
 {
   void **allocatedptr, *tmp;
 
+  if (ptr == NULL)
+    return xmalloc(size);
+
   if ((allocatedptr = findptr(ptr)) == NULL)
     return NULL;
 
   if ((tmp = realloc(ptr, size)) == NULL)
     return NULL;
 
-  *allocatedptr = tmp;
+  /* The new pointer hashes elsewhere, the table cannot need to grow
+     as one entry is removed for the one added */
+  if (tmp != ptr)
+  {
+    clearptr(allocatedptr);
+    insertptr(allocated.pointers, allocated.total, tmp);
+    allocated.used++;
+  }
 
   return tmp;
 }
 
 int xfree_all(void)
 {
-  int i;
+  size_t i;
   int freed = 0;
 
   for (i = 0; i < allocated.total; i++)
@@ -273,7 +327,6 @@ char *xstrndup(const char *s, size_t siz)
 
 int xasprintf(char **strp, const char *fmt, ...)
 {
-  INDI_UNUSED(strp);
   va_list ap;
   char *tmp;
   int err;
@@ -283,7 +336,7 @@ int xasprintf(char **strp, const char *fmt, ...)
   if ((err = vasprintf(&tmp, fmt, ap)) < 0)
     goto done;
 
-  if (saveptr(tmp) == NULL)
+  if ((*strp = saveptr(tmp)) == NULL)
     err = -1;
 
 	done:
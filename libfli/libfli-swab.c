@@ -0,0 +1,94 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+        Neither the name of the copyright holder nor the names of
+        its contributors may be used to endorse or promote products
+        derived from this software without specific prior written
+        permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+
+*/
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "libfli-swab.h"
+
+void fli_swab16(unsigned short *dst, const unsigned short *src,
+								size_t count, unsigned short offset)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	const __m128i voffset = _mm_set1_epi16((short) offset);
+
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i *) (src + i));
+		__m128i b = _mm_loadu_si128((const __m128i *) (src + i + 8));
+
+		a = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+		b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_add_epi16(a, voffset));
+		_mm_storeu_si128((__m128i *) (dst + i + 8), _mm_add_epi16(b, voffset));
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	const uint16x8_t voffset = vdupq_n_u16(offset);
+
+	for (; i + 16 <= count; i += 16)
+	{
+		uint16x8_t a = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(vld1q_u16(src + i))));
+		uint16x8_t b = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(vld1q_u16(src + i + 8))));
+
+		vst1q_u16(dst + i, vaddq_u16(a, voffset));
+		vst1q_u16(dst + i + 8, vaddq_u16(b, voffset));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = (unsigned short) ((((src[i] << 8) & 0xff00) | ((src[i] >> 8) & 0x00ff)) + offset);
+}
+
+void fli_be16toh(unsigned short *dst, const unsigned short *src,
+								 size_t count, unsigned short offset)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	size_t i;
+
+	for (i = 0; i < count; i++)
+		dst[i] = (unsigned short) (src[i] + offset);
+#else
+	fli_swab16(dst, src, count, offset);
+#endif
+}
@@ -0,0 +1,55 @@
+/*
+
+  Copyright (c) 2026 INDI Developers
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+        Neither the name of the copyright holder nor the names of
+        its contributors may be used to endorse or promote products
+        derived from this software without specific prior written
+        permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+
+*/
+
+#ifndef _LIBFLI_SWAB_H_
+#define _LIBFLI_SWAB_H_
+
+#include <stddef.h>
+
+/* Byte swap count 16-bit words from src into dst and add offset to each
+   of them (modulo 65536). dst may equal src. */
+void fli_swab16(unsigned short *dst, const unsigned short *src,
+								size_t count, unsigned short offset);
+
+/* Convert count big endian 16-bit words from src to host order into dst
+   and add offset to each of them, the vectorized equivalent of
+   dst[i] = ntohs(src[i]) + offset. dst may equal src. */
+void fli_be16toh(unsigned short *dst, const unsigned short *src,
+								 size_t count, unsigned short offset);
+
+#endif /* _LIBFLI_SWAB_H_ */
@@ -225,14 +225,43 @@ LIBFLIAPI FLIUsbBulkIO(flidev_t dev, int ep, void *buf, long *len)
 	return usb_bulktransfer(dev, ep, buf, len);
 }
 
+/**
+   Grab the remaining rows of an image.  This function reads as many of
+   the rows not yet grabbed from camera device \texttt{dev} as fit in
+   \texttt{buffsize} bytes, converting them to host byte order directly
+   into \texttt{buff}.  Rows are \texttt{2 * width} bytes long, where
+   \texttt{width} is the width of the image area.  A whole frame is
+   grabbed when \texttt{buff} is large enough, otherwise the call may
+   be repeated until the frame is complete.  Calls may be freely mixed
+   with \texttt{FLIGrabRow}.
+
+   @param dev Camera whose image to grab.
+
+   @param buff Pointer to where the rows will be placed.
+
+   @param buffsize Size of \texttt{buff} in bytes.
+
+   @param bytesgrabbed Pointer to where the number of bytes placed in
+   \texttt{buff} will be stored.
+
+   @return Zero on success.
+   @return Non-zero on failure, -EINVAL if the camera does not support
+   frame grabs or no rows are left.
+
+   @see FLIGrabRow
+   @see FLIExposeFrame
+*/
 LIBFLIAPI FLIGrabFrame(flidev_t dev, void* buff,
 		       size_t buffsize, size_t* bytesgrabbed)
 {
-  INDI_UNUSED(dev);
-  INDI_UNUSED(buff);
-  INDI_UNUSED(buffsize);
-  INDI_UNUSED(bytesgrabbed);
-	return -EINVAL;
+  CHKDEVICE(dev);
+
+  if (bytesgrabbed == NULL)
+    return -EINVAL;
+
+  *bytesgrabbed = 0;
+
+  return DEVICE->fli_command(dev, FLI_GRAB_FRAME, 3, buff, &buffsize, bytesgrabbed);
 }
 
 /**
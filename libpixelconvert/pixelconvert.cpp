@@ -0,0 +1,456 @@
+/*
+    Pixel layout conversion kernels for INDI color camera drivers
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "pixelconvert.h"
+
+#include <atomic>
+#include <utility>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PIXELCONVERT_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXELCONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+
+// All x86 kernels work on blocks of 48 bytes (three 128-bit registers), which hold
+// 16 pixels of 8-bit RGB or 8 pixels of 16-bit RGB. Every output register is
+// assembled from the three input registers with one byte shuffle each.
+constexpr size_t BLOCK_BYTES = 48;
+
+struct BlockShuffle
+{
+    // mask[o][r][k]: byte of input register r that goes to byte k of output register o, 0x80 if none.
+    uint8_t mask[3][3][16];
+    // The AVX2 kernel gains nothing on 16-bit elements, pixelconvert_bench measures it
+    // slower than SSSE3 for RGB48, so those run the SSSE3 kernel on AVX2 machines too.
+    bool useAVX2;
+};
+
+BlockShuffle makeShuffle(bool swap, int elementSize)
+{
+    BlockShuffle s;
+    s.useAVX2 = (elementSize == 1);
+
+    for (int o = 0; o < 3; o++)
+        for (int r = 0; r < 3; r++)
+            for (int k = 0; k < 16; k++)
+                s.mask[o][r][k] = 0x80;
+
+    for (int o = 0; o < 3; o++)
+    {
+        for (int k = 0; k < 16; k++)
+        {
+            int src;
+            if (swap)
+            {
+                // Output stays interleaved, first and third channel exchange places.
+                int p       = o * 16 + k;
+                int element = p / elementSize;
+                int channel = element % 3;
+                src = ((element - channel) + (2 - channel)) * elementSize + p % elementSize;
+            }
+            else
+            {
+                // Output register o holds channel o only.
+                int element = k / elementSize;
+                src = (element * 3 + o) * elementSize + k % elementSize;
+            }
+            s.mask[o][src / 16][k] = static_cast<uint8_t>(src % 16);
+        }
+    }
+
+    return s;
+}
+
+const BlockShuffle &deinterleave8()
+{
+    static const BlockShuffle s = makeShuffle(false, 1);
+    return s;
+}
+
+const BlockShuffle &deinterleave16()
+{
+    static const BlockShuffle s = makeShuffle(false, 2);
+    return s;
+}
+
+const BlockShuffle &swap8()
+{
+    static const BlockShuffle s = makeShuffle(true, 1);
+    return s;
+}
+
+const BlockShuffle &swap16()
+{
+    static const BlockShuffle s = makeShuffle(true, 2);
+    return s;
+}
+
+#ifdef PIXELCONVERT_X86
+// Process whole 48-byte blocks. Output register o of block n is written to out[o] + n * step.
+// Returns the number of blocks processed.
+__attribute__((target("ssse3")))
+size_t shuffleBlocksSSSE3(const uint8_t *src, uint8_t *out[3], size_t step, size_t blocks, const BlockShuffle &s)
+{
+    __m128i mask[3][3];
+    for (int o = 0; o < 3; o++)
+        for (int r = 0; r < 3; r++)
+            mask[o][r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s.mask[o][r]));
+
+    uint8_t *o0 = out[0], *o1 = out[1], *o2 = out[2];
+
+    for (size_t n = 0; n < blocks; n++)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+
+        __m128i r0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, mask[0][0]), _mm_shuffle_epi8(b, mask[0][1])),
+                                  _mm_shuffle_epi8(c, mask[0][2]));
+        __m128i r1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, mask[1][0]), _mm_shuffle_epi8(b, mask[1][1])),
+                                  _mm_shuffle_epi8(c, mask[1][2]));
+        __m128i r2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, mask[2][0]), _mm_shuffle_epi8(b, mask[2][1])),
+                                  _mm_shuffle_epi8(c, mask[2][2]));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(o0), r0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(o1), r1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(o2), r2);
+
+        src += BLOCK_BYTES;
+        o0 += step;
+        o1 += step;
+        o2 += step;
+    }
+
+    return blocks;
+}
+
+// AVX2 byte shuffles do not cross 128-bit lanes, so each iteration places block n in
+// the low lane and block n + 1 in the high lane and reuses the SSSE3 masks.
+__attribute__((target("avx2")))
+size_t shuffleBlocksAVX2(const uint8_t *src, uint8_t *out[3], size_t step, size_t blocks, const BlockShuffle &s)
+{
+    __m256i mask[3][3];
+    for (int o = 0; o < 3; o++)
+        for (int r = 0; r < 3; r++)
+            mask[o][r] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s.mask[o][r])));
+
+    uint8_t *o0 = out[0], *o1 = out[1], *o2 = out[2];
+    const size_t pairs = blocks / 2;
+
+    for (size_t n = 0; n < pairs; n++)
+    {
+        __m256i in[3];
+        for (int r = 0; r < 3; r++)
+        {
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + r * 16));
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + BLOCK_BYTES + r * 16));
+            in[r] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        }
+
+        uint8_t *dst[3] = { o0, o1, o2 };
+        for (int o = 0; o < 3; o++)
+        {
+            __m256i v = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(in[0], mask[o][0]),
+                                        _mm256_shuffle_epi8(in[1], mask[o][1])),
+                                        _mm256_shuffle_epi8(in[2], mask[o][2]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst[o]), _mm256_castsi256_si128(v));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst[o] + step), _mm256_extracti128_si256(v, 1));
+        }
+
+        src += 2 * BLOCK_BYTES;
+        o0 += 2 * step;
+        o1 += 2 * step;
+        o2 += 2 * step;
+    }
+
+    return pairs * 2;
+}
+#endif
+
+#ifdef PIXELCONVERT_NEON
+size_t deinterleave24NEON(const uint8_t *src, uint8_t *d0, uint8_t *d1, uint8_t *d2, size_t pixels)
+{
+    size_t n = 0;
+    for (; n + 16 <= pixels; n += 16)
+    {
+        uint8x16x3_t v = vld3q_u8(src + n * 3);
+        vst1q_u8(d0 + n, v.val[0]);
+        vst1q_u8(d1 + n, v.val[1]);
+        vst1q_u8(d2 + n, v.val[2]);
+    }
+    return n;
+}
+
+size_t deinterleave48NEON(const uint16_t *src, uint16_t *d0, uint16_t *d1, uint16_t *d2, size_t pixels)
+{
+    size_t n = 0;
+    for (; n + 8 <= pixels; n += 8)
+    {
+        uint16x8x3_t v = vld3q_u16(src + n * 3);
+        vst1q_u16(d0 + n, v.val[0]);
+        vst1q_u16(d1 + n, v.val[1]);
+        vst1q_u16(d2 + n, v.val[2]);
+    }
+    return n;
+}
+
+size_t swap24NEON(uint8_t *buffer, size_t pixels)
+{
+    size_t n = 0;
+    for (; n + 16 <= pixels; n += 16)
+    {
+        uint8x16x3_t v = vld3q_u8(buffer + n * 3);
+        std::swap(v.val[0], v.val[2]);
+        vst3q_u8(buffer + n * 3, v);
+    }
+    return n;
+}
+
+size_t swap48NEON(uint16_t *buffer, size_t pixels)
+{
+    size_t n = 0;
+    for (; n + 8 <= pixels; n += 8)
+    {
+        uint16x8x3_t v = vld3q_u16(buffer + n * 3);
+        std::swap(v.val[0], v.val[2]);
+        vst3q_u16(buffer + n * 3, v);
+    }
+    return n;
+}
+#endif
+
+PixelConvertSIMD detectSIMD()
+{
+#if defined(PIXELCONVERT_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return PIXELCONVERT_SIMD_AVX2;
+    if (__builtin_cpu_supports("ssse3"))
+        return PIXELCONVERT_SIMD_SSSE3;
+#elif defined(PIXELCONVERT_NEON)
+    return PIXELCONVERT_SIMD_NEON;
+#endif
+    return PIXELCONVERT_SIMD_SCALAR;
+}
+
+std::atomic<int> g_SIMD { -1 };
+
+PixelConvertSIMD currentSIMD()
+{
+    int level = g_SIMD.load(std::memory_order_relaxed);
+    if (level < 0)
+    {
+        level = detectSIMD();
+        g_SIMD.store(level, std::memory_order_relaxed);
+    }
+    return static_cast<PixelConvertSIMD>(level);
+}
+
+// Run the block kernel for the active instruction set and return the number of pixels handled.
+size_t shuffleBlocks(const uint8_t *src, uint8_t *out[3], size_t step, size_t pixels, size_t pixelsPerBlock,
+                     const BlockShuffle &s)
+{
+#ifdef PIXELCONVERT_X86
+    size_t blocks = pixels / pixelsPerBlock;
+    size_t done   = 0;
+
+    switch (currentSIMD())
+    {
+        case PIXELCONVERT_SIMD_AVX2:
+            if (s.useAVX2)
+                done = shuffleBlocksAVX2(src, out, step, blocks, s);
+            if (done < blocks)
+            {
+                uint8_t *rest[3] = { out[0] + done * step, out[1] + done * step, out[2] + done * step };
+                done += shuffleBlocksSSSE3(src + done * BLOCK_BYTES, rest, step, blocks - done, s);
+            }
+            break;
+        case PIXELCONVERT_SIMD_SSSE3:
+            done = shuffleBlocksSSSE3(src, out, step, blocks, s);
+            break;
+        default:
+            break;
+    }
+
+    return done * pixelsPerBlock;
+#else
+    (void)src;
+    (void)out;
+    (void)step;
+    (void)pixels;
+    (void)pixelsPerBlock;
+    (void)s;
+    return 0;
+#endif
+}
+
+template <typename T>
+void deinterleaveScalar(const T *src, T *d0, T *d1, T *d2, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++)
+    {
+        d0[i] = src[0];
+        d1[i] = src[1];
+        d2[i] = src[2];
+        src += 3;
+    }
+}
+
+template <typename T>
+void swapScalar(T *buffer, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++, buffer += 3)
+        std::swap(buffer[0], buffer[2]);
+}
+
+}
+
+extern "C" {
+
+void pixelconvert_deinterleave_rgb24(const uint8_t *src, uint8_t *dstR, uint8_t *dstG, uint8_t *dstB,
+                                     size_t pixels, PixelConvertOrder order)
+{
+    uint8_t *d0 = (order == PIXELCONVERT_ORDER_BGR) ? dstB : dstR;
+    uint8_t *d2 = (order == PIXELCONVERT_ORDER_BGR) ? dstR : dstB;
+    size_t done = 0;
+
+#ifdef PIXELCONVERT_NEON
+    if (currentSIMD() == PIXELCONVERT_SIMD_NEON)
+        done = deinterleave24NEON(src, d0, dstG, d2, pixels);
+#endif
+    if (done == 0)
+    {
+        uint8_t *out[3] = { d0, dstG, d2 };
+        done = shuffleBlocks(src, out, 16, pixels, 16, deinterleave8());
+    }
+
+    deinterleaveScalar(src + done * 3, d0 + done, dstG + done, d2 + done, pixels - done);
+}
+
+void pixelconvert_deinterleave_rgb48(const uint16_t *src, uint16_t *dstR, uint16_t *dstG, uint16_t *dstB,
+                                     size_t pixels, PixelConvertOrder order)
+{
+    uint16_t *d0 = (order == PIXELCONVERT_ORDER_BGR) ? dstB : dstR;
+    uint16_t *d2 = (order == PIXELCONVERT_ORDER_BGR) ? dstR : dstB;
+    size_t done = 0;
+
+#ifdef PIXELCONVERT_NEON
+    if (currentSIMD() == PIXELCONVERT_SIMD_NEON)
+        done = deinterleave48NEON(src, d0, dstG, d2, pixels);
+#endif
+    if (done == 0)
+    {
+        uint8_t *out[3] = { reinterpret_cast<uint8_t *>(d0), reinterpret_cast<uint8_t *>(dstG), reinterpret_cast<uint8_t *>(d2) };
+        done = shuffleBlocks(reinterpret_cast<const uint8_t *>(src), out, 16, pixels, 8, deinterleave16());
+    }
+
+    deinterleaveScalar(src + done * 3, d0 + done, dstG + done, d2 + done, pixels - done);
+}
+
+void pixelconvert_swap_rb24(uint8_t *buffer, size_t pixels)
+{
+    size_t done = 0;
+
+#ifdef PIXELCONVERT_NEON
+    if (currentSIMD() == PIXELCONVERT_SIMD_NEON)
+        done = swap24NEON(buffer, pixels);
+#endif
+    if (done == 0)
+    {
+        uint8_t *out[3] = { buffer, buffer + 16, buffer + 32 };
+        done = shuffleBlocks(buffer, out, BLOCK_BYTES, pixels, 16, swap8());
+    }
+
+    swapScalar(buffer + done * 3, pixels - done);
+}
+
+void pixelconvert_swap_rb48(uint16_t *buffer, size_t pixels)
+{
+    size_t done = 0;
+
+#ifdef PIXELCONVERT_NEON
+    if (currentSIMD() == PIXELCONVERT_SIMD_NEON)
+        done = swap48NEON(buffer, pixels);
+#endif
+    if (done == 0)
+    {
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(buffer);
+        uint8_t *out[3] = { bytes, bytes + 16, bytes + 32 };
+        done = shuffleBlocks(bytes, out, BLOCK_BYTES, pixels, 8, swap16());
+    }
+
+    swapScalar(buffer + done * 3, pixels - done);
+}
+
+PixelConvertSIMD pixelconvert_get_simd(void)
+{
+    return currentSIMD();
+}
+
+PixelConvertSIMD pixelconvert_best_simd(void)
+{
+    return detectSIMD();
+}
+
+int pixelconvert_set_simd(PixelConvertSIMD level)
+{
+    PixelConvertSIMD best = detectSIMD();
+    bool supported = (level == PIXELCONVERT_SIMD_SCALAR);
+
+#if defined(PIXELCONVERT_X86)
+    supported |= (level == PIXELCONVERT_SIMD_SSSE3 && best >= PIXELCONVERT_SIMD_SSSE3);
+    supported |= (level == PIXELCONVERT_SIMD_AVX2 && best == PIXELCONVERT_SIMD_AVX2);
+#elif defined(PIXELCONVERT_NEON)
+    supported |= (level == PIXELCONVERT_SIMD_NEON && best == PIXELCONVERT_SIMD_NEON);
+#else
+    (void)best;
+#endif
+
+    if (!supported)
+        return -1;
+
+    g_SIMD.store(level, std::memory_order_relaxed);
+    return 0;
+}
+
+const char *pixelconvert_simd_name(PixelConvertSIMD level)
+{
+    switch (level)
+    {
+        case PIXELCONVERT_SIMD_SCALAR:
+            return "Scalar";
+        case PIXELCONVERT_SIMD_SSSE3:
+            return "SSSE3";
+        case PIXELCONVERT_SIMD_AVX2:
+            return "AVX2";
+        case PIXELCONVERT_SIMD_NEON:
+            return "NEON";
+    }
+    return "Unknown";
+}
+
+}
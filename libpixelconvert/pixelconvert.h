@@ -0,0 +1,106 @@
+/*
+    Pixel layout conversion kernels for INDI color camera drivers
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIXELCONVERT_VERSION_MAJOR 1
+#define PIXELCONVERT_VERSION_MINOR 0
+
+/**
+ * @brief Instruction set used by the conversion kernels.
+ * The best supported level is selected at runtime on first use.
+ */
+typedef enum
+{
+    PIXELCONVERT_SIMD_SCALAR = 0,
+    PIXELCONVERT_SIMD_SSSE3,
+    PIXELCONVERT_SIMD_AVX2,
+    PIXELCONVERT_SIMD_NEON
+} PixelConvertSIMD;
+
+/**
+ * @brief Channel order of interleaved input pixels.
+ */
+typedef enum
+{
+    PIXELCONVERT_ORDER_RGB = 0,
+    PIXELCONVERT_ORDER_BGR
+} PixelConvertOrder;
+
+/**
+ * @brief Split interleaved 8-bit RGB24/BGR24 pixels into three planes.
+ * @param src interleaved input, 3 * pixels bytes.
+ * @param dstR red plane, pixels bytes.
+ * @param dstG green plane, pixels bytes.
+ * @param dstB blue plane, pixels bytes.
+ * @param pixels number of pixels.
+ * @param order channel order of src.
+ * @note src must not overlap any of the destination planes.
+ */
+void pixelconvert_deinterleave_rgb24(const uint8_t *src, uint8_t *dstR, uint8_t *dstG, uint8_t *dstB,
+                                     size_t pixels, PixelConvertOrder order);
+
+/**
+ * @brief Split interleaved 16-bit RGB48/BGR48 pixels into three planes.
+ * Same as pixelconvert_deinterleave_rgb24 with 16-bit samples.
+ */
+void pixelconvert_deinterleave_rgb48(const uint16_t *src, uint16_t *dstR, uint16_t *dstG, uint16_t *dstB,
+                                     size_t pixels, PixelConvertOrder order);
+
+/**
+ * @brief Swap first and third channel of interleaved 8-bit pixels in place (RGB24 <-> BGR24).
+ */
+void pixelconvert_swap_rb24(uint8_t *buffer, size_t pixels);
+
+/**
+ * @brief Swap first and third channel of interleaved 16-bit pixels in place (RGB48 <-> BGR48).
+ */
+void pixelconvert_swap_rb48(uint16_t *buffer, size_t pixels);
+
+/**
+ * @return Instruction set currently used by the kernels.
+ */
+PixelConvertSIMD pixelconvert_get_simd(void);
+
+/**
+ * @brief Force the kernels to use a given instruction set. Used by tests and benchmarks.
+ * @return 0 on success, -1 if the level is not supported by this build or CPU.
+ */
+int pixelconvert_set_simd(PixelConvertSIMD level);
+
+/**
+ * @return Highest instruction set supported by this build and CPU.
+ */
+PixelConvertSIMD pixelconvert_best_simd(void);
+
+/**
+ * @return Printable name of an instruction set level.
+ */
+const char *pixelconvert_simd_name(PixelConvertSIMD level);
+
+#ifdef __cplusplus
+}
+#endif
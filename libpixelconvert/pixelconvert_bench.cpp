@@ -0,0 +1,98 @@
+/*
+    Microbenchmark for the pixel layout conversion kernels
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+// Usage: pixelconvert_bench [width] [height] [iterations]
+// Defaults to a 26MP (6248x4176) frame, the size of the largest current color sensors.
+
+#include "pixelconvert.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+template <typename T>
+static void legacyDeinterleave(const T *src, T *image, size_t pixels)
+{
+    T *dstR = image;
+    T *dstG = image + pixels;
+    T *dstB = image + pixels * 2;
+    const T *end = src + pixels * 3;
+    while (src != end)
+    {
+        *dstB++ = *src++;
+        *dstG++ = *src++;
+        *dstR++ = *src++;
+    }
+}
+
+static double run(int iterations, const std::function<void()> &fn)
+{
+    fn();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+template <typename T>
+static void bench(const char *label, size_t pixels, int iterations,
+                  void (*convert)(const T *, T *, T *, T *, size_t, PixelConvertOrder))
+{
+    std::vector<T> src(pixels * 3), dst(pixels * 3);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = static_cast<T>(i * 2654435761u);
+
+    double mb = pixels * 3 * sizeof(T) / 1e6;
+    double legacy = run(iterations, [&]()
+    {
+        legacyDeinterleave(src.data(), dst.data(), pixels);
+    });
+    printf("%-8s %-8s %8.2f ms %8.1f MB/s\n", label, "Legacy", legacy, mb / legacy * 1000);
+
+    for (PixelConvertSIMD level : { PIXELCONVERT_SIMD_SCALAR, PIXELCONVERT_SIMD_SSSE3, PIXELCONVERT_SIMD_AVX2, PIXELCONVERT_SIMD_NEON })
+    {
+        if (pixelconvert_set_simd(level) != 0)
+            continue;
+
+        double ms = run(iterations, [&]()
+        {
+            convert(src.data(), dst.data(), dst.data() + pixels, dst.data() + pixels * 2, pixels, PIXELCONVERT_ORDER_BGR);
+        });
+        printf("%-8s %-8s %8.2f ms %8.1f MB/s  x%.2f\n", label, pixelconvert_simd_name(level), ms, mb / ms * 1000, legacy / ms);
+    }
+    pixelconvert_set_simd(pixelconvert_best_simd());
+}
+
+int main(int argc, char *argv[])
+{
+    size_t width  = argc > 1 ? strtoul(argv[1], nullptr, 10) : 6248;
+    size_t height = argc > 2 ? strtoul(argv[2], nullptr, 10) : 4176;
+    int iterations = argc > 3 ? atoi(argv[3]) : 10;
+
+    printf("Frame %zux%zu, %d iterations, best SIMD: %s\n", width, height, iterations,
+           pixelconvert_simd_name(pixelconvert_best_simd()));
+
+    bench<uint8_t>("RGB24", width * height, iterations, pixelconvert_deinterleave_rgb24);
+    bench<uint16_t>("RGB48", width * height, iterations, pixelconvert_deinterleave_rgb48);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+    Frame ring for INDI camera drivers that stream video
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "pixelconvert_framering.h"
+
+void FrameRing::allocate(size_t depth, size_t frameSize)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mSlots.size() != depth)
+        mSlots.resize(depth);
+
+    for (auto &slot : mSlots)
+        slot.data.resize(frameSize);
+
+    mHead = mTail = mCount = 0;
+    mClosed = mDiscard = false;
+}
+
+void FrameRing::release()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSlots.clear();
+    mSlots.shrink_to_fit();
+    mHead = mTail = mCount = 0;
+}
+
+FrameRing::Slot *FrameRing::beginWrite()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    // The slot at mTail stays counted while the consumer processes it, so it is never handed out twice.
+    if (mClosed || mCount >= mSlots.size())
+        return nullptr;
+
+    return &mSlots[mHead];
+}
+
+void FrameRing::endWrite()
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mHead = (mHead + 1) % mSlots.size();
+        mCount++;
+    }
+    mCondition.notify_one();
+}
+
+FrameRing::Slot *FrameRing::beginRead(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (!mCondition.wait_for(lock, timeout, [this] { return mCount > 0 || mClosed; }))
+        return nullptr;
+
+    // Once closed, frames already queued are still handed out unless they are discarded
+    if (mCount == 0 || (mClosed && mDiscard))
+        return nullptr;
+
+    return &mSlots[mTail];
+}
+
+void FrameRing::endRead()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mTail = (mTail + 1) % mSlots.size();
+    mCount--;
+}
+
+void FrameRing::close(bool discardQueued)
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mClosed = true;
+        mDiscard = discardQueued;
+    }
+    mCondition.notify_all();
+}
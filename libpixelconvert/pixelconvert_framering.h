@@ -0,0 +1,96 @@
+/*
+    Frame ring for INDI camera drivers that stream video
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Fixed depth ring of pre-allocated video frames shared by one producer and one consumer.
+ *
+ * The producer never blocks: when every slot is still waiting for the consumer, beginWrite()
+ * returns nullptr and the frame has to be dropped. The consumer waits for filled slots with
+ * beginRead() and hands them back with endRead().
+ */
+class FrameRing
+{
+    public:
+        struct Slot
+        {
+            std::vector<uint8_t> data;
+            /** Number of bytes of data filled by the last frame */
+            size_t size {0};
+            /** Time the frame was read from the camera */
+            std::chrono::steady_clock::time_point timestamp;
+        };
+
+    public:
+        /** Allocate depth slots of frameSize bytes each and reset the ring */
+        void allocate(size_t depth, size_t frameSize);
+
+        /** Free all slots */
+        void release();
+
+        /** @return next free slot, or nullptr if the ring is full */
+        Slot *beginWrite();
+        /** Publish the slot returned by beginWrite() to the consumer */
+        void endWrite();
+
+        /** Wait up to timeout for a filled slot. Returns nullptr on timeout or when the ring is closed and empty */
+        Slot *beginRead(std::chrono::milliseconds timeout);
+        /** Return the slot obtained by beginRead() to the producer */
+        void endRead();
+
+        /**
+         * Stop the producer and wake up the consumer. The consumer can still read the frames
+         * queued so far, unless discardQueued is set.
+         */
+        void close(bool discardQueued = false);
+
+        bool isClosed()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            return mClosed;
+        }
+
+        size_t depth() const
+        {
+            return mSlots.size();
+        }
+
+        size_t frameSize() const
+        {
+            return mSlots.empty() ? 0 : mSlots.front().data.size();
+        }
+
+    private:
+        std::vector<Slot> mSlots;
+        size_t mHead {0};
+        size_t mTail {0};
+        size_t mCount {0};
+        bool mClosed {false};
+        bool mDiscard {false};
+
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+};
@@ -0,0 +1,166 @@
+/*
+    Unit tests for the video frame ring
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "pixelconvert_framering.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+
+namespace
+{
+const std::chrono::milliseconds shortWait(10);
+
+void writeFrame(FrameRing &ring, uint8_t value)
+{
+    FrameRing::Slot *slot = ring.beginWrite();
+    ASSERT_NE(nullptr, slot);
+    slot->data[0] = value;
+    slot->size    = 1;
+    ring.endWrite();
+}
+}
+
+TEST(FrameRing, DropsWhenFull)
+{
+    FrameRing ring;
+    ring.allocate(3, 16);
+    EXPECT_EQ(3u, ring.depth());
+    EXPECT_EQ(16u, ring.frameSize());
+
+    for (uint8_t i = 0; i < 3; i++)
+        writeFrame(ring, i);
+    EXPECT_EQ(nullptr, ring.beginWrite());
+
+    // The slot being read stays taken until endRead()
+    FrameRing::Slot *slot = ring.beginRead(shortWait);
+    ASSERT_NE(nullptr, slot);
+    EXPECT_EQ(0, slot->data[0]);
+    EXPECT_EQ(nullptr, ring.beginWrite());
+    ring.endRead();
+    writeFrame(ring, 3);
+
+    for (uint8_t i = 1; i < 4; i++)
+    {
+        slot = ring.beginRead(shortWait);
+        ASSERT_NE(nullptr, slot);
+        EXPECT_EQ(i, slot->data[0]);
+        ring.endRead();
+    }
+    EXPECT_EQ(nullptr, ring.beginRead(shortWait));
+}
+
+TEST(FrameRing, CloseKeepsQueuedFrames)
+{
+    FrameRing ring;
+    ring.allocate(4, 8);
+    writeFrame(ring, 7);
+    writeFrame(ring, 8);
+    ring.close();
+
+    EXPECT_TRUE(ring.isClosed());
+    EXPECT_EQ(nullptr, ring.beginWrite());
+    for (uint8_t i = 7; i < 9; i++)
+    {
+        FrameRing::Slot *slot = ring.beginRead(shortWait);
+        ASSERT_NE(nullptr, slot);
+        EXPECT_EQ(i, slot->data[0]);
+        ring.endRead();
+    }
+    EXPECT_EQ(nullptr, ring.beginRead(shortWait));
+}
+
+TEST(FrameRing, CloseCanDiscardQueuedFrames)
+{
+    FrameRing ring;
+    ring.allocate(4, 8);
+    writeFrame(ring, 1);
+    ring.close(true);
+    EXPECT_EQ(nullptr, ring.beginRead(shortWait));
+
+    // A new stream starts empty and open
+    ring.allocate(4, 8);
+    EXPECT_FALSE(ring.isClosed());
+    EXPECT_EQ(nullptr, ring.beginRead(shortWait));
+}
+
+TEST(FrameRing, CloseWakesConsumer)
+{
+    FrameRing ring;
+    ring.allocate(2, 8);
+    std::thread closer([&ring]
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ring.close();
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(nullptr, ring.beginRead(std::chrono::milliseconds(5000)));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    closer.join();
+}
+
+TEST(FrameRing, ProducerConsumer)
+{
+    const int frames = 10000;
+    FrameRing ring;
+    ring.allocate(4, 4);
+
+    int received = 0, dropped = 0;
+    bool ordered = true;
+    std::thread consumer([&]
+    {
+        int last = -1;
+        while (true)
+        {
+            bool closed = ring.isClosed();
+            FrameRing::Slot *slot = ring.beginRead(shortWait);
+            if (slot == nullptr)
+            {
+                if (closed)
+                    break;
+                continue;
+            }
+            int value;
+            memcpy(&value, slot->data.data(), sizeof(value));
+            ordered = ordered && value > last;
+            last = value;
+            received++;
+            ring.endRead();
+        }
+    });
+
+    for (int i = 0; i < frames; i++)
+    {
+        FrameRing::Slot *slot = ring.beginWrite();
+        if (slot == nullptr)
+        {
+            dropped++;
+            continue;
+        }
+        memcpy(slot->data.data(), &i, sizeof(i));
+        ring.endWrite();
+    }
+    ring.close();
+    consumer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(frames, received + dropped);
+}
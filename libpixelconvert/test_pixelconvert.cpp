@@ -0,0 +1,187 @@
+/*
+    Unit tests for the pixel layout conversion kernels
+    Copyright (C) 2026 INDI Developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "pixelconvert.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const size_t sizes[] = { 0, 1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 47, 48, 100, 1023, 4099 };
+
+std::vector<PixelConvertSIMD> supportedLevels()
+{
+    std::vector<PixelConvertSIMD> levels;
+    for (PixelConvertSIMD level : { PIXELCONVERT_SIMD_SCALAR, PIXELCONVERT_SIMD_SSSE3, PIXELCONVERT_SIMD_AVX2, PIXELCONVERT_SIMD_NEON })
+    {
+        if (pixelconvert_set_simd(level) == 0)
+            levels.push_back(level);
+    }
+    pixelconvert_set_simd(pixelconvert_best_simd());
+    return levels;
+}
+
+template <typename T>
+std::vector<T> randomPixels(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<T> data(count);
+    for (auto &v : data)
+        v = static_cast<T>(rng());
+    return data;
+}
+
+// Reference: the per-pixel loop the ASI and Player One drivers used for BGR24.
+template <typename T>
+void legacyDeinterleaveBGR(const T *src, T *image, size_t pixels)
+{
+    T *dstR = image;
+    T *dstG = image + pixels;
+    T *dstB = image + pixels * 2;
+    const T *end = src + pixels * 3;
+    while (src != end)
+    {
+        *dstB++ = *src++;
+        *dstG++ = *src++;
+        *dstR++ = *src++;
+    }
+}
+
+// Reference: the per-pixel loop the Toupcam driver used for RGB24.
+template <typename T>
+void legacyDeinterleaveRGB(const T *src, T *image, size_t pixels)
+{
+    T *subR = image;
+    T *subG = image + pixels;
+    T *subB = image + pixels * 2;
+    for (size_t i = 0; i < pixels * 3; i += 3)
+    {
+        *subR++ = src[i];
+        *subG++ = src[i + 1];
+        *subB++ = src[i + 2];
+    }
+}
+
+// Reference: the std::swap loop used on RGB24 video frames.
+template <typename T>
+void legacySwap(T *buffer, size_t pixels)
+{
+    for (size_t i = 0; i < pixels * 3; i += 3)
+        std::swap(buffer[i], buffer[i + 2]);
+}
+
+}
+
+TEST(PixelConvert, DeinterleaveRGB24)
+{
+    for (auto level : supportedLevels())
+    {
+        ASSERT_EQ(pixelconvert_set_simd(level), 0);
+        for (size_t pixels : sizes)
+        {
+            auto src = randomPixels<uint8_t>(pixels * 3, pixels);
+            std::vector<uint8_t> expected(pixels * 3), actual(pixels * 3, 0xA5);
+
+            legacyDeinterleaveBGR(src.data(), expected.data(), pixels);
+            pixelconvert_deinterleave_rgb24(src.data(), actual.data(), actual.data() + pixels, actual.data() + pixels * 2,
+                                            pixels, PIXELCONVERT_ORDER_BGR);
+            EXPECT_EQ(expected, actual) << pixelconvert_simd_name(level) << " BGR " << pixels;
+
+            legacyDeinterleaveRGB(src.data(), expected.data(), pixels);
+            pixelconvert_deinterleave_rgb24(src.data(), actual.data(), actual.data() + pixels, actual.data() + pixels * 2,
+                                            pixels, PIXELCONVERT_ORDER_RGB);
+            EXPECT_EQ(expected, actual) << pixelconvert_simd_name(level) << " RGB " << pixels;
+        }
+    }
+    pixelconvert_set_simd(pixelconvert_best_simd());
+}
+
+TEST(PixelConvert, DeinterleaveRGB48)
+{
+    for (auto level : supportedLevels())
+    {
+        ASSERT_EQ(pixelconvert_set_simd(level), 0);
+        for (size_t pixels : sizes)
+        {
+            auto src = randomPixels<uint16_t>(pixels * 3, pixels + 1);
+            std::vector<uint16_t> expected(pixels * 3), actual(pixels * 3, 0xA5A5);
+
+            legacyDeinterleaveBGR(src.data(), expected.data(), pixels);
+            pixelconvert_deinterleave_rgb48(src.data(), actual.data(), actual.data() + pixels, actual.data() + pixels * 2,
+                                            pixels, PIXELCONVERT_ORDER_BGR);
+            EXPECT_EQ(expected, actual) << pixelconvert_simd_name(level) << " BGR " << pixels;
+
+            legacyDeinterleaveRGB(src.data(), expected.data(), pixels);
+            pixelconvert_deinterleave_rgb48(src.data(), actual.data(), actual.data() + pixels, actual.data() + pixels * 2,
+                                            pixels, PIXELCONVERT_ORDER_RGB);
+            EXPECT_EQ(expected, actual) << pixelconvert_simd_name(level) << " RGB " << pixels;
+        }
+    }
+    pixelconvert_set_simd(pixelconvert_best_simd());
+}
+
+TEST(PixelConvert, SwapRB)
+{
+    for (auto level : supportedLevels())
+    {
+        ASSERT_EQ(pixelconvert_set_simd(level), 0);
+        for (size_t pixels : sizes)
+        {
+            auto expected8 = randomPixels<uint8_t>(pixels * 3, pixels + 2);
+            auto actual8 = expected8;
+            legacySwap(expected8.data(), pixels);
+            pixelconvert_swap_rb24(actual8.data(), pixels);
+            EXPECT_EQ(expected8, actual8) << pixelconvert_simd_name(level) << " 8-bit " << pixels;
+
+            auto expected16 = randomPixels<uint16_t>(pixels * 3, pixels + 3);
+            auto actual16 = expected16;
+            legacySwap(expected16.data(), pixels);
+            pixelconvert_swap_rb48(actual16.data(), pixels);
+            EXPECT_EQ(expected16, actual16) << pixelconvert_simd_name(level) << " 16-bit " << pixels;
+        }
+    }
+    pixelconvert_set_simd(pixelconvert_best_simd());
+}
+
+TEST(PixelConvert, UnalignedBuffers)
+{
+    const size_t pixels = 1001;
+    std::vector<uint8_t> src(pixels * 3 + 1), expected(pixels * 3), actual(pixels * 3 + 1);
+    std::mt19937 rng(7);
+    for (auto &v : src)
+        v = static_cast<uint8_t>(rng());
+
+    legacyDeinterleaveBGR(src.data() + 1, expected.data(), pixels);
+    uint8_t *image = actual.data() + 1;
+    pixelconvert_deinterleave_rgb24(src.data() + 1, image, image + pixels, image + pixels * 2, pixels, PIXELCONVERT_ORDER_BGR);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), image));
+}
+
+TEST(PixelConvert, SIMDSelection)
+{
+    EXPECT_EQ(pixelconvert_set_simd(PIXELCONVERT_SIMD_SCALAR), 0);
+    EXPECT_EQ(pixelconvert_get_simd(), PIXELCONVERT_SIMD_SCALAR);
+    EXPECT_EQ(pixelconvert_set_simd(pixelconvert_best_simd()), 0);
+    EXPECT_EQ(pixelconvert_get_simd(), pixelconvert_best_simd());
+}
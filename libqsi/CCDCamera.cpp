@@ -13,7 +13,11 @@ REVISION HISTORY
 *****************************************************************************************/
 #include <algorithm>
 #include <cctype> 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <pthread.h>
 #include <time.h>
 #include <sys/time.h>
@@ -1044,13 +1048,7 @@ int  CCCDCamera::get_ImageArray(unsigned short* pVal)
 	if ( !m_bIsConnected )
 		return Error ( _T("Not Connected"), IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOTCONNECTED) );
 
-	FillImageBuffer(true); // Retrieve data from the camera
-
-	if ( !m_bImageValid )
-		return Error ( _T("No Image Available"), IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOIMAGEAVAILABLE) );
-
-	m_iError = m_QSIInterface.AdjustZero(m_pusBuffer, pVal, m_ExposureSettings.ColumnsToRead, m_ExposureSettings.RowsToRead, m_iOverscanAdjustment, m_AutoZeroData.zeroEnable);
-	return S_OK;
+	return DownloadImageArray(pVal, true); // Retrieve data from the camera
 }
 
 int CCCDCamera::get_ImageArray(double* pVal)
@@ -1077,13 +1075,7 @@ int CCCDCamera::get_ImageArray(double* pVal)
 	if ( !m_bIsConnected )
 		return Error ( _T("Not Connected"), IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOTCONNECTED) );
 
-	FillImageBuffer(true);
-
-	if ( !m_bImageValid )
-		return Error ( _T("No Image Available"), IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOIMAGEAVAILABLE) );
-
-	m_iError = m_QSIInterface.AdjustZero(m_pusBuffer, pVal, m_ExposureSettings.ColumnsToRead, m_ExposureSettings.RowsToRead, m_dOverscanAdjustment, m_AutoZeroData.zeroEnable);
-	return S_OK;
+	return DownloadImageArray(pVal, true);
 }
 
 int  CCCDCamera::get_ImageReady(bool* pVal)
@@ -2769,13 +2761,31 @@ void CCCDCamera::CloseCamera ( void )
 	return;
 }
 
-int CCCDCamera::FillImageBuffer(bool bMakeRequest)
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	double MsBetween(Clock::time_point start, Clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	// Overscan adjustment matching the output type, see QSI_Interface::AdjustZero
+	int 	OverscanAdjustment(const USHORT *, int iAdjust, double) { return iAdjust; }
+	int 	OverscanAdjustment(const long *, int iAdjust, double) { return iAdjust; }
+	double 	OverscanAdjustment(const double *, int, double dAdjust) { return dAdjust; }
+}
+
+int CCCDCamera::FillImageBuffer(bool bMakeRequest, const RowBlockCallback & onRows, std::vector<int> * pRemapped)
 {
 	// This is the common code for reading an image from the camera
 	// and filling the image buffer
 	// The interface methods call this and then transfer the data
 	// from the USHORT buffer and convert it into the appropriate
-	// format
+	// format.
+	// When onRows is set, each block of rows is handed to a worker thread
+	// as soon as it is read, so it is processed while the next block
+	// is on the wire.
 
 	int iStride;
 	int iRowsRead;
@@ -2788,6 +2798,8 @@ int CCCDCamera::FillImageBuffer(bool bMakeRequest)
 	if (!m_DownloadPending)
 		return S_OK;
 
+	Clock::time_point tStart = Clock::now();
+
 	// Surround entire operation with a semaphore so the read data isn;t interrupted by a status request
 	csQSI.Lock();
 	m_DownloadPending = false;
@@ -2810,11 +2822,60 @@ int CCCDCamera::FillImageBuffer(bool bMakeRequest)
 		}
 	}
 
+	Clock::time_point tRequest = Clock::now();
+
 	// Some callers require each row word aligned, so this may be some number of bytes more that number of columns
 	// MaxIm is always row align, so stride is just the size of the row in bytes.
 	iStride = m_ExposureSettings.ColumnsToRead * iPixelSize;
 	iTotRowsRead = 0;
 
+	// Rows up to iRowsReady are in m_pusBuffer and may be handed to onRows
+	std::mutex mtxRows;
+	std::condition_variable cvRows;
+	int iRowsReady = 0;
+	bool bReadDone = false;
+	double dRowsMs = 0;
+	std::thread worker;
+
+	if (onRows)
+	{
+		const int iCols = m_ExposureSettings.ColumnsToRead;
+		worker = std::thread([&, iCols]()
+		{
+			int iRowsDone = 0;
+			for (;;)
+			{
+				int iRows;
+				{
+					std::unique_lock<std::mutex> lock(mtxRows);
+					cvRows.wait(lock, [&]() { return iRowsReady > iRowsDone || bReadDone; });
+					iRows = iRowsReady;
+				}
+				if (iRows == iRowsDone)
+					break;
+
+				Clock::time_point t = Clock::now();
+				onRows(iRowsDone * iCols, (iRows - iRowsDone) * iCols);
+				dRowsMs += MsBetween(t, Clock::now());
+				iRowsDone = iRows;
+			}
+		});
+	}
+
+	auto publishRows = [&](int iRows, bool bDone)
+	{
+		if (!worker.joinable())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(mtxRows);
+			iRowsReady = iRows;
+			bReadDone = bDone;
+		}
+		cvRows.notify_one();
+		if (bDone)
+			worker.join();
+	};
+
 	while (iTotRowsRead < m_ExposureSettings.RowsToRead)
 	{
 		// ReadImageByRow may return fewer rows than requested.  It is up to the caller to make additional calls to retreive the entire image.
@@ -2823,22 +2884,87 @@ int CCCDCamera::FillImageBuffer(bool bMakeRequest)
 		if (m_iError != ALL_OK)
 		{
 			csQSI.Unlock();
+			publishRows(iTotRowsRead, true);
 			return Error ( "Image transfer error", IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, m_iError) );
 		}
 		iTotRowsRead += iRowsRead;  // Update the number of pixels read, ReadImage may return less row that we requested.
+		publishRows(iTotRowsRead, false);
 	}
 	//
 	// Image is now in m_pusBuffer
 	//
 	csQSI.Unlock();
+
+	Clock::time_point tRows = Clock::now();
+	publishRows(iTotRowsRead, true);
+	Clock::time_point tDrain = Clock::now();
 	
 	m_iError = GetAutoZeroData( bMakeRequest ); // true == issue autozero request to camera
 	if( m_iError != ALL_OK ) 
 		return Error ( "Auto zero get data error", IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, m_iError) );
 
+	Clock::time_point tAutoZero = Clock::now();
+
 	// Now apply the Hot Pixel map
-	m_QSIInterface.HotPixelRemap((BYTE *)m_pusBuffer, 0, m_ExposureSettings, m_DeviceDetails, m_AutoZeroData.zeroLevel);
+	m_QSIInterface.HotPixelRemap((BYTE *)m_pusBuffer, 0, m_ExposureSettings, m_DeviceDetails, m_AutoZeroData.zeroLevel, pRemapped);
 	m_bImageValid = true;
+
+	Clock::time_point tRemap = Clock::now();
+
+	// LogWrite does not forward its arguments, format here
+	char szTiming[256];
+	snprintf(szTiming, sizeof(szTiming),
+			 "Image download timing (ms): request %.1f, rows %.1f (%d rows), row processing %.1f of which %.1f after the last row, autozero %.1f, hot pixels %.1f",
+			 MsBetween(tStart, tRequest), MsBetween(tRequest, tRows), iTotRowsRead, dRowsMs, MsBetween(tRows, tDrain),
+			 MsBetween(tDrain, tAutoZero), MsBetween(tAutoZero, tRemap));
+	m_QSIInterface.LogWrite(2, szTiming);
+	return S_OK;
+}
+
+template <typename T>
+int CCCDCamera::DownloadImageArray(T * pVal, bool bMakeRequest)
+{
+	// Converts the image to the callers type and applies the auto zero adjustment.
+	// A pending download copies each block of rows into pVal while the next one is read,
+	// only the adjustment is left once the overscan has arrived after the last row.
+	const int iCols = m_ExposureSettings.ColumnsToRead;
+	const int iRows = m_ExposureSettings.RowsToRead;
+
+	if (!m_DownloadPending)
+	{
+		if ( !m_bImageValid )
+			return Error ( _T("No Image Available"), IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOIMAGEAVAILABLE) );
+
+		m_iError = m_QSIInterface.AdjustZero(m_pusBuffer, pVal, iCols, iRows, OverscanAdjustment(pVal, m_iOverscanAdjustment, m_dOverscanAdjustment), m_AutoZeroData.zeroEnable);
+		return S_OK;
+	}
+
+	USHORT usMaxPixel = 0;
+	std::vector<int> remapped;
+
+	FillImageBuffer(bMakeRequest, [&](int iFirst, int iCount)
+	{
+		USHORT usMax = m_QSIInterface.CopyRows(m_pusBuffer + iFirst, pVal + iFirst, iCount);
+		usMaxPixel = std::max(usMax, usMaxPixel);
+	}, &remapped);
+
+	if ( !m_bImageValid )
+		return Error ( _T("No Image Available"), IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOIMAGEAVAILABLE) );
+
+	Clock::time_point tStart = Clock::now();
+
+	// Hot pixels were replaced in m_pusBuffer after their rows had been copied
+	for (size_t i = 0; i < remapped.size(); i++)
+	{
+		usMaxPixel = std::max(m_QSIInterface.CopyRows(m_pusBuffer + remapped[i], pVal + remapped[i], 1), usMaxPixel);
+	}
+
+	m_iError = m_QSIInterface.AdjustZeroInPlace(pVal, iCols * iRows, OverscanAdjustment(pVal, m_iOverscanAdjustment, m_dOverscanAdjustment),
+												m_AutoZeroData.zeroEnable, usMaxPixel);
+
+	char szTiming[128];
+	snprintf(szTiming, sizeof(szTiming), "Image auto zero adjust timing (ms): %.1f", MsBetween(tStart, Clock::now()));
+	m_QSIInterface.LogWrite(2, szTiming);
 	return S_OK;
 }
 
@@ -4063,15 +4189,8 @@ int CCCDCamera::HSRImage(double Duration, USHORT * pImage)
 	// Wait for Image Data, it will just start when camera is ready
 	// This will also read the autozero pixels after the image
 	///////////////////////////////////////////////////////////////////
-	FillImageBuffer(false); // False indicates to need to issue CMD to transfer data/autozero
-	if ( !m_bImageValid) 
-		return Error ( _T("No Image Available"), IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOIMAGEAVAILABLE) );
-
-	USHORT* pSrc = m_pusBuffer;
-	// Adjust zero also copies the data and does any appropriate casting of pixel type.
-	m_iError = m_QSIInterface.AdjustZero(pSrc, pImage, m_ExposureSettings.ColumnsToRead, m_ExposureSettings.RowsToRead,  m_iOverscanAdjustment, m_AutoZeroData.zeroEnable);
-
-	return S_OK;
+	// Rows are copied into pImage as they arrive, the zero adjustment follows the autozero pixels.
+	return DownloadImageArray(pImage, false); // False indicates to need to issue CMD to transfer data/autozero
 }
 
 int CCCDCamera::put_HSRMode(bool newVal)
@@ -17,7 +17,9 @@ REVISION HISTORY
 #include "QSI_Interface.h"
 #include "qsiapi.h"
 #include "config.h"
+#include <functional>
 #include <string>
+#include <vector>
 #include "QSICriticalSection.h"
 
 #ifndef PACKAGE_VERSION
@@ -295,7 +297,11 @@ private:
 	int 	PutFilterConnected(bool bCon);
 	int 	GetFilterConnected(bool * pVal);
 	void 	CloseCamera ( void );
-	int 	FillImageBuffer( bool bMakeRequest );
+	// Called on a worker thread with each block of rows (first pixel, pixel count) once it is in m_pusBuffer
+	typedef std::function<void(int, int)> RowBlockCallback;
+	int 	FillImageBuffer( bool bMakeRequest, const RowBlockCallback & onRows = RowBlockCallback(),
+							 std::vector<int> * pRemapped = NULL );
+	template <typename T> int	DownloadImageArray( T * pVal, bool bMakeRequest );
 	int		GetAutoZeroData(bool bMakeRequest );
 
 	//////////////////////////////////////////////////////////////////////////////////////
@@ -100,7 +100,8 @@ bool HotPixelMap::Save(void)
 }
 
 void HotPixelMap::Remap(	BYTE * Image, int RowPad, QSI_ExposureSettings Exposure,
-							QSI_DeviceDetails Details, USHORT ZeroPixel, QSILog * log)
+							QSI_DeviceDetails Details, USHORT ZeroPixel, QSILog * log,
+							std::vector<int> * Remapped)
 {
 	int pIndex;
 	std::vector<Pixel>::iterator vi;
@@ -118,6 +119,8 @@ void HotPixelMap::Remap(	BYTE * Image, int RowPad, QSI_ExposureSettings Exposure
 			log->Write(2, _T("Remap pixel: x=%d, y=%d, old value: %d, new value: %d."),
 							(*vi).x, (*vi).y, *(USHORT*)(&Image[pIndex]), ZeroPixel); 
 			*(USHORT*)(&Image[pIndex]) = ZeroPixel;
+			if (Remapped != NULL)
+				Remapped->push_back(pIndex / 2);	// pixel index
 		}
 	}
 }
@@ -30,7 +30,8 @@ public:
 	HotPixelMap(std::string Serial);
 	~HotPixelMap(void);
 	void Remap(	BYTE * Image, int RowPad, QSI_ExposureSettings Exposure,
-				QSI_DeviceDetails Details, USHORT ZeroPixel, QSILog * log);
+				QSI_DeviceDetails Details, USHORT ZeroPixel, QSILog * log,
+				std::vector<int> * Remapped = NULL);
 	bool Save(void);
 	std::vector<Pixel> GetPixels(void);
 	void SetPixels(std::vector<Pixel> map);
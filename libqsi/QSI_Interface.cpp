@@ -2823,6 +2823,110 @@ int QSI_Interface::AdjustZero(USHORT* pSrc, long* pDst, int iPixelsPerRow, int i
 	return result;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Pipelined download.  The overscan pixels follow the last image row, so the auto zero
+// adjustment is only known once the whole image is in.  CopyRows converts blocks to the
+// output type while the next block downloads, AdjustZeroInPlace then applies the
+// adjustment and saturation limit exactly as AdjustZero does.
+template <typename T>
+static USHORT CopyRowsT(const USHORT* pSrc, T* pDst, int iPixels)
+{
+	USHORT usMax = 0;
+	for (int i = 0; i < iPixels; i++)
+	{
+		USHORT pixel = pSrc[i];
+		if (pixel > usMax)
+			usMax = pixel;
+		pDst[i] = (T)pixel;
+	}
+	return usMax;
+}
+
+template <typename T, typename A>
+static void AdjustZeroInPlaceT(T* pDst, int iPixels, A adjust, A maxADU, int & iNegPixelCount, int & iSatPixelCount)
+{
+	for (int i = 0; i < iPixels; i++)
+	{
+		A pixel = (A)pDst[i] + adjust;
+		if (pixel < 0)
+		{
+			pixel = 0;
+			iNegPixelCount++;
+		}
+		if (pixel > maxADU)
+		{
+			pixel = maxADU;
+			iSatPixelCount++;
+		}
+		pDst[i] = (T)pixel;
+	}
+}
+
+USHORT QSI_Interface::CopyRows(USHORT* pSrc, USHORT* pDst, int iPixels)
+{
+	return CopyRowsT(pSrc, pDst, iPixels);
+}
+
+USHORT QSI_Interface::CopyRows(USHORT* pSrc, double* pDst, int iPixels)
+{
+	return CopyRowsT(pSrc, pDst, iPixels);
+}
+
+USHORT QSI_Interface::CopyRows(USHORT* pSrc, long* pDst, int iPixels)
+{
+	return CopyRowsT(pSrc, pDst, iPixels);
+}
+
+template <typename T, typename A>
+int QSI_Interface::AdjustZeroInPlaceImpl(T* pDst, int iPixels, A adjust, bool bAdjust, USHORT usMaxPixel)
+{
+	int iNegPixelCount = 0;
+	int iSatPixelCount = 0;
+
+	if (m_bAutoZeroEnable == false)
+	{
+		m_log->Write(2, _T("WARNING: AutoZero disabled via user setting."));
+		bAdjust = false;
+	}
+
+	if (!bAdjust)
+		adjust = 0;
+
+	// The copied pixels are never negative, nothing to do unless they move or some exceed the max ADU
+	if (adjust == 0 && usMaxPixel <= m_dwAutoZeroMaxADU)
+	{
+		m_log->Write(2, _T("AutoZero adjust pixels in place skipped, no adjustment."));
+		return 0;
+	}
+
+	AdjustZeroInPlaceT(pDst, iPixels, adjust, (A)m_dwAutoZeroMaxADU, iNegPixelCount, iSatPixelCount);
+
+	if (m_log->LoggingEnabled(6) || (m_log->LoggingEnabled(1) && iNegPixelCount > 0) )
+	{
+		m_log->Write(6, _T("AutoZero Data:"));
+		snprintf(m_log->m_Message, MSGSIZE, _T("NegPixels: %d, Pixels Exceeding Sat Threshold : %d"),
+											 iNegPixelCount, iSatPixelCount );
+		m_log->Write(6);
+	}
+	m_log->Write(2, _T("AutoZero adjust pixels in place complete."));
+	return 0;
+}
+
+int QSI_Interface::AdjustZeroInPlace(USHORT* pDst, int iPixels, int usAdjust, bool bAdjust, USHORT usMaxPixel)
+{
+	return AdjustZeroInPlaceImpl<USHORT, int>(pDst, iPixels, usAdjust, bAdjust, usMaxPixel);
+}
+
+int QSI_Interface::AdjustZeroInPlace(double* pDst, int iPixels, double dAdjust, bool bAdjust, USHORT usMaxPixel)
+{
+	return AdjustZeroInPlaceImpl<double, double>(pDst, iPixels, dAdjust, bAdjust, usMaxPixel);
+}
+
+int QSI_Interface::AdjustZeroInPlace(long* pDst, int iPixels, int usAdjust, bool bAdjust, USHORT usMaxPixel)
+{
+	return AdjustZeroInPlaceImpl<long, int>(pDst, iPixels, usAdjust, bAdjust, usMaxPixel);
+}
+
 int compareUSHORT( const void *val1, const void *val2)
 {
 	if (*(USHORT*)val1 == *(USHORT*)val2)
@@ -2914,10 +3018,10 @@ int QSI_Interface::QSIWriteTimeout(int timeout)
 }
 
 void QSI_Interface::HotPixelRemap(	BYTE * Image, int RowPad, QSI_ExposureSettings Exposure,
-							QSI_DeviceDetails Details, USHORT ZeroPixel)
+							QSI_DeviceDetails Details, USHORT ZeroPixel, std::vector<int> * Remapped)
 {
 	m_log->Write(2, _T("Hot Pixel Remap started."));
-	m_hpmMap.Remap(Image, RowPad, Exposure, Details, ZeroPixel, m_log);
+	m_hpmMap.Remap(Image, RowPad, Exposure, Details, ZeroPixel, m_log, Remapped);
 	m_log->Write(2, _T("Hot Pixel Remap complete."));
 }
 
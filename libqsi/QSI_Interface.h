@@ -119,6 +119,14 @@ public:
 	int AdjustZero(USHORT* pSrc, USHORT * pDst, int iRowLen, int iRowsLeft, int    usAdjust, bool bAdjust);
 	int AdjustZero(USHORT* pSrc, double * pDst, int iRowLen, int iRowsLeft, double dAdjust,  bool bAdjust);
 	int AdjustZero(USHORT* pSrc, long   * pDst, int iRowLen, int iRowsLeft, int    usAdjust, bool bAdjust);
+	// Pipelined download: copy rows before the adjustment is known, returns the largest pixel copied
+	USHORT CopyRows(USHORT* pSrc, USHORT * pDst, int iPixels);
+	USHORT CopyRows(USHORT* pSrc, double * pDst, int iPixels);
+	USHORT CopyRows(USHORT* pSrc, long   * pDst, int iPixels);
+	// then adjust the copied pixels, same result as AdjustZero on the source
+	int AdjustZeroInPlace(USHORT * pDst, int iPixels, int    usAdjust, bool bAdjust, USHORT usMaxPixel);
+	int AdjustZeroInPlace(double * pDst, int iPixels, double dAdjust,  bool bAdjust, USHORT usMaxPixel);
+	int AdjustZeroInPlace(long   * pDst, int iPixels, int    usAdjust, bool bAdjust, USHORT usMaxPixel);
 	// End new Autozero
 	int HasFastExposure( bool & bFast );
 	int QSIRead( unsigned char * Buffer, int BytesToRead, int * BytesReturned);
@@ -129,7 +137,7 @@ public:
 	int QSIWriteTimeout(int timeout);
 	//
 	void HotPixelRemap(	BYTE * Image, int RowPad, QSI_ExposureSettings Exposure,
-							QSI_DeviceDetails Details, USHORT ZeroPixel);
+							QSI_DeviceDetails Details, USHORT ZeroPixel, std::vector<int> * Remapped = NULL);
 
 	int CMD_ExtTrigMode( BYTE action, BYTE polarity);
 
@@ -172,6 +180,7 @@ private:
 	void PutBool(PVOID, bool);
 	void Put2Bytes(PVOID, USHORT);
 	void Put3Bytes(PVOID, uint32_t);
+	template <typename T, typename A> int AdjustZeroInPlaceImpl(T* pDst, int iPixels, A adjust, bool bAdjust, USHORT usMaxPixel);
 	
 	int m_iError; // Holds errors; declared here so it won't have to be declared every function
 	HostConnection 		m_HostCon;